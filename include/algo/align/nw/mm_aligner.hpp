@@ -100,7 +100,8 @@ protected:
         eID,      eDD,   eGD,
         eIG,      eDG,   eGG
     };
-    TScore x_FindBestJ( const vector<TScore>& vEtop,
+    TScore x_FindBestJ( const SCoordRect& rect,
+                        const vector<TScore>& vEtop,
                         const vector<TScore>& vFtop,
                         const vector<TScore>& vGtop,
                         const vector<TScore>& vEbtm,
@@ -90,6 +90,15 @@ public:
     // Compute the alignment
     virtual TScore Run(void);
 
+    // Compute the optimal score only, without the alignment.
+    // Uses space linear in the sequence lengths, so it is suitable for
+    // sequences too long for Run(). The dynamic programming matrix is
+    // computed in tiles along anti-diagonals with SIMD instructions
+    // where available and in parallel bands of rows when multiple
+    // threads are enabled. The result is the same as the score returned
+    // by Run(); patterns are not supported.
+    TScore RunScoreOnly(void);
+
     //See CNWFormatter class for output options
 
     // Compte an alignment based on two Seq-locs
@@ -237,7 +246,22 @@ public:
                                        size_t start1 = kMax_UInt,
                                        size_t start2 = kMax_UInt ) const;
 
-    void    EnableMultipleThreads(bool enable = true);
+    // Use up to max_threads threads, or as many as there are CPUs
+    // if max_threads is zero.
+    void    EnableMultipleThreads(bool enable = true, size_t max_threads = 0);
+
+    // Compute the alignment in linear space with the Myers-Miller
+    // (Hirschberg) divide-and-conquer algorithm of CMMAligner instead of
+    // keeping the full backtrace matrix. This takes about twice as long
+    // as the default quadratic-space mode but is not limited by
+    // the available memory, and uses all threads enabled with
+    // EnableMultipleThreads(). Supported for global alignments without
+    // a pattern. Among equally scored alignments a different one may be
+    // reported than in the default mode.
+    void    SetLinearSpace(bool linear_space = true) {
+        m_LinearSpace = linear_space;
+    }
+    bool    GetLinearSpace(void) const { return m_LinearSpace; }
 
     // A naive pattern generator-use cautiously.
     // Do not use on sequences with repeats or error.
@@ -323,6 +347,9 @@ protected:
     // approximate max space to use
     size_t                   m_MaxMem;
 
+    // linear space mode flag
+    bool                     m_LinearSpace;
+
     // facilitate guide pre- and  post-processing, if applicable
     virtual TScore x_Run   (void);
 
@@ -391,6 +418,11 @@ protected:
     // retrieve transcript symbol for a one-character diag
     virtual ETranscriptSymbol x_GetDiagTS(size_t i1, size_t i2) const;
 
+    // linear space alignment and score-only computation
+    TScore x_RunLinearSpace(void);
+    struct SScoreOnlyData;
+    void x_ScoreOnlyBands(SScoreOnlyData* data, size_t first_band);
+
 private:
     // Needleman-Wunsch + Smith-Waterman
     void x_SWDoBackTrace(const CBacktraceMatrix4 & backtrace,
@@ -398,6 +430,7 @@ private:
 
 
     friend class CNWAlignerThread_Align;
+    friend class CNWAlignerThread_ScoreOnly;
 };
 
 
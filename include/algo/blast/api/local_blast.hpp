@@ -112,6 +112,19 @@ public:
     /// Get the diagnostics structure (deep copy, needs to be deleted by caller)
     BlastDiagnostics* GetDiagnostics();
 
+    /// Set the number of threads used in the traceback stage, which may
+    /// differ from the number used in the preliminary stage. If not set
+    /// (or set to 0), the value of the BLAST_TRACEBACK_THREADS environment
+    /// variable is used, and otherwise the value set with
+    /// SetNumberOfThreads.
+    /// @param nthreads number of traceback threads [in]
+    void SetNumberOfTracebackThreads(size_t nthreads) {
+        m_NumTracebackThreads = nthreads;
+    }
+
+    /// Get the number of threads to use in the traceback stage
+    size_t GetNumberOfTracebackThreads(void) const;
+
     // set batch number
     void SetBatchNumber( int batch_num ) {
 	m_batch_num_str = string("B") + NStr::NumericToString( batch_num );
@@ -144,6 +157,9 @@ private:
     /// Warnings and error messages
     TSearchMessages                 m_Messages;
 
+    /// Number of threads for the traceback stage, 0 if not set
+    size_t m_NumTracebackThreads;
+
     // current batch number
     std::string m_batch_num_str;
 
@@ -1066,6 +1066,8 @@ public:
 
         /// unaligned reads in magicblast
         eFasta,
+        /// Binary columnar tabular output, 21
+        eBinaryTabular,
         /// Sentinel value for error checking
         eEndValue
         
@@ -62,6 +62,18 @@ typedef struct {
 } BlastGapDP;
 
 
+/** Query profile of one query context, used by the striped computation
+ *  of protein Smith-Waterman scores. The profile depends only on the
+ *  query and the score matrix, so it is built once per search. */
+typedef struct BlastSWProfile {
+   const Uint1* query;  /**< query sequence the profile was built from */
+   Int4 query_length;   /**< length of the query sequence */
+   Int4** matrix;       /**< score matrix or PSSM the profile was built
+                             from */
+   Int4 max_score;      /**< largest score in the profile */
+   void* scores;        /**< profile scores, in the striped layout */
+} BlastSWProfile;
+
 typedef struct JumperGapAlign JumperGapAlign;
 typedef struct ChainingStruct ChainingStruct;
 
@@ -78,6 +90,11 @@ typedef struct BlastGapAlignStruct {
                                          gapped extension */
    BlastGapDP* dp_mem; /**< scratch structures for dynamic programming */
    Int4 dp_mem_alloc;  /**< current number of structures allocated */
+   BlastSWProfile* sw_profiles; /**< Smith-Waterman query profiles,
+                                     indexed by query context */
+   Int4 num_sw_profiles; /**< number of elements in sw_profiles */
+   void* sw_scratch;     /**< scratch space of the striped Smith-Waterman */
+   Int4 sw_scratch_alloc; /**< bytes allocated for sw_scratch */
    BlastScoreBlk* sbp; /**< Pointer to the scoring information block */
    Int4 gap_x_dropoff; /**< X-dropoff parameter to use */
    Int4 max_mismatches;  /**< Max number of mismatches for jumper */
@@ -116,6 +133,14 @@ NCBI_XBLAST_EXPORT
 BlastGapAlignStruct* 
 BLAST_GapAlignStructFree(BlastGapAlignStruct* gap_align);
 
+/** Deallocates the Smith-Waterman query profiles and scratch space of a
+ *  BlastGapAlignStruct; they are rebuilt when next needed.
+ * @param gap_align Structure holding the profiles [in] [out]
+ */
+NCBI_XBLAST_EXPORT
+void
+BlastGapAlignSWProfilesFree(BlastGapAlignStruct* gap_align);
+
 /** Performs gapped extension for all non-Mega BLAST programs, given
  * that ungapped extension has been done earlier.
  * Sorts initial HSPs by score (from ungapped extension);
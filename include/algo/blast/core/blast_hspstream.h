@@ -202,6 +202,11 @@ extern const int kBlastHSPStream_Success;
 NCBI_XBLAST_EXPORT
 extern const int kBlastHSPStream_Eof;
 
+/** Return value when the stream is locked by another thread (applicable to
+ * BlastHSPStreamTryBatchWrite only) */
+NCBI_XBLAST_EXPORT
+extern const int kBlastHSPStream_Busy;
+
 /** Invokes the user-specified write function for this BlastHSPStream
  * implementation.
  * @param hsp_stream The BlastHSPStream object [in]
@@ -212,6 +217,35 @@ extern const int kBlastHSPStream_Eof;
 NCBI_XBLAST_EXPORT
 int BlastHSPStreamWrite(BlastHSPStream* hsp_stream, BlastHSPList** hsp_list);
 
+/** Writes a batch of HSP lists to the stream, taking the stream's lock only
+ * once for the whole batch. This lets a search thread collect its HSP lists
+ * in a buffer of its own and merge them into the shared stream from time to
+ * time, instead of contending for the lock on every subject sequence.
+ * @param hsp_stream The BlastHSPStream object [in]
+ * @param hsp_lists Array of HSP lists; NULL entries are skipped. The stream
+ * takes ownership of every list it has written and sets its entry to NULL;
+ * on error, the remaining lists are left to the caller [in] [out]
+ * @param num_hsplists Number of entries in hsp_lists [in]
+ * @return kBlastHSPStream_Success on success, otherwise kBlastHSPStream_Error
+ */
+NCBI_XBLAST_EXPORT
+int BlastHSPStreamBatchWrite(BlastHSPStream* hsp_stream,
+                             BlastHSPList** hsp_lists, Int4 num_hsplists);
+
+/** Same as BlastHSPStreamBatchWrite, but does not wait for the stream's lock:
+ * if another thread holds it, nothing is written, so that the caller can
+ * keep searching and try again later.
+ * @param hsp_stream The BlastHSPStream object [in]
+ * @param hsp_lists Array of HSP lists, as for BlastHSPStreamBatchWrite; left
+ * untouched if the stream is busy [in] [out]
+ * @param num_hsplists Number of entries in hsp_lists [in]
+ * @return kBlastHSPStream_Success on success, kBlastHSPStream_Busy if the
+ * lock is held by another thread, otherwise kBlastHSPStream_Error
+ */
+NCBI_XBLAST_EXPORT
+int BlastHSPStreamTryBatchWrite(BlastHSPStream* hsp_stream,
+                                BlastHSPList** hsp_lists, Int4 num_hsplists);
+
 /** Invokes the user-specified read function for this BlastHSPStream
  * implementation.
  * @param hsp_stream The BlastHSPStream object [in]
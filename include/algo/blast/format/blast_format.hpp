@@ -45,6 +45,7 @@ Author: Jason Papadopoulos
 #include <algo/blast/api/psiblast_iteration.hpp>
 #include <algo/blast/core/blast_seqsrc.h>
 #include <objtools/align_format/tabular.hpp>
+#include <objtools/align_format/binary_tabular.hpp>
 #include <objtools/align_format/showalign.hpp>
 #include <objtools/align_format/showdefline.hpp>
 #include <objtools/align_format/taxFormat.hpp>
@@ -414,6 +415,9 @@ private:
     /// Pointer to the SAM formatting object
     unique_ptr<CBlast_SAM_Formatter> m_SamFormatter;
 
+    /// Writer of the binary tabular output
+    CRef<align_format::CBlastBinaryTabularWriter> m_BinaryTabularWriter;
+
     string m_Cmdline;
 
     /// If true, print long sequence ids (database|accession)
@@ -81,6 +81,28 @@ IOEventToServIOEvent(EIO_Event event)
 
 class CNetCacheServer;
 
+
+/// Statistics of the CServer poll cycle
+struct SServer_LoopStat
+{
+    SServer_LoopStat(void)
+        : iterations(0), events(0),
+          busy_time(0), max_busy_time(0), wait_time(0)
+    {}
+
+    /// Number of the poll cycle iterations
+    Uint8   iterations;
+    /// Number of the events returned by poll, including the wakeups
+    Uint8   events;
+    /// Total time spent in the iterations outside of poll, in seconds
+    double  busy_time;
+    /// Longest iteration outside of poll, in seconds
+    double  max_busy_time;
+    /// Total time spent waiting in poll, in seconds
+    double  wait_time;
+};
+
+
 /////////////////////////////////////////////////////////////////////////////
 ///
 ///  CServer::
@@ -166,6 +188,16 @@ public:
     ///  currently listened ports
     vector<unsigned short>  GetListenerPorts(void);
 
+    /// Get statistics of the poll cycle accumulated since the start
+    /// or since the last ResetLoopStat()
+    void GetLoopStat(SServer_LoopStat* stat) const;
+    /// Reset statistics of the poll cycle
+    void ResetLoopStat(void);
+
+    /// Whether the connections are polled with epoll (enabled with the
+    /// [server] Use_Epoll configuration parameter, Linux only)
+    bool IsEpollUsed(void) const;
+
 protected:
     /// Initialize the server
     ///
@@ -192,6 +224,7 @@ protected:
 
 private:
     void x_DoRun(void);
+    void x_UpdateLoopStat(double busy_time, double wait_time, size_t events);
 
     friend class CNetCacheServer;
     CPoolOfThreads_ForServer* GetThreadPool(void) { return m_ThreadPool; }
@@ -200,6 +233,9 @@ private:
     CServer_ConnectionPool*     m_ConnectionPool;
     CPoolOfThreads_ForServer*   m_ThreadPool;
     string m_ThreadSuffix;
+
+    mutable CFastMutex          m_LoopStatLock;
+    SServer_LoopStat            m_LoopStat;
 };
 
 
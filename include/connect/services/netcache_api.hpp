@@ -455,6 +455,49 @@ class NCBI_XCONNECT_EXPORT CNetCacheAPI
     CNcbiIstream* GetIStream(const string& key, size_t* blob_size = NULL,
             const CNamedParameterList* optional = NULL);
 
+    /// @name Multi-blob operations
+    /// Commands for blobs stored on the same server are sent
+    /// back-to-back over a single connection and the responses are
+    /// read in the same order; different servers are accessed in
+    /// parallel. Blobs that cannot be accessed this way (version 3
+    /// keys, keys of other services, a failed connection) are
+    /// processed one by one by the respective single-blob method;
+    /// so are the blobs not found on their primary servers by
+    /// ReadBlobs(), to look for them on the mirrors.
+    /// @{
+
+    /// Check if the BLOBs exist.
+    ///
+    /// @return
+    ///    Existence flags in the order of blob_ids.
+    vector<bool> HasBlobs(const vector<string>& blob_ids,
+            const CNamedParameterList* optional = NULL);
+
+    /// Read the BLOBs entirely.
+    ///
+    /// @param buffers
+    ///    Resized to the number of keys; receives the contents
+    ///    of the found BLOBs (empty strings for the missing ones).
+    /// @return
+    ///    eReadComplete or eNotFound for each of the keys.
+    vector<EReadResult> ReadBlobs(const vector<string>& keys,
+            vector<string>& buffers,
+            const CNamedParameterList* optional = NULL);
+
+    /// Create new BLOBs.
+    ///
+    /// @note
+    ///    If a connection breaks after the data were sent, the BLOBs
+    ///    without received keys are created again one by one. The server
+    ///    may have already stored some of them; such BLOBs are left
+    ///    unreferenced until their TTL expires.
+    /// @return
+    ///    Keys of the created BLOBs in the order of data.
+    vector<string> PutBlobs(const vector<string>& data,
+            const CNamedParameterList* optional = NULL);
+
+    /// @}
+
     /// Remove BLOB by key
     void Remove(const string& blob_id,
             const CNamedParameterList* optional = NULL);
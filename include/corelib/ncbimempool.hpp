@@ -95,10 +95,38 @@ public:
     /// and delete it correspondingly.
     static void Delete(const CObject* object);
 
+    /// Allocation statistics.
+    struct SStatistics
+    {
+        SStatistics(void)
+            : m_Allocations(0), m_AllocatedBytes(0),
+              m_LargeAllocations(0), m_Chunks(0)
+            {
+            }
+
+        /// Number of memory blocks allocated from the pool.
+        size_t m_Allocations;
+        /// Total size of these blocks.
+        size_t m_AllocatedBytes;
+        /// Number of requests rejected by size (above malloc threshold),
+        /// these blocks are allocated from system heap by the caller.
+        size_t m_LargeAllocations;
+        /// Number of chunks allocated from system heap.
+        size_t m_Chunks;
+    };
+
+    /// Get allocation statistics collected since construction
+    /// or last ResetStatistics() call.
+    const SStatistics& GetStatistics(void) const;
+
+    /// Reset allocation statistics.
+    void ResetStatistics(void);
+
 private:
     size_t m_ChunkSize;
     size_t m_MallocThreshold;
     CRef<CObjectMemoryPoolChunk> m_CurrentChunk;
+    SStatistics m_Statistics;
 
 private:
     // prevent copying
@@ -124,6 +152,21 @@ size_t CObjectMemoryPool::GetMallocThreshold(void) const
 }
 
 
+inline
+const CObjectMemoryPool::SStatistics&
+CObjectMemoryPool::GetStatistics(void) const
+{
+    return m_Statistics;
+}
+
+
+inline
+void CObjectMemoryPool::ResetStatistics(void)
+{
+    m_Statistics = SStatistics();
+}
+
+
 END_NCBI_SCOPE
 
 /* @} */
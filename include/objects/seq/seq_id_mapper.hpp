@@ -113,6 +113,12 @@ public:
     };
     size_t Dump(CNcbiOstream& out,
                 EDumpDetails details = eDumpTotalBytes) const;
+
+    /// Get number of times a thread had to wait for the lock of
+    /// a Seq-id type index. Lookups of existing handles run concurrently,
+    /// so the count grows only when handles are created or released
+    /// while other threads access the same Seq-id type.
+    Uint8 GetLockContentionCount(void) const;
     
 private:
     CSeq_id_Mapper(void);
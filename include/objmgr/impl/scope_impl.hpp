@@ -127,6 +127,80 @@ struct SSeqMatch_Scope : public SSeqMatch_TSE
 };
 
 
+// Configuration lock of a scope.
+// After Freeze() the configuration cannot be changed anymore,
+// read locks become no-ops and write locks throw an exception.
+class CScope_ConfLock
+{
+public:
+    typedef CGuard<CScope_ConfLock,
+                   SSimpleReadLock<CScope_ConfLock>,
+                   SSimpleReadUnlock<CScope_ConfLock> > TReadLockGuard;
+    typedef CGuard<CScope_ConfLock,
+                   SSimpleWriteLock<CScope_ConfLock>,
+                   SSimpleWriteUnlock<CScope_ConfLock> > TWriteLockGuard;
+
+    CScope_ConfLock(void)
+        : m_Frozen(false)
+        {
+        }
+
+    bool IsFrozen(void) const
+        {
+            return m_Frozen.load(memory_order_acquire);
+        }
+
+    void ReadLock(void)
+        {
+            if ( !IsFrozen() ) {
+                m_Lock.ReadLock();
+                if ( IsFrozen() ) {
+                    // frozen while we were waiting for the lock
+                    m_Lock.Unlock();
+                }
+            }
+        }
+    void ReadUnlock(void)
+        {
+            if ( !IsFrozen() ) {
+                m_Lock.Unlock();
+            }
+        }
+
+    void WriteLock(void)
+        {
+            if ( IsFrozen() ) {
+                x_ThrowFrozen();
+            }
+            m_Lock.WriteLock();
+        }
+    void WriteUnlock(void)
+        {
+            m_Lock.Unlock();
+        }
+
+    // Must be called with the write lock held.
+    void SetFrozen(void)
+        {
+            m_Frozen.store(true, memory_order_release);
+        }
+    // Only for the scope destruction, when no other thread can use it.
+    void Unfreeze(void)
+        {
+            m_Frozen.store(false, memory_order_release);
+        }
+
+private:
+    NCBI_NORETURN static void x_ThrowFrozen(void);
+
+    CRWLock      m_Lock;
+    atomic<bool> m_Frozen;
+
+    CScope_ConfLock(const CScope_ConfLock&);
+    CScope_ConfLock& operator=(const CScope_ConfLock&);
+};
+
+
 class NCBI_XOBJMGR_EXPORT CScope_Impl : public CObject
 {
 public:
@@ -553,6 +627,12 @@ public:
     }
     void SetKeepExternalAnnotsForEdit(bool keep = true);
 
+    void Freeze(void);
+    bool IsFrozen(void) const
+    {
+        return m_ConfLock.IsFrozen();
+    }
+
 private:
     // Get bioseq handles for sequences from the given TSE using the filter
     typedef vector<CBioseq_Handle> TBioseq_HandleSet;
@@ -641,7 +721,7 @@ private:
 
     CInitMutexPool       m_MutexPool;
 
-    typedef CRWLock                     TConfLock;
+    typedef CScope_ConfLock             TConfLock;
     typedef TConfLock::TReadLockGuard   TConfReadLockGuard;
     typedef TConfLock::TWriteLockGuard  TConfWriteLockGuard;
     typedef CFastMutex                  TSeq_idMapLock;
@@ -79,6 +79,8 @@ class CScope_Impl;
 class CSynonymsSet;
 class CBlobIdKey;
 class CDataLoader;
+class CMappedFeat;
+struct SAnnotSelector;
 
 
 /////////////////////////////////////////////////////////////////////////////
@@ -615,6 +617,34 @@ public:
                            const TSeq_id_Handles& idhs,
                            TGetFlags flags = 0);
 
+    /// Get features for many locations
+    /// This is a convenience wrapper over CFeat_CI: every location is
+    /// iterated with its own CFeat_CI and the selector, so the selector
+    /// and annotation collector setup are not shared between locations,
+    /// and annotations are loaded per sequence as CFeat_CI does it.
+    /// The only shared work is the resolution of the sequences of all
+    /// locations, done first with batched loader requests as by
+    /// GetBioseqHandles(); the sequences stay locked while the features
+    /// are collected.
+    /// The returned vector contains features for all requested
+    /// locations in the same order, as CFeat_CI would report them;
+    /// null locations get no features.
+    /// If thread_count is greater than 1 the locations are split
+    /// between that many threads, and the first exception thrown
+    /// by any of them is rethrown. A thread_count of 0 is the same as 1:
+    /// the features are collected in the calling thread.
+    /// Users of the result should include <objmgr/mapped_feat.hpp>.
+    typedef vector<CConstRef<CSeq_loc> > TSeq_locs;
+    typedef vector<CMappedFeat> TMappedFeats;
+    typedef vector<TMappedFeats> TBulkFeatures;
+    TBulkFeatures GetBulkFeatures(const TSeq_locs& locs,
+                                  const SAnnotSelector& sel,
+                                  unsigned thread_count = 1);
+    void GetBulkFeatures(TBulkFeatures* results,
+                         const TSeq_locs& locs,
+                         const SAnnotSelector& sel,
+                         unsigned thread_count = 1);
+
     /// Get bioseq synonyms, resolving to the bioseq in this scope.
     CConstRef<CSynonymsSet> GetSynonyms(const CSeq_id&        id);
 
@@ -689,6 +719,32 @@ public:
     ///   GetDefaultKeepExternalAnnotsForEdit(), GetKeepExternalAnnotsForEdit()
     void SetKeepExternalAnnotsForEdit(bool keep = true);
 
+    /// Freeze configuration of the scope.
+    ///
+    /// After this call data loaders, scopes and entries cannot be added
+    /// to or removed from the scope, transactions cannot be started, and
+    /// the history cannot be reset - such calls throw CObjMgrException.
+    /// Edit handle methods that run as edit commands (e.g. AddSeqdesc(),
+    /// AddFeat(), Remove()) need a transaction and throw too.
+    /// In exchange, sequence and annotation lookups do not take the
+    /// scope configuration lock, so many threads sharing a frozen scope
+    /// do not serialize on it. Data are still loaded on demand from
+    /// the scope's data loaders.
+    /// Some edit handle methods change the data in place without a
+    /// transaction (e.g. SetDescr() returning a reference, or the
+    /// qualifier, xref and feature id methods of CSeq_feat_EditHandle),
+    /// and objects added to the scope by non-const reference stay
+    /// modifiable by their owner. The scope cannot detect such changes,
+    /// so the caller must not keep edit handles or modifiable references
+    /// to the scope data across Freeze().
+    /// The scope cannot be unfrozen.
+    /// @sa
+    ///   IsFrozen()
+    void Freeze(void);
+
+    /// Return true if the scope was frozen by Freeze().
+    bool IsFrozen(void) const;
+
 protected:
     CScope_Impl& GetImpl(void);
 
@@ -138,6 +138,32 @@ public:
                           TSeqPos start = 0,
                           TSeqPos stop = kInvalidSeqPos);
 
+    /// Piece of sequence data referring directly to the original Seq-data
+    /// buffer, without conversion into the CSeqVector coding.
+    struct SPackedSegment
+    {
+        TSeqPos     m_Pos;      ///< start position in this CSeqVector
+        TSeqPos     m_Length;   ///< number of residues
+        TCoding     m_Coding;   ///< data coding, e_not_set for a gap
+        const char* m_Data;     ///< start of the packed data, null for a gap
+        TSeqPos     m_DataPos;  ///< index of the first residue in m_Data
+        /// If true the residues go backwards from m_DataPos+m_Length-1
+        /// down to m_DataPos and should be complemented.
+        bool        m_Reverse;
+        /// Keeps m_Data valid while the segment is in use
+        CConstRef<CSeq_data> m_SeqData;
+    };
+    typedef vector<SPackedSegment> TPackedSegments;
+    /// Get the sequence data for the interval [start, stop) as a list of
+    /// segments pointing into the original packed buffers (Ncbi2na,
+    /// Ncbi4na, or one of the one byte per residue codings) and gaps.
+    /// No residue is copied or converted.
+    /// Returns false and clears the list if some part of the data is
+    /// stored in a coding that cannot be exposed directly.
+    bool GetPackedSegments(TPackedSegments& segments,
+                           TSeqPos start = 0,
+                           TSeqPos stop = kInvalidSeqPos) const;
+
     typedef CSeq_inst::TMol TMol;
 
     TMol GetSequenceType(void) const;
@@ -0,0 +1,303 @@
+/* $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's offical duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*/
+
+/// @file: binary_tabular.hpp
+/// Binary columnar form of the BLAST tabular output.
+///
+/// The binary tabular format accepts the same field specifiers as the text
+/// tabular format and stores them column by column. A file has the layout
+/// (all integers little-endian):
+///
+///   header: "BLTC", Uint1 version, Uint4 number of columns, then for each
+///           column Uint1 column type, Uint2 name length and the name
+///           (the tabular format specifier, e.g. "qseqid")
+///   blocks: Uint4 number of rows, Uint1 codec, Uint4 payload size,
+///           Uint4 stored size and the stored payload. The payload is the
+///           concatenation of all columns of the block; numeric columns are
+///           arrays of fixed-width values, string columns hold a
+///           dictionary (Uint4 size, then Uint4 length and bytes of each
+///           entry) followed by one Uint4 dictionary index per row.
+///   end:    a block header with zero rows
+///
+/// Each block is self-contained, so a reader needs to keep only one block
+/// in memory.
+
+#ifndef OBJTOOLS_ALIGN_FORMAT___BINARY_TABULAR_HPP
+#define OBJTOOLS_ALIGN_FORMAT___BINARY_TABULAR_HPP
+
+#include <corelib/ncbistre.hpp>
+#include <objtools/align_format/tabular.hpp>
+
+#include <unordered_map>
+
+BEGIN_NCBI_SCOPE
+BEGIN_SCOPE(align_format)
+
+/// Type of values stored in a binary tabular column
+enum EBinaryTabularColumnType {
+    eBTC_Int4 = 1,  ///< 32-bit signed integer
+    eBTC_Int8,      ///< 64-bit signed integer
+    eBTC_Double,    ///< IEEE 754 double
+    eBTC_String     ///< Dictionary-encoded string
+};
+
+/// Description of a binary tabular column
+struct SBinaryTabularColumn {
+    /// Tabular format specifier of this column
+    string name;
+    /// Type of values in this column
+    EBinaryTabularColumnType type;
+
+    SBinaryTabularColumn(const string& n = kEmptyStr,
+                         EBinaryTabularColumnType t = eBTC_String)
+        : name(n), type(t) {}
+};
+
+/// List of binary tabular columns, in the order they are stored
+typedef vector<SBinaryTabularColumn> TBinaryTabularColumns;
+
+
+/// Writes rows of the binary tabular format, buffering them into blocks of
+/// columns.
+class NCBI_ALIGN_FORMAT_EXPORT CBlastBinaryTabularWriter : public CObject
+{
+public:
+    /// Compression applied to the blocks
+    enum ECompression {
+        eNoCompression = 0, ///< Blocks are stored as is
+        eZstd               ///< Blocks are compressed with zstd
+    };
+
+    /// Number of rows buffered before a block is written
+    static const size_t kDefaultRowsPerBlock = 4096;
+
+    /// Is the given compression available in this build?
+    static bool IsCompressionSupported(ECompression compression);
+
+    /// Compression used when none is specified: zstd if available
+    static ECompression GetDefaultCompression(void);
+
+    /// Constructor
+    /// @param ostr Stream to write output to; should be opened in binary
+    ///        mode [in]
+    /// @param compression Block compression; blocks that do not shrink are
+    ///        stored uncompressed [in]
+    /// @param rows_per_block Number of rows in each block [in]
+    CBlastBinaryTabularWriter(CNcbiOstream& ostr,
+                              ECompression compression =
+                                  GetDefaultCompression(),
+                              size_t rows_per_block = kDefaultRowsPerBlock);
+
+    /// Destructor, writes out the remaining rows if Finish was not called
+    ~CBlastBinaryTabularWriter();
+
+    /// Get the output stream
+    CNcbiOstream& GetStream(void) { return m_Ostream; }
+
+    /// Have the columns been set?
+    bool HasColumns(void) const { return m_HeaderWritten; }
+
+    /// Set the columns and write the file header. Must be called once,
+    /// before the first row is added.
+    /// @param columns Columns of the output [in]
+    void SetColumns(const TBinaryTabularColumns& columns);
+
+    /// Get the columns
+    const TBinaryTabularColumns& GetColumns(void) const { return m_Columns; }
+
+    /// Add one row. Values are given in their text tabular form and
+    /// converted to the column type; numeric values that are not available
+    /// ("N/A") are stored as -1 in integer columns and NaN in double
+    /// columns.
+    /// @param values One value per column [in]
+    /// @throw CStringException if a numeric value cannot be converted
+    void AddRow(const vector<string>& values);
+
+    /// Set a value of an integer column in the current row. Every column
+    /// of the row must be set, in order, before EndRow is called.
+    /// @param col Column index [in]
+    /// @param value Value, -1 if not available [in]
+    void SetInteger(size_t col, Int8 value);
+
+    /// Set a value of a double column in the current row
+    /// @param col Column index [in]
+    /// @param value Value, NaN if not available [in]
+    void SetDouble(size_t col, double value);
+
+    /// Set a value of a string column in the current row
+    /// @param col Column index [in]
+    /// @param value Value [in]
+    void SetString(size_t col, const string& value);
+
+    /// Finish the row whose values were given with the Set methods
+    void EndRow(void);
+
+    /// Write the buffered rows and the end of data marker. Rows cannot be
+    /// added afterwards.
+    void Finish(void);
+
+private:
+    /// Prohibit copy constructor
+    CBlastBinaryTabularWriter(const CBlastBinaryTabularWriter&);
+    /// Prohibit assignment operator
+    CBlastBinaryTabularWriter& operator=(const CBlastBinaryTabularWriter&);
+
+    /// Values of one column in the current block
+    struct SColumnBuffer {
+        vector<Int8> ints;          ///< Values of integer columns
+        vector<double> reals;       ///< Values of double columns
+        vector<Uint4> indices;      ///< Dictionary indices of string columns
+        vector<string> dict;        ///< Dictionary of string columns
+        unordered_map<string, Uint4> dict_map; ///< Dictionary lookup
+    };
+
+    /// Get the buffer of the column whose value is set next
+    /// @param col Column index [in]
+    /// @param type Expected column type [in]
+    SColumnBuffer& x_GetBuffer(size_t col, EBinaryTabularColumnType type);
+
+    /// Drop the values already set for the current row
+    void x_DiscardRow(void);
+
+    /// Write the buffered rows as one block
+    void x_FlushBlock(void);
+
+    CNcbiOstream& m_Ostream;        ///< Stream to write output to
+    ECompression m_Compression;     ///< Block compression
+    size_t m_RowsPerBlock;          ///< Number of rows per block
+    TBinaryTabularColumns m_Columns;///< Output columns
+    vector<SColumnBuffer> m_Buffers;///< Per-column values of current block
+    size_t m_NumRows;               ///< Number of rows in current block
+    size_t m_NextColumn;            ///< Column to be set next in the row
+    bool m_HeaderWritten;           ///< Has the header been written?
+    bool m_Finished;                ///< Has the end marker been written?
+};
+
+
+/// Reads the binary tabular format one block at a time.
+class NCBI_ALIGN_FORMAT_EXPORT CBlastBinaryTabularReader : public CObject
+{
+public:
+    /// Constructor, reads the file header
+    /// @param istr Stream to read from; should be opened in binary mode [in]
+    /// @throw CException if the stream does not start with a valid header
+    CBlastBinaryTabularReader(CNcbiIstream& istr);
+
+    /// Get the columns
+    const TBinaryTabularColumns& GetColumns(void) const { return m_Columns; }
+
+    /// Find a column by its tabular format specifier
+    /// @param name Format specifier, e.g. "sseqid" [in]
+    /// @return Column index or -1 if there is no such column
+    int GetColumnIndex(const string& name) const;
+
+    /// Read the next block
+    /// @return false at the end of data
+    /// @throw CException if the block is malformed or uses a compression
+    /// not supported in this build
+    bool ReadBlock(void);
+
+    /// Number of rows in the current block
+    size_t GetNumRows(void) const { return m_NumRows; }
+
+    /// Get a value of an integer column
+    /// @param col Column index [in]
+    /// @param row Row index within the current block [in]
+    Int8 GetInteger(size_t col, size_t row) const;
+
+    /// Get a value of a double column
+    /// @param col Column index [in]
+    /// @param row Row index within the current block [in]
+    double GetDouble(size_t col, size_t row) const;
+
+    /// Get a value of a string column
+    /// @param col Column index [in]
+    /// @param row Row index within the current block [in]
+    const string& GetString(size_t col, size_t row) const;
+
+    /// Get any value in text form
+    /// @param col Column index [in]
+    /// @param row Row index within the current block [in]
+    string GetValue(size_t col, size_t row) const;
+
+private:
+    /// Prohibit copy constructor
+    CBlastBinaryTabularReader(const CBlastBinaryTabularReader&);
+    /// Prohibit assignment operator
+    CBlastBinaryTabularReader& operator=(const CBlastBinaryTabularReader&);
+
+    /// Values of one column in the current block
+    struct SColumnData {
+        vector<Int8> ints;       ///< Values of integer columns
+        vector<double> reals;    ///< Values of double columns
+        vector<Uint4> indices;   ///< Dictionary indices of string columns
+        vector<string> dict;     ///< Dictionary of string columns
+    };
+
+    CNcbiIstream& m_Istream;        ///< Stream to read from
+    TBinaryTabularColumns m_Columns;///< Columns of the input
+    vector<SColumnData> m_Data;     ///< Per-column values of current block
+    size_t m_NumRows;               ///< Number of rows in current block
+    bool m_AtEnd;                   ///< Was the end marker read?
+};
+
+
+/// Tabular formatter that sends its rows to a binary tabular writer
+/// instead of printing them as text. The fields are selected with the same
+/// format specifiers as for CBlastTabularInfo.
+class NCBI_ALIGN_FORMAT_EXPORT CBlastBinaryTabularInfo
+    : public CBlastTabularInfo
+{
+public:
+    /// Constructor. Sets the writer columns, if they are not set yet.
+    /// @param writer Writer to send the rows to [in]
+    /// @param format Output format - what fields to include in the
+    /// output [in]
+    /// @param parse_local_ids Should local ids be parsed? [in]
+    CBlastBinaryTabularInfo(CBlastBinaryTabularWriter& writer,
+                            const string& format = kDfltArgTabularOutputFmt,
+                            bool parse_local_ids = false);
+
+    /// Columns corresponding to the requested fields
+    TBinaryTabularColumns GetColumns(void) const;
+
+    /// Add one row to the binary output
+    virtual void Print(void);
+
+    /// Type of the column used to store a tabular field
+    /// @param field Tabular field [in]
+    static EBinaryTabularColumnType GetColumnType(ETabularField field);
+
+private:
+    CBlastBinaryTabularWriter& m_Writer; ///< Writer for the rows
+    /// Scratch buffer for the text of string fields
+    CNcbiOstrstream m_FieldStream;
+};
+
+END_SCOPE(align_format)
+END_NCBI_SCOPE
+
+#endif /* OBJTOOLS_ALIGN_FORMAT___BINARY_TABULAR_HPP */
@@ -190,6 +190,10 @@ public:
 
 protected:
     bool x_IsFieldRequested(ETabularField field);
+    /// Fields to show, in the order they are printed
+    const list<ETabularField>& x_GetFieldsToShow(void) const {
+        return m_FieldsToShow;
+    }
     /// Add a field to the list of fields to show, if it is not yet present in
     /// the list of fields.
     /// @param field Which field to add? [in]
@@ -212,6 +216,19 @@ protected:
     /// Print the value of a given field
     /// @param field Which field to show? [in]
     void x_PrintField(ETabularField field);
+    /// Get the value of an integer field without formatting it
+    /// @param field Which field to get? [in]
+    /// @param value Value of the field [out]
+    /// @return false if the field is not an integer one or its value is not
+    /// available
+    bool x_GetIntegerField(ETabularField field, Int8& value) const;
+    /// Get the value of a floating point field (e-value, bit score,
+    /// percentages) at full precision, without formatting it
+    /// @param field Which field to get? [in]
+    /// @param value Value of the field [out]
+    /// @return false if the field is not a floating point one or its value
+    /// is not available
+    bool x_GetDoubleField(ETabularField field, double& value) const;
     /// Print query Seq-id
     void x_PrintQuerySeqId(void) const;
     /// Print query gi
@@ -332,6 +349,8 @@ private:
     int m_Score;             ///< Raw score of this HSP
     string m_BitScore;       ///< Bit score of this HSP, in appropriate format
     string m_Evalue;         ///< E-value of this HSP, in appropriate format
+    double m_BitScoreValue;  ///< Bit score of this HSP, NaN if not set
+    double m_EvalueValue;    ///< E-value of this HSP, NaN if not set
     int m_AlignLength;       ///< Alignment length of this HSP
     int m_NumGaps;           ///< Total number of gaps in this HSP
     int m_NumGapOpens;       ///< Number of gap openings in this HSP
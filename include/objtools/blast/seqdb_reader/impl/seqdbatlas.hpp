@@ -54,6 +54,7 @@
 #include <map>
 #include <set>
 #include <mutex>
+#include <atomic>
 
 BEGIN_NCBI_SCOPE
 
@@ -152,6 +153,14 @@ class CSeqDBFileMemMap;
 /// @return The modified path is returned.
 string SeqDB_MakeOSPath(const string & dbs);
 
+/// Get the page fault counts of this process.
+///
+/// The counts are zero on platforms which do not report them.
+///
+/// @param major_faults Faults which required I/O are returned here.
+/// @param minor_faults Other faults are returned here.
+void SeqDB_GetPageFaults(Int8 & major_faults, Int8 & minor_faults);
+
 
 /// CSeqDBLockHold
 ///
@@ -563,9 +572,68 @@ public:
     }    
 
     int GetOpenedFilseCount(void) { return m_OpenedFilesCount;}
-    
-private:
 
+    /// Readahead policy for memory mapped sequence data.
+    ///
+    /// By default pages of the sequence files are brought in by page
+    /// faults on first access.  When scanning large databases from fast
+    /// storage this makes the search fault-bound, so the OID iteration
+    /// can instead ask the OS to start reading the sequence data of the
+    /// next OID range ahead of time.  The policy is taken from the
+    /// BLASTDB_READAHEAD environment variable ("none", "willneed" or
+    /// "sequential") or the READAHEAD entry of the [BLAST] section of
+    /// the application's configuration file.
+    enum EReadahead {
+        eReadaheadNone,       ///< Rely on page faults only
+        eReadaheadWillNeed,   ///< Request the next OID range in advance
+        eReadaheadSequential  ///< As above, and mark the sequence files
+                              ///  as being read sequentially
+    };
+
+    /// Get the readahead policy.
+    EReadahead GetReadahead() const
+    {
+        return m_Readahead;
+    }
+
+    /// Set the readahead policy.
+    /// @param readahead
+    ///   The new readahead policy.
+    void SetReadahead(EReadahead readahead)
+    {
+        m_Readahead = readahead;
+    }
+
+    /// Ask the OS to read part of a mapped file in advance.
+    ///
+    /// The region is extended to page boundaries.  This is a hint only;
+    /// errors are ignored.
+    ///
+    /// @param file
+    ///   The mapped file, as returned by GetMemoryFile().
+    /// @param begin
+    ///   The starting offset of the region.
+    /// @param end
+    ///   The offset of the first byte after the region.
+    /// @param first_use
+    ///   True if this is the first readahead request for this file.
+    /// @return
+    ///   The number of bytes requested, or 0 if no request was issued.
+    Uint8 Readahead(CMemoryFile * file,
+                    TIndx         begin,
+                    TIndx         end,
+                    bool          first_use);
+
+    /// Get memory mapping statistics.
+    ///
+    /// The atlas is shared by all databases open in the process, so
+    /// only the mapped_files and mapped_bytes fields are filled in, and
+    /// they cover the files of all of those databases.
+    /// @param stats
+    ///   The statistics are returned here.
+    void GetMemoryMapStats(SSeqDBMemoryMapStats & stats);
+
+private:
     class CAtlasMappedFile : public CMemoryFile {
     public:
     	CAtlasMappedFile(const string & filename): CMemoryFile(filename),m_Count(1){
@@ -609,6 +677,12 @@ private:
 
     /// BlastDB search path.
     const string m_SearchPath;
+
+    /// Readahead policy for sequence data.
+    EReadahead m_Readahead;
+
+    /// Total size of the currently mapped files.
+    std::atomic<Uint8> m_MappedBytes;
 };
 
 
@@ -675,7 +749,8 @@ public:
         : m_Atlas(atlas),
           m_DataPtr (NULL),
           m_MappedFile( NULL),
-          m_Mapped(false)
+          m_Mapped(false),
+          m_Advised(false)
     {
         Init(filename);
     }
@@ -684,7 +759,8 @@ public:
         : m_Atlas(atlas),
           m_DataPtr (NULL),
           m_MappedFile( NULL),
-          m_Mapped(false)
+          m_Mapped(false),
+          m_Advised(false)
     {
         
     }
@@ -738,11 +814,36 @@ public:
         if(m_MappedFile && m_Mapped ) {
         	m_MappedFile = m_Atlas.ReturnMemoryFile(m_Filename);
             m_Mapped = false;
+            m_Advised = false;
         }        
     }
 
     bool IsMapped(){return m_Mapped;}
 
+    /// Ask the OS to read part of the file in advance.
+    ///
+    /// This does nothing unless readahead is enabled in the atlas.
+    ///
+    /// @param begin
+    ///   The starting offset of the region.
+    /// @param end
+    ///   The offset of the first byte after the region.
+    /// @return
+    ///   The number of bytes requested, or 0 if no request was issued.
+    Uint8 Readahead(TIndx begin, TIndx end)
+    {
+        if (m_Atlas.GetReadahead() == CSeqDBAtlas::eReadaheadNone) {
+            return 0;
+        }
+        CFastMutexGuard mtx_gurad(m_Mtx);
+        if ( !m_MappedFile || !m_Mapped ) {
+            return 0;
+        }
+        Uint8 bytes = m_Atlas.Readahead(m_MappedFile, begin, end, !m_Advised);
+        m_Advised = true;
+        return bytes;
+    }
+
     /// Get a pointer to the specified offset.
     ///
     /// Given an offset (which is assumed to be available here), this
@@ -778,6 +879,9 @@ private:
     CMemoryFile *m_MappedFile;
 
     bool m_Mapped;
+
+    /// True if a readahead request was made for the mapped file.
+    bool m_Advised;
 };
 
 
@@ -825,6 +825,23 @@ public:
         
         return p;        
     }
+
+    /// Ask the OS to read part of the file in advance.
+    ///
+    /// This is a hint that the sequence data between the given offsets
+    /// will be accessed soon; it does nothing unless readahead is
+    /// enabled in the memory management layer.
+    ///
+    /// @param start
+    ///     The starting offset of the region.
+    /// @param end
+    ///     The offset for the first byte after the region.
+    /// @return
+    ///     The number of bytes requested, or 0 if no request was issued.
+    Uint8 Readahead(TIndx start, TIndx end) const
+    {
+        return m_Lease.Readahead(start, end);
+    }
 };
 
 
@@ -256,6 +256,22 @@ public:
     ///   The length in bases of the sequence.
     int GetSeqLengthExact(int oid) const;
 
+    /// Approximate total length of a range of sequences.
+    ///
+    /// This method computes the number of residues in a range of
+    /// OIDs from the sequence offsets in the index file, without
+    /// looking at the sequences themselves.  For nucleotide volumes
+    /// the result includes the ambiguity data, which is normally
+    /// small compared to the packed bases.
+    ///
+    /// @param begin
+    ///   The first OID of the range. [in]
+    /// @param end
+    ///   The OID after the last one in the range. [in]
+    /// @return
+    ///   The approximate length in bases of the range.
+    Int8 GetRangeLengthApprox(int begin, int end) const;
+
     /// Get filtered sequence header information.
     ///
     /// This method returns the set of Blast-def-line objects stored
@@ -461,6 +477,17 @@ public:
     /// reacquired (but not, for example, the index file data).
     void UnLease();
 
+    /// Request the sequence data of a range of OIDs in advance.
+    ///
+    /// If readahead is enabled in the atlas, the OS is asked to start
+    /// reading the sequence data for these OIDs, so that it is resident
+    /// by the time the sequences are fetched.
+    ///
+    /// @param begin The first OID of the range, relative to this volume.
+    /// @param end The OID after the last one in the range.
+    /// @return The number of bytes requested, or 0 if none was issued.
+    Uint8 Readahead(int begin, int end) const;
+
 
     /// Find the OID given a PIG.
     ///
@@ -1006,6 +1006,18 @@ public:
     /// iterations to be performed over the same CSeqDB object
     void ResetInternalChunkBookmark();
 
+    /// Get memory mapping statistics.
+    ///
+    /// This reports the amount of database data currently memory
+    /// mapped by all CSeqDB objects of the process, the readahead
+    /// requests issued during OID iteration of this object (see the
+    /// BLASTDB_READAHEAD environment variable), and the page faults of
+    /// the process since this object was created.
+    ///
+    /// @param stats
+    ///   The statistics are returned here.
+    void GetMemoryMapStats(SSeqDBMemoryMapStats & stats) const;
+
     /// Get list of database names.
     ///
     /// This returns the database name list used at construction.
@@ -156,6 +156,32 @@ struct NCBI_XOBJREAD_EXPORT SBlastSeqIdListInfo {
 		string db_vol_names;
 };
 
+/// Memory mapping statistics of a CSeqDB object
+///
+/// The memory management layer is shared by all CSeqDB objects of the
+/// process, so the mapped file counts cover the files of every open
+/// database.  The readahead counts are those of the CSeqDB object
+/// only.  The fault counts are taken from the resource usage of the
+/// whole process since the CSeqDB object was created, so they include
+/// faults not caused by it.
+struct NCBI_XOBJREAD_EXPORT SSeqDBMemoryMapStats {
+    SSeqDBMemoryMapStats() : mapped_files(0), mapped_bytes(0),
+                             readahead_requests(0), readahead_bytes(0),
+                             major_faults(0), minor_faults(0) {}
+    /// Number of files currently memory mapped by the process
+    Uint8 mapped_files;
+    /// Number of bytes currently memory mapped by the process
+    Uint8 mapped_bytes;
+    /// Number of readahead requests issued to the OS for this database
+    Uint8 readahead_requests;
+    /// Number of bytes covered by readahead requests for this database
+    Uint8 readahead_bytes;
+    /// Major page faults (requiring I/O) of the process
+    Int8 major_faults;
+    /// Minor page faults of the process
+    Int8 minor_faults;
+};
+
 enum EOidMaskType{
 	fNone = 0x0,
  	fExcludeModel = 0x01
@@ -36,6 +36,7 @@
 #include <corelib/ncbiobj.hpp>
 #include <serial/serialdef.hpp>
 #include <memory>
+#include <atomic>
 
 
 /** @addtogroup ObjStreamSupport
@@ -111,6 +112,35 @@ public:
                  ESerialDataFormat dataFormat, TFormatFlags flags,
                  CByteSource& data);
 
+    /// Buffers kept outside of objects
+    ///
+    /// Classes generated for types listed in datatool "_delay_types"
+    /// have no CDelayBuffer data members, so that their layout does not
+    /// depend on delayed parsing. Unparsed data of their members is kept
+    /// in buffers looked up by the member address instead.
+    /// The checks below cost nothing while there are no such buffers.
+
+    /// Check if the member has unparsed data
+    static bool IsDelayedExternal(TConstObjectPtr member)
+        {
+            return sm_ExternalCount.load(memory_order_relaxed) != 0  &&
+                x_IsDelayedExternal(member);
+        }
+    /// Parse unparsed data of the member, if any
+    static void UpdateExternal(TConstObjectPtr member)
+        {
+            if ( sm_ExternalCount.load(memory_order_relaxed) != 0 )
+                x_UpdateExternal(member);
+        }
+    /// Forget unparsed data of the member, if any
+    static void ForgetExternal(TConstObjectPtr member)
+        {
+            if ( sm_ExternalCount.load(memory_order_relaxed) != 0 )
+                x_ForgetExternal(member);
+        }
+    /// Get buffer of the member, creating an empty one if necessary
+    static CDelayBuffer& GetExternal(TConstObjectPtr member);
+
 private:
     struct SInfo
     {
@@ -138,8 +168,19 @@ private:
     static void* operator new(size_t);
 
     void DoUpdate(void);
+    // parse the data, update mutex must be locked
+    void x_Parse(void);
+    // parse the data without forgetting it, update mutex must be locked
+    void x_ParseData(void) const;
+
+    static bool x_IsDelayedExternal(TConstObjectPtr member);
+    static void x_UpdateExternal(TConstObjectPtr member);
+    static void x_ForgetExternal(TConstObjectPtr member);
 
     unique_ptr<SInfo> m_Info;
+
+    // number of buffers kept outside of objects
+    static atomic<size_t> sm_ExternalCount;
 };
 
 /* @} */
@@ -44,7 +44,7 @@ BEGIN_NCBI_SCOPE
 
 NCBI_DEFINE_ERRCODE_X(Serial_Core,       801,  5);
 NCBI_DEFINE_ERRCODE_X(Serial_OStream,    802, 13);
-NCBI_DEFINE_ERRCODE_X(Serial_IStream,    803, 10);
+NCBI_DEFINE_ERRCODE_X(Serial_IStream,    803, 11);
 NCBI_DEFINE_ERRCODE_X(Serial_TypeInfo,   804,  3);
 NCBI_DEFINE_ERRCODE_X(Serial_MemberInfo, 805,  2);
 NCBI_DEFINE_ERRCODE_X(Serial_ASNTypes,   806,  3);
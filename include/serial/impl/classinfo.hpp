@@ -104,6 +104,13 @@ public:
     CClassTypeInfo* SetImplicit(void);
     bool IsImplicitNonEmpty(void) const;
 
+    /// Set reader of SEQUENCE data in ASN.1 binary format, which is
+    /// specialized for this class (generated by datatool -ocr).
+    /// It is used only when the generic reader would do the same,
+    /// otherwise the generic reader is called.
+    CClassTypeInfo* SetCompiledReadFunction(TTypeReadFunction func);
+    TTypeReadFunction GetCompiledReadFunction(void) const;
+
     void AddSubClass(const CMemberId& id, const CTypeRef& type);
     void AddSubClass(const char* id, TTypeInfoGetter getter);
     void AddSubClassNull(const CMemberId& id);
@@ -141,6 +148,7 @@ private:
     unique_ptr<TSubClasses> m_SubClasses;
 
     TGetTypeIdFunction m_GetTypeIdFunction;
+    TTypeReadFunction m_CompiledReadFunction;
 
     const CMemberInfo* GetImplicitMember(void) const;
 
@@ -150,6 +158,9 @@ private:
     static void ReadClassSequential(CObjectIStream& in,
                                     TTypeInfo objectType,
                                     TObjectPtr objectPtr);
+    static void ReadClassCompiled(CObjectIStream& in,
+                                  TTypeInfo objectType,
+                                  TObjectPtr objectPtr);
     static void ReadClassRandom(CObjectIStream& in,
                                 TTypeInfo objectType,
                                 TObjectPtr objectPtr);
@@ -56,6 +56,12 @@ const CMemberInfo* CClassTypeInfo::GetMemberInfo(const CTempString& name) const
     return GetMemberInfo(GetMembers().Find(name));
 }
 
+inline
+TTypeReadFunction CClassTypeInfo::GetCompiledReadFunction(void) const
+{
+    return m_CompiledReadFunction;
+}
+
 inline
 bool CClassTypeInfo::RandomOrder(void) const
 {
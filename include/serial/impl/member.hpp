@@ -38,6 +38,7 @@
 #include <serial/impl/hookdata.hpp>
 #include <serial/impl/hookfunc.hpp>
 #include <serial/typeinfo.hpp>
+#include <serial/delaybuf.hpp>
 
 
 /** @addtogroup FieldsComplex
@@ -60,6 +61,7 @@ class CSkipClassMemberHook;
 class CCopyClassMemberHook;
 
 class CDelayBuffer;
+class CSerialException;
 
 class CMemberInfoFunctions;
 
@@ -132,6 +134,16 @@ public:
 
     bool CanBeDelayed(void) const;
     CMemberInfo* SetDelayBuffer(CDelayBuffer* buffer);
+    /// Delay parsing of the member only when its type is selected
+    /// in the input stream by CObjectIStream::AddDelayedType()
+    /// Without SetDelayBuffer() the buffer is kept outside of the object,
+    /// see CDelayBuffer::GetExternal().
+    CMemberInfo* SetDelayOnRequest(void);
+    bool DelayOnRequest(void) const;
+    /// true if the member holds unparsed data
+    bool IsDelayed(TConstObjectPtr object) const;
+    /// parse unparsed data of the member, if any
+    void ParseDelayed(TConstObjectPtr object) const;
     CDelayBuffer& GetDelayBuffer(TObjectPtr object) const;
     const CDelayBuffer& GetDelayBuffer(TConstObjectPtr object) const;
 
@@ -145,6 +157,11 @@ public:
     void CopyMissingMember(CObjectStreamCopier& copier) const;
     void SkipMember(CObjectIStream& in) const;
     void SkipMissingMember(CObjectIStream& in) const;
+    /// Handle exception thrown while reading the member with set flag:
+    /// null or missing value resets the flag if the member allows it,
+    /// other errors are rethrown. Must be called from the catch block.
+    void ReadWithSetFlagFailed(CObjectIStream& in, TObjectPtr classPtr,
+                               CSerialException& e) const;
 
     TObjectPtr GetMemberPtr(TObjectPtr classPtr) const;
     TConstObjectPtr GetMemberPtr(TConstObjectPtr classPtr) const;
@@ -156,6 +173,7 @@ public:
     void ResetLocalReadHook(CObjectIStream& in);
     void SetPathReadHook(CObjectIStream* in, const string& path,
                          CReadClassMemberHook* hook);
+    bool HaveReadHooks(void) const;
 
     void SetGlobalWriteHook(CWriteClassMemberHook* hook);
     void SetLocalWriteHook(CObjectOStream& out, CWriteClassMemberHook* hook);
@@ -205,6 +223,10 @@ private:
     Uint4 m_BitSetMask;
     // offset of delay buffer inside object
     TPointerOffsetType m_DelayOffset;
+    // delay buffer is used only for selected types
+    bool m_DelayOnRequest;
+    // delay buffer is kept outside of the object
+    bool m_DelayExternal;
 
     TMemberGetConst m_GetConstFunction;
     TMemberGet m_GetFunction;
@@ -70,21 +70,53 @@ bool CMemberInfo::HaveSetFlag(void) const
 inline
 bool CMemberInfo::CanBeDelayed(void) const
 {
-    return m_DelayOffset != eNoOffset;
+    return m_DelayOffset != eNoOffset || m_DelayExternal;
+}
+
+inline
+bool CMemberInfo::DelayOnRequest(void) const
+{
+    return m_DelayOnRequest;
 }
 
 inline
 CDelayBuffer& CMemberInfo::GetDelayBuffer(TObjectPtr object) const
 {
+    if ( m_DelayExternal ) {
+        return CDelayBuffer::GetExternal(GetItemPtr(object));
+    }
     return CTypeConverter<CDelayBuffer>::Get(CRawPointer::Add(object, m_DelayOffset));
 }
 
 inline
 const CDelayBuffer& CMemberInfo::GetDelayBuffer(TConstObjectPtr object) const
 {
+    if ( m_DelayExternal ) {
+        return CDelayBuffer::GetExternal(GetItemPtr(object));
+    }
     return CTypeConverter<const CDelayBuffer>::Get(CRawPointer::Add(object, m_DelayOffset));
 }
 
+inline
+bool CMemberInfo::IsDelayed(TConstObjectPtr object) const
+{
+    if ( m_DelayExternal ) {
+        return CDelayBuffer::IsDelayedExternal(GetItemPtr(object));
+    }
+    return CanBeDelayed() && GetDelayBuffer(object).Delayed();
+}
+
+inline
+void CMemberInfo::ParseDelayed(TConstObjectPtr object) const
+{
+    if ( m_DelayExternal ) {
+        CDelayBuffer::UpdateExternal(GetItemPtr(object));
+    }
+    else if ( CanBeDelayed() ) {
+        const_cast<CDelayBuffer&>(GetDelayBuffer(object)).Update();
+    }
+}
+
 inline
 TConstObjectPtr CMemberInfo::GetMemberPtr(TConstObjectPtr classPtr) const
 {
@@ -111,6 +143,12 @@ void CMemberInfo::ReadMissingMember(CObjectIStream& stream,
     m_ReadHookData.GetCurrentFunction2nd()(stream, this, classPtr);
 }
 
+inline
+bool CMemberInfo::HaveReadHooks(void) const
+{
+    return m_ReadHookData.HaveHooks();
+}
+
 inline
 void CMemberInfo::WriteMember(CObjectOStream& stream,
                               TConstObjectPtr classPtr) const
@@ -0,0 +1,143 @@
+#ifndef OBJISTRASNBIMPL__HPP
+#define OBJISTRASNBIMPL__HPP
+
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   Support of class readers generated by datatool for ASN.1 binary format.
+*   The generated reader supplies straight-line code reading members'
+*   values, all the rest (tags, missing members, hooks) is done here
+*   exactly as in CObjectIStreamAsnBinary::ReadClassSequential().
+*/
+
+#include <corelib/ncbistd.hpp>
+#include <serial/objistrasnb.hpp>
+#include <serial/impl/classinfo.hpp>
+#include <serial/impl/member.hpp>
+
+
+/** @addtogroup ObjStreamSupport
+ *
+ * @{
+ */
+
+
+BEGIN_NCBI_SCOPE
+
+inline
+TMemberIndex
+CObjectIStreamAsnBinary::BeginCompiledClassMember(const CClassTypeInfo* classType,
+                                                  TMemberIndex pos)
+{
+    // in most cases the next member in the data is the expected one,
+    // check its short context-specific tag without looking up members
+    if ( pos <= classType->GetMembers().LastIndex() ) {
+        const CMemberId& id = classType->GetMemberInfo(pos)->GetId();
+        if ( id.HasTag() && id.GetTag() < eLongTag &&
+             id.GetTagClass() == eContextSpecific && HaveMoreElements() ) {
+            TByte byte = MakeTagByte(eContextSpecific, eConstructed,
+                                     ETagValue(id.GetTag()));
+            if ( PeekTagByte() == byte ) {
+                StartTag(byte);
+                m_CurrentTagLength = 1;
+#if CHECK_INSTREAM_STATE
+                m_CurrentTagState = eTagParsed;
+#endif
+                ExpectIndefiniteLength();
+                return pos;
+            }
+        }
+    }
+    return CObjectIStreamAsnBinary::BeginClassMember(classType, pos);
+}
+
+
+template<class TMemberReader>
+void CObjectIStreamAsnBinary::ReadCompiledClass(const CClassTypeInfo* classType,
+                                                TObjectPtr classPtr,
+                                                TMemberReader reader)
+{
+    BEGIN_OBJECT_FRAME3(eFrameClass, classType, classPtr);
+    CObjectIStreamAsnBinary::BeginClass(classType);
+
+    CClassTypeInfo::CIterator pos(classType);
+    BEGIN_OBJECT_FRAME(eFrameClassMember);
+    TMemberIndex index;
+    while ( (index = BeginCompiledClassMember(classType, *pos)) != kInvalidMember ) {
+        const CMemberInfo* memberInfo = classType->GetMemberInfo(index);
+        SetTopMemberId(memberInfo->GetId());
+        for ( TMemberIndex i = *pos; i < index; ++i ) {
+            classType->GetMemberInfo(i)->ReadMissingMember(*this, classPtr);
+        }
+        // hooks may be installed at any time, including path hooks
+        // activated by SetTopMemberId() above;
+        // delayed and default members are read by the generic code
+        bool done = false;
+        if ( !memberInfo->HaveReadHooks() &&
+             !memberInfo->GetTypeInfo()->HaveReadHooks() &&
+             !memberInfo->CanBeDelayed() &&
+             !((memberInfo->GetDefault() || memberInfo->Nillable()) &&
+               memberInfo->GetId().HaveNoPrefix()) ) {
+            if ( memberInfo->HaveSetFlag() ) {
+                // same order and errors as in ReadWithSetFlagMember()
+                memberInfo->UpdateSetFlagYes(classPtr);
+                try {
+                    done = reader(index);
+                    if ( done && GetVerifyData() == eSerialVerifyData_Yes ) {
+                        memberInfo->Validate(classPtr, *this);
+                    }
+                }
+                catch ( CSerialException& e ) {
+                    memberInfo->ReadWithSetFlagFailed(*this, classPtr, e);
+                    done = true;
+                }
+            }
+            else {
+                done = reader(index);
+            }
+        }
+        if ( !done ) {
+            memberInfo->ReadMember(*this, classPtr);
+        }
+        pos.SetIndex(index + 1);
+        CObjectIStreamAsnBinary::EndClassMember();
+    }
+    END_OBJECT_FRAME();
+    for ( ; pos.Valid(); ++pos ) {
+        classType->GetMemberInfo(pos)->ReadMissingMember(*this, classPtr);
+    }
+
+    CObjectIStreamAsnBinary::EndClass();
+    END_OBJECT_FRAME();
+}
+
+
+END_NCBI_SCOPE
+
+
+/* @} */
+
+#endif  /* OBJISTRASNBIMPL__HPP */
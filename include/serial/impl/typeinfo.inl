@@ -69,6 +69,12 @@ void CTypeInfo::ReadData(CObjectIStream& in, TObjectPtr object) const
     m_ReadHookData.GetCurrentFunction()(in, this, object);
 }
 
+inline
+bool CTypeInfo::HaveReadHooks(void) const
+{
+    return m_ReadHookData.HaveHooks();
+}
+
 inline
 void CTypeInfo::WriteData(CObjectOStream& out, TConstObjectPtr object) const
 {
@@ -527,6 +527,25 @@ public:
     EDelayBufferParsing GetDelayBufferParsingPolicy(void) const;
     bool ShouldParseDelayBuffer(void) const;
 
+    /// Delayed parsing of selected types.
+    ///
+    /// Class members generated with delay buffers for their type
+    /// (datatool definition "_delay_types") are not parsed when their
+    /// type, or the element type of a container member, is selected here.
+    /// The member data is kept as is and parsed on first access to the
+    /// member, or written unchanged into an output stream of the same
+    /// data format.
+    /// Initial selection comes from the list of ASN.1 type names
+    /// in parameter [SERIAL] READ_DELAYED_TYPES.
+    /// Delayed data is parsed by const getters too, so reading of such
+    /// object modifies it. The object must not be shared by threads
+    /// until its delayed members are accessed once, or the access must be
+    /// synchronized by the caller.
+    void SetDelayedType(TTypeInfo type);
+    void AddDelayedType(TTypeInfo type);
+    void ResetDelayedTypes(void);
+    bool IsDelayedType(TTypeInfo type) const;
+
 //---------------------------------------------------------------------------
 // User interface
 
@@ -812,6 +831,11 @@ public:
             return m_MemoryPool;
         }
     // create and set new memory pool
+    // CObject-derived data objects are then allocated in pool chunks,
+    // a chunk is released when the last object allocated in it is deleted.
+    // The pool is also used by default if SERIAL_READ_MEMORY_POOL
+    // parameter is set; allocation counts are posted with Trace severity
+    // when the stream is destroyed.
     void UseMemoryPool(void);
 
     // internal reader
@@ -1087,6 +1111,7 @@ private:
 
     TTypeInfo m_MonitorType;
     vector<TTypeInfo> m_ReqMonitorType;
+    vector<string> m_DelayedTypes;
     
 public:
     enum ESpecialCaseRead {
@@ -139,6 +139,15 @@ public:
     virtual void ReadBitString(CBitString& obj) override;
     virtual void SkipBitString(void) override;
 
+    /// Read SEQUENCE class data using member reader specialized for
+    /// the class (generated by datatool -ocr, see objistrasnbimpl.hpp).
+    /// reader(index) reads value of member 'index' and returns true,
+    /// or returns false if the member should be read in a generic way.
+    template<class TMemberReader>
+    void ReadCompiledClass(const CClassTypeInfo* classType,
+                           TObjectPtr classPtr,
+                           TMemberReader reader);
+
 protected:
     virtual bool ReadBool(void) override;
     virtual char ReadChar(void) override;
@@ -337,6 +346,8 @@ private:
     void ReadStringValue(size_t length, string& s, EFixNonPrint fix_type);
     void SkipTagData(void);
     bool HaveMoreElements(void);
+    TMemberIndex BeginCompiledClassMember(const CClassTypeInfo* classType,
+                                          TMemberIndex pos);
     void UnexpectedMember(TLongTag tag, const CItemsInfo& items);
     void UnexpectedByte(TByte byte);
     void GetTagPattern(vector<int>& pattern, size_t max_length);
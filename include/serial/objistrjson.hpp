@@ -222,6 +222,7 @@ private:
     int ReadEscapedChar(bool* encoded=0);
     char ReadEncodedChar(EStringType type, bool& encoded);
     TUnicodeSymbol ReadUtf8Char(char c);
+    size_t x_ReadPlainChars(string& str, EStringType type);
     string x_ReadString(EStringType type);
     void x_ReadData(string& data, EStringType type = eStringTypeUTF8);
     bool x_ReadDataAndCheck(string& data, EStringType type = eStringTypeUTF8);
@@ -283,6 +283,7 @@ private:
     Type x_UseMemberDefault(void);
     int x_VerifyChar(int);
     int x_ReadEncodedChar(char endingChar, EStringType type, bool& encoded);
+    size_t x_ReadPlainChars(string& str, char endingChar, EStringType type);
 
     enum ETagState {
         eTagOutside,
@@ -38,6 +38,7 @@
 #include <corelib/ncbithr.hpp>
 #include <serial/objistr.hpp>
 #include <serial/objectio.hpp>
+#include <util/bytesrc.hpp>
 
 #include <queue>
 #include <future>
@@ -320,6 +321,12 @@ public:
 ///  buffer, which is good. If data object is big it still goes into a single
 ///  buffer no matter how big the object is.
 ///  To limit memory consumption, use MaxTotalRawSize parameter.
+///  CObjectIStreamAsyncIterator<TRoot, TChild> can also split big TRoot
+///  objects (ASN.1 binary only): with SplitRootObjects parameter, raw data
+///  of TChild objects is collected and parsed in parallel, one buffer of
+///  TChild objects per parsing thread. If reading of the input fails, the
+///  objects read before the error are returned first, and then
+///  operator++ throws the exception.
 ///
 ///  The iterator does its job asynchronously. It starts working immediately
 ///  after its creation and stops only when it is destroyed.
@@ -351,7 +358,8 @@ public:
             , m_MaxParserThreads (16)
             , m_MaxTotalRawSize  (16 * 1024 * 1024)
             , m_MinRawBufferSize (128 * 1024)
-            , m_SameThread(false) {
+            , m_SameThread(false)
+            , m_SplitRoot(false) {
         }
 
         /// Filter by member index
@@ -395,12 +403,25 @@ public:
             m_SameThread = same_thread;  return *this;
         }
 
+        /// CObjectIStreamAsyncIterator<TRoot, TChild> only:
+        /// split each TRoot object into the raw data of its TChild objects
+        /// and parse these in parallel, so that a single huge TRoot object
+        /// (a Bioseq-set, for example) is not parsed by one thread.
+        /// @note
+        ///  Only ASN.1 binary streams are split; with other formats
+        ///  the flag is ignored. The raw data is always read in a separate
+        ///  thread in this mode.
+        CParams& SplitRootObjects(bool split_root) {
+            m_SplitRoot = split_root;  return *this;
+        }
+
     private:
         launch    m_ThreadPolicy;
         unsigned  m_MaxParserThreads;
         size_t    m_MaxTotalRawSize;
         size_t    m_MinRawBufferSize;
         bool      m_SameThread;
+        bool      m_SplitRoot;
 
         template<typename...> friend class CObjectIStreamAsyncIterator;
     };
@@ -1193,7 +1214,8 @@ protected:
     CObjectIStreamAsyncIterator( CObjectIStream& istr,
                                  EOwnership deleteInStream,
                                  FParserFunction parser,
-                                 const CParams& params);
+                                 const CParams& params,
+                                 TTypeInfo split_root = nullptr);
 private: 
     static TObjectsQueue sx_ClearGarbageAndParse(
             CRef<CByteSource> bytesource,  ESerialDataFormat format,
@@ -1207,7 +1229,7 @@ private:
     
     struct CData {
         CData(CObjectIStream& istr, EOwnership deleteInStream, FParserFunction parser,
-            const CParams& params);
+            const CParams& params, TTypeInfo split_root);
         ~CData(void);
 
         using future_queue_t  = future<TObjectsQueue>;
@@ -1216,7 +1238,26 @@ private:
         void x_UpdateObjectsQueue();
         void x_UpdateFuturesQueue();
         CRef< CByteSource > x_GetNextData(void);
+        bool x_PushReaderData(CRef< CByteSource > data, size_t size);
         void x_ReaderThread(void);
+        void x_SplitReaderThread(void);
+        void x_AddSplitData(CRef< CByteSource > data);
+        bool x_FlushSplitData(void);
+
+        // collects raw data of one TRoot object skipped in the stream
+        class x_CSplitRootHook : public CSkipObjectHook
+        {
+        public:
+            x_CSplitRootHook(CData* pthis) : m_This(pthis) {
+            }
+            virtual void SkipObject(CObjectIStream& in, const CObjectTypeInfo& type) override {
+                CStreamDelayBufferGuard guard(in);
+                in.SkipAnyContentObject();
+                m_This->x_AddSplitData(guard.EndDelayBuffer());
+            }
+        private:
+            CData* m_This;
+        };
 
         TObjectsQueue m_ObjectsQueue; // current queue of objects
         TObjectsQueue m_GarbageQueue; // popped so-far from objects-queue
@@ -1238,6 +1279,11 @@ private:
         thread                       m_Reader;
         queue< CRef< CByteSource > > m_ReaderData;
         queue< size_t >              m_ReaderDataSize;
+
+        TTypeInfo                    m_SplitRoot;
+        CRef<CMemorySourceCollector> m_SplitData;
+        size_t                       m_SplitDataSize;
+        exception_ptr                m_ReaderError;
     };
     shared_ptr<CData> m_Data;
 };
@@ -1302,8 +1348,8 @@ CObjectIStreamAsyncIterator<TRoot>::CObjectIStreamAsyncIterator(
 template<typename TRoot>
 CObjectIStreamAsyncIterator<TRoot>::CObjectIStreamAsyncIterator(
     CObjectIStream& istr,  EOwnership deleteInStream,
-    FParserFunction parser,  const CParams& params)
-    : m_Data(new CData(istr, deleteInStream, parser, params))
+    FParserFunction parser,  const CParams& params, TTypeInfo split_root)
+    : m_Data(new CData(istr, deleteInStream, parser, params, split_root))
 {
     ++(*this);
 }
@@ -1334,7 +1380,8 @@ CObjectIStreamAsyncIterator<TRoot>::operator++() {
         do {
             m_Data->x_UpdateFuturesQueue();
             m_Data->x_UpdateObjectsQueue();
-        } while (!IsValid() && !m_Data->m_EndOfData);
+        } while (!IsValid() &&
+                 !(m_Data->m_EndOfData && m_Data->m_FuturesQueue.empty()));
         if (!IsValid()) {
             m_Data.reset();
         }
@@ -1426,7 +1473,7 @@ CObjectIStreamAsyncIterator<TRoot>::sx_ClearGarbageAndParse(
 template<typename TRoot>
 CObjectIStreamAsyncIterator<TRoot>::CData::CData(
         CObjectIStream& istr, EOwnership deleteInStream, FParserFunction parser,
-        const CParams& params)
+        const CParams& params, TTypeInfo split_root)
     : m_Istr(&istr)
     , m_Own(deleteInStream)
     , m_Parser(parser) 
@@ -1437,9 +1484,24 @@ CObjectIStreamAsyncIterator<TRoot>::CData::CData(
     , m_Policy(params.m_ThreadPolicy)
     , m_EndOfData(m_Istr->EndOfData())
     , m_Params(params)
+    , m_SplitRoot(nullptr)
+    , m_SplitDataSize(0)
 {
+    if (split_root && params.m_SplitRoot &&
+        m_Istr->GetDataFormat() == eSerial_AsnBinary) {
+        // raw data of TRoot objects is parsed as a sequence of top-level
+        // objects; the raw data cannot be read in this thread, because
+        // a single root object can give any number of buffers
+        m_SplitRoot = split_root;
+        m_Parser = &CObjectIStreamAsyncIterator<TRoot>::sx_ClearGarbageAndParse;
+        m_MaxRawSize = max(params.m_MaxTotalRawSize, max(m_RawBufferSize, size_t(1)));
+    }
     if (m_MaxRawSize != 0 && !m_EndOfData) {
-        m_Reader = thread([this](){x_ReaderThread();});
+        if (m_SplitRoot) {
+            m_Reader = thread([this](){x_SplitReaderThread();});
+        } else {
+            m_Reader = thread([this](){x_ReaderThread();});
+        }
     }
 }
 
@@ -1485,8 +1547,10 @@ CObjectIStreamAsyncIterator<TRoot>::CData::x_UpdateObjectsQueue()
     if(    m_ObjectsQueue.empty() 
         && !m_FuturesQueue.empty()) 
     {
-        m_ObjectsQueue = m_FuturesQueue.front().get();
+        // pop first, so that an exception leaves the queue consistent
+        future_queue_t objects = std::move(m_FuturesQueue.front());
         m_FuturesQueue.pop();
+        m_ObjectsQueue = objects.get();
     }
 }
 
@@ -1506,6 +1570,12 @@ CObjectIStreamAsyncIterator<TRoot>::CData::x_UpdateFuturesQueue()
     CRef< CByteSource > data = x_GetNextData();
     if (data.IsNull()) {
         m_EndOfData = true;
+        if (m_ReaderError) {
+            // report the error after the objects read before it
+            promise<TObjectsQueue> error;
+            error.set_exception(m_ReaderError);
+            m_FuturesQueue.push(error.get_future());
+        }
         return;
     }
 
@@ -1585,19 +1655,8 @@ CObjectIStreamAsyncIterator<TRoot>::CData::x_ReaderThread(void)
 
         size_t this_buffer_size = m_Istr->GetStreamPos() - startpos;
         CRef< CByteSource > data = guard.EndDelayBuffer();
-        {
-            unique_lock<mutex> lck(m_ReaderMutex);
-            // make sure we do not consume too much memory
-            while (!m_EndOfData && m_CurrentRawSize >= m_MaxRawSize) {
-                m_ReaderCv.wait(lck);
-            }
-            if (m_EndOfData) {
-                break;
-            }
-            m_ReaderData.push( data);
-            m_ReaderDataSize.push( this_buffer_size);
-            m_CurrentRawSize += this_buffer_size;
-            m_ReaderCv.notify_one();
+        if (!x_PushReaderData(data, this_buffer_size)) {
+            break;
         }
     }
     CRef< CByteSource > data;
@@ -1608,6 +1667,97 @@ CObjectIStreamAsyncIterator<TRoot>::CData::x_ReaderThread(void)
     m_ReaderCv.notify_one();
 }
 
+template<typename TRoot>
+bool
+CObjectIStreamAsyncIterator<TRoot>::CData::x_PushReaderData(
+    CRef< CByteSource > data, size_t size)
+{
+    unique_lock<mutex> lck(m_ReaderMutex);
+    // make sure we do not consume too much memory
+    while (!m_EndOfData && m_CurrentRawSize >= m_MaxRawSize) {
+        m_ReaderCv.wait(lck);
+    }
+    if (m_EndOfData) {
+        return false;
+    }
+    m_ReaderData.push( data);
+    m_ReaderDataSize.push( size);
+    m_CurrentRawSize += size;
+    m_ReaderCv.notify_one();
+    return true;
+}
+
+// Split reading:
+//
+// Skip the outer objects (m_SplitRoot) type-wise, with a local skip hook on
+// TRoot. The hook does not parse TRoot objects, but only scans their
+// boundaries (SkipAnyContentObject) and collects the raw data. As soon as
+// there is enough data, it goes into the parsing queue, where it is parsed
+// as a sequence of top-level TRoot objects.
+
+template<typename TRoot>
+void
+CObjectIStreamAsyncIterator<TRoot>::CData::x_SplitReaderThread(void)
+{
+    CObjectTypeInfo type = CType<TRoot>();
+    type.SetLocalSkipHook(*m_Istr, new x_CSplitRootHook(this));
+    try {
+        while (Serial_FilterSkip(*m_Istr, CObjectTypeInfo(m_SplitRoot)))
+            ;
+    } catch (...) {
+        // collected objects are complete, they go before the error;
+        // the end marker below makes the error visible to the consumer
+        m_ReaderError = current_exception();
+    }
+    x_FlushSplitData();
+    type.ResetLocalSkipHook(*m_Istr);
+
+    CRef< CByteSource > data;
+    m_ReaderMutex.lock();
+    m_ReaderData.push( data);
+    m_ReaderDataSize.push(0);
+    m_ReaderMutex.unlock();
+    m_ReaderCv.notify_one();
+}
+
+template<typename TRoot>
+void
+CObjectIStreamAsyncIterator<TRoot>::CData::x_AddSplitData(
+    CRef< CByteSource > data)
+{
+    if (!m_SplitData) {
+        m_SplitData.Reset(new CMemorySourceCollector);
+    }
+    char buffer[16 * 1024];
+    CRef<CByteSourceReader> reader = data->Open();
+    for (;;) {
+        size_t count = reader->Read(buffer, sizeof(buffer));
+        if (count == 0) {
+            break;
+        }
+        m_SplitData->AddChunk(buffer, count);
+        m_SplitDataSize += count;
+    }
+    if (m_SplitDataSize >= m_RawBufferSize && !x_FlushSplitData()) {
+        // the iterator is gone, stop skipping
+        NCBI_THROW(CSerialException, eFail, "raw data reading canceled");
+    }
+}
+
+template<typename TRoot>
+bool
+CObjectIStreamAsyncIterator<TRoot>::CData::x_FlushSplitData(void)
+{
+    if (!m_SplitData) {
+        return true;
+    }
+    CRef< CByteSource > data = m_SplitData->GetSource();
+    size_t size = m_SplitDataSize;
+    m_SplitData.Reset();
+    m_SplitDataSize = 0;
+    return x_PushReaderData(data, size);
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 ///  CObjectIStreamAsyncIterator<TRoot,TChild> implementation
@@ -1623,7 +1773,8 @@ CObjectIStreamAsyncIterator<TRoot, TChild>::CObjectIStreamAsyncIterator(
         CObjectIStream& istr, EOwnership deleteInStream,
         const CParams& params)
     : CParent(istr, deleteInStream,
-        &CObjectIStreamAsyncIterator<TRoot, TChild>::sx_ClearGarbageAndParse, params)
+        &CObjectIStreamAsyncIterator<TRoot, TChild>::sx_ClearGarbageAndParse, params,
+        ns_ObjectIStreamFilterIterator::xxx_GetTypeInfo<TRoot>())
 {
 }
 
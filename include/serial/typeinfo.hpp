@@ -200,6 +200,8 @@ public:
     /// Set local context-specific read hook
     void SetPathReadHook(CObjectIStream* in, const string& path,
                          CReadObjectHook* hook);
+    /// Check if any read hook is set
+    bool HaveReadHooks(void) const;
 
     /// Set global (for all input streams) write hook
     void SetGlobalWriteHook(CWriteObjectHook* hook);
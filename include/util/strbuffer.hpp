@@ -121,6 +121,13 @@ public:
     //     (limit if not found)
     size_t PeekFindChar(char c, size_t limit)
         THROWS1((CIOException));
+    // find the first of symbols 'c1', 'c2', control chars (below ' ')
+    // and, if 'stop8bit' is true, chars above 0x7F in the buffered data
+    // without skipping; the buffer is filled if it is empty
+    // return relative offset of symbol from current position
+    //     (size of buffered data if not found)
+    size_t PeekFindSpecialChar(char c1, char c2, bool stop8bit)
+        THROWS1((CIOException));
 
     const char* GetCurrentPos(void) const THROWS1_NONE;
     // returns true if succeeded
@@ -168,7 +168,8 @@ void CMMAligner::x_DoSubmatrix( const SCoordRect& submatr,
     // locate the transition point
     size_t trans_pos = 0;
     ETransitionType trans_type = eGG;
-    TScore score1 = x_FindBestJ ( vEtop, vFtop, vGtop, vEbtm, vFbtm, vGbtm,
+    TScore score1 = x_FindBestJ ( submatr,
+                                  vEtop, vFtop, vGtop, vEbtm, vFbtm, vGbtm,
                                   trans_pos, trans_type );
     if(top_level)
         m_score = score1;
@@ -326,6 +327,7 @@ void CMMAligner::x_DoSubmatrix( const SCoordRect& submatr,
 
 
 CNWAligner::TScore CMMAligner::x_FindBestJ (
+    const SCoordRect& rect,
     const vector<TScore>& vEtop, const vector<TScore>& vFtop,
     const vector<TScore>& vGtop, const vector<TScore>& vEbtm,
     const vector<TScore>& vFbtm, const vector<TScore>& vGbtm,
@@ -336,8 +338,11 @@ CNWAligner::TScore CMMAligner::x_FindBestJ (
     TScore score = kMin_Int;
     TScore trans_alts [9];
 
-    bool bFreeGapLeft2  = m_esf_L2 && dim == m_SeqLen2 + 1;
-    bool bFreeGapRight2 = m_esf_R2 && dim == m_SeqLen2 + 1;
+    // a vertical gap along the first or last column of the submatrix
+    // is an end gap only if that column is the first or the last one
+    // of the whole matrix
+    bool bFreeGapLeft2  = m_esf_L2 && rect.j1 == 0;
+    bool bFreeGapRight2 = m_esf_R2 && rect.j2 == m_SeqLen2 - 1;
 
     for(size_t i = 0; i < dim ; ++i) {
         trans_alts [0] = vEtop[i] + vEbtm[i] - m_Wg;   // II
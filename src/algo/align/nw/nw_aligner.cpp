@@ -73,7 +73,8 @@ CNWAligner::CNWAligner()
       m_score(kInfMinus),
       m_mt(false),
       m_maxthreads(1),
-      m_MaxMem(GetDefaultSpaceLimit())
+      m_MaxMem(GetDefaultSpaceLimit()),
+      m_LinearSpace(false)
 {
     SetScoreMatrix(0);
 }
@@ -95,14 +96,15 @@ CNWAligner::CNWAligner( const char* seq1, size_t len1,
       m_prg_callback(0),
       m_terminate(false),
       m_Seq1Vec(&seq1[0], &seq1[0]+len1),
-      m_Seq1(&m_Seq1Vec[0]), m_SeqLen1(len1),
+      m_Seq1(m_Seq1Vec.data()), m_SeqLen1(len1),
       m_Seq2Vec(&seq2[0], &seq2[0]+len2),
-      m_Seq2(&m_Seq2Vec[0]), m_SeqLen2(len2),
+      m_Seq2(m_Seq2Vec.data()), m_SeqLen2(len2),
       m_PositivesAsMatches(false),
       m_score(kInfMinus),
       m_mt(false),
       m_maxthreads(1),
-      m_MaxMem(GetDefaultSpaceLimit())
+      m_MaxMem(GetDefaultSpaceLimit()),
+      m_LinearSpace(false)
 {
     SetScoreMatrix(scoremat);
     SetSequences(seq1, len1, seq2, len2);
@@ -124,13 +126,15 @@ CNWAligner::CNWAligner(const string& seq1,
       m_prg_callback(0),
       m_terminate(false),
       m_Seq1Vec(seq1.begin(), seq1.end()),
-      m_Seq1(&m_Seq1Vec[0]), m_SeqLen1(seq1.size()),
+      m_Seq1(m_Seq1Vec.data()), m_SeqLen1(seq1.size()),
       m_Seq2Vec(seq2.begin(), seq2.end()),
-      m_Seq2(&m_Seq2Vec[0]), m_SeqLen2(seq2.size()),
+      m_Seq2(m_Seq2Vec.data()), m_SeqLen2(seq2.size()),
+      m_PositivesAsMatches(false),
       m_score(kInfMinus),
       m_mt(false),
       m_maxthreads(1),
-      m_MaxMem(GetDefaultSpaceLimit())
+      m_MaxMem(GetDefaultSpaceLimit()),
+      m_LinearSpace(false)
 {
     SetScoreMatrix(scoremat);
     SetSequences(seq1, seq2);
@@ -173,9 +177,9 @@ void CNWAligner::SetSequences(const char* seq1, size_t len1,
     }
     m_Seq1Vec.assign(&seq1[0], &seq1[0]+len1);
     m_Seq2Vec.assign(&seq2[0], &seq2[0]+len2);
-    m_Seq1 = &m_Seq1Vec[0];
+    m_Seq1 = m_Seq1Vec.data();
     m_SeqLen1 = len1;
-    m_Seq2 = &m_Seq2Vec[0];
+    m_Seq2 = m_Seq2Vec.data();
     m_SeqLen2 = len2;
     m_Transcript.clear();
 }
@@ -515,15 +519,20 @@ CNWAligner::TScore CNWAligner::Run()
                    g_msg_DataNotAvailable);
     }
 
-    if(!x_CheckMemoryLimit()) {
-        NCBI_THROW(CAlgoAlignException, eMemoryLimit, g_msg_HitSpaceLimit);
-    }
-
     if (m_SmithWaterman && !m_guides.empty()) {
         NCBI_THROW(CAlgoAlignException, eBadParameter,
                    "Smith-Waterman not compatible with provided pattern");
     }
 
+    if(m_LinearSpace) {
+        m_score = x_RunLinearSpace();
+        return m_score;
+    }
+
+    if(!x_CheckMemoryLimit()) {
+        NCBI_THROW(CAlgoAlignException, eMemoryLimit, g_msg_HitSpaceLimit);
+    }
+
     m_score = x_Run();
 
     return m_score;
@@ -1132,9 +1141,15 @@ bool CNWAligner::x_CheckMemoryLimit()
 }
 
 
-void CNWAligner::EnableMultipleThreads(bool enable)
+void CNWAligner::EnableMultipleThreads(bool enable, size_t max_threads)
 {
-    m_maxthreads = (m_mt = enable)? CSystemInfo::GetCpuCount(): 1;
+    m_mt = enable;
+    if(!enable) {
+        m_maxthreads = 1;
+    }
+    else {
+        m_maxthreads = max_threads > 0? max_threads: CSystemInfo::GetCpuCount();
+    }
 }
 
 
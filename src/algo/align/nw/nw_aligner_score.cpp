@@ -0,0 +1,584 @@
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:  CNWAligner linear space score-only computation
+ *                    and linear space alignment
+ *
+ * The score-only computation splits the dynamic programming matrix into
+ * bands of rows and each band into tiles of columns. Within a tile, cells
+ * are computed one anti-diagonal at a time; the cells of an anti-diagonal
+ * do not depend on each other, so several of them are computed at once
+ * with SSE2 instructions. Bands are distributed over threads and processed
+ * as a pipeline: a tile can be computed as soon as the tile above it is
+ * done. Only the row between bands and one column per band are kept.
+ *
+ * ===========================================================================
+ *
+ */
+
+#include <ncbi_pch.hpp>
+#include "nw_aligner_threads.hpp"
+#include "messages.hpp"
+#include <algo/align/nw/align_exception.hpp>
+#include <algo/align/nw/mm_aligner.hpp>
+
+#include <exception>
+#include <typeinfo>
+
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+#  include <emmintrin.h>
+#  if NCBI_SSE >= 41
+#    include <smmintrin.h>
+#  endif
+#endif
+
+
+BEGIN_NCBI_SCOPE
+
+
+namespace {
+
+typedef CNWAligner::TScore TScore;
+
+// Band height and tile width in dynamic programming cells
+const size_t kScoreOnlyBandHeight = 256;
+const size_t kScoreOnlyTileWidth  = 2048;
+
+// Diagonal buffers of one band
+struct SScoreOnlyWorkspace {
+
+    SScoreOnlyWorkspace(size_t height):
+        m_Score(height + 1)
+    {
+        for(size_t k = 0; k < 3; ++k) m_V[k].resize(height + 1);
+        for(size_t k = 0; k < 2; ++k) {
+            m_E[k].resize(height + 1);
+            m_F[k].resize(height + 1);
+        }
+    }
+
+    vector<TScore> m_V[3];  // anti-diagonals d, d-1 and d-2
+    vector<TScore> m_E[2];  // anti-diagonals d and d-1
+    vector<TScore> m_F[2];
+    vector<TScore> m_Score; // substitution scores along anti-diagonal d
+};
+
+
+// Parameters of a tile
+struct SScoreOnlyTile {
+
+    const char*  m_Seq1;     // first row character of the tile
+    const char*  m_RevSeq2;  // second sequence, reversed
+    ptrdiff_t    m_RevOffset;// second sequence length minus first column
+    size_t       m_Height;
+    size_t       m_Width;
+    bool         m_FreeLastRow;
+    bool         m_FreeLastColumn;
+};
+
+
+inline TScore s_Max(TScore a, TScore b)
+{
+    return a >= b? a: b;
+}
+
+
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+inline __m128i s_Max4(__m128i a, __m128i b)
+{
+#  if NCBI_SSE >= 41
+    return _mm_max_epi32(a, b);
+#  else
+    const __m128i mask = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+#  endif
+}
+#endif
+
+
+// Compute one tile. Rows and columns of the tile are numbered from one;
+// row zero and column zero are the cells above and to the left of the tile.
+// On entry row_V and row_F hold row zero (columns 1..width), col_V and col_E
+// hold column zero (rows 1..height) and corner is the cell (0,0).
+// On exit row_V and row_F hold the last row and col_V and col_E the last
+// column of the tile. Returns the best score of the tile (Smith-Waterman).
+TScore s_ScoreOnlyTile(const SScoreOnlyTile& tile,
+                       const TNCBIScore (* sm) [NCBI_FSM_DIM],
+                       TScore wg, TScore ws, bool sw,
+                       TScore corner,
+                       TScore* row_V, TScore* row_F,
+                       TScore* col_V, TScore* col_E,
+                       SScoreOnlyWorkspace& work)
+{
+    const size_t h = tile.m_Height, w = tile.m_Width;
+
+    TScore* Vd  = &work.m_V[0][0];
+    TScore* Vd1 = &work.m_V[1][0];
+    TScore* Vd2 = &work.m_V[2][0];
+    TScore* Ed  = &work.m_E[0][0];
+    TScore* Ed1 = &work.m_E[1][0];
+    TScore* Fd  = &work.m_F[0][0];
+    TScore* Fd1 = &work.m_F[1][0];
+    TScore* sc  = &work.m_Score[0];
+
+    TScore best = 0;
+
+    // anti-diagonal zero holds the corner only
+    Vd[0] = corner;
+
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+    const __m128i vwg   = _mm_set1_epi32(wg);
+    const __m128i vws   = _mm_set1_epi32(ws);
+    const __m128i vzero = _mm_setzero_si128();
+    __m128i vbest = vzero;
+#endif
+
+    for(size_t d = 1; d <= h + w; ++d) {
+
+        // rotate anti-diagonals
+        TScore* tmp = Vd2; Vd2 = Vd1; Vd1 = Vd; Vd = tmp;
+        swap(Ed, Ed1);
+        swap(Fd, Fd1);
+
+        // boundary cells
+        if(d <= w) {
+            Vd[0] = row_V[d - 1];
+            Fd[0] = row_F[d - 1];
+        }
+        if(d <= h) {
+            Vd[d] = col_V[d - 1];
+            Ed[d] = col_E[d - 1];
+        }
+
+        // inner cells (i, d - i)
+        const size_t i0 = d > w? d - w: 1;
+        const size_t i1 = min(h + 1, d);
+        if(i0 >= i1) {
+            continue;
+        }
+
+        const char* pseq1 = tile.m_Seq1 + i0 - 1;
+        const char* pseq2 = tile.m_RevSeq2 + (tile.m_RevOffset - ptrdiff_t(d)
+                                              + ptrdiff_t(i0));
+        for(size_t i = i0; i < i1; ++i) {
+            sc[i] = sm[(size_t)*pseq1++][(size_t)*pseq2++];
+        }
+
+        size_t i = i0;
+
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+        for(; i + 4 <= i1; i += 4) {
+
+            const __m128i G = _mm_add_epi32(
+                _mm_loadu_si128((const __m128i*)(Vd2 + i - 1)),
+                _mm_loadu_si128((const __m128i*)(sc + i)));
+
+            const __m128i E = _mm_add_epi32(s_Max4(
+                _mm_loadu_si128((const __m128i*)(Ed1 + i)),
+                _mm_add_epi32(_mm_loadu_si128((const __m128i*)(Vd1 + i)),
+                              vwg)), vws);
+
+            const __m128i F = _mm_add_epi32(s_Max4(
+                _mm_loadu_si128((const __m128i*)(Fd1 + i - 1)),
+                _mm_add_epi32(_mm_loadu_si128((const __m128i*)(Vd1 + i - 1)),
+                              vwg)), vws);
+
+            __m128i V = s_Max4(G, s_Max4(E, F));
+            if(sw) {
+                V = s_Max4(V, vzero);
+                vbest = s_Max4(vbest, V);
+            }
+
+            _mm_storeu_si128((__m128i*)(Ed + i), E);
+            _mm_storeu_si128((__m128i*)(Fd + i), F);
+            _mm_storeu_si128((__m128i*)(Vd + i), V);
+        }
+#endif
+
+        for(; i < i1; ++i) {
+            const TScore G = Vd2[i - 1] + sc[i];
+            const TScore E = s_Max(Ed1[i], Vd1[i] + wg) + ws;
+            const TScore F = s_Max(Fd1[i - 1], Vd1[i - 1] + wg) + ws;
+            TScore V = s_Max(G, s_Max(E, F));
+            if(sw) {
+                V = s_Max(V, 0);
+                best = s_Max(best, V);
+            }
+            Ed[i] = E;
+            Fd[i] = F;
+            Vd[i] = V;
+        }
+
+        // gaps can be free in the last row and the last column
+        const bool last_row = i0 <= h && h < i1;
+        const bool last_col = d > w;
+        size_t free_cells [2], num_free_cells = 0;
+        if(last_row && tile.m_FreeLastRow) {
+            free_cells[num_free_cells++] = h;
+        }
+        if(last_col && tile.m_FreeLastColumn) {
+            free_cells[num_free_cells++] = d - w;
+        }
+        for(size_t k = 0; k < num_free_cells; ++k) {
+            const size_t ic = free_cells[k];
+            const bool free1 = tile.m_FreeLastRow && ic == h;
+            const bool free2 = tile.m_FreeLastColumn && ic + w == d;
+            const TScore G = Vd2[ic - 1] + sc[ic];
+            const TScore E = s_Max(Ed1[ic], Vd1[ic] + (free1? 0: wg))
+                             + (free1? 0: ws);
+            const TScore F = s_Max(Fd1[ic - 1], Vd1[ic - 1] + (free2? 0: wg))
+                             + (free2? 0: ws);
+            TScore V = s_Max(G, s_Max(E, F));
+            if(sw) {
+                V = s_Max(V, 0);
+                best = s_Max(best, V);
+            }
+            Ed[ic] = E;
+            Fd[ic] = F;
+            Vd[ic] = V;
+        }
+
+        // save the last row and column
+        if(last_row) {
+            row_V[d - h - 1] = Vd[h];
+            row_F[d - h - 1] = Fd[h];
+        }
+        if(last_col) {
+            col_V[d - w - 1] = Vd[d - w];
+            col_E[d - w - 1] = Ed[d - w];
+        }
+    }
+
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+    if(sw) {
+        TScore lanes [4];
+        _mm_storeu_si128((__m128i*)lanes, vbest);
+        for(size_t k = 0; k < 4; ++k) {
+            best = s_Max(best, lanes[k]);
+        }
+    }
+#endif
+
+    return best;
+}
+
+} // namespace
+
+
+// Data shared by the threads computing the score
+struct CNWAligner::SScoreOnlyData {
+
+    size_t          m_BandHeight;
+    size_t          m_TileWidth;
+    size_t          m_NumBands;
+    size_t          m_NumTiles;
+    size_t          m_NumThreads;   // band k is computed by thread k % this
+
+    vector<char>    m_RevSeq2;      // second sequence, reversed
+
+    // the row between the last computed bands
+    vector<TScore>  m_RowV;
+    vector<TScore>  m_RowF;
+
+    // number of tiles done in every band, guarded by m_Mutex
+    vector<size_t>  m_TilesDone;
+    bool            m_Failed;
+    CFastMutex          m_Mutex;
+    CConditionVariable  m_Cond;
+
+    // best score found by every thread (Smith-Waterman)
+    vector<TScore>  m_Best;
+};
+
+
+void CNWAligner::x_ScoreOnlyBands(SScoreOnlyData* data, size_t first_band)
+{
+    const bool free_left1 (m_esf_L1), free_left2 (m_esf_L2);
+    const TScore wgleft1 (free_left1? 0: m_Wg), wsleft1 (free_left1? 0: m_Ws);
+    const TScore wgleft2 (free_left2? 0: m_Wg), wsleft2 (free_left2? 0: m_Ws);
+
+    const size_t H (data->m_BandHeight), W (data->m_TileWidth);
+    SScoreOnlyWorkspace work (H);
+    vector<TScore> col_V (H), col_E (H);
+    TScore best (0);
+
+    try {
+        for(size_t band = first_band; band < data->m_NumBands;
+            band += data->m_NumThreads)
+        {
+            const size_t r0 (band * H);
+            const size_t h (min(H, m_SeqLen1 - r0));
+
+            for(size_t k = 0; k < h; ++k) {
+                col_V[k] = wgleft2 + TScore(r0 + k + 1) * wsleft2;
+                col_E[k] = kInfMinus;
+            }
+            TScore corner (r0 == 0? 0: wgleft2 + TScore(r0) * wsleft2);
+
+            SScoreOnlyTile tile;
+            tile.m_Seq1 = m_Seq1 + r0;
+            tile.m_RevSeq2 = &data->m_RevSeq2[0];
+            tile.m_Height = h;
+            tile.m_FreeLastRow = m_esf_R1 && r0 + h == m_SeqLen1;
+
+            for(size_t t = 0; t < data->m_NumTiles; ++t) {
+
+                const size_t c0 (t * W);
+                const size_t w (min(W, m_SeqLen2 - c0));
+                TScore* row_V (&data->m_RowV[c0]);
+                TScore* row_F (&data->m_RowF[c0]);
+
+                if(band == 0) {
+                    for(size_t k = 0; k < w; ++k) {
+                        row_V[k] = wgleft1 + TScore(c0 + k + 1) * wsleft1;
+                        row_F[k] = kInfMinus;
+                    }
+                }
+                else {
+                    // wait for the tile above
+                    CFastMutexGuard guard (data->m_Mutex);
+                    while(!data->m_Failed &&
+                          data->m_TilesDone[band - 1] <= t)
+                    {
+                        data->m_Cond.WaitForSignal(data->m_Mutex);
+                    }
+                    if(data->m_Failed) {
+                        return;
+                    }
+                }
+
+                const TScore next_corner (row_V[w - 1]);
+
+                tile.m_RevOffset = ptrdiff_t(m_SeqLen2 - c0);
+                tile.m_Width = w;
+                tile.m_FreeLastColumn = m_esf_R2 && c0 + w == m_SeqLen2;
+
+                const TScore tile_best (s_ScoreOnlyTile(tile, m_ScoreMatrix.s,
+                                                        m_Wg, m_Ws,
+                                                        m_SmithWaterman,
+                                                        corner, row_V, row_F,
+                                                        &col_V[0], &col_E[0],
+                                                        work));
+                best = max(best, tile_best);
+                corner = next_corner;
+
+                CFastMutexGuard guard (data->m_Mutex);
+                data->m_TilesDone[band] = t + 1;
+                data->m_Cond.SignalAll();
+            }
+        }
+    }
+    catch(...) {
+        CFastMutexGuard guard (data->m_Mutex);
+        data->m_Failed = true;
+        data->m_Cond.SignalAll();
+        throw;
+    }
+
+    data->m_Best[first_band] = best;
+}
+
+
+CNWAligner::TScore CNWAligner::RunScoreOnly(void)
+{
+    if(typeid(*this) != typeid(CNWAligner) &&
+       typeid(*this) != typeid(CMMAligner)) {
+        NCBI_THROW(CAlgoAlignException, eBadParameter,
+                   "Score-only computation is supported by CNWAligner and CMMAligner only");
+    }
+
+    if(m_ScoreMatrixInvalid) {
+        NCBI_THROW(CAlgoAlignException, eInvalidMatrix,
+                   "CNWAligner::SetScoreMatrix(NULL) must be called "
+                   "after changing match/mismatch scores "
+                   "to make sure that the new parameters are engaged.");
+    }
+
+    if(!m_Seq1 || !m_Seq2) {
+        NCBI_THROW(CAlgoAlignException, eNoSeqData,
+                   g_msg_DataNotAvailable);
+    }
+
+    if(!m_guides.empty()) {
+        NCBI_THROW(CAlgoAlignException, eBadParameter,
+                   "Score-only computation not compatible with "
+                   "provided pattern");
+    }
+
+    if(m_SmithWaterman && (!m_esf_L1 || !m_esf_R1 ||
+                           !m_esf_L2 || !m_esf_R2)) {
+        NCBI_THROW(CAlgoAlignException, eBadParameter,
+                   "Smith-Waterman not compatible with end gap penalties");
+    }
+
+    if(m_SeqLen1 == 0 || m_SeqLen2 == 0) {
+        // one gap covers the other sequence; it reaches both ends of the
+        // empty one, so it is free if either of them is
+        const size_t len = m_SeqLen1 + m_SeqLen2;
+        const bool esf = m_SeqLen1 == 0? m_esf_L1 || m_esf_R1:
+                                         m_esf_L2 || m_esf_R2;
+        return len == 0 || m_SmithWaterman || esf?
+            0: m_Wg + TScore(len)*m_Ws;
+    }
+
+    SScoreOnlyData data;
+    data.m_BandHeight = kScoreOnlyBandHeight;
+    data.m_TileWidth = kScoreOnlyTileWidth;
+    data.m_NumBands = (m_SeqLen1 + data.m_BandHeight - 1) / data.m_BandHeight;
+    data.m_NumTiles = (m_SeqLen2 + data.m_TileWidth - 1) / data.m_TileWidth;
+    data.m_RevSeq2.assign(m_Seq2, m_Seq2 + m_SeqLen2);
+    reverse(data.m_RevSeq2.begin(), data.m_RevSeq2.end());
+    data.m_RowV.resize(m_SeqLen2);
+    data.m_RowF.resize(m_SeqLen2);
+    data.m_TilesDone.assign(data.m_NumBands, 0);
+    data.m_Failed = false;
+
+    // with a single tile per band there is nothing to pipeline
+    size_t num_threads (1);
+    if(m_mt && data.m_NumTiles > 1) {
+        const size_t max_threads (min(m_maxthreads, data.m_NumBands));
+        while(num_threads < max_threads &&
+              NW_RequestNewThread(static_cast<unsigned int>(m_maxthreads))) {
+            ++num_threads;
+        }
+    }
+    data.m_NumThreads = num_threads;
+    data.m_Best.assign(num_threads, 0);
+
+    typedef vector<CNWAlignerThread_ScoreOnly*> TThreadVector;
+    TThreadVector threads;
+    threads.reserve(num_threads);
+    for(size_t k = 1; k < num_threads; ++k) {
+        CNWAlignerThread_ScoreOnly* thread =
+            new CNWAlignerThread_ScoreOnly(this, &data, k);
+        threads.push_back(thread);
+        thread->Run();
+    }
+
+    // the worker threads use data, so they must be joined
+    // whatever x_ScoreOnlyBands() throws
+    unique_ptr<CException> e;
+    exception_ptr other;
+    try {
+        x_ScoreOnlyBands(&data, 0);
+    }
+    catch(CException& ex) {
+        e.reset(new CException(ex));
+    }
+    catch(...) {
+        other = current_exception();
+    }
+
+    ITERATE(TThreadVector, ii, threads) {
+
+        if(e.get() == 0 && !other) {
+            CException* pe = 0;
+            (*ii)->Join(reinterpret_cast<void**>(&pe));
+            if(pe) {
+                e.reset(new CException (*pe));
+            }
+        }
+        else {
+            (*ii)->Join(0);
+        }
+    }
+    if(other) {
+        rethrow_exception(other);
+    }
+    if(e.get()) {
+        throw *e;
+    }
+
+    if(m_SmithWaterman) {
+        return *max_element(data.m_Best.begin(), data.m_Best.end());
+    }
+    return data.m_RowV[m_SeqLen2 - 1];
+}
+
+
+CNWAligner::TScore CNWAligner::x_RunLinearSpace(void)
+{
+    if(typeid(*this) != typeid(CNWAligner)) {
+        NCBI_THROW(CAlgoAlignException, eBadParameter,
+                   "Linear space mode is supported by CNWAligner only");
+    }
+
+    if(m_SmithWaterman || !m_guides.empty()) {
+        NCBI_THROW(CAlgoAlignException, eBadParameter,
+                   "Linear space mode not compatible with Smith-Waterman "
+                   "or provided pattern");
+    }
+
+    // CMMAligner implements the Myers-Miller algorithm on top of
+    // the same parameters
+    CMMAligner mm;
+    CNWAligner& mm_base (mm);
+    mm_base.m_Wm = m_Wm;
+    mm_base.m_Wms = m_Wms;
+    mm_base.m_Wg = m_Wg;
+    mm_base.m_Ws = m_Ws;
+    mm_base.m_esf_L1 = m_esf_L1;
+    mm_base.m_esf_R1 = m_esf_R1;
+    mm_base.m_esf_L2 = m_esf_L2;
+    mm_base.m_esf_R2 = m_esf_R2;
+    mm_base.m_abc = m_abc;
+    mm_base.m_ScoreMatrix = m_ScoreMatrix;
+    mm_base.m_ScoreMatrixInvalid = false;
+    mm_base.m_prg_callback = m_prg_callback;
+    mm_base.m_PositivesAsMatches = m_PositivesAsMatches;
+    mm_base.m_GapPreference = m_GapPreference;
+    mm_base.m_mt = m_mt;
+    mm_base.m_maxthreads = m_maxthreads;
+    mm_base.m_MaxMem = m_MaxMem;
+    mm.SetSequences(m_Seq1, m_SeqLen1, m_Seq2, m_SeqLen2, false);
+
+    const TScore score (mm.Run());
+    m_terminate = mm_base.m_terminate;
+    m_Transcript = mm_base.m_Transcript;
+
+    // CMMAligner reports every diagonal step as a match;
+    // tell matches from replacements as the default mode does
+    size_t i1 (0), i2 (0);
+    NON_CONST_REVERSE_ITERATE(TTranscript, ii, m_Transcript) {
+        switch(*ii) {
+        case eTS_Match:
+        case eTS_Replace:
+            *ii = x_GetDiagTS(i1++, i2++);
+            break;
+        case eTS_Insert:
+            ++i2;
+            break;
+        case eTS_Delete:
+            ++i1;
+            break;
+        default:
+            break;
+        }
+    }
+    return score;
+}
+
+
+END_NCBI_SCOPE
@@ -83,4 +83,36 @@ void CNWAlignerThread_Align::OnExit()
     --g_nwnw_thread_count;
 }
 
+
+void* CNWAlignerThread_ScoreOnly::Main()
+{
+    m_exception.reset(0);
+
+    try {
+        m_aligner->x_ScoreOnlyBands(m_data, m_first_band);
+    }
+
+    catch(CException& e) {
+
+        m_exception.reset(new CException(e));
+    }
+
+    catch(...) {
+
+        m_exception.reset(new CException (DIAG_COMPILE_INFO, 0,
+                                          CException::eUnknown,
+                                          "Unregistered exception caught from "
+                                          "CNWAligner::x_ScoreOnlyBands()"));
+    }
+
+    return m_exception.get();
+}
+
+
+void CNWAlignerThread_ScoreOnly::OnExit()
+{
+    CFastMutexGuard guard(thread_count_mutex_nw);
+    --g_nwnw_thread_count;
+}
+
 END_NCBI_SCOPE
@@ -60,6 +60,32 @@ protected:
     unique_ptr<CException>        m_exception;
 };
 
+class CNWAlignerThread_ScoreOnly: public CThread
+{
+public:
+
+    CNWAlignerThread_ScoreOnly(CNWAligner* aligner,
+                               CNWAligner::SScoreOnlyData* data,
+                               size_t first_band):
+        m_aligner(aligner),
+        m_data(data),
+        m_first_band(first_band)
+    {}
+
+    virtual void* Main();
+    virtual void  OnExit();
+
+protected:
+
+    virtual ~CNWAlignerThread_ScoreOnly() {}
+
+    CNWAligner*                 m_aligner;
+    CNWAligner::SScoreOnlyData* m_data;
+    size_t                      m_first_band;
+
+    unique_ptr<CException>        m_exception;
+};
+
 bool NW_RequestNewThread(const unsigned int max_threads);
 
 
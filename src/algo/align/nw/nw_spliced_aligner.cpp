@@ -53,7 +53,8 @@ CSplicedAligner::CSplicedAligner():
 CSplicedAligner::CSplicedAligner(const char* seq1, size_t len1,
                                  const char* seq2, size_t len2)
     : CBandAligner(seq1, len1, seq2, len2),
-      m_IntronMinSize(GetDefaultIntronMinSize())
+      m_IntronMinSize(GetDefaultIntronMinSize()),
+      m_cds_start(0), m_cds_stop(0)
 {
     SetEndSpaceFree(true, true, false, false);
 }
@@ -61,7 +62,8 @@ CSplicedAligner::CSplicedAligner(const char* seq1, size_t len1,
 
 CSplicedAligner::CSplicedAligner(const string& seq1, const string& seq2)
     : CBandAligner(seq1, seq2),
-      m_IntronMinSize(GetDefaultIntronMinSize())
+      m_IntronMinSize(GetDefaultIntronMinSize()),
+      m_cds_start(0), m_cds_stop(0)
 {
     SetEndSpaceFree(true, true, false, false);
 }
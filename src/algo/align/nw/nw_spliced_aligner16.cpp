@@ -33,6 +33,7 @@
 
 #include <ncbi_pch.hpp>
 #include "messages.hpp"
+#include "nw_spliced_row.hpp"
 #include <algo/align/nw/nw_spliced_aligner16.hpp>
 #include <algo/align/nw/align_exception.hpp>
 
@@ -275,6 +276,13 @@ CNWAligner::TScore CSplicedAligner16::x_Align (SAlignInOut* data)
 
     const Uint1 * NCBI_RESTRICT splices (& stl_splices.front());
 
+    // diagonal and vertical gap scores of the current row
+    CNWSplicedProfile<TScore> profile (sm, seq2, N2);
+    vector<TScore> stl_rowG (N2);
+    vector<Uint1> stl_rowFext (N2);
+    TScore * NCBI_RESTRICT rowG (&stl_rowG.front());
+    Uint1 * NCBI_RESTRICT rowFext (&stl_rowFext.front());
+
     size_t cds_start (m_cds_start), cds_stop (m_cds_stop);
     if(cds_start < cds_stop) {
         cds_start -= data->m_offset1;
@@ -334,10 +342,13 @@ NWSPL_DETECTDONOR(2)
             wg1 = ws1 = 0;
         }
 
+        NW_SplicedRowGF(rowV, rowF, profile.Get(ci), N2, wg2, ws2,
+                        bFreeGapRight2? 0: wg2, bFreeGapRight2? 0: ws2,
+                        rowG, rowFext);
+
         for (j = 1; j < N2; ++j, ++k) {
-            			
 
-            G = pV[j] + sm[ci][(unsigned char)seq2[j]];
+            G = rowG[j];
             pV[j] = V;
 
             n0 = V + wg1;
@@ -351,18 +362,9 @@ NWSPL_DETECTDONOR(2)
                 tracer = 0;
             }
 
-            if(j == N2 - 1 && bFreeGapRight2) {
-                wg2 = ws2 = 0;
-            }
-
-            n0 = rowV[j] + wg2;
-            if(rowF[j] >= n0) {
-                rowF[j] += ws2;
+            if(rowFext[j]) {
                 tracer |= kMaskFc;
             }
-            else {
-                rowF[j] = n0 + ws2;
-            }
 
             // evaluate the score (V)
             if (E >= rowF[j]) {
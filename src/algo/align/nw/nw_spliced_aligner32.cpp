@@ -34,6 +34,7 @@
 
 #include <ncbi_pch.hpp>
 #include "messages.hpp"
+#include "nw_spliced_row.hpp"
 #include <algo/align/nw/nw_spliced_aligner32.hpp>
 #include <algo/align/nw/align_exception.hpp>
 
@@ -248,6 +249,60 @@ CNWAligner::TScore CSplicedAligner32::x_Align (SAlignInOut* data)
         cds_stop -= data->m_offset1;
     }
 
+    // diagonal and vertical gap scores of the current row
+    CNWSplicedProfile<TScore> profile (sm, seq2, N2);
+    vector<TScore> stl_rowG (N2);
+    vector<Uint1> stl_rowFext (N2);
+    TScore* rowG = &stl_rowG[0];
+    Uint1* rowFext = &stl_rowFext[0];
+
+    // acceptor and donor penalties at every position of the second
+    // sequence, added to the splice and donor scores: zero for consensus
+    // signals, m_Wd1 for signals with one character distorted and m_Wd2
+    // otherwise. At the first position of the second sequence there is
+    // no preceding character unless the sequence is aligned from an
+    // offset, so the acceptor there counts as distorted.
+    vector<TScore> stl_accPenalty (splice_type_count_32 * N2, 0);
+    vector<TScore> stl_dnrPenalty (splice_type_count_32 * N2, 0);
+    TScore* accPenalty [splice_type_count_32];
+    TScore* dnrPenalty [splice_type_count_32];
+    for(unsigned char st = 0; st < splice_type_count_32; ++st) {
+        accPenalty[st] = &stl_accPenalty[st*N2];
+        dnrPenalty[st] = &stl_dnrPenalty[st*N2];
+    }
+    for(size_t j = 1; j < N2; ++j) {
+        const bool has_c1 = j > 1 || data->m_offset2 > 0;
+        unsigned char c1 = has_c1? seq2[j-1]: 0, c2 = seq2[j];
+        Uint1 acc_mask = has_c1?
+            0x0F & dnr_acc_matrix[(size_t(c1)<<8)|c2]: 0;
+        for(Uint1 st = 0; st < splice_type_count_32; ++st ) {
+            if(acc_mask & (0x01 << st)) {
+                if( c1 != g_nwspl32_acceptor[st][0] ||
+                    c2 != g_nwspl32_acceptor[st][1] ) {
+                    accPenalty[st][j] = m_Wd1;
+                }
+            }
+            else {
+                accPenalty[st][j] = m_Wd2;
+            }
+        }
+        if(j < N2 - 2) {
+            unsigned char d1 = seq2[j+1], d2 = seq2[j+2];
+            Uint1 dnr_mask = 0xF0 & dnr_acc_matrix[(size_t(d1)<<8)|d2];
+            for(Uint1 st = 0; st < splice_type_count_32; ++st ) {
+                if( dnr_mask & (0x10 << st) ) {
+                    if( d1 != g_nwspl32_donor[st][0] ||
+                        d2 != g_nwspl32_donor[st][1] ) {
+                        dnrPenalty[st][j] = m_Wd1;
+                    }
+                }
+                else {
+                    dnrPenalty[st][j] = m_Wd2;
+                }
+            }
+        }
+    }
+
     size_t i, j = 0, k0;
     unsigned char ci;
     for(i = 0;  i < N1;  ++i, j = 0) {
@@ -298,9 +353,13 @@ CNWAligner::TScore CSplicedAligner32::x_Align (SAlignInOut* data)
             }
         }
 
+        NW_SplicedRowGF(rowV, rowF, profile.Get(ci), N2, wg2, ws2,
+                        bFreeGapRight2? 0: wg2, bFreeGapRight2? 0: ws2,
+                        rowG, rowFext);
+
         for (j = 1; j < N2; ++j, ++k) {
             
-            G = pV[j] + sm[ci][(unsigned char)seq2[j]];
+            G = rowG[j];
             pV[j] = V;
 
             n0 = V + wg1;
@@ -312,15 +371,7 @@ CNWAligner::TScore CSplicedAligner32::x_Align (SAlignInOut* data)
 		ins_start = k-1;
             }
 
-            if(j == N2 - 1 && bFreeGapRight2) {
-                wg2 = ws2 = 0;
-            }
-            n0 = rowV[j] + wg2;
-            if(rowF[j] >= n0) {
-                rowF[j] += ws2;
-            }
-            else {
-                rowF[j] = n0 + ws2;
+            if(!rowFext[j]) {
                 del_start[j] = k-N2;
             }
 
@@ -361,27 +412,15 @@ CNWAligner::TScore CSplicedAligner32::x_Align (SAlignInOut* data)
                 
             // check splice signal
             Uint8 dnr_pos = kMax_UI4;
-            unsigned char c1 = seq2[j-1], c2 = seq2[j];
-            Uint1 acc_mask = 0x0F & dnr_acc_matrix[(size_t(c1)<<8)|c2];
             for(Uint1 st = 0; st < splice_type_count_32; ++st ) {
-                if(acc_mask & (0x01 << st)) {
-                    TScore vAcc = vBestDonor[st] + m_Wi[st];
-                    if( c1 != g_nwspl32_acceptor[st][0] ||
-                        c2 != g_nwspl32_acceptor[st][1] ) {
-
-                        vAcc += m_Wd1;
-                    }
-                    if(vAcc > V) {
-                        V = vAcc;
-                        dnr_pos = k0 + jBestDonor[st];
-                    }
+                TScore vAcc = vBestDonor[st] + m_Wi[st];
+                const TScore pen = accPenalty[st][j];
+                if(pen != 0) {
+                    vAcc += pen;
                 }
-                else {   // try arbitrary splice
-                    TScore vAcc = vBestDonor[st] + m_Wi[st] + m_Wd2;
-                    if(vAcc > V) {
-                        V = vAcc;
-                        dnr_pos = k0 + jBestDonor[st];
-                    }
+                if(vAcc > V) {
+                    V = vAcc;
+                    dnr_pos = k0 + jBestDonor[st];
                 }
             }
             
@@ -393,34 +432,13 @@ CNWAligner::TScore CSplicedAligner32::x_Align (SAlignInOut* data)
 
             // detect donor candidates
             if(j < N2 - 2) {
-                unsigned char d1 = seq2[j+1], d2 = seq2[j+2];
-                Uint1 dnr_mask = 0xF0 & dnr_acc_matrix[(size_t(d1)<<8)|d2];
                 for(Uint1 st = 0; st < splice_type_count_32; ++st ) {
-                    if( dnr_mask & (0x10 << st) ) {
-                        if( d1 == g_nwspl32_donor[st][0] &&
-                            d2 == g_nwspl32_donor[st][1] ) {
-
-                            if(V > vBestDonor[st]) {
-                                jAllDonors[st][jTail[st]] = j;
-                                vAllDonors[st][jTail[st]] = V;
-                                ++(jTail[st]);
-                            }
-                        } else {
-                            TScore v = V + m_Wd1;
-                            if(v > vBestDonor[st]) {
-                                jAllDonors[st][jTail[st]] = j;
-                                vAllDonors[st][jTail[st]] = v;
-                                ++(jTail[st]);
-                            }
-                        }
-                    }
-                    else { // both chars distorted
-                        TScore v = V + m_Wd2;
-                        if(v > vBestDonor[st]) {
-                            jAllDonors[st][jTail[st]] = j;
-                            vAllDonors[st][jTail[st]] = v;
-                            ++(jTail[st]);
-                        }
+                    const TScore pen = dnrPenalty[st][j];
+                    const TScore v = pen != 0? V + pen: V;
+                    if(v > vBestDonor[st]) {
+                        jAllDonors[st][jTail[st]] = j;
+                        vAllDonors[st][jTail[st]] = v;
+                        ++(jTail[st]);
                     }
                 }
             }
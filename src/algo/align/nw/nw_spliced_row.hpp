@@ -0,0 +1,212 @@
+#ifndef ALGO___NW_SPLICED_ROW__HPP
+#define ALGO___NW_SPLICED_ROW__HPP
+
+/* $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:  Row helpers for the spliced aligners
+*
+* In the spliced dynamic programming, the diagonal (G) and the vertical
+* gap (F) scores of a row depend on the previous row only, while the
+* horizontal gaps and the introns run along the row. The helpers below
+* compute G and F for a whole row ahead of the sequential part, several
+* genomic positions at a time with SSE2 instructions where available.
+* The arithmetic is exactly that of the scalar recurrences, so the
+* alignments do not change.
+*
+*/
+
+#include <algo/align/nw/nw_aligner.hpp>
+
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+#  include <emmintrin.h>
+#endif
+
+
+BEGIN_NCBI_SCOPE
+
+
+// Substitution scores of first sequence characters against every position
+// of the second sequence, computed on the first request for a character.
+template<typename TValue>
+class CNWSplicedProfile
+{
+public:
+
+    // seq2 is addressed from one, as in the aligners' main loops
+    CNWSplicedProfile(const TNCBIScore (* sm) [NCBI_FSM_DIM],
+                      const char* seq2, size_t n2):
+        m_Sm(sm), m_Seq2(seq2), m_N2(n2), m_Rows(256)
+    {}
+
+    const TValue* Get(unsigned char c) {
+        vector<TValue>& row (m_Rows[c]);
+        if(row.empty()) {
+            row.resize(m_N2);
+            const TNCBIScore* sc (m_Sm[c]);
+            for(size_t j = 1; j < m_N2; ++j) {
+                row[j] = sc[(unsigned char)m_Seq2[j]];
+            }
+        }
+        return &row[0];
+    }
+
+private:
+
+    const TNCBIScore (* m_Sm) [NCBI_FSM_DIM];
+    const char*             m_Seq2;
+    size_t                  m_N2;
+    vector<vector<TValue> > m_Rows;
+};
+
+
+// Compute G and F for cells 1..n2-1 of a row.
+// rowV and rowF hold the previous row on entry; rowF is updated.
+// ext[j] is set to 1 if the vertical gap ending at cell j was extended
+// and to 0 if it was opened. The last cell uses the wg_last/ws_last
+// penalties.
+template<typename TValue>
+inline void NW_SplicedRowGF_Scalar(const TValue* rowV, TValue* rowF,
+                                   const TValue* profile, size_t j0, size_t j1,
+                                   TValue wg, TValue ws,
+                                   TValue* G, Uint1* ext)
+{
+    for(size_t j = j0; j < j1; ++j) {
+        G[j] = rowV[j - 1] + profile[j];
+        const TValue n0 = rowV[j] + wg;
+        if(rowF[j] >= n0) {
+            rowF[j] += ws;
+            ext[j] = 1;
+        }
+        else {
+            rowF[j] = n0 + ws;
+            ext[j] = 0;
+        }
+    }
+}
+
+
+template<typename TValue>
+inline void NW_SplicedRowGF(const TValue* rowV, TValue* rowF,
+                            const TValue* profile, size_t n2,
+                            TValue wg, TValue ws,
+                            TValue wg_last, TValue ws_last,
+                            TValue* G, Uint1* ext)
+{
+    if(n2 < 2) {
+        return;
+    }
+    NW_SplicedRowGF_Scalar(rowV, rowF, profile, 1, n2 - 1, wg, ws, G, ext);
+    NW_SplicedRowGF_Scalar(rowV, rowF, profile, n2 - 1, n2,
+                           wg_last, ws_last, G, ext);
+}
+
+
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+
+template<>
+inline void NW_SplicedRowGF<int>(const int* rowV, int* rowF,
+                                 const int* profile, size_t n2,
+                                 int wg, int ws, int wg_last, int ws_last,
+                                 int* G, Uint1* ext)
+{
+    if(n2 < 2) {
+        return;
+    }
+
+    const __m128i vwg (_mm_set1_epi32(wg));
+    const __m128i vws (_mm_set1_epi32(ws));
+
+    size_t j = 1;
+    for(; j + 4 <= n2 - 1; j += 4) {
+
+        _mm_storeu_si128((__m128i*)(G + j), _mm_add_epi32(
+            _mm_loadu_si128((const __m128i*)(rowV + j - 1)),
+            _mm_loadu_si128((const __m128i*)(profile + j))));
+
+        const __m128i F  (_mm_loadu_si128((const __m128i*)(rowF + j)));
+        const __m128i n0 (_mm_add_epi32(
+            _mm_loadu_si128((const __m128i*)(rowV + j)), vwg));
+        const __m128i open (_mm_cmpgt_epi32(n0, F));
+        _mm_storeu_si128((__m128i*)(rowF + j), _mm_add_epi32(
+            _mm_or_si128(_mm_and_si128(open, n0), _mm_andnot_si128(open, F)),
+            vws));
+
+        const int open_bits (_mm_movemask_ps(_mm_castsi128_ps(open)));
+        ext[j]     = !(open_bits & 1);
+        ext[j + 1] = !(open_bits & 2);
+        ext[j + 2] = !(open_bits & 4);
+        ext[j + 3] = !(open_bits & 8);
+    }
+
+    NW_SplicedRowGF_Scalar(rowV, rowF, profile, j, n2 - 1, wg, ws, G, ext);
+    NW_SplicedRowGF_Scalar(rowV, rowF, profile, n2 - 1, n2,
+                           wg_last, ws_last, G, ext);
+}
+
+
+template<>
+inline void NW_SplicedRowGF<double>(const double* rowV, double* rowF,
+                                    const double* profile, size_t n2,
+                                    double wg, double ws,
+                                    double wg_last, double ws_last,
+                                    double* G, Uint1* ext)
+{
+    if(n2 < 2) {
+        return;
+    }
+
+    const __m128d vwg (_mm_set1_pd(wg));
+    const __m128d vws (_mm_set1_pd(ws));
+
+    size_t j = 1;
+    for(; j + 2 <= n2 - 1; j += 2) {
+
+        _mm_storeu_pd(G + j, _mm_add_pd(_mm_loadu_pd(rowV + j - 1),
+                                        _mm_loadu_pd(profile + j)));
+
+        const __m128d F  (_mm_loadu_pd(rowF + j));
+        const __m128d n0 (_mm_add_pd(_mm_loadu_pd(rowV + j), vwg));
+        const __m128d extend (_mm_cmpge_pd(F, n0));
+        _mm_storeu_pd(rowF + j, _mm_add_pd(
+            _mm_or_pd(_mm_and_pd(extend, F), _mm_andnot_pd(extend, n0)),
+            vws));
+
+        const int ext_bits (_mm_movemask_pd(extend));
+        ext[j]     = ext_bits & 1;
+        ext[j + 1] = (ext_bits >> 1) & 1;
+    }
+
+    NW_SplicedRowGF_Scalar(rowV, rowF, profile, j, n2 - 1, wg, ws, G, ext);
+    NW_SplicedRowGF_Scalar(rowV, rowF, profile, n2 - 1, n2,
+                           wg_last, ws_last, G, ext);
+}
+
+#endif
+
+
+END_NCBI_SCOPE
+
+#endif  /* ALGO___NW_SPLICED_ROW__HPP */
@@ -0,0 +1,219 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   Unit tests for the score-only and linear space modes of CNWAligner.
+*
+* ===========================================================================
+*/
+
+#include <ncbi_pch.hpp>
+
+#include <corelib/test_boost.hpp>
+#include <corelib/ncbithr.hpp>
+#include <util/random_gen.hpp>
+#include <util/tables/raw_scoremat.h>
+#include <algo/align/nw/nw_aligner.hpp>
+
+USING_NCBI_SCOPE;
+
+
+static string s_RandomSeq(CRandom& random, const char* alphabet, size_t len)
+{
+    const size_t abc_len = strlen(alphabet);
+    string seq;
+    for (size_t i = 0;  i < len;  ++i) {
+        seq += alphabet[random.GetRand(0, CRandom::TValue(abc_len - 1))];
+    }
+    return seq;
+}
+
+/// Mutated copy of a sequence, so that the pair has a meaningful alignment
+static string s_Mutate(CRandom& random, const char* alphabet,
+                       const string& seq)
+{
+    const size_t abc_len = strlen(alphabet);
+    string result;
+    ITERATE(string, it, seq) {
+        switch (random.GetRand(0, 9)) {
+        case 0:  // substitution
+            result += alphabet[random.GetRand(0, CRandom::TValue(abc_len-1))];
+            break;
+        case 1:  // deletion
+            break;
+        case 2:  // insertion
+            result += *it;
+            result += alphabet[random.GetRand(0, CRandom::TValue(abc_len-1))];
+            break;
+        default:
+            result += *it;
+        }
+    }
+    if (result.empty()) {
+        result = alphabet[0];
+    }
+    return result;
+}
+
+
+BOOST_AUTO_TEST_CASE(ScoreOnlyAndLinearSpaceMatchRun)
+{
+    CRandom random(17);
+    const char* kDna = "ACGT";
+    const char* kProtein = "ARNDCQEGHILKMFPSTWYV";
+
+    for (int iter = 0;  iter < 200;  ++iter) {
+        const bool protein = iter % 3 == 0;
+        const char* abc = protein ? kProtein : kDna;
+        const size_t len = 1 + random.GetRand(0, iter < 100 ? 40 : 600);
+        const string seq1 = s_RandomSeq(random, abc, len);
+        const string seq2 = iter % 4 == 0 ? s_RandomSeq(random, abc, len/2+1)
+                                          : s_Mutate(random, abc, seq1);
+        bool esf[4];
+        for (int k = 0;  k < 4;  ++k) {
+            esf[k] = random.GetRand(0, 1) != 0;
+        }
+        const CNWAligner::EGapPreference gap_pref =
+            random.GetRand(0, 1) ? CNWAligner::eLater : CNWAligner::eEarlier;
+
+        CNWAligner aligner(seq1, seq2, protein ? &NCBISM_Blosum62 : 0);
+        aligner.SetWg(protein ? -11 : -5);
+        aligner.SetWs(protein ? -1 : -2);
+        aligner.SetEndSpaceFree(esf[0], esf[1], esf[2], esf[3]);
+        aligner.SetGapPreference(gap_pref);
+        aligner.EnableMultipleThreads(iter % 2 == 0);
+
+        const CNWAligner::TScore score = aligner.Run();
+        BOOST_REQUIRE_EQUAL(
+            aligner.ScoreFromTranscript(aligner.GetTranscript(false), 0, 0),
+            score);
+
+        BOOST_REQUIRE_EQUAL(aligner.RunScoreOnly(), score);
+
+        // The linear space alignment may differ from the default one,
+        // but it must be optimal too
+        aligner.SetLinearSpace(true);
+        BOOST_REQUIRE_EQUAL(aligner.Run(), score);
+        BOOST_REQUIRE_EQUAL(
+            aligner.ScoreFromTranscript(aligner.GetTranscript(false), 0, 0),
+            score);
+        if ( !protein ) {
+            // Matches and mismatches must be told apart
+            BOOST_REQUIRE_EQUAL(
+                aligner.ScoreFromTranscript(aligner.GetTranscript(false)),
+                score);
+        }
+    }
+}
+
+
+// Sequences longer than a tile, so that every band has several tiles and
+// the bands are pipelined across threads
+BOOST_AUTO_TEST_CASE(ScoreOnlyLongSequencesMatchRun)
+{
+    CRandom random(29);
+    const char* kDna = "ACGT";
+    const char* kProtein = "ARNDCQEGHILKMFPSTWYV";
+
+    for (int iter = 0;  iter < 8;  ++iter) {
+        const bool protein = iter % 4 == 3;
+        const char* abc = protein ? kProtein : kDna;
+        const size_t len = 900 + random.GetRand(0, 600);
+        const string seq1 = s_RandomSeq(random, abc, len);
+        string seq2 = s_Mutate(random, abc, seq1);
+        // make the second sequence span a few tiles
+        seq2 = s_RandomSeq(random, abc, 2000 + random.GetRand(0, 2500))
+            + seq2 + s_RandomSeq(random, abc, random.GetRand(0, 1500));
+
+        CNWAligner aligner(seq1, seq2, protein ? &NCBISM_Blosum62 : 0);
+        aligner.SetWg(protein ? -11 : -5);
+        aligner.SetWs(protein ? -1 : -2);
+        aligner.SetEndSpaceFree(iter % 2 == 0, iter % 3 == 0,
+                                iter % 2 != 0, iter % 3 != 0);
+        const CNWAligner::TScore score = aligner.Run();
+
+        // more threads than CPUs are fine; bands are still pipelined
+        aligner.EnableMultipleThreads(true, 1 + iter % 4);
+        BOOST_REQUIRE_EQUAL(aligner.RunScoreOnly(), score);
+
+        aligner.EnableMultipleThreads(false);
+        BOOST_REQUIRE_EQUAL(aligner.RunScoreOnly(), score);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ScoreOnlySmithWatermanMatchesRun)
+{
+    CRandom random(41);
+    const char* kDna = "ACGT";
+    const char* kProtein = "ARNDCQEGHILKMFPSTWYV";
+
+    for (int iter = 0;  iter < 60;  ++iter) {
+        const bool protein = iter % 3 == 0;
+        const char* abc = protein ? kProtein : kDna;
+        const bool long_seqs = iter % 10 == 9;
+        const size_t len = long_seqs ? 1000 + random.GetRand(0, 500)
+                                     : 1 + random.GetRand(0, 300);
+        const string core = s_RandomSeq(random, abc, len);
+        // local similarity surrounded by unrelated sequence
+        const string seq1 = s_RandomSeq(random, abc, random.GetRand(0, 50))
+            + core + s_RandomSeq(random, abc, random.GetRand(0, 50));
+        const string seq2 = s_RandomSeq(random, abc, long_seqs ? 2500 : 20)
+            + s_Mutate(random, abc, core)
+            + s_RandomSeq(random, abc, random.GetRand(0, 80));
+
+        CNWAligner aligner(seq1, seq2, protein ? &NCBISM_Blosum62 : 0);
+        aligner.SetWg(protein ? -11 : -5);
+        aligner.SetWs(protein ? -1 : -2);
+        aligner.SetSmithWaterman(true);
+        const CNWAligner::TScore score = aligner.Run();
+
+        aligner.EnableMultipleThreads(iter % 2 == 0, 3);
+        BOOST_REQUIRE_EQUAL(aligner.RunScoreOnly(), score);
+    }
+}
+
+// A gap covering a whole sequence is free if it reaches a free end.
+// The aligner is reused, as SetSequences() accepts an empty sequence
+// only while it still holds the buffer of a previous one.
+BOOST_AUTO_TEST_CASE(ScoreOnlyEmptySequence)
+{
+    const string seq ("ACGTTGCA");
+    const CNWAligner::TScore gap (-5 - 2 * int(seq.size()));
+    for (int k = 0;  k < 16;  ++k) {
+        const bool L1 = (k & 1) != 0, R1 = (k & 2) != 0;
+        const bool L2 = (k & 4) != 0, R2 = (k & 8) != 0;
+        CNWAligner aligner (seq, seq);
+        aligner.SetWg(-5);
+        aligner.SetWs(-2);
+        aligner.SetEndSpaceFree(L1, R1, L2, R2);
+
+        aligner.SetSequences("", seq);
+        BOOST_CHECK_EQUAL(aligner.RunScoreOnly(), L1 || R1? 0: gap);
+        aligner.SetSequences(seq, "");
+        BOOST_CHECK_EQUAL(aligner.RunScoreOnly(), L2 || R2? 0: gap);
+        aligner.SetSequences("", "");
+        BOOST_CHECK_EQUAL(aligner.RunScoreOnly(), 0);
+    }
+}
@@ -0,0 +1,359 @@
+/*  $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's official duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*
+* File Description:
+*   Unit tests for the row computations of the spliced aligners.
+*
+* ===========================================================================
+*/
+
+#include <ncbi_pch.hpp>
+
+#include <corelib/test_boost.hpp>
+#include <util/random_gen.hpp>
+#include <algo/align/nw/nw_spliced_aligner16.hpp>
+#include <algo/align/nw/nw_spliced_aligner32.hpp>
+
+#include "../nw_spliced_row.hpp"
+
+USING_NCBI_SCOPE;
+
+
+// G and F of a row computed by NW_SplicedRowGF (SSE2 where available)
+// must be those of the scalar recurrences, including ties between
+// extending and opening a vertical gap.
+template<typename TValue>
+static void s_CheckSplicedRowGF(CRandom& random, size_t n2, TValue step)
+{
+    vector<TValue> rowV (n2 + 1), rowF (n2 + 1), profile (n2 + 1);
+    for (size_t j = 0;  j < n2;  ++j) {
+        // few distinct values, so that F == V + wg happens often
+        rowV[j]    = step * TValue(random.GetRand(0, 6));
+        rowF[j]    = step * TValue(random.GetRand(0, 6)) - 2 * step;
+        profile[j] = step * (random.GetRand(0, 1) ? 1 : -2);
+    }
+    const TValue wg (-2 * step), ws (-step);
+    const TValue wg_last (-step), ws_last (0);
+
+    vector<TValue> F1 (rowF), F2 (rowF), G1 (n2 + 1), G2 (n2 + 1);
+    vector<Uint1>  ext1 (n2 + 1, 2), ext2 (n2 + 1, 2);
+
+    NW_SplicedRowGF(&rowV[0], &F1[0], &profile[0], n2, wg, ws,
+                    wg_last, ws_last, &G1[0], &ext1[0]);
+    if (n2 >= 2) {
+        NW_SplicedRowGF_Scalar(&rowV[0], &F2[0], &profile[0], 1, n2 - 1,
+                               wg, ws, &G2[0], &ext2[0]);
+        NW_SplicedRowGF_Scalar(&rowV[0], &F2[0], &profile[0], n2 - 1, n2,
+                               wg_last, ws_last, &G2[0], &ext2[0]);
+    }
+
+    for (size_t j = 1;  j < n2;  ++j) {
+        BOOST_REQUIRE_EQUAL(G1[j], G2[j]);
+        BOOST_REQUIRE_EQUAL(F1[j], F2[j]);
+        BOOST_REQUIRE_EQUAL(int(ext1[j]), int(ext2[j]));
+    }
+    // cells outside the row are left alone
+    BOOST_REQUIRE_EQUAL(F1[0], rowF[0]);
+    BOOST_REQUIRE_EQUAL(int(ext1[0]), 2);
+    BOOST_REQUIRE_EQUAL(int(ext1[n2]), 2);
+}
+
+BOOST_AUTO_TEST_CASE(SplicedRowMatchesScalar)
+{
+    CRandom random(5);
+    for (size_t n2 = 0;  n2 < 40;  ++n2) {
+        for (int iter = 0;  iter < 20;  ++iter) {
+            s_CheckSplicedRowGF<int>(random, n2, 3);
+            s_CheckSplicedRowGF<double>(random, n2, 0.25);
+        }
+    }
+}
+
+
+static string s_RandomDna(CRandom& random, size_t len)
+{
+    string seq;
+    for (size_t i = 0;  i < len;  ++i) {
+        seq += "ACGT"[random.GetRand(0, 3)];
+    }
+    return seq;
+}
+
+/// Copy of a sequence with about one substitution, deletion or insertion
+/// in every 'rate' positions
+static string s_MutateDna(CRandom& random, const string& seq, int rate)
+{
+    string result;
+    ITERATE(string, it, seq) {
+        switch (random.GetRand(0, 3 * rate - 1)) {
+        case 0:
+            result += "ACGT"[random.GetRand(0, 3)];
+            break;
+        case 1:
+            break;
+        case 2:
+            result += *it;
+            result += "ACGT"[random.GetRand(0, 3)];
+            break;
+        default:
+            result += *it;
+        }
+    }
+    return result;
+}
+
+/// Transcript with runs of the same symbol written as count and symbol
+static string s_RunLengthTranscript(const string& transcript)
+{
+    string result;
+    for (size_t i = 0;  i < transcript.size();  ) {
+        size_t k = i;
+        while (k < transcript.size()  &&  transcript[k] == transcript[i]) {
+            ++k;
+        }
+        result += NStr::NumericToString(k - i) + transcript[i];
+        i = k;
+    }
+    return result;
+}
+
+struct SSplicedPair {
+    string cdna;
+    string genomic;
+};
+
+/// Genomic sequence with 'exons' exons of the given lengths separated by
+/// introns with the given donor and acceptor signals, and the cDNA made
+/// from the exons
+static SSplicedPair s_MakeSplicedPair(CRandom& random,
+                                      const vector<size_t>& exons,
+                                      const vector<string>& signals,
+                                      size_t intron_len,
+                                      size_t flank_len,
+                                      int mutation_rate)
+{
+    SSplicedPair pair;
+    pair.genomic = s_RandomDna(random, flank_len);
+    string mrna;
+    for (size_t i = 0;  i < exons.size();  ++i) {
+        const string exon = s_RandomDna(random, exons[i]);
+        mrna += exon;
+        pair.genomic += exon;
+        if (i + 1 < exons.size()) {
+            const string& signal = signals[i % signals.size()];
+            pair.genomic += signal.substr(0, 2) +
+                s_RandomDna(random, intron_len - 4) + signal.substr(2, 2);
+        }
+    }
+    pair.genomic += s_RandomDna(random, flank_len);
+    pair.cdna = mutation_rate ? s_MutateDna(random, mrna, mutation_rate)
+                              : mrna;
+    return pair;
+}
+
+/// Pairs of cDNA and genomic sequences for the aligners: splice signals of
+/// all types, exons and introns at the ends of the sequences, intron
+/// lengths around the minimum, ambiguous intron positions, and random
+/// gene structures with every row length modulo the vector width
+static vector<SSplicedPair> s_SplicedPairs(void)
+{
+    CRandom random(29);
+    vector<SSplicedPair> pairs;
+    const char* const kSignals[] = { "GTAG", "GCAG", "ATAC", "GGCA" };
+
+    // each splice type, and the types mixed
+    for (size_t s = 0;  s < ArraySize(kSignals);  ++s) {
+        pairs.push_back(s_MakeSplicedPair(
+            random, { 40, 35, 45 }, { kSignals[s] }, 60, 10, 0));
+    }
+    pairs.push_back(s_MakeSplicedPair(
+        random, { 30, 30, 30, 30 }, { "GTAG", "ATAC", "GCAG" }, 50, 5, 0));
+
+    // no genomic flanks; exons of one and two bases next to the ends
+    pairs.push_back(s_MakeSplicedPair(
+        random, { 1, 50, 2 }, { "GTAG" }, 40, 0, 0));
+    pairs.push_back(s_MakeSplicedPair(
+        random, { 2, 60, 1 }, { "ATAC" }, 40, 0, 0));
+    // a short exon between two introns
+    pairs.push_back(s_MakeSplicedPair(
+        random, { 40, 3, 40 }, { "GTAG" }, 45, 8, 0));
+
+    // introns of the minimum size and one base shorter
+    const size_t min_intron = CSplicedAligner::GetDefaultIntronMinSize();
+    pairs.push_back(s_MakeSplicedPair(
+        random, { 40, 40 }, { "GTAG" }, min_intron, 6, 0));
+    pairs.push_back(s_MakeSplicedPair(
+        random, { 40, 40 }, { "GTAG" }, min_intron - 1, 6, 0));
+
+    // the intron can be shifted: the exon ends the way the intron does
+    {
+        SSplicedPair pair;
+        const string exon1 = s_RandomDna(random, 30) + "AG";
+        const string exon2 = "GT" + s_RandomDna(random, 30);
+        pair.cdna = exon1 + exon2;
+        pair.genomic = s_RandomDna(random, 7) + exon1 + "GT" +
+            s_RandomDna(random, 46) + "AG" + exon2 + s_RandomDna(random, 7);
+        pairs.push_back(pair);
+    }
+
+    // a poly(A) tail missing from the genomic sequence
+    {
+        SSplicedPair pair = s_MakeSplicedPair(
+            random, { 50, 50 }, { "GTAG" }, 70, 10, 0);
+        pair.cdna += string(20, 'A');
+        pairs.push_back(pair);
+    }
+
+    // ambiguous bases
+    {
+        SSplicedPair pair = s_MakeSplicedPair(
+            random, { 45, 45 }, { "GCAG" }, 55, 4, 0);
+        pair.cdna[10] = pair.cdna[60] = 'N';
+        pair.genomic[20] = 'N';
+        pairs.push_back(pair);
+    }
+
+    // genomic lengths with every remainder modulo the vector width
+    for (size_t flank = 0;  flank < 4;  ++flank) {
+        pairs.push_back(s_MakeSplicedPair(
+            random, { 25, 25 }, { "GTAG" }, 40, flank, 25));
+    }
+
+    // random gene structures with mutated cDNA
+    for (int iter = 0;  iter < 12;  ++iter) {
+        vector<size_t> exons (random.GetRand(2, 4));
+        NON_CONST_ITERATE(vector<size_t>, it, exons) {
+            *it = random.GetRand(10, 90);
+        }
+        vector<string> signals;
+        for (size_t i = 0;  i + 1 < exons.size();  ++i) {
+            signals.push_back(kSignals[random.GetRand(0, 3)]);
+        }
+        pairs.push_back(s_MakeSplicedPair(
+            random, exons, signals, random.GetRand(30, 150),
+            random.GetRand(0, 30), random.GetRand(15, 40)));
+    }
+
+    return pairs;
+}
+
+/// Score and run-length transcript of every pair
+template<class TAligner>
+static vector<string> s_AlignSplicedPairs(void)
+{
+    vector<string> results;
+    const vector<SSplicedPair> pairs = s_SplicedPairs();
+    ITERATE(vector<SSplicedPair>, it, pairs) {
+        TAligner aligner(it->cdna, it->genomic);
+        aligner.SetEndSpaceFree(false, false, true, true);
+        const CNWAligner::TScore score = aligner.Run();
+        results.push_back(NStr::NumericToString(score) + ' ' +
+            s_RunLengthTranscript(aligner.GetTranscriptString()));
+    }
+    return results;
+}
+
+// Results of the spliced aligners before their rows were vectorized
+static const char* const kSpliced16Results[] = {
+    "54 10I40M60+35M60+45M10I",
+    "46 10I40M60+35M60+45M10I",
+    "42 10I40M60+35M60+45M10I",
+    "38 10I38M60+2R35M60+45M10I",
+    "56 5I30M50+30M50+30M50+30M5I",
+    "37 1M40+50M40+2M",
+    "35 2M40+60M40+1M",
+    "25 8I40M45+3M45+40M8I",
+    "38 6I40M25+40M6I",
+    "23 6I38M26+2D40M6I",
+    "18 7I32M50+32M7I",
+    "56 10I50M70+51M2R1M4R1M1R10D",
+    "43 4I10M1R5M1R28M55+15M1R29M4I",
+    "39 25M40+9M1R15M",
+    "25 1I3M1R21M40+25M1I",
+    "15 2I17M3R5M40+25M2I",
+    "12 1M3I24M40+8M1I16M1R2I",
+    "45 17D25+9M1R4M2D52M71+34M8I",
+    "51 38M82+12M1I16M",
+    "104 7D25+20M1D61M139+47M1R14M1I25M182+1M24D",
+    "86 2R27+34M150+58M1I22M150+18M150+32M29+1R1M2D",
+    "72 29M1R3M1I38M1I5M1R5M122+9M1I8M1I120+4M1R1M1R11M122+13M1R8M",
+    "73 8D25+39M88+25M88+61M1I1M32+2M16D",
+    "22 8I20M1R1M1I15M1D10M1I10M31+8M1R10M1D20M61+1M1R1M1R4M2R1M1R16M1D23M1I5M1R1I14M1R7I",
+    "146 1M3I46M1I40M98+12M1R14M1D22M1R3M1D7M98+24M1R9M1I24M98+3M1I14M1I21M1I11M1R2M3I",
+    "53 5D25+31M1D17M1D5M1D13M1D6M123+21M1I2M1R20M1D18M1D12M1R1M1R155+12D",
+    "77 9I29M96+60M96+2M1R64M9I",
+    "35 3D2M2R1M1R1M86+12M1R14M63+6M1D7M1D3M1R13M1I18M1R25M1R2M26+1R1I3M7D",
+    "42 14D1R2M29+14M1I41M1D5M1R86+3M1I2M1R39M1I8M25+10D"
+};
+
+static const char* const kSpliced32Results[] = {
+    "40 10I40M60+35M60+45M10I",
+    "34 10I40M60+35M60+45M10I",
+    "28 10I40M60+35M60+45M10I",
+    "28 10I38M60+2R35M1R60+44M10I",
+    "36 5I30M50+30M50+30M50+30M5I",
+    "23 1M40+50M40+2M",
+    "21 2M40+60M40+1M",
+    "15 8I40M90+1M2R40M8I",
+    "31 6I40M25+40M6I",
+    "18 6I39M25+1M1D39M6I",
+    "11 7I32M50+32M7I",
+    "49 10I50M70+51M2R1M4R1M1R10D",
+    "37 4I10M1R5M1R28M55+15M1R29M4I",
+    "32 25M40+9M1R15M",
+    "18 1I3M1R21M40+25M1I",
+    "8 2I17M3R5M40+25M2I",
+    "5 1M3I24M40+8M1I16M1R2I",
+    "33 7I6M1D8M2I11M1R4M2D52M71+34M8I",
+    "44 38M82+12M1I16M",
+    "89 8D26+19M1D61M139+47M1R14M1I23M185+27D",
+    "58 2D29+34M150+58M1I23M1R150+16M150+32M29+1R1M2D",
+    "55 29M1R3M1I38M1I5M1R5M122+9M2R1M1R2M1R8M1R243+4M1R2M1R1M1I14M1R8M",
+    "55 8D25+39M88+25M88+61M1D9M25+2M7D",
+    "11 8I20M1R1M1I15M1D10M1I10M31+8M1R10M1D20M61+1M1R1M1R4M2R1M1R16M1D23M1I5M1R1I14M1R7I",
+    "126 1M3I46M1I40M98+12M1R14M1D22M1R3M1D7M98+24M1R9M1I24M98+3M1I14M1I21M1I11M1R2M3I",
+    "36 5D25+31M1D17M1D5M1D13M1D6M123+21M1I2M1R20M1D18M1D12M158+15D",
+    "66 9I29M96+60M96+2M1R64M9I",
+    "20 3D2M2R1M1R1M86+12M1R14M63+6M1D7M1D3M1R13M1I18M1R25M1R6M1R26+6D",
+    "25 17D32+14M1I41M1D5M1R86+3M1I2M1R36M31+4M2R15D"
+};
+
+BOOST_AUTO_TEST_CASE(SplicedAligner16MatchesScalarTranscripts)
+{
+    const vector<string> results = s_AlignSplicedPairs<CSplicedAligner16>();
+    BOOST_REQUIRE_EQUAL(results.size(), ArraySize(kSpliced16Results));
+    for (size_t i = 0;  i < results.size();  ++i) {
+        BOOST_CHECK_EQUAL(results[i], kSpliced16Results[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SplicedAligner32MatchesScalarTranscripts)
+{
+    const vector<string> results = s_AlignSplicedPairs<CSplicedAligner32>();
+    BOOST_REQUIRE_EQUAL(results.size(), ArraySize(kSpliced32Results));
+    for (size_t i = 0;  i < results.size();  ++i) {
+        BOOST_CHECK_EQUAL(results[i], kSpliced32Results[i]);
+    }
+}
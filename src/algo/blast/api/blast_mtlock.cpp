@@ -52,6 +52,8 @@ static int BlastLockHandler(void* user_data, EMT_Lock how)
     case eMT_Unlock:
         lock->Unlock();
         break;
+    case eMT_TryLock:
+        return lock->TryLock() ? 1 : 0;
     default:
         break;
     }
@@ -112,7 +112,8 @@ CLocalBlast::CLocalBlast(CRef<IQueryFactory> qf,
   m_Opts            (const_cast<CBlastOptions*>(&opts_handle->GetOptions())),
   m_InternalData    (0),
   m_PrelimSearch    (new CBlastPrelimSearch(qf, m_Opts, dbinfo)),
-  m_TbackSearch     (0)
+  m_TbackSearch     (0),
+  m_NumTracebackThreads(0)
 {}
 
 CLocalBlast::CLocalBlast(CRef<IQueryFactory> qf,
@@ -123,7 +124,8 @@ CLocalBlast::CLocalBlast(CRef<IQueryFactory> qf,
   m_InternalData    (0),
   m_PrelimSearch    (new CBlastPrelimSearch(qf, m_Opts, db)),
   m_TbackSearch     (0),
-  m_LocalDbAdapter  (db.GetNonNullPointer())
+  m_LocalDbAdapter  (db.GetNonNullPointer()),
+  m_NumTracebackThreads(0)
 {}
 
 CLocalBlast::CLocalBlast(CRef<IQueryFactory> qf,
@@ -136,7 +138,8 @@ CLocalBlast::CLocalBlast(CRef<IQueryFactory> qf,
   m_PrelimSearch    (new CBlastPrelimSearch(qf, m_Opts, seqsrc,
                                             CRef<CPssmWithParameters>())),
   m_TbackSearch     (0),
-  m_SeqInfoSrc      (seqInfoSrc)
+  m_SeqInfoSrc      (seqInfoSrc),
+  m_NumTracebackThreads(0)
 {}
 
 /** FIXME: this should be removed as soon as we safely can
@@ -284,7 +287,7 @@ CLocalBlast::Run()
 	&& !m_LocalDbAdapter->IsDbScanMode()) {
         m_TbackSearch->SetResultType(eSequenceComparison);
     }
-    m_TbackSearch->SetNumberOfThreads(GetNumberOfThreads());
+    m_TbackSearch->SetNumberOfThreads(GetNumberOfTracebackThreads());
     CRef<CSearchResultSet> retval = m_TbackSearch->Run();
     retval->SetFilteredQueryRegions(m_PrelimSearch->GetFilteredQueryRegions());
     m_Messages = m_TbackSearch->GetSearchMessages();
@@ -293,6 +296,27 @@ CLocalBlast::Run()
     return retval;
 }
 
+size_t
+CLocalBlast::GetNumberOfTracebackThreads(void) const
+{
+    if (m_NumTracebackThreads > 0) {
+        return m_NumTracebackThreads;
+    }
+
+    // used to tune the traceback stage independently of the preliminary
+    // stage, e.g.: when the traceback is dominated by sequence fetching
+    const char* tback_threads_str = getenv("BLAST_TRACEBACK_THREADS");
+    if (tback_threads_str && !NStr::IsBlank(tback_threads_str)) {
+        int retval = NStr::StringToInt(tback_threads_str,
+                                       NStr::fConvErr_NoThrow);
+        if (retval > 0) {
+            _TRACE("Using traceback thread count from environment " << retval);
+            return static_cast<size_t>(retval);
+        }
+    }
+    return GetNumberOfThreads();
+}
+
 Int4 CLocalBlast::GetNumExtensions()
 {
     Int4 retv = 0;
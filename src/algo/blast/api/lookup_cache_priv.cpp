@@ -0,0 +1,652 @@
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/** @file lookup_cache_priv.cpp
+ * On-disk cache of lookup tables
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbifile.hpp>
+#include <util/checksum.hpp>
+#include <algo/blast/core/blast_nalookup.h>
+#include <algo/blast/core/blast_aalookup.h>
+#include <algo/blast/core/blast_filter.h>
+#include <algo/blast/core/blast_util.h>
+#include "lookup_cache_priv.hpp"
+
+/** @addtogroup AlgoBlast
+ *
+ * @{
+ */
+
+BEGIN_NCBI_SCOPE
+BEGIN_SCOPE(blast)
+
+/// Identifies lookup table cache files
+static const char kCacheMagic[4] = { 'B', 'L', 'U', 'T' };
+
+/// Version of the cache file layout; increment whenever the layout or the
+/// lookup table structures change
+static const Uint4 kCacheVersion = 2;
+
+/// Used to reject files written on a machine with another byte order
+static const Uint4 kByteOrderMark = 0x01020304;
+
+/// Header of a lookup table cache file. The header is followed by the
+/// scalar fields of the table and then by its arrays, each preceded by
+/// its number of elements.
+struct SLookupCacheHeader {
+    char  magic[4];        ///< kCacheMagic
+    Uint4 version;         ///< kCacheVersion
+    Uint4 byte_order;      ///< kByteOrderMark
+    Uint4 lut_type;        ///< ELookupTableType of the table
+    Int4  query_length;    ///< Length of the concatenated query
+};
+
+/// Name of the environment variable holding the cache directory
+static const char* kCacheDirEnv = "BLAST_LOOKUP_CACHE_DIR";
+
+/// Mirrors the mask-at-hash check of the lookup table constructors, which
+/// decides whether the table keeps the masked locations.
+static bool
+s_MaskAtHash(const QuerySetUpOptions* query_options)
+{
+    if ( !query_options ) {
+        return false;
+    }
+    return SBlastFilterOptionsMaskAtHash(query_options->filtering_options) ||
+           (query_options->filter_string &&
+            strchr(query_options->filter_string, 'm'));
+}
+
+template <class T>
+static void
+s_AddToDigest(CChecksum& digest, const T& value)
+{
+    digest.AddChars(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/// Score matrix used to find the neighboring words of a protein lookup
+/// table, chosen as in LookupTableWrapInit
+static const SBlastScoreMatrix*
+s_GetAaLookupMatrix(const BlastScoreBlk* sbp)
+{
+    if ( !sbp ) {
+        return NULL;
+    }
+    if (sbp->psi_matrix  &&  sbp->psi_matrix->pssm) {
+        return sbp->psi_matrix->pssm;
+    }
+    return sbp->matrix;
+}
+
+CLookupTableCache::CLookupTableCache(const BLAST_SequenceBlk* queries,
+                                     const LookupTableOptions* lookup_options,
+                                     const QuerySetUpOptions* query_options,
+                                     const BlastSeqLoc* lookup_segments,
+                                     const BlastScoreBlk* sbp)
+{
+    const char* dir = getenv(kCacheDirEnv);
+    if ( !dir  ||  NStr::IsBlank(dir)  ||  !queries  ||  !lookup_options ) {
+        return;
+    }
+    // tables that depend on the database contents cannot be reused
+    if (lookup_options->db_filter) {
+        return;
+    }
+    switch (lookup_options->lut_type) {
+    case eNaLookupTable:
+    case eMBLookupTable:
+    case eSmallNaLookupTable:
+        break;
+    case eAaLookupTable:
+        if ( !s_GetAaLookupMatrix(sbp) ) {
+            return;
+        }
+        break;
+    default:
+        return;
+    }
+
+    CChecksum digest(CChecksum::eMD5);
+    digest.AddChars(kCacheMagic, sizeof(kCacheMagic));
+    s_AddToDigest(digest, kCacheVersion);
+    s_AddToDigest(digest, lookup_options->threshold);
+    s_AddToDigest(digest, (Int4)lookup_options->lut_type);
+    s_AddToDigest(digest, lookup_options->word_size);
+    s_AddToDigest(digest, lookup_options->mb_template_length);
+    s_AddToDigest(digest, lookup_options->mb_template_type);
+    s_AddToDigest(digest, (Int4)lookup_options->program_number);
+    s_AddToDigest(digest, lookup_options->stride);
+    s_AddToDigest(digest, s_MaskAtHash(query_options));
+    s_AddToDigest(digest, queries->length);
+    digest.AddChars(reinterpret_cast<const char*>(queries->sequence),
+                    queries->length);
+    for (const BlastSeqLoc* loc = lookup_segments;  loc;  loc = loc->next) {
+        s_AddToDigest(digest, loc->ssr->left);
+        s_AddToDigest(digest, loc->ssr->right);
+    }
+    if (lookup_options->lut_type == eAaLookupTable) {
+        const SBlastScoreMatrix* matrix = s_GetAaLookupMatrix(sbp);
+        s_AddToDigest(digest, (bool)(matrix != sbp->matrix));
+        s_AddToDigest(digest, (Uint8)matrix->ncols);
+        s_AddToDigest(digest, (Uint8)matrix->nrows);
+        for (size_t i = 0;  i < matrix->ncols;  i++) {
+            digest.AddChars(reinterpret_cast<const char*>(matrix->data[i]),
+                            matrix->nrows * sizeof(int));
+        }
+    }
+
+    m_Path = CDirEntry::MakePath(dir, digest.GetHexSum(), "blut");
+}
+
+/// Sequential reader of a memory mapped cache file
+class CLookupCacheReader
+{
+public:
+    CLookupCacheReader(const char* data, size_t size)
+        : m_Data(data), m_End(data + size)
+    {}
+
+    /// Read a scalar value
+    template <class T>
+    void Get(T& value)
+    {
+        x_Check(sizeof(T));
+        memcpy(&value, m_Data, sizeof(T));
+        m_Data += sizeof(T);
+    }
+
+    /// Read an array of the expected number of elements into malloc'ed
+    /// memory, owned by the caller (lookup table structures free their
+    /// arrays with sfree)
+    template <class T>
+    T* GetArray(Int8 expected)
+    {
+        Int8 num;
+        Get(num);
+        if (num != expected) {
+            NCBI_THROW(CException, eUnknown, "Lookup table size mismatch");
+        }
+        if (num == 0) {
+            return NULL;
+        }
+        x_Check(num * sizeof(T));
+        T* retval = (T*)malloc(num * sizeof(T));
+        if ( !retval ) {
+            NCBI_THROW(CException, eUnknown, "Out of memory");
+        }
+        memcpy(retval, m_Data, num * sizeof(T));
+        m_Data += num * sizeof(T);
+        return retval;
+    }
+
+    /// Read a list of sequence locations
+    BlastSeqLoc* GetLocations()
+    {
+        Int4 num;
+        BlastSeqLoc* head = NULL;
+        Get(num);
+        for (Int4 i = 0;  i < num;  i++) {
+            Int4 left, right;
+            Get(left);
+            Get(right);
+            BlastSeqLocNew(&head, left, right);
+        }
+        return head;
+    }
+
+private:
+    void x_Check(size_t length) const
+    {
+        if ((size_t)(m_End - m_Data) < length) {
+            NCBI_THROW(CException, eUnknown, "Truncated lookup table file");
+        }
+    }
+
+    const char* m_Data;
+    const char* m_End;
+};
+
+/// Sequential writer of a cache file
+class CLookupCacheWriter
+{
+public:
+    CLookupCacheWriter(CNcbiOstream& out) : m_Out(out) {}
+
+    template <class T>
+    void Put(const T& value)
+    {
+        m_Out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    void PutArray(const T* array, Int8 num)
+    {
+        if ( !array ) {
+            num = 0;
+        }
+        Put(num);
+        m_Out.write(reinterpret_cast<const char*>(array), num * sizeof(T));
+    }
+
+    void PutLocations(const BlastSeqLoc* locs)
+    {
+        Int4 num = 0;
+        for (const BlastSeqLoc* loc = locs;  loc;  loc = loc->next) {
+            num++;
+        }
+        Put(num);
+        for (const BlastSeqLoc* loc = locs;  loc;  loc = loc->next) {
+            Put(loc->ssr->left);
+            Put(loc->ssr->right);
+        }
+    }
+
+private:
+    CNcbiOstream& m_Out;
+};
+
+/// Number of elements in a megablast lookup table presence vector
+static Int8
+s_MBPVArraySize(const BlastMBLookupTable* lut)
+{
+    return lut->hashsize >> lut->pv_array_bts;
+}
+
+/// Number of elements in a blastn lookup table presence vector
+static Int8
+s_NaPVArraySize(const BlastNaLookupTable* lut)
+{
+    return (lut->backbone_size >> PV_ARRAY_BTS) + 1;
+}
+
+/// Number of elements in a protein lookup table presence vector
+static Int8
+s_AaPVArraySize(const BlastAaLookupTable* lut)
+{
+    return (lut->backbone_size >> PV_ARRAY_BTS) + 1;
+}
+
+static BlastMBLookupTable*
+s_ReadMBLookupTable(CLookupCacheReader& in, Int4 query_length)
+{
+    BlastMBLookupTable* lut =
+        (BlastMBLookupTable*)calloc(1, sizeof(BlastMBLookupTable));
+    try {
+        Int4 value;
+        in.Get(lut->word_length);
+        in.Get(lut->lut_word_length);
+        in.Get(lut->hashsize);
+        in.Get(lut->discontiguous);
+        in.Get(lut->template_length);
+        in.Get(value);
+        lut->template_type = (EDiscTemplateType)value;
+        in.Get(lut->two_templates);
+        in.Get(value);
+        lut->second_template_type = (EDiscTemplateType)value;
+        in.Get(lut->stride);
+        in.Get(lut->scan_step);
+        in.Get(lut->pv_array_bts);
+        in.Get(lut->longest_chain);
+        in.Get(lut->num_unique_pos_added);
+        in.Get(lut->num_words_added);
+        lut->hashtable = in.GetArray<Int4>(lut->hashsize);
+        lut->next_pos = in.GetArray<Int4>(query_length + 1);
+        if (lut->two_templates) {
+            lut->hashtable2 = in.GetArray<Int4>(lut->hashsize);
+            lut->next_pos2 = in.GetArray<Int4>(query_length + 1);
+        }
+        lut->pv_array = in.GetArray<PV_ARRAY_TYPE>(s_MBPVArraySize(lut));
+        lut->masked_locations = in.GetLocations();
+    }
+    catch (...) {
+        BlastMBLookupTableDestruct(lut);
+        throw;
+    }
+    return lut;
+}
+
+static void
+s_WriteMBLookupTable(CLookupCacheWriter& out, const BlastMBLookupTable* lut,
+                     Int4 query_length)
+{
+    out.Put(lut->word_length);
+    out.Put(lut->lut_word_length);
+    out.Put(lut->hashsize);
+    out.Put(lut->discontiguous);
+    out.Put(lut->template_length);
+    out.Put((Int4)lut->template_type);
+    out.Put(lut->two_templates);
+    out.Put((Int4)lut->second_template_type);
+    out.Put(lut->stride);
+    out.Put(lut->scan_step);
+    out.Put(lut->pv_array_bts);
+    out.Put(lut->longest_chain);
+    out.Put(lut->num_unique_pos_added);
+    out.Put(lut->num_words_added);
+    out.PutArray(lut->hashtable, lut->hashsize);
+    out.PutArray(lut->next_pos, query_length + 1);
+    if (lut->two_templates) {
+        out.PutArray(lut->hashtable2, lut->hashsize);
+        out.PutArray(lut->next_pos2, query_length + 1);
+    }
+    out.PutArray(lut->pv_array, s_MBPVArraySize(lut));
+    out.PutLocations(lut->masked_locations);
+}
+
+static BlastSmallNaLookupTable*
+s_ReadSmallNaLookupTable(CLookupCacheReader& in)
+{
+    BlastSmallNaLookupTable* lut =
+        (BlastSmallNaLookupTable*)calloc(1, sizeof(BlastSmallNaLookupTable));
+    try {
+        in.Get(lut->mask);
+        in.Get(lut->word_length);
+        in.Get(lut->lut_word_length);
+        in.Get(lut->scan_step);
+        in.Get(lut->backbone_size);
+        in.Get(lut->longest_chain);
+        in.Get(lut->overflow_size);
+        lut->final_backbone = in.GetArray<Int2>(lut->backbone_size);
+        lut->overflow = in.GetArray<Int2>(lut->overflow_size);
+        lut->masked_locations = in.GetLocations();
+    }
+    catch (...) {
+        BlastSmallNaLookupTableDestruct(lut);
+        throw;
+    }
+    return lut;
+}
+
+static void
+s_WriteSmallNaLookupTable(CLookupCacheWriter& out,
+                          const BlastSmallNaLookupTable* lut)
+{
+    out.Put(lut->mask);
+    out.Put(lut->word_length);
+    out.Put(lut->lut_word_length);
+    out.Put(lut->scan_step);
+    out.Put(lut->backbone_size);
+    out.Put(lut->longest_chain);
+    out.Put(lut->overflow_size);
+    out.PutArray(lut->final_backbone, lut->backbone_size);
+    out.PutArray(lut->overflow, lut->overflow_size);
+    out.PutLocations(lut->masked_locations);
+}
+
+static BlastNaLookupTable*
+s_ReadNaLookupTable(CLookupCacheReader& in)
+{
+    BlastNaLookupTable* lut =
+        (BlastNaLookupTable*)calloc(1, sizeof(BlastNaLookupTable));
+    try {
+        in.Get(lut->mask);
+        in.Get(lut->word_length);
+        in.Get(lut->lut_word_length);
+        in.Get(lut->scan_step);
+        in.Get(lut->backbone_size);
+        in.Get(lut->longest_chain);
+        in.Get(lut->overflow_size);
+        lut->thick_backbone =
+            in.GetArray<NaLookupBackboneCell>(lut->backbone_size);
+        lut->overflow = in.GetArray<Int4>(lut->overflow_size);
+        lut->pv = in.GetArray<PV_ARRAY_TYPE>(s_NaPVArraySize(lut));
+        lut->masked_locations = in.GetLocations();
+    }
+    catch (...) {
+        BlastNaLookupTableDestruct(lut);
+        throw;
+    }
+    return lut;
+}
+
+static void
+s_WriteNaLookupTable(CLookupCacheWriter& out, const BlastNaLookupTable* lut)
+{
+    out.Put(lut->mask);
+    out.Put(lut->word_length);
+    out.Put(lut->lut_word_length);
+    out.Put(lut->scan_step);
+    out.Put(lut->backbone_size);
+    out.Put(lut->longest_chain);
+    out.Put(lut->overflow_size);
+    out.PutArray(lut->thick_backbone, lut->backbone_size);
+    out.PutArray(lut->overflow, lut->overflow_size);
+    out.PutArray(lut->pv, s_NaPVArraySize(lut));
+    out.PutLocations(lut->masked_locations);
+}
+
+static BlastAaLookupTable*
+s_ReadAaLookupTable(CLookupCacheReader& in)
+{
+    BlastAaLookupTable* lut =
+        (BlastAaLookupTable*)calloc(1, sizeof(BlastAaLookupTable));
+    try {
+        Int4 value;
+        in.Get(lut->threshold);
+        in.Get(lut->mask);
+        in.Get(lut->charsize);
+        in.Get(lut->word_length);
+        in.Get(lut->lut_word_length);
+        in.Get(lut->alphabet_size);
+        in.Get(lut->backbone_size);
+        in.Get(lut->longest_chain);
+        in.Get(value);
+        lut->bone_type = (EBoneType)value;
+        in.Get(lut->overflow_size);
+        in.Get(lut->use_pssm);
+        in.Get(lut->neighbor_matches);
+        in.Get(lut->exact_matches);
+        if (lut->bone_type == eBackbone) {
+            lut->thick_backbone =
+                in.GetArray<AaLookupBackboneCell>(lut->backbone_size);
+            lut->overflow = in.GetArray<Int4>(lut->overflow_size);
+        }
+        else if (lut->bone_type == eSmallbone) {
+            lut->thick_backbone =
+                in.GetArray<AaLookupSmallboneCell>(lut->backbone_size);
+            lut->overflow = in.GetArray<Uint2>(lut->overflow_size);
+        }
+        else {
+            NCBI_THROW(CException, eUnknown, "Unknown lookup table bone type");
+        }
+        lut->pv = in.GetArray<PV_ARRAY_TYPE>(s_AaPVArraySize(lut));
+    }
+    catch (...) {
+        BlastAaLookupTableDestruct(lut);
+        throw;
+    }
+    return lut;
+}
+
+static void
+s_WriteAaLookupTable(CLookupCacheWriter& out, const BlastAaLookupTable* lut)
+{
+    out.Put(lut->threshold);
+    out.Put(lut->mask);
+    out.Put(lut->charsize);
+    out.Put(lut->word_length);
+    out.Put(lut->lut_word_length);
+    out.Put(lut->alphabet_size);
+    out.Put(lut->backbone_size);
+    out.Put(lut->longest_chain);
+    out.Put((Int4)lut->bone_type);
+    out.Put(lut->overflow_size);
+    out.Put(lut->use_pssm);
+    out.Put(lut->neighbor_matches);
+    out.Put(lut->exact_matches);
+    if (lut->bone_type == eBackbone) {
+        out.PutArray((const AaLookupBackboneCell*)lut->thick_backbone,
+                     lut->backbone_size);
+        out.PutArray((const Int4*)lut->overflow, lut->overflow_size);
+    }
+    else {
+        out.PutArray((const AaLookupSmallboneCell*)lut->thick_backbone,
+                     lut->backbone_size);
+        out.PutArray((const Uint2*)lut->overflow, lut->overflow_size);
+    }
+    out.PutArray(lut->pv, s_AaPVArraySize(lut));
+}
+
+LookupTableWrap*
+CLookupTableCache::Load(BLAST_SequenceBlk* queries) const
+{
+    if ( !IsEnabled()  ||  !CFile(m_Path).Exists() ) {
+        return NULL;
+    }
+
+    LookupTableWrap* retval = NULL;
+    try {
+        CMemoryFile mapped(m_Path);
+        CLookupCacheReader in((const char*)mapped.GetPtr(), mapped.GetSize());
+
+        SLookupCacheHeader header;
+        in.Get(header);
+        if (memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0  ||
+            header.version != kCacheVersion  ||
+            header.byte_order != kByteOrderMark  ||
+            header.query_length != queries->length) {
+            ERR_POST(Warning << "Ignoring incompatible lookup table cache file "
+                     << m_Path);
+            return NULL;
+        }
+
+        retval = (LookupTableWrap*)calloc(1, sizeof(LookupTableWrap));
+        retval->lut_type = (ELookupTableType)header.lut_type;
+        switch (retval->lut_type) {
+        case eMBLookupTable:
+            retval->lut = s_ReadMBLookupTable(in, queries->length);
+            break;
+        case eSmallNaLookupTable:
+            retval->lut = s_ReadSmallNaLookupTable(in);
+            // compressed query used by the small table's extension routines
+            BlastCompressBlastnaSequence(queries);
+            break;
+        case eNaLookupTable:
+            retval->lut = s_ReadNaLookupTable(in);
+            break;
+        case eAaLookupTable:
+            retval->lut = s_ReadAaLookupTable(in);
+            break;
+        default:
+            sfree(retval);
+            return NULL;
+        }
+    }
+    catch (CException& e) {
+        ERR_POST(Warning << "Cannot read lookup table cache file " << m_Path
+                 << ": " << e.GetMsg());
+        sfree(retval);
+        return NULL;
+    }
+    _TRACE("Loaded lookup table from " << m_Path);
+    return retval;
+}
+
+void
+CLookupTableCache::Save(const LookupTableWrap* lookup_wrap,
+                        const BLAST_SequenceBlk* queries) const
+{
+    if ( !IsEnabled()  ||  !lookup_wrap  ||  !lookup_wrap->lut ) {
+        return;
+    }
+    switch (lookup_wrap->lut_type) {
+    case eMBLookupTable:
+    case eSmallNaLookupTable:
+    case eNaLookupTable:
+    case eAaLookupTable:
+        break;
+    default:
+        return;
+    }
+
+    // write to a uniquely named file first, so that concurrent searches,
+    // in this or other processes, never see a partially written table
+    CDirEntry entry(m_Path);
+    string tmp_path = CFile::GetTmpNameEx(entry.GetDir(),
+                                          entry.GetName() + ".",
+                                          CFile::eTmpFileCreate);
+    if (tmp_path.empty()) {
+        ERR_POST(Warning << "Cannot create lookup table cache file in "
+                 << entry.GetDir());
+        return;
+    }
+    {
+        CNcbiOfstream ofs(tmp_path.c_str(), IOS_BASE::out | IOS_BASE::binary);
+        if ( !ofs ) {
+            ERR_POST(Warning << "Cannot create lookup table cache file "
+                     << tmp_path);
+            CFile(tmp_path).Remove();
+            return;
+        }
+        CLookupCacheWriter out(ofs);
+
+        SLookupCacheHeader header;
+        memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+        header.version = kCacheVersion;
+        header.byte_order = kByteOrderMark;
+        header.lut_type = lookup_wrap->lut_type;
+        header.query_length = queries->length;
+        out.Put(header);
+
+        switch (lookup_wrap->lut_type) {
+        case eMBLookupTable:
+            s_WriteMBLookupTable(out,
+                    (const BlastMBLookupTable*)lookup_wrap->lut,
+                    queries->length);
+            break;
+        case eSmallNaLookupTable:
+            s_WriteSmallNaLookupTable(out,
+                    (const BlastSmallNaLookupTable*)lookup_wrap->lut);
+            break;
+        case eAaLookupTable:
+            s_WriteAaLookupTable(out,
+                    (const BlastAaLookupTable*)lookup_wrap->lut);
+            break;
+        default:
+            s_WriteNaLookupTable(out,
+                    (const BlastNaLookupTable*)lookup_wrap->lut);
+            break;
+        }
+        ofs.flush();
+        if ( !ofs ) {
+            ERR_POST(Warning << "Cannot write lookup table cache file "
+                     << tmp_path);
+            CFile(tmp_path).Remove();
+            return;
+        }
+    }
+    if ( !CFile(tmp_path).Rename(m_Path, CFile::fRF_Overwrite) ) {
+        CFile(tmp_path).Remove();
+    }
+}
+
+END_SCOPE(blast)
+END_NCBI_SCOPE
+
+/* @} */
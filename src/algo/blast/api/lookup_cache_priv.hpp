@@ -0,0 +1,108 @@
+/* $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ */
+
+/** @file lookup_cache_priv.hpp
+ * On-disk cache of lookup tables, keyed by the query data and the options
+ * used to build them
+ */
+
+#ifndef ALGO_BLAST_API__LOOKUP_CACHE_PRIV_HPP
+#define ALGO_BLAST_API__LOOKUP_CACHE_PRIV_HPP
+
+#include <corelib/ncbistd.hpp>
+#include <algo/blast/core/lookup_wrap.h>
+#include <algo/blast/core/blast_options.h>
+#include <algo/blast/core/blast_stat.h>
+
+/** @addtogroup AlgoBlast
+ *
+ * @{
+ */
+
+BEGIN_NCBI_SCOPE
+BEGIN_SCOPE(blast)
+
+/// Persistent cache of lookup tables for repeated searches with the same
+/// queries. The cache is enabled by setting the BLAST_LOOKUP_CACHE_DIR
+/// environment variable to a writable directory. Each table is stored in
+/// its own file, named after a digest of the query sequence data, the
+/// lookup table segments and the options that affect the table.
+///
+/// Only the lookup table types that depend on nothing but the query and
+/// the score matrix are cached: the small, standard and megablast
+/// nucleotide tables without database word count filtering, and the
+/// standard protein table, whose digest also covers the score matrix or
+/// PSSM. The compressed protein table and the RPS and indexed tables are
+/// built as usual.
+class NCBI_XBLAST_EXPORT CLookupTableCache
+{
+public:
+    /// Set up the cache for a lookup table to be built.
+    /// @param queries Query sequence data [in]
+    /// @param lookup_options Lookup table options [in]
+    /// @param query_options Query set up options [in]
+    /// @param lookup_segments Query regions indexed in the table [in]
+    /// @param sbp Score block; its matrix or PSSM determines the neighboring
+    ///        words of protein tables [in]
+    CLookupTableCache(const BLAST_SequenceBlk* queries,
+                      const LookupTableOptions* lookup_options,
+                      const QuerySetUpOptions* query_options,
+                      const BlastSeqLoc* lookup_segments,
+                      const BlastScoreBlk* sbp);
+
+    /// Is the cache enabled and applicable to this lookup table?
+    bool IsEnabled() const { return !m_Path.empty(); }
+
+    /// Name of the cache file, empty if the cache is not enabled
+    const string& GetPath() const { return m_Path; }
+
+    /// Load a previously saved lookup table.
+    /// @param queries Query sequence data; for small nucleotide tables
+    ///        the compressed query is computed as on table construction
+    ///        [in|out]
+    /// @return Lookup table or NULL if it is not in the cache or the
+    ///         cached file is unusable
+    LookupTableWrap* Load(BLAST_SequenceBlk* queries) const;
+
+    /// Save a lookup table, if its type is supported. Errors are
+    /// reported as warnings only, as the cache is an optimization.
+    /// @param lookup_wrap Lookup table to save [in]
+    /// @param queries Query sequence data the table was built from [in]
+    void Save(const LookupTableWrap* lookup_wrap,
+              const BLAST_SequenceBlk* queries) const;
+
+private:
+    /// Name of the cache file for this lookup table, empty if disabled
+    string m_Path;
+};
+
+END_SCOPE(blast)
+END_NCBI_SCOPE
+
+/* @} */
+
+#endif /* ALGO_BLAST_API__LOOKUP_CACHE_PRIV_HPP */
@@ -42,6 +42,7 @@
 #include "blast_aux_priv.hpp"
 #include "blast_memento_priv.hpp"
 #include "blast_setup.hpp"
+#include "lookup_cache_priv.hpp"
 
 // SeqAlignVector building
 #include "blast_seqalign.hpp"
@@ -211,29 +212,37 @@ CSetupFactory::CreateLookupTable(CRef<ILocalQueryData> query_data,
 
     BlastSeqLoc * lookup_segments = lookup_segments_wrap->getLocs();
 
-    Int2 status = LookupTableWrapInit_MT(queries,
-                                         opts_memento->m_LutOpts,
-                                         opts_memento->m_QueryOpts,
-                                         lookup_segments,
-                                         score_blk,
-                                         &retval,
-                                         rps_info ? (*rps_info)() : 0,
-                                         &blast_msg,
-                                         seqsrc,
-                                         static_cast<Uint4>(num_threads));
-    if (status != 0) {
-         TSearchMessages search_messages;
-         Blast_Message2TSearchMessages(blast_msg.Get(), 
-                                           query_data->GetQueryInfo(), 
-                                           search_messages);
-         string msg;
-         if (search_messages.HasMessages()) {
-              msg = search_messages.ToString();
-         } else {
-              msg = "LookupTableWrapInit failed (" + 
-                   NStr::IntToString(status) + " error code)";
-         }
-         NCBI_THROW(CBlastException, eCoreBlastError, msg);
+    CLookupTableCache cache(queries, opts_memento->m_LutOpts,
+                            opts_memento->m_QueryOpts, lookup_segments,
+                            score_blk);
+    Int2 status = 0;
+
+    if ( !(retval = cache.Load(queries)) ) {
+        status = LookupTableWrapInit_MT(queries,
+                                        opts_memento->m_LutOpts,
+                                        opts_memento->m_QueryOpts,
+                                        lookup_segments,
+                                        score_blk,
+                                        &retval,
+                                        rps_info ? (*rps_info)() : 0,
+                                        &blast_msg,
+                                        seqsrc,
+                                        static_cast<Uint4>(num_threads));
+        if (status != 0) {
+             TSearchMessages search_messages;
+             Blast_Message2TSearchMessages(blast_msg.Get(), 
+                                               query_data->GetQueryInfo(), 
+                                               search_messages);
+             string msg;
+             if (search_messages.HasMessages()) {
+                  msg = search_messages.ToString();
+             } else {
+                  msg = "LookupTableWrapInit failed (" + 
+                       NStr::IntToString(status) + " error code)";
+             }
+             NCBI_THROW(CBlastException, eCoreBlastError, msg);
+        }
+        cache.Save(retval, queries);
     }
 
     // For PHI BLAST, save information about pattern occurrences in query in
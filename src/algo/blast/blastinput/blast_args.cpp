@@ -2598,25 +2598,26 @@ CFormattingArgs::SetArgumentDescriptions(CArgDescriptions& arg_desc)
     if(m_FormatFlags & eIsSAM) {
     	kOutputFormatDescription += ",\n 17 = Sequence Alignment/Map (SAM)";
     }
-    kOutputFormatDescription += ",\n 18 = Organism Report\n\n";
+    kOutputFormatDescription += ",\n 18 = Organism Report";
+    kOutputFormatDescription += ",\n 21 = Binary columnar tabular\n\n";
     if(m_FormatFlags & eIsSAM) {
     	kOutputFormatDescription +=
-                "Options 6, 7, 10 and 17 "
+                "Options 6, 7, 10, 17 and 21 "
     			"can be additionally configured to produce\n"
     		    "a custom format specified by space delimited format specifiers,\n"
                 "or in the case of options 6, 7, and 10, by a token specified\n"
                 "by the delim keyword. E.g.: \"17 delim=@ qacc sacc score\".\n"
                 "The delim keyword must appear after the numeric output format\n"
                 "specification.\n"
-    		    "The supported format specifiers for options 6, 7 and 10 are:\n";
+    		    "The supported format specifiers for options 6, 7, 10 and 21 are:\n";
     }
     else {
     	kOutputFormatDescription +=
-    			"Options 6, 7 and 10 "
+    			"Options 6, 7, 10 and 21 "
     			"can be additionally configured to produce\n"
     		    "a custom format specified by space delimited format specifiers,\n"
-                "or by a token specified by the delim keyword.\n"
-                " E.g.: \"10 delim=@ qacc sacc score\".\n"                
+                "or in the case of options 6, 7, and 10, by a token specified\n"
+                "by the delim keyword. E.g.: \"10 delim=@ qacc sacc score\".\n"
                 "The delim keyword must appear after the numeric output format\n"
                 "specification.\n"
     		    "The supported format specifiers are:\n";
@@ -2841,6 +2842,7 @@ CFormattingArgs::ParseFormattingString(const CArgs& args,
         if ( !(fmt_type == eTabular ||
                fmt_type == eTabularWithComments ||
                fmt_type == eCommaSeparatedValues ||
+               fmt_type == eBinaryTabular ||
                fmt_type == eSAM) ) {
                custom_fmt_spec.clear();
         }
@@ -2865,6 +2867,11 @@ CFormattingArgs::ExtractAlgorithmOptions(const CArgs& args,
         NCBI_THROW(CInputException, eInvalidInput,
                    "FASTA output format is only applicable to magicblast");
     }
+    if (m_OutputFormat == eBinaryTabular && !m_CustomDelim.empty()) {
+        NCBI_THROW(CInputException, eInvalidInput,
+                   "The delim keyword is not applicable to binary tabular "
+                   "output");
+    }
     s_ValidateCustomDelim(m_CustomOutputFormatSpec,m_CustomDelim);
     m_ShowGis = static_cast<bool>(args[kArgShowGIs]);
     if(m_IsIgBlast){
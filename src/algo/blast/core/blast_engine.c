@@ -78,6 +78,15 @@
 /** Converts nucleotide coordinates to protein */
 #define CONV_NUCL2PROT_COORDINATES(length) (length) / CODON_LENGTH
 
+/** Number of HSP lists a thread of a multi-threaded preliminary search
+    collects before it tries to write them to the shared HSP stream */
+#define PRELIM_HSP_BUFFER_SIZE 64
+
+/** Number of HSP lists a thread of a multi-threaded preliminary search
+    collects at most; while the stream is busy with another thread, the
+    lists are kept until the buffer is this full */
+#define PRELIM_HSP_BUFFER_MAX 256
+
 NCBI_XBLAST_EXPORT const int   kBlastMajorVersion = 2;
 NCBI_XBLAST_EXPORT const int   kBlastMinorVersion = 16;
 NCBI_XBLAST_EXPORT const int   kBlastPatchVersion = 1;
@@ -1315,6 +1324,66 @@ s_AdjustSubjectForSraSearch(BlastHSPList* hsp_list, Uint1 offset )
 }
 
 
+/** Raises the per-query score cutoffs to the given percentage of the lowest
+ * score kept in each full hit list of the HSP stream.
+ * @param hsp_stream Stream with the results found so far [in]
+ * @param hit_params Hit saving parameters with the cutoffs [in] [out]
+ */
+static void
+s_UpdateLowScore(const BlastHSPStream* hsp_stream,
+                 BlastHitSavingParameters* hit_params)
+{
+    int query_index;
+
+    for (query_index=0; query_index<hsp_stream->results->num_queries; query_index++)
+        if (hsp_stream->results->hitlist_array[query_index] && hsp_stream->results->hitlist_array[query_index]->heapified)
+            hit_params->low_score[query_index] =
+                MAX(hit_params->low_score[query_index],
+                    hit_params->options->low_score_perc*(hsp_stream->results->hitlist_array[query_index]->low_score));
+}
+
+/** Writes the HSP lists collected by a thread of the preliminary search to
+ * the shared HSP stream, empties the buffer and raises the per-query score
+ * cutoffs from the updated results. Lists that the stream did not take
+ * because of an error are freed.
+ * @param hsp_stream Stream to write to [in] [out]
+ * @param hit_params Hit saving parameters with the cutoffs [in] [out]
+ * @param buffer HSP lists collected by the thread [in] [out]
+ * @param count Number of lists in buffer, set to 0 unless the stream was
+ * busy [in] [out]
+ * @param wait If FALSE, nothing is done while another thread holds the
+ * stream's lock [in]
+ * @return Status of the batch write, kBlastHSPStream_Busy if nothing was
+ * written because the stream was busy
+ */
+static Int2
+s_FlushHSPListBuffer(BlastHSPStream* hsp_stream,
+                     BlastHitSavingParameters* hit_params,
+                     BlastHSPList** buffer, Int4* count, Boolean wait)
+{
+    Int4 index;
+    Int2 status;
+
+    if (wait) {
+        status = (Int2) BlastHSPStreamBatchWrite(hsp_stream, buffer, *count);
+    } else {
+        status = (Int2) BlastHSPStreamTryBatchWrite(hsp_stream, buffer,
+                                                    *count);
+        if (status == kBlastHSPStream_Busy)
+            return status;
+    }
+
+    for (index = 0; index < *count; index++) {
+        buffer[index] = Blast_HSPListFree(buffer[index]);
+    }
+    *count = 0;
+
+    if (status == 0 && hit_params->low_score)
+        s_UpdateLowScore(hsp_stream, hit_params);
+
+    return status;
+}
+
 static Int4 s_GetMinimumSubjSeqLen(LookupTableWrap* lookup_wrap)
 {
     Int4 word_length = 1;
@@ -1360,6 +1429,8 @@ BLAST_PreliminarySearchEngine(EBlastProgramType program_number,
     BlastScoreBlk* sbp = gap_align->sbp;
     BlastSeqSrcIterator* itr;
     const Boolean kNucleotide = Blast_ProgramIsNucleotide(program_number);
+    BlastHSPList** hsp_buffer = NULL;
+    Int4 hsp_buffer_count = 0;
 
     T_MB_IdbCheckOid check_index_oid =
         (T_MB_IdbCheckOid)lookup_wrap->check_index_oid;
@@ -1408,6 +1479,14 @@ BLAST_PreliminarySearchEngine(EBlastProgramType program_number,
 
     itr = BlastSeqSrcIteratorNewEx(MAX(BlastSeqSrcGetNumSeqs(seq_src)/100,1));
 
+    /* When several threads share the HSP stream, each of them collects its
+       HSP lists in a buffer of its own and writes them in batches, so that
+       the threads do not contend for the stream's lock on every subject. */
+    if (hsp_stream && hsp_stream->x_lock) {
+        hsp_buffer = (BlastHSPList**)
+            calloc(PRELIM_HSP_BUFFER_MAX, sizeof(BlastHSPList*));
+    }
+
     /* iterate over all subject sequences */
     while ( (seq_arg.oid = BlastSeqSrcIteratorNext(seq_src, itr))
            != BLAST_SEQSRC_EOF) {
@@ -1439,8 +1518,14 @@ BLAST_PreliminarySearchEngine(EBlastProgramType program_number,
            if ((status = BLAST_OneSubjectUpdateParameters(program_number,
                           seq_arg.seq->length, score_options, query_info,
                           sbp, hit_params, word_params,
-                          eff_len_params)) != 0)
+                          eff_len_params)) != 0) {
+              if (hsp_buffer) {
+                  s_FlushHSPListBuffer(hsp_stream, hit_params, hsp_buffer,
+                                       &hsp_buffer_count, TRUE);
+                  sfree(hsp_buffer);
+              }
               return status;
+          }
       }
 
       stat_length = seq_arg.seq->length;
@@ -1478,7 +1563,6 @@ BLAST_PreliminarySearchEngine(EBlastProgramType program_number,
       }
 
       if (hsp_list && hsp_list->hspcnt > 0) {
-         int query_index=0; /* Used to loop over queries below. */
          if (!gapped_calculation) {
         	 if(seq_arg.seq->bases_offset > 0)
         	 {
@@ -1505,6 +1589,12 @@ BLAST_PreliminarySearchEngine(EBlastProgramType program_number,
                   }
 
                   BlastSeqSrcReleaseSequence(seq_src, &seq_arg);
+                  if (hsp_buffer) {
+                      s_FlushHSPListBuffer(hsp_stream, hit_params,
+                                           hsp_buffer, &hsp_buffer_count,
+                                           TRUE);
+                      sfree(hsp_buffer);
+                  }
                   return status;
                }
                /* Relink HSPs if sum statistics is used, because scores might
@@ -1551,7 +1641,19 @@ BLAST_PreliminarySearchEngine(EBlastProgramType program_number,
          }
 
          /* Save the results. */
-         status = BlastHSPStreamWrite(hsp_stream, &hsp_list);
+         if (hsp_buffer) {
+             hsp_buffer[hsp_buffer_count++] = hsp_list;
+             hsp_list = NULL;
+             if (hsp_buffer_count >= PRELIM_HSP_BUFFER_SIZE) {
+                 status = s_FlushHSPListBuffer(hsp_stream, hit_params,
+                                  hsp_buffer, &hsp_buffer_count,
+                                  hsp_buffer_count == PRELIM_HSP_BUFFER_MAX);
+                 if (status == kBlastHSPStream_Busy)
+                     status = 0;
+             }
+         } else {
+             status = BlastHSPStreamWrite(hsp_stream, &hsp_list);
+         }
          if (status != 0)
             break;
 
@@ -1564,14 +1666,9 @@ BLAST_PreliminarySearchEngine(EBlastProgramType program_number,
                               hit_params, hsp_stream);
          }
 
-         if (hit_params->low_score)
-         {
- 	    for (query_index=0; query_index<hsp_stream->results->num_queries; query_index++)
-              if (hsp_stream->results->hitlist_array[query_index] && hsp_stream->results->hitlist_array[query_index]->heapified)
-                   hit_params->low_score[query_index] =
-			MAX(hit_params->low_score[query_index],
-                           hit_params->options->low_score_perc*(hsp_stream->results->hitlist_array[query_index]->low_score));
-         }
+         /* Buffered HSP lists raise the cutoffs when they are flushed */
+         if (hit_params->low_score && !hsp_buffer)
+             s_UpdateLowScore(hsp_stream, hit_params);
       }
 
       BlastSeqSrcReleaseSequence(seq_src, &seq_arg);
@@ -1591,6 +1688,18 @@ BLAST_PreliminarySearchEngine(EBlastProgramType program_number,
             lookup_wrap->end_search_indication))( last_vol_idx );
     }
 
+    /* Write the HSP lists this thread still holds; they are kept also if
+       the search was interrupted, as they would have been without the
+       buffer. */
+    if (hsp_buffer) {
+        Int2 flush_status = s_FlushHSPListBuffer(hsp_stream, hit_params,
+                                                 hsp_buffer,
+                                                 &hsp_buffer_count, TRUE);
+        if (status == 0)
+            status = flush_status;
+        sfree(hsp_buffer);
+    }
+
     hsp_list = Blast_HSPListFree(hsp_list);  /* in case we were interrupted */
     BlastSequenceBlkFree(seq_arg.seq);
     itr = BlastSeqSrcIteratorFree(itr);
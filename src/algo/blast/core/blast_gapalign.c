@@ -280,6 +280,7 @@ BLAST_GapAlignStructFree(BlastGapAlignStruct* gap_align)
       s_BlastGreedyAlignsFree(gap_align->greedy_align_mem);
    GapStateFree(gap_align->state_struct);
    sfree(gap_align->dp_mem);
+   BlastGapAlignSWProfilesFree(gap_align);
    JumperGapAlignFree(gap_align->jumper);
    ChainingStructFree(gap_align->chaining);
 
@@ -287,6 +288,20 @@ BLAST_GapAlignStructFree(BlastGapAlignStruct* gap_align)
    return NULL;
 }
 
+/* Documented in blast_gapalign.h */
+void
+BlastGapAlignSWProfilesFree(BlastGapAlignStruct* gap_align)
+{
+   Int4 i;
+
+   for (i = 0; i < gap_align->num_sw_profiles; i++)
+      sfree(gap_align->sw_profiles[i].scores);
+   sfree(gap_align->sw_profiles);
+   gap_align->num_sw_profiles = 0;
+   sfree(gap_align->sw_scratch);
+   gap_align->sw_scratch_alloc = 0;
+}
+
 /* Documented in blast_gapalign.h */
 Int2
 BLAST_GapAlignStructNew(const BlastScoringParameters* score_params,
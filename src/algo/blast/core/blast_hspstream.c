@@ -260,6 +260,7 @@ void BlastHSPStreamTBackClose(BlastHSPStream* hsp_stream,
 const int kBlastHSPStream_Error = -1;
 const int kBlastHSPStream_Success = 0;
 const int kBlastHSPStream_Eof = 1;
+const int kBlastHSPStream_Busy = 2;
 
 /** Read one HSP list from the results saved in an HSP list collector. Once an
  * HSP list is read from the stream, it relinquishes ownership and removes it
@@ -387,6 +388,81 @@ int BlastHSPStreamWrite(BlastHSPStream* hsp_stream, BlastHSPList** hsp_list)
    return kBlastHSPStream_Success;
 }
 
+/** Writes a batch of HSP lists; the caller holds the stream's lock, which
+ * is released on return.
+ * @param hsp_stream The BlastHSPStream object [in]
+ * @param hsp_lists Array of HSP lists [in] [out]
+ * @param num_hsplists Number of entries in hsp_lists [in]
+ * @return kBlastHSPStream_Success on success, otherwise kBlastHSPStream_Error
+ */
+static int
+s_BlastHSPStreamBatchWriteLocked(BlastHSPStream* hsp_stream,
+                                 BlastHSPList** hsp_lists, Int4 num_hsplists)
+{
+   Int2 status = 0;
+   Int4 index;
+
+   /* See BlastHSPStreamWrite */
+   if (hsp_stream->results_sorted) {
+      MT_LOCK_Do(hsp_stream->x_lock, eMT_Unlock);
+      return kBlastHSPStream_Error;
+   }
+
+   for (index = 0; index < num_hsplists; index++) {
+      if (!hsp_lists[index])
+         continue;
+
+      if (hsp_stream->writer) {
+         if (!(hsp_stream->writer_initialized)) {
+            (hsp_stream->writer->InitFnPtr)
+                     (hsp_stream->writer->data, hsp_stream->results);
+            hsp_stream->writer_initialized = TRUE;
+         }
+
+         status = (hsp_stream->writer->RunFnPtr)
+                  (hsp_stream->writer->data, hsp_lists[index]);
+      }
+
+      if (status != 0) {
+         MT_LOCK_Do(hsp_stream->x_lock, eMT_Unlock);
+         return kBlastHSPStream_Error;
+      }
+
+      hsp_stream->results_sorted = FALSE;
+      hsp_lists[index] = NULL;
+   }
+
+   MT_LOCK_Do(hsp_stream->x_lock, eMT_Unlock);
+
+   return kBlastHSPStream_Success;
+}
+
+int BlastHSPStreamBatchWrite(BlastHSPStream* hsp_stream,
+                             BlastHSPList** hsp_lists, Int4 num_hsplists)
+{
+   if (!hsp_stream)
+      return kBlastHSPStream_Error;
+
+   MT_LOCK_Do(hsp_stream->x_lock, eMT_Lock);
+
+   return s_BlastHSPStreamBatchWriteLocked(hsp_stream, hsp_lists,
+                                           num_hsplists);
+}
+
+int BlastHSPStreamTryBatchWrite(BlastHSPStream* hsp_stream,
+                                BlastHSPList** hsp_lists, Int4 num_hsplists)
+{
+   if (!hsp_stream)
+      return kBlastHSPStream_Error;
+
+   /* MT_LOCK_Do returns -1 when there is no lock to take */
+   if (MT_LOCK_Do(hsp_stream->x_lock, eMT_TryLock) == 0)
+      return kBlastHSPStream_Busy;
+
+   return s_BlastHSPStreamBatchWriteLocked(hsp_stream, hsp_lists,
+                                           num_hsplists);
+}
+
 /* #define _DEBUG_VERBOSE 1 */
 /** Merge two HSPStreams. The HSPs from the first stream are
  *  moved to the second stream.
@@ -2580,6 +2580,7 @@ static void s_BlastGapAlignStruct_Free(BlastGapAlignStruct* copy)
             sfree(copy->dp_mem);
         }
     }
+    BlastGapAlignSWProfilesFree(copy);
     {
         if (copy->sbp != NULL) {
             sfree(copy->sbp);
@@ -2613,6 +2614,13 @@ static BlastGapAlignStruct* s_BlastGapAlignStruct_Copy(
     // Any pointer members will be processed separately.
     memcpy(copy, orig, sizeof(BlastGapAlignStruct));
 
+    // Smith-Waterman profiles and scratch space are per thread and
+    // rebuilt on demand
+    copy->sw_profiles = NULL;
+    copy->num_sw_profiles = 0;
+    copy->sw_scratch = NULL;
+    copy->sw_scratch_alloc = 0;
+
     {
         GapStateArrayStruct* o = orig->state_struct;
         if (o != NULL) {
@@ -41,23 +41,215 @@
 /** swap two integers */
 #define SWAP_INT(A, B) {Int4 tmp = (A); (A) = (B); (B) = tmp; }
 
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+#  include <emmintrin.h>
+/** Compute protein Smith-Waterman scores with SSE2 */
+#  define SW_STRIPED 1
+/** Number of 16-bit scores held in one SSE2 register */
+#  define SW_LANES 8
+#endif
+
+#ifdef SW_STRIPED
+
+/** Return the query profile of one query context, building it if the
+ *  context has no profile yet or its profile was built from another
+ *  query or score matrix. The profile holds, for each letter of the
+ *  subject alphabet, the scores of that letter against the query, in
+ *  the striped order of Farrar (Bioinformatics 23:156-161, 2007).
+ * @param gap_align Structure holding the profiles [in] [out]
+ * @param context Query context [in]
+ * @param A The query sequence [in]
+ * @param a_size Length of the query sequence [in]
+ * @param matrix Score matrix, or PSSM for the query [in]
+ * @param is_pssm TRUE if matrix is position-specific [in]
+ * @return The profile, or NULL if out of memory
+ */
+static const BlastSWProfile* s_GetSWProfile(BlastGapAlignStruct *gap_align,
+                            Int4 context, const Uint1 *A, Int4 a_size,
+                            Int4 **matrix, Boolean is_pssm)
+{
+   Int4 i, j, k;
+   Int4 alphabet_size = gap_align->sbp->alphabet_size;
+   Int4 seg_len = (a_size + SW_LANES - 1) / SW_LANES;
+   BlastSWProfile *profile;
+
+   if (context >= gap_align->num_sw_profiles) {
+      Int4 num_profiles = MAX(context + 1, 2 * gap_align->num_sw_profiles);
+      BlastSWProfile *new_profiles = (BlastSWProfile *)realloc(
+                                     gap_align->sw_profiles,
+                                     num_profiles * sizeof(BlastSWProfile));
+      if (new_profiles == NULL)
+         return NULL;
+      memset(new_profiles + gap_align->num_sw_profiles, 0,
+             (num_profiles - gap_align->num_sw_profiles) *
+             sizeof(BlastSWProfile));
+      gap_align->sw_profiles = new_profiles;
+      gap_align->num_sw_profiles = num_profiles;
+   }
+
+   profile = gap_align->sw_profiles + context;
+   if (profile->scores != NULL && profile->query == A &&
+       profile->query_length == a_size && profile->matrix == matrix)
+      return profile;
+
+   sfree(profile->scores);
+   profile->scores = malloc(alphabet_size * seg_len * sizeof(__m128i));
+   if (profile->scores == NULL)
+      return NULL;
+   profile->query = A;
+   profile->query_length = a_size;
+   profile->matrix = matrix;
+   profile->max_score = 0;
+
+   /* padding positions past the end of A get the lowest possible
+      score so they never start an alignment */
+   for (k = 0; k < alphabet_size; k++) {
+      Int2 *row = (Int2 *)((__m128i *)profile->scores + k * seg_len);
+      for (i = 0; i < seg_len; i++) {
+         for (j = 0; j < SW_LANES; j++) {
+            Int4 pos = j * seg_len + i;
+            Int4 score = INT2_MIN;
+            if (pos < a_size) {
+               score = is_pssm ? matrix[pos][k] : matrix[A[pos]][k];
+               score = MAX(MIN(score, INT2_MAX), INT2_MIN);
+               profile->max_score = MAX(profile->max_score, score);
+            }
+            row[i * SW_LANES + j] = (Int2)score;
+         }
+      }
+   }
+   return profile;
+}
+
+/** Compute the score of the best local alignment between a query and
+ *  a protein sequence with the striped algorithm of Farrar. Scores are
+ *  kept in saturated 16-bit lanes, and the query is laid out across the
+ *  lanes so that the dependency along the query is only resolved by a
+ *  (rarely needed) correction loop.
+ * @param profile Query profile [in]
+ * @param B The subject sequence [in]
+ * @param b_size Length of the subject sequence [in]
+ * @param gap_open Gap open penalty [in]
+ * @param gap_extend Gap extension penalty [in]
+ * @param gap_align Auxiliary data for gapped alignment
+ *             (used for scratch space) [in] [out]
+ * @return The score of the best local alignment, or -1 if the score may
+ *         not fit into 16 bits, in which case it must be recomputed with
+ *         32-bit arithmetic
+ */
+static Int4 s_SmithWatermanScoreOnlyStriped(const BlastSWProfile *profile,
+                            const Uint1 *B, Int4 b_size,
+                            Int4 gap_open, Int4 gap_extend,
+                            BlastGapAlignStruct *gap_align)
+{
+   Int4 i, j, k;
+   Int4 seg_len = (profile->query_length + SW_LANES - 1) / SW_LANES;
+   Int4 scratch_size = 3 * seg_len * sizeof(__m128i);
+   Int4 final_best_score;
+   __m128i *h_load, *h_store, *e_scores, *tmp;
+   __m128i v_gap_open_extend = _mm_set1_epi16((Int2)(gap_open + gap_extend));
+   __m128i v_gap_extend = _mm_set1_epi16((Int2)gap_extend);
+   __m128i v_best = _mm_setzero_si128();
+
+   if (scratch_size > gap_align->sw_scratch_alloc) {
+      sfree(gap_align->sw_scratch);
+      gap_align->sw_scratch_alloc = 0;
+      gap_align->sw_scratch = malloc(scratch_size);
+      if (gap_align->sw_scratch == NULL)
+         return -1;
+      gap_align->sw_scratch_alloc = scratch_size;
+   }
+   h_load = (__m128i *)gap_align->sw_scratch;
+   h_store = h_load + seg_len;
+   e_scores = h_store + seg_len;
+   memset(h_load, 0, scratch_size);
+
+   for (j = 0; j < b_size; j++) {
+      const __m128i *letter_profile = (const __m128i *)profile->scores +
+                                      B[j] * seg_len;
+      __m128i v_f = _mm_setzero_si128();
+      __m128i v_h = _mm_slli_si128(h_store[seg_len - 1], 2);
+
+      tmp = h_load;
+      h_load = h_store;
+      h_store = tmp;
+
+      /* all scores are nonnegative, so the unsigned saturated
+         subtractions below implement the clamping to zero
+         of local alignment */
+      for (i = 0; i < seg_len; i++) {
+         __m128i v_e = _mm_loadu_si128(e_scores + i);
+
+         v_h = _mm_adds_epi16(v_h, _mm_loadu_si128(letter_profile + i));
+         v_h = _mm_max_epi16(v_h, v_e);
+         v_h = _mm_max_epi16(v_h, v_f);
+         v_best = _mm_max_epi16(v_best, v_h);
+         _mm_storeu_si128(h_store + i, v_h);
+
+         v_h = _mm_subs_epu16(v_h, v_gap_open_extend);
+         v_e = _mm_max_epi16(_mm_subs_epu16(v_e, v_gap_extend), v_h);
+         _mm_storeu_si128(e_scores + i, v_e);
+         v_f = _mm_max_epi16(_mm_subs_epu16(v_f, v_gap_extend), v_h);
+
+         v_h = _mm_loadu_si128(h_load + i);
+      }
+
+      /* propagate gaps in B across lane boundaries until they
+         can no longer improve any score */
+      for (k = 0; k < SW_LANES; k++) {
+         v_f = _mm_slli_si128(v_f, 2);
+         for (i = 0; i < seg_len; i++) {
+            v_h = _mm_max_epi16(_mm_loadu_si128(h_store + i), v_f);
+            v_best = _mm_max_epi16(v_best, v_h);
+            _mm_storeu_si128(h_store + i, v_h);
+
+            v_h = _mm_subs_epu16(v_h, v_gap_open_extend);
+            _mm_storeu_si128(e_scores + i,
+                      _mm_max_epi16(_mm_loadu_si128(e_scores + i), v_h));
+            v_f = _mm_subs_epu16(v_f, v_gap_extend);
+            if (!_mm_movemask_epi8(_mm_cmpgt_epi16(v_f, v_h)))
+               break;
+         }
+         if (i < seg_len)
+            break;
+      }
+   }
+
+   v_best = _mm_max_epi16(v_best, _mm_srli_si128(v_best, 8));
+   v_best = _mm_max_epi16(v_best, _mm_srli_si128(v_best, 4));
+   v_best = _mm_max_epi16(v_best, _mm_srli_si128(v_best, 2));
+   final_best_score = _mm_extract_epi16(v_best, 0);
+
+   /* no cell could have saturated unless the best score came
+      within one letter score of the 16-bit limit */
+   if (final_best_score > INT2_MAX - profile->max_score)
+      return -1;
+
+   return final_best_score;
+}
+
+#endif /* SW_STRIPED */
+
 /** Compute the score of the best local alignment between
  *  two protein sequences. When using Smith-Waterman, the vast
  *  majority of the runtime is tied up in this routine.
- * @param A The first sequence [in]
+ * @param A The first sequence (the query) [in]
  * @param a_size Length of the first sequence [in]
  * @param B The second sequence [in]
  * @param b_size Length of the second sequence [in]
  * @param gap_open Gap open penalty [in]
  * @param gap_extend Gap extension penalty [in]
  * @param gap_align Auxiliary data for gapped alignment 
- *             (used for score matrix info) [in]
+ *             (used for score matrix info and query profiles) [in]
+ * @param context Query context of A, which selects the query
+ *             profile [in]
  * @return The score of the best local alignment between A and B
  */
 static Int4 s_SmithWatermanScoreOnly(const Uint1 *A, Int4 a_size,
                             const Uint1 *B, Int4 b_size,
                             Int4 gap_open, Int4 gap_extend,
-                            BlastGapAlignStruct *gap_align)
+                            BlastGapAlignStruct *gap_align,
+                            Int4 context)
 {
    Int4 i, j;
    Int4 **matrix;
@@ -73,20 +265,34 @@ static Int4 s_SmithWatermanScoreOnly(const Uint1 *A, Int4 a_size,
    Int4 gap_open_extend = gap_open + gap_extend;
 
    /* choose the score matrix */
-   if (is_pssm) {
+   if (is_pssm)
       matrix = gap_align->sbp->psi_matrix->pssm->data;
-   }
-   else {
-      /* for square score matrices, assume the matrix
-         is symmetric. This means that A and B can be
-         switched without changing the score, and this
-         saves memory if one sequence is large but the
-         other is not */
-      if (a_size < b_size) {
-         SWAP_SEQS(A, B);
-         SWAP_INT(a_size, b_size);
-      }
+   else
       matrix = gap_align->sbp->matrix->data;
+
+#ifdef SW_STRIPED
+   /* the query profile is reused for every subject sequence */
+   if (a_size > 0 && b_size > 0 && gap_open_extend <= INT2_MAX) {
+      const BlastSWProfile *profile = s_GetSWProfile(gap_align, context,
+                                                A, a_size, matrix, is_pssm);
+      if (profile != NULL) {
+         final_best_score = s_SmithWatermanScoreOnlyStriped(profile,
+                                             B, b_size, gap_open,
+                                             gap_extend, gap_align);
+         if (final_best_score >= 0)
+            return final_best_score;
+      }
+   }
+#endif
+
+   /* for square score matrices, assume the matrix
+      is symmetric. This means that A and B can be
+      switched without changing the score, and this
+      saves memory if one sequence is large but the
+      other is not */
+   if (!is_pssm && a_size < b_size) {
+      SWAP_SEQS(A, B);
+      SWAP_INT(a_size, b_size);
    }
 
    /* allocate space for scratch structures */
@@ -700,7 +906,7 @@ Int2 BLAST_SmithWatermanGetGappedScore (EBlastProgramType program_number,
                               subject->length,
                               score_params->gap_open,
                               score_params->gap_extend,
-                              gap_align);
+                              gap_align, context);
       }
       else {
          score = s_NuclSmithWaterman(subject->sequence,
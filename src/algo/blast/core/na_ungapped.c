@@ -38,6 +38,27 @@
 #include "masksubj.inl"
 #include "jumper.h"
 
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 40  &&  defined(__GNUC__)
+#  include <tmmintrin.h>
+/** Use SSSE3 to compare 16 bases at a time in exact match extensions */
+#  define NA_SIMD_EXACT_MATCH 1
+#endif
+
+/** Number of bases compared at once by the vectorized exact match
+    extension */
+#define NA_SIMD_WIDTH 16
+
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 41  &&  defined(__GNUC__)
+#  include <smmintrin.h>
+/** Use SSE4.1 to score 64 bases at a time in approximate ungapped
+    extensions */
+#  define NA_SIMD_UNGAPPED 1
+#endif
+
+/** Number of packed subject bytes scored at once by the vectorized
+    approximate ungapped extension */
+#define NA_SIMD_UNGAPPED_BYTES 16
+
 /** Check to see if an index->q_pos pair exists in MB lookup table 
  * @param lookup_wrap The lookup table wrap structure [in]
  * @param index The index to the lookup table [in]
@@ -242,6 +263,210 @@ s_NuclUngappedExtendExact(BLAST_SequenceBlk * query,
     ungapped_data->score = score;
 }
 
+#ifdef NA_SIMD_UNGAPPED
+
+/** Pack 64 consecutive query bases into 16 bytes, four bases per byte, as
+ * the approximate ungapped extension does: byte i is
+ * (q[4i] << 6) | (q[4i+1] << 4) | (q[4i+2] << 2) | q[4i+3], truncated to
+ * 8 bits, also for query letters which are not ncbi2na.
+ * @param q Pointer to the first of the 64 query bases [in]
+ * @return The packed query bases
+ */
+static NCBI_INLINE __m128i
+s_PackQueryBytes16(const Uint1 * q)
+{
+    const __m128i kByte = _mm_set1_epi32(0xFF);
+    __m128i v[4], lanes[4];
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        v[i] = _mm_loadu_si128((const __m128i *) (q + 16 * i));
+    }
+
+    if (_mm_testz_si128(_mm_or_si128(_mm_or_si128(v[0], v[1]),
+                                     _mm_or_si128(v[2], v[3])),
+                        _mm_set1_epi8((char) ~NCBI2NA_MASK))) {
+        /* all ncbi2na, so the shifted bases do not overlap: 
+           q[0]*64 + q[1]*16 and q[2]*4 + q[3] in the 16-bit lanes, added
+           up in the 32-bit lanes */
+        const __m128i kWeights = _mm_set1_epi32(0x01041040);
+        const __m128i kOnes = _mm_set1_epi16(1);
+        for (i = 0; i < 4; i++) {
+            lanes[i] = _mm_madd_epi16(_mm_maddubs_epi16(v[i], kWeights),
+                                      kOnes);
+        }
+    } else {
+        /* the four bases of a byte are the four bytes of a 32-bit lane,
+           the first one least significant */
+        for (i = 0; i < 4; i++) {
+            __m128i b = _mm_slli_epi32(_mm_and_si128(v[i], kByte), 6);
+            b = _mm_or_si128(b, _mm_slli_epi32(
+                        _mm_and_si128(_mm_srli_epi32(v[i], 8), kByte), 4));
+            b = _mm_or_si128(b, _mm_slli_epi32(
+                        _mm_and_si128(_mm_srli_epi32(v[i], 16), kByte), 2));
+            b = _mm_or_si128(b, _mm_srli_epi32(v[i], 24));
+            lanes[i] = _mm_and_si128(b, kByte);
+        }
+    }
+    return _mm_packus_epi16(_mm_packus_epi32(lanes[0], lanes[1]),
+                            _mm_packus_epi32(lanes[2], lanes[3]));
+}
+
+/** Score 16 packed bytes of query bases XOR-ed with subject bases, one
+ * 32-bit score per byte. The scores of nucl_score_table depend only on the
+ * number of mismatching bases of a byte (see BLAST_InitialWordParametersNew),
+ * so they are looked up by that number in a table of bytes.
+ * @param diff Query bytes XOR-ed with subject bytes [in]
+ * @param score_lut Byte k is the score of a byte with k mismatches [in]
+ * @param scores The scores of the 16 bytes, 4 per vector [out]
+ */
+static NCBI_INLINE void
+s_NuclScoreBytes16(__m128i diff, __m128i score_lut, __m128i scores[4])
+{
+    const __m128i kLowNibble = _mm_set1_epi8(0x0F);
+    /* number of non-zero 2-bit groups of a nibble, for the bits 0 and 2
+       set by the OR below */
+    const __m128i kCountLut = _mm_setr_epi8(0, 1, 0, 1, 1, 2, 1, 2,
+                                            0, 1, 0, 1, 1, 2, 1, 2);
+    __m128i groups = _mm_and_si128(
+        _mm_or_si128(diff, _mm_srli_epi16(diff, 1)), _mm_set1_epi8(0x55));
+    __m128i count = _mm_add_epi8(
+        _mm_shuffle_epi8(kCountLut, _mm_and_si128(groups, kLowNibble)),
+        _mm_shuffle_epi8(kCountLut,
+                         _mm_and_si128(_mm_srli_epi16(groups, 4), kLowNibble)));
+    __m128i bytes = _mm_shuffle_epi8(score_lut, count);
+
+    scores[0] = _mm_cvtepi8_epi32(bytes);
+    scores[1] = _mm_cvtepi8_epi32(_mm_srli_si128(bytes, 4));
+    scores[2] = _mm_cvtepi8_epi32(_mm_srli_si128(bytes, 8));
+    scores[3] = _mm_cvtepi8_epi32(_mm_srli_si128(bytes, 12));
+}
+
+/** Build the table of bytes used by s_NuclScoreBytes16.
+ * @param score_table Scores of all combinations of 4 matches and
+ *                    mismatches [in]
+ * @param score_lut The table [out]
+ * @return FALSE if the scores do not fit in a byte
+ */
+static NCBI_INLINE Boolean
+s_NuclScoreLut(const Int4 * score_table, __m128i * score_lut)
+{
+    /* bytes with 0, 1, 2, 3 and 4 mismatching bases */
+    static const Uint1 kMismatches[5] = { 0x00, 0x01, 0x05, 0x15, 0x55 };
+    Int1 lut[16];
+    Int4 k;
+
+    memset(lut, 0, sizeof(lut));
+    for (k = 0; k < 5; k++) {
+        Int4 score = score_table[kMismatches[k]];
+        if (score < -128 || score > 127)
+            return FALSE;
+        lut[k] = (Int1) score;
+    }
+    *score_lut = _mm_loadu_si128((const __m128i *) lut);
+    return TRUE;
+}
+
+/** Run the X-drop recurrence of s_NuclUngappedExtend over
+ * NA_SIMD_UNGAPPED_BYTES steps at once. With P(k) the running sum after
+ * step k and M(k) the maximum of 0 and P(0..k), the scalar loop raises the
+ * score at the steps where P(k) exceeds M(k-1), and stops at the first step
+ * where P(k) - M(k) < X; both are found from vector prefix sums and prefix
+ * maxima.
+ * @param scores Scores of the next steps, 4 per vector [in]
+ * @param X The drop-off parameter, negative [in]
+ * @param sum Running sum since the last raise of the score [in] [out]
+ * @param score The score of the extension [in] [out]
+ * @param best Index of the last step which raised the score, or -1 [out]
+ * @return TRUE if the extension stops within these steps
+ */
+static NCBI_INLINE Boolean
+s_NuclUngappedExtendBlock(const __m128i scores[4], Int4 X, Int4 * sum,
+                          Int4 * score, Int4 * best)
+{
+    const __m128i kX = _mm_set1_epi32(X);
+    __m128i p[4], m[4];
+    __m128i carry = _mm_set1_epi32(*sum);
+    __m128i max_carry = _mm_setzero_si128();
+    int raised = 0, dropped = 0;
+    Int4 i, last;
+
+    /* prefix sums and maxima within each vector; they do not depend on
+       each other. The zeros shifted into the maxima stand for the sum
+       before the vector, which never exceeds the maximum so far. */
+    for (i = 0; i < 4; i++) {
+        p[i] = _mm_add_epi32(scores[i], _mm_slli_si128(scores[i], 4));
+        p[i] = _mm_add_epi32(p[i], _mm_slli_si128(p[i], 8));
+        m[i] = _mm_max_epi32(p[i], _mm_slli_si128(p[i], 4));
+        m[i] = _mm_max_epi32(m[i], _mm_slli_si128(m[i], 8));
+    }
+
+    for (i = 0; i < 4; i++) {
+        __m128i m_prev;
+
+        p[i] = _mm_add_epi32(p[i], carry);
+        m[i] = _mm_max_epi32(_mm_add_epi32(m[i], carry), max_carry);
+        m_prev = _mm_max_epi32(_mm_slli_si128(m[i], 4), max_carry);
+
+        raised |= _mm_movemask_ps(_mm_castsi128_ps(
+                      _mm_cmpgt_epi32(p[i], m_prev))) << (4 * i);
+        dropped |= _mm_movemask_ps(_mm_castsi128_ps(
+                      _mm_cmplt_epi32(_mm_sub_epi32(p[i], m[i]), kX)))
+                   << (4 * i);
+        carry = _mm_shuffle_epi32(p[i], 0xFF);
+        max_carry = _mm_shuffle_epi32(m[i], 0xFF);
+    }
+
+    if (dropped) {
+        Int4 p_last[4], m_last[4];
+
+        last = __builtin_ctz(dropped);
+        raised &= (1 << last) - 1;
+        _mm_storeu_si128((__m128i *) p_last, p[last / 4]);
+        _mm_storeu_si128((__m128i *) m_last, m[last / 4]);
+        *score += m_last[last % 4];
+        *sum = p_last[last % 4] - m_last[last % 4];
+    } else {
+        *score += _mm_cvtsi128_si32(max_carry);
+        *sum = _mm_cvtsi128_si32(carry) - _mm_cvtsi128_si32(max_carry);
+    }
+    *best = raised ? 31 - __builtin_clz(raised) : -1;
+    return dropped != 0;
+}
+
+/** Extend across 16 bytes given the XOR of query and subject; a block
+ * without mismatches cannot trigger the dropoff and is scored directly.
+ * @param diff Query bytes XOR subject bytes, in the order of extension [in]
+ * @param score_lut Table built by s_NuclScoreLut [in]
+ * @param block_score Score of 16 matching bytes [in]
+ * @param X The drop-off parameter [in]
+ * @param sum Running sum since the last raise of the score [in] [out]
+ * @param score The score of the extension [in] [out]
+ * @param best Index of the last byte which raised the score, or -1 [out]
+ * @return TRUE if the extension dropped off
+ */
+static NCBI_INLINE Boolean
+s_NuclUngappedExtend16(__m128i diff, __m128i score_lut, Int4 block_score,
+                       Int4 X, Int4 * sum, Int4 * score, Int4 * best)
+{
+    __m128i scores[4];
+
+    if (_mm_testz_si128(diff, diff)) {
+        *sum += block_score;
+        *best = -1;
+        if (*sum > 0) {
+            *score += *sum;
+            *sum = 0;
+            *best = NA_SIMD_UNGAPPED_BYTES - 1;
+        }
+        return FALSE;
+    }
+    s_NuclScoreBytes16(diff, score_lut, scores);
+    return s_NuclUngappedExtendBlock(scores, X, sum, score, best);
+}
+
+#endif /* NA_SIMD_UNGAPPED */
+
 /** Perform ungapped extension of a word hit. Use an approximate method
  * and revert to rigorous ungapped alignment if the approximate score
  * is high enough
@@ -273,6 +498,14 @@ s_NuclUngappedExtend(BLAST_SequenceBlk * query,
     Int4 i, len;
     Uint1 *new_q;
     Int4 q_ext, s_ext;
+#ifdef NA_SIMD_UNGAPPED
+    const __m128i kReverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                           7, 6, 5, 4, 3, 2, 1, 0);
+    __m128i score_lut;
+    Boolean use_simd = s_NuclScoreLut(score_table, &score_lut);
+    Int4 block_score = NA_SIMD_UNGAPPED_BYTES * score_table[0];
+    Int4 best;
+#endif
 
     /* The left extension begins behind (q_ext,s_ext); this is the first
        4-base boundary after s_off. */
@@ -288,8 +521,31 @@ s_NuclUngappedExtend(BLAST_SequenceBlk * query,
     score = 0;
     sum = 0;
     new_q = q;
+    i = 0;
+
+#ifdef NA_SIMD_UNGAPPED
+    /* 64 bases at a time; the bytes of a block are scored backwards */
+    for (; use_simd  &&  i + NA_SIMD_UNGAPPED_BYTES <= len;
+         s -= NA_SIMD_UNGAPPED_BYTES, q -= 4 * NA_SIMD_UNGAPPED_BYTES,
+         i += NA_SIMD_UNGAPPED_BYTES) {
+        Boolean dropped;
+        __m128i diff = _mm_xor_si128(
+            s_PackQueryBytes16(q - 4 * NA_SIMD_UNGAPPED_BYTES),
+            _mm_loadu_si128((const __m128i *) (s - NA_SIMD_UNGAPPED_BYTES)));
+        dropped = s_NuclUngappedExtend16(_mm_shuffle_epi8(diff, kReverse),
+                                         score_lut, block_score, X,
+                                         &sum, &score, &best);
+        if (best >= 0) {
+            new_q = q - 4 * (best + 1);
+        }
+        if (dropped) {
+            len = i;    /* skip the scalar loop below */
+            break;
+        }
+    }
+#endif
 
-    for (i = 0; i < len; s--, q -= 4, i++) {
+    for (; i < len; s--, q -= 4, i++) {
         Uint1 s_byte = s[-1];
         Uint1 q_byte = (q[-4] << 6) | (q[-3] << 4) | (q[-2] << 2) | q[-1];
 
@@ -318,8 +574,27 @@ s_NuclUngappedExtend(BLAST_SequenceBlk * query,
         COMPRESSION_RATIO;
     sum = 0;
     new_q = q;
+    i = 0;
+
+#ifdef NA_SIMD_UNGAPPED
+    for (; use_simd  &&  i + NA_SIMD_UNGAPPED_BYTES <= len;
+         s += NA_SIMD_UNGAPPED_BYTES, q += 4 * NA_SIMD_UNGAPPED_BYTES,
+         i += NA_SIMD_UNGAPPED_BYTES) {
+        Boolean dropped = s_NuclUngappedExtend16(
+            _mm_xor_si128(s_PackQueryBytes16(q),
+                          _mm_loadu_si128((const __m128i *) s)),
+            score_lut, block_score, X, &sum, &score, &best);
+        if (best >= 0) {
+            new_q = q + 4 * best + 3;
+        }
+        if (dropped) {
+            len = i;    /* skip the scalar loop below */
+            break;
+        }
+    }
+#endif
 
-    for (i = 0; i < len; s++, q += 4, i++) {
+    for (; i < len; s++, q += 4, i++) {
         Uint1 s_byte = s[0];
         Uint1 q_byte = (q[0] << 6) | (q[1] << 4) | (q[2] << 2) | q[3];
 
@@ -1029,6 +1304,139 @@ s_BlastNaExtendDirect(const BlastOffsetPair * offset_pairs, Int4 num_hits,
     return hits_extended;
 }
 
+#ifdef NA_SIMD_EXACT_MATCH
+
+/** Pack 16 consecutive query bases (one base per byte) into a 32-bit
+ * word, two bits per base, with the first base in the most significant
+ * bits. This is the same layout as 4 bytes of ncbi2na subject data.
+ * @param q Pointer to the first of the 16 query bases [in]
+ * @param invalid Bit i is set if query base i is not an ncbi2na letter
+ *                and so cannot match any subject base [out]
+ * @return The packed query bases
+ */
+static NCBI_INLINE Uint4
+s_PackQueryBases16(const Uint1 * q, Uint4 * invalid)
+{
+    const __m128i kMask = _mm_set1_epi8(NCBI2NA_MASK);
+    __m128i bases = _mm_loadu_si128((const __m128i *) q);
+    __m128i packed;
+
+    *invalid = ~(Uint4)_mm_movemask_epi8(
+                   _mm_cmpeq_epi8(_mm_max_epu8(bases, kMask), kMask)) & 0xFFFF;
+
+    /* q[0]*4 + q[1] in each 16-bit lane, then 
+       (q[0]*4 + q[1])*16 + q[2]*4 + q[3] in each 32-bit lane */
+    packed = _mm_maddubs_epi16(_mm_and_si128(bases, kMask),
+                               _mm_set1_epi16(0x0104));
+    packed = _mm_madd_epi16(packed, _mm_set1_epi32(0x00010010));
+
+    /* gather the low byte of each 32-bit lane, first lane last so that
+       the first base lands in the most significant bits */
+    packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(12, 8, 4, 0,
+                                                    -1, -1, -1, -1,
+                                                    -1, -1, -1, -1,
+                                                    -1, -1, -1, -1));
+    return (Uint4)_mm_cvtsi128_si32(packed);
+}
+
+/** Retrieve 16 consecutive bases of ncbi2na packed subject data, starting
+ * at an arbitrary offset, in the layout produced by s_PackQueryBases16.
+ * Only the bytes containing the 16 bases are accessed.
+ * @param subject The packed subject sequence [in]
+ * @param s_off Offset of the first base [in]
+ * @return The subject bases
+ */
+static NCBI_INLINE Uint4
+s_GetSubjectBases16(const Uint1 * subject, Int4 s_off)
+{
+    const Uint1 *s = subject + s_off / COMPRESSION_RATIO;
+    Int4 shift = 2 * (s_off % COMPRESSION_RATIO);
+    Uint4 word = (Uint4)s[0] << 24 | (Uint4)s[1] << 16 |
+                 (Uint4)s[2] << 8 | (Uint4)s[3];
+
+    if (shift)
+        word = word << shift | s[4] >> (8 - shift);
+    return word;
+}
+
+#endif /* NA_SIMD_EXACT_MATCH */
+
+/** Count the exact matches between query and subject bases, moving
+ * forward from the given offsets.
+ * @param q Pointer to the first query base to compare [in]
+ * @param subject The packed subject sequence [in]
+ * @param s_off Offset of the first subject base to compare [in]
+ * @param max_len Maximum number of bases to compare [in]
+ * @return Number of matching bases before the first mismatch
+ */
+static NCBI_INLINE Int4
+s_NaExactMatchRight(const Uint1 * q, const Uint1 * subject,
+                    Int4 s_off, Int4 max_len)
+{
+    Int4 len = 0;
+
+#ifdef NA_SIMD_EXACT_MATCH
+    for (; len + NA_SIMD_WIDTH <= max_len; len += NA_SIMD_WIDTH) {
+        Uint4 invalid;
+        Uint4 diff = s_PackQueryBases16(q + len, &invalid) ^
+                     s_GetSubjectBases16(subject, s_off + len);
+
+        if (diff | invalid) {
+            Int4 matches = diff ? __builtin_clz(diff) / 2 : NA_SIMD_WIDTH;
+            if (invalid)
+                matches = MIN(matches, __builtin_ctz(invalid));
+            return len + matches;
+        }
+    }
+#endif
+
+    for (; len < max_len; ++len) {
+        Int4 pos = s_off + len;
+        if (((Uint1) (subject[pos / COMPRESSION_RATIO] << 
+                      (2 * (pos % COMPRESSION_RATIO))) >> 6) != q[len])
+            break;
+    }
+    return len;
+}
+
+/** Count the exact matches between query and subject bases, moving
+ * backward from the given offsets.
+ * @param q Pointer one past the first query base to compare [in]
+ * @param subject The packed subject sequence [in]
+ * @param s_off Offset one past the first subject base to compare [in]
+ * @param max_len Maximum number of bases to compare [in]
+ * @return Number of matching bases before the first mismatch
+ */
+static NCBI_INLINE Int4
+s_NaExactMatchLeft(const Uint1 * q, const Uint1 * subject,
+                   Int4 s_off, Int4 max_len)
+{
+    Int4 len = 0;
+
+#ifdef NA_SIMD_EXACT_MATCH
+    for (; len + NA_SIMD_WIDTH <= max_len; len += NA_SIMD_WIDTH) {
+        Uint4 invalid;
+        Uint4 diff = s_PackQueryBases16(q - len - NA_SIMD_WIDTH, &invalid) ^
+                     s_GetSubjectBases16(subject, s_off - len - NA_SIMD_WIDTH);
+
+        if (diff | invalid) {
+            Int4 matches = diff ? __builtin_ctz(diff) / 2 : NA_SIMD_WIDTH;
+            if (invalid)
+                matches = MIN(matches, __builtin_clz(invalid) - NA_SIMD_WIDTH);
+            return len + matches;
+        }
+    }
+#endif
+
+    for (; len < max_len; ++len) {
+        Int4 pos = s_off - len - 1;
+        if (((Uint1) (subject[pos / COMPRESSION_RATIO] << 
+                      (2 * (pos % COMPRESSION_RATIO))) >> 6) != q[-len - 1])
+            break;
+    }
+    return len;
+}
+
 /** Perform exact match extensions on the hits retrieved from
  * blastn/megablast lookup tables, assuming an arbitrary number of bases 
  * in a lookup and arbitrary start offset of each hit. Also 
@@ -1098,42 +1506,23 @@ s_BlastNaExtend(const BlastOffsetPair * offset_pairs, Int4 num_hits,
            faster. Point to the first base of the lookup table hit and
            work backwards */
 
-        Int4 ext_left = 0;
-        Int4 s_off = s_offset;
-        Uint1 *q = query->sequence + q_offset;
-        Uint1 *s = subject->sequence + s_off / COMPRESSION_RATIO;
-
-        for (; ext_left < MIN(ext_to, s_offset); ++ext_left) {
-            s_off--;
-            q--;
-            if (s_off % COMPRESSION_RATIO == 3)
-                s--;
-            if (((Uint1) (*s << (2 * (s_off % COMPRESSION_RATIO))) >> 6)
-                != *q)
-                break;
-        }
+        Int4 ext_left = s_NaExactMatchLeft(query->sequence + q_offset,
+                                           subject->sequence, s_offset,
+                                           MIN(ext_to, s_offset));
 
         /* do the right extension if the left extension did not find all
            the bases required. Begin at the first base beyond the lookup
            table hit and move forwards */
 
         if (ext_left < ext_to) {
-            Int4 ext_right = 0;
-            s_off = s_offset + lut_word_length;
+            Int4 ext_right;
+            Int4 s_off = s_offset + lut_word_length;
             if (s_off + ext_to - ext_left > s_range) 
                 continue;
-            q = query->sequence + q_offset + lut_word_length;
-            s = subject->sequence + s_off / COMPRESSION_RATIO;
-
-            for (; ext_right < ext_to - ext_left; ++ext_right) {
-                if (((Uint1) (*s << (2 * (s_off % COMPRESSION_RATIO))) >>
-                     6) != *q)
-                    break;
-                s_off++;
-                q++;
-                if (s_off % COMPRESSION_RATIO == 0)
-                    s++;
-            }
+            ext_right = s_NaExactMatchRight(query->sequence + q_offset + 
+                                            lut_word_length,
+                                            subject->sequence, s_off,
+                                            ext_to - ext_left);
 
             /* check if enough extra matches were found */
             if (ext_left + ext_right < ext_to)
@@ -1788,6 +2177,23 @@ Int2 MB_IndexedWordFinder(
     return 0;
 }
 
+/** Determine whether exact match extensions of the given length should
+ * use s_BlastNaExtend even when the byte-aligned routine is applicable.
+ * This is the case when the extension is long enough to be examined with
+ * the vectorized comparison.
+ * @param ext_to Number of bases beyond the lookup table word [in]
+ * @return TRUE if the vectorized routine is preferred
+ */
+static Boolean
+s_PreferVectorExtend(Int4 ext_to)
+{
+#ifdef NA_SIMD_EXACT_MATCH
+    return ext_to >= NA_SIMD_WIDTH;
+#else
+    return FALSE;
+#endif
+}
+
 void BlastChooseNaExtend(LookupTableWrap * lookup_wrap)
 {
     if (lookup_wrap->lut_type == eMBLookupTable) {
@@ -1798,7 +2204,9 @@ void BlastChooseNaExtend(LookupTableWrap * lookup_wrap)
         if (lut->lut_word_length == lut->word_length || lut->discontiguous)
             lut->extend_callback = (void *)s_BlastNaExtendDirect;
         else if (lut->lut_word_length % COMPRESSION_RATIO == 0 &&
-                 lut->scan_step % COMPRESSION_RATIO == 0)
+                 lut->scan_step % COMPRESSION_RATIO == 0 &&
+                 !s_PreferVectorExtend(lut->word_length -
+                                       lut->lut_word_length))
             lut->extend_callback = (void *)s_BlastNaExtendAligned;
         else
             lut->extend_callback = (void *)s_BlastNaExtend;
@@ -1828,7 +2236,9 @@ void BlastChooseNaExtend(LookupTableWrap * lookup_wrap)
         if (lut->lut_word_length == lut->word_length)
             lut->extend_callback = (void *)s_BlastNaExtendDirect;
         else if (lut->lut_word_length % COMPRESSION_RATIO == 0 &&
-                 lut->scan_step % COMPRESSION_RATIO == 0)
+                 lut->scan_step % COMPRESSION_RATIO == 0 &&
+                 !s_PreferVectorExtend(lut->word_length -
+                                       lut->lut_word_length))
             lut->extend_callback = (void *)s_BlastNaExtendAligned;
         else
             lut->extend_callback = (void *)s_BlastNaExtend;
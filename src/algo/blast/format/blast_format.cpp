@@ -197,6 +197,9 @@ CBlastFormat::CBlastFormat(const blast::CBlastOptions& options,
     if (m_FormatType == CFormattingArgs::eSAM) {
     	x_InitSAMFormatter();
     }
+    if (m_FormatType == CFormattingArgs::eBinaryTabular) {
+        m_BinaryTabularWriter.Reset(new CBlastBinaryTabularWriter(m_Outfile));
+    }
 
     CNcbiApplication* app = CNcbiApplication::Instance();
     if (app) {
@@ -306,6 +309,9 @@ CBlastFormat::CBlastFormat(const blast::CBlastOptions& opts,
     if (m_FormatType == CFormattingArgs::eSAM) {
     	x_InitSAMFormatter();
     }    
+    if (m_FormatType == CFormattingArgs::eBinaryTabular) {
+        m_BinaryTabularWriter.Reset(new CBlastBinaryTabularWriter(m_Outfile));
+    }
     CNcbiApplication* app = CNcbiApplication::Instance();
     if (app) {
         const CNcbiRegistry& registry = app->GetConfig();
@@ -761,12 +767,23 @@ CBlastFormat::x_PrintTabularReport(const blast::CSearchResults& results,
     // (plus a header)
     if (m_FormatType == CFormattingArgs::eTabular ||
         m_FormatType == CFormattingArgs::eTabularWithComments ||
-        m_FormatType == CFormattingArgs::eCommaSeparatedValues) {
+        m_FormatType == CFormattingArgs::eCommaSeparatedValues ||
+        m_FormatType == CFormattingArgs::eBinaryTabular) {
         const CBlastTabularInfo::EFieldDelimiter kDelim = 
             (m_FormatType == CFormattingArgs::eCommaSeparatedValues
              ? CBlastTabularInfo::eComma : CBlastTabularInfo::eTab);
         
-        CBlastTabularInfo tabinfo(m_Outfile, m_CustomOutputFormatSpec, kDelim);
+        CRef<CBlastTabularInfo> tabinfo_ref;
+        if (m_FormatType == CFormattingArgs::eBinaryTabular) {
+            tabinfo_ref.Reset(new CBlastBinaryTabularInfo(
+                              *m_BinaryTabularWriter,
+                              m_CustomOutputFormatSpec));
+        } else {
+            tabinfo_ref.Reset(new CBlastTabularInfo(m_Outfile,
+                                                    m_CustomOutputFormatSpec,
+                                                    kDelim));
+        }
+        CBlastTabularInfo& tabinfo = *tabinfo_ref;
         if(!m_CustomDelim.empty()) {
             tabinfo.SetCustomDelim(m_CustomDelim);
         }
@@ -1440,7 +1457,8 @@ CBlastFormat::PrintOneResultSet(const blast::CSearchResults& results,
 
     if (m_FormatType == CFormattingArgs::eTabular ||
         m_FormatType == CFormattingArgs::eTabularWithComments ||
-        m_FormatType == CFormattingArgs::eCommaSeparatedValues) {
+        m_FormatType == CFormattingArgs::eCommaSeparatedValues ||
+        m_FormatType == CFormattingArgs::eBinaryTabular) {
         x_PrintTabularReport(results, itr_num);
         return;
     }
@@ -2034,7 +2052,8 @@ CBlastFormat::PrintPhiResult(const blast::CSearchResultSet& result_set,
 
     if (m_FormatType == CFormattingArgs::eTabular ||
         m_FormatType == CFormattingArgs::eTabularWithComments ||
-        m_FormatType == CFormattingArgs::eCommaSeparatedValues) {
+        m_FormatType == CFormattingArgs::eCommaSeparatedValues ||
+        m_FormatType == CFormattingArgs::eBinaryTabular) {
         ITERATE(CSearchResultSet, result, result_set) {
            x_PrintTabularReport(**result, itr_num);
         }
@@ -2219,6 +2238,9 @@ CBlastFormat::PrintEpilog(const blast::CBlastOptions& options)
         CBlastTabularInfo tabinfo(m_Outfile, m_CustomOutputFormatSpec);
         tabinfo.PrintNumProcessed(m_QueriesFormatted);
         return;
+    } else if (m_FormatType == CFormattingArgs::eBinaryTabular) {
+        m_BinaryTabularWriter->Finish();
+        return;
     } else if (m_FormatType >= CFormattingArgs::eTabular) 
         return;  // No footer for these.
 
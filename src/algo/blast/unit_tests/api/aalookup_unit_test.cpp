@@ -53,8 +53,10 @@
 #include <algo/blast/core/blast_encoding.h>
 #include <algo/blast/core/blast_aalookup.h>
 #include <algo/blast/core/lookup_util.h>
+#include "lookup_cache_priv.hpp"
 
 #include "test_objmgr.hpp"
+#include "blast_test_util.hpp"
 
 using namespace std;
 using namespace ncbi;
@@ -436,6 +438,80 @@ BOOST_AUTO_TEST_CASE(testDebruijnPSSM)
 
 // TestBlastAaLookupTable
 
+BOOST_AUTO_TEST_CASE(LookupTableCacheTest) {
+  TestUtil::CLookupTableCacheDir cache_dir;
+  GetSeqBlk();
+  FillLookupTable(true);
+
+  CLookupTableCache cache(query_blk, lookup_options, NULL, lookup_segments,
+                          sbp);
+  BOOST_REQUIRE(cache.IsEnabled());
+  BOOST_REQUIRE(cache.Load(query_blk) == NULL);
+  cache.Save(lookup_wrap_ptr, query_blk);
+
+  // the cached table must be identical to the one it was saved from
+  LookupTableWrap* loaded = cache.Load(query_blk);
+  BOOST_REQUIRE(loaded != NULL);
+  BOOST_REQUIRE_EQUAL(eAaLookupTable, (ELookupTableType)loaded->lut_type);
+  BlastAaLookupTable* cached = (BlastAaLookupTable*) loaded->lut;
+  BOOST_REQUIRE_EQUAL(lookup->threshold, cached->threshold);
+  BOOST_REQUIRE_EQUAL(lookup->mask, cached->mask);
+  BOOST_REQUIRE_EQUAL(lookup->charsize, cached->charsize);
+  BOOST_REQUIRE_EQUAL(lookup->word_length, cached->word_length);
+  BOOST_REQUIRE_EQUAL(lookup->lut_word_length, cached->lut_word_length);
+  BOOST_REQUIRE_EQUAL(lookup->alphabet_size, cached->alphabet_size);
+  BOOST_REQUIRE_EQUAL(lookup->backbone_size, cached->backbone_size);
+  BOOST_REQUIRE_EQUAL(lookup->longest_chain, cached->longest_chain);
+  BOOST_REQUIRE_EQUAL(lookup->bone_type, cached->bone_type);
+  BOOST_REQUIRE_EQUAL(lookup->overflow_size, cached->overflow_size);
+  BOOST_REQUIRE_EQUAL(lookup->use_pssm, cached->use_pssm);
+  BOOST_REQUIRE_EQUAL(lookup->neighbor_matches, cached->neighbor_matches);
+  BOOST_REQUIRE_EQUAL(lookup->exact_matches, cached->exact_matches);
+  BOOST_REQUIRE_EQUAL(eSmallbone, cached->bone_type);
+  BOOST_REQUIRE(memcmp(lookup->thick_backbone, cached->thick_backbone,
+                lookup->backbone_size * sizeof(AaLookupSmallboneCell)) == 0);
+  BOOST_REQUIRE(lookup->overflow_size > 0);
+  BOOST_REQUIRE(memcmp(lookup->overflow, cached->overflow,
+                lookup->overflow_size * sizeof(Uint2)) == 0);
+  BOOST_REQUIRE(memcmp(lookup->pv, cached->pv,
+                ((lookup->backbone_size >> PV_ARRAY_BTS) + 1) *
+                sizeof(PV_ARRAY_TYPE)) == 0);
+  LookupTableWrapFree(loaded);
+
+  // the neighboring words depend on the score matrix...
+  sbp->matrix->data[1][1]++;
+  CLookupTableCache matrix(query_blk, lookup_options, NULL, lookup_segments,
+                           sbp);
+  sbp->matrix->data[1][1]--;
+  BOOST_REQUIRE(matrix.GetPath() != cache.GetPath());
+  BOOST_REQUIRE(matrix.Load(query_blk) == NULL);
+
+  // ...or the PSSM that replaces it
+  sbp->psi_matrix = SPsiBlastScoreMatrixNew(query_blk->length);
+  CLookupTableCache pssm(query_blk, lookup_options, NULL, lookup_segments,
+                         sbp);
+  sbp->psi_matrix = SPsiBlastScoreMatrixFree(sbp->psi_matrix);
+  BOOST_REQUIRE(pssm.GetPath() != cache.GetPath());
+
+  // ...and on the threshold
+  lookup_options->threshold += 1;
+  CLookupTableCache threshold(query_blk, lookup_options, NULL,
+                              lookup_segments, sbp);
+  lookup_options->threshold -= 1;
+  BOOST_REQUIRE(threshold.GetPath() != cache.GetPath());
+
+  CLookupTableCache same(query_blk, lookup_options, NULL, lookup_segments,
+                         sbp);
+  BOOST_REQUIRE_EQUAL(cache.GetPath(), same.GetPath());
+
+  // compressed alphabet tables are not cached
+  lookup_options->lut_type = eCompressedAaLookupTable;
+  CLookupTableCache compressed(query_blk, lookup_options, NULL,
+                               lookup_segments, sbp);
+  lookup_options->lut_type = eAaLookupTable;
+  BOOST_REQUIRE( !compressed.IsEnabled() );
+}
+
 // Register this test suite with the default test factory registry
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -34,6 +34,8 @@
 #include <ncbi_pch.hpp>
 #include "blast_test_util.hpp"
 #include <corelib/ncbimisc.hpp>
+#include <corelib/ncbienv.hpp>
+#include <corelib/ncbifile.hpp>
 #include <corelib/ncbitype.h>
 #include <util/random_gen.hpp>
 
@@ -291,5 +293,19 @@ EndianIndependentBufferHash(const char * buffer,
     return hash;
 }
 
+CLookupTableCacheDir::CLookupTableCacheDir()
+    : m_Dir(CFile::GetTmpName())
+{
+    if ( !CDir(m_Dir).Create() ) {
+        throw runtime_error("Could not create " + m_Dir);
+    }
+    CNcbiEnvironment().Set("BLAST_LOOKUP_CACHE_DIR", m_Dir);
+}
+
+CLookupTableCacheDir::~CLookupTableCacheDir()
+{
+    CNcbiEnvironment().Unset("BLAST_LOOKUP_CACHE_DIR");
+    CDir(m_Dir).Remove(CDir::eRecursive);
 }
 
+}
@@ -173,6 +173,20 @@ Uint4 EndianIndependentBufferHash(const char * buffer,
                                   Uint4        swap_size = 1,
                                   Uint4        hash_seed = 1);
 
+/// Points the lookup table cache (BLAST_LOOKUP_CACHE_DIR) to a new
+/// temporary directory, which is removed along with this object
+class CLookupTableCacheDir {
+public:
+    CLookupTableCacheDir();
+    ~CLookupTableCacheDir();
+
+    /// Name of the cache directory
+    const std::string& GetDir() const { return m_Dir; }
+
+private:
+    std::string m_Dir;
+};
+
 }
 
 #endif // _BLAST_TEST_UTIL_HPP
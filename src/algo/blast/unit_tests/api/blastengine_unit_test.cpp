@@ -55,6 +55,7 @@
 #include <algo/blast/api/seqsrc_multiseq.hpp>
 #include <algo/blast/api/seqsrc_seqdb.hpp>
 #include <algo/blast/api/local_blast.hpp>
+#include <algo/blast/api/local_db_adapter.hpp>
 #include <algo/blast/api/objmgr_query_data.hpp>
 #include <algo/blast/api/prelim_stage.hpp>
 #include <blast_objmgr_priv.hpp>
@@ -552,5 +553,67 @@ BOOST_AUTO_TEST_CASE(testGappedOffsets)
      BOOST_REQUIRE_EQUAL(retval, false);
 }
 
+// The traceback stage uses its own thread count when one is set, then
+// BLAST_TRACEBACK_THREADS, then the preliminary stage thread count
+BOOST_AUTO_TEST_CASE(testTracebackThreads)
+{
+    const TGi kQueryGi = GI_CONST(186279); // Short human sequence with repeats
+    const TGi kSubjectGi = GI_CONST(29791382); // Contig from human chromosome 1
+
+    setupQueryAndSubject(kQueryGi, kSubjectGi);
+
+    CRef<CBlastOptionsHandle> opts_handle
+        (CBlastOptionsFactory::Create(eBlastn));
+    CRef<IQueryFactory> query_factory(new CObjMgr_QueryFactory(m_vQuery));
+    CRef<IQueryFactory> subject_factory
+        (new CObjMgr_QueryFactory(m_vSubject));
+    CRef<CLocalDbAdapter> subjects
+        (new CLocalDbAdapter(subject_factory, opts_handle));
+
+    CNcbiEnvironment env;
+    env.Unset("BLAST_TRACEBACK_THREADS");
+
+    CLocalBlast blaster(query_factory, opts_handle, subjects);
+    blaster.SetNumberOfThreads(2);
+    BOOST_REQUIRE_EQUAL((size_t)2, blaster.GetNumberOfTracebackThreads());
+
+    env.Set("BLAST_TRACEBACK_THREADS", "3");
+    BOOST_REQUIRE_EQUAL((size_t)3, blaster.GetNumberOfTracebackThreads());
+    env.Set("BLAST_TRACEBACK_THREADS", "none");
+    BOOST_REQUIRE_EQUAL((size_t)2, blaster.GetNumberOfTracebackThreads());
+
+    env.Set("BLAST_TRACEBACK_THREADS", "3");
+    blaster.SetNumberOfTracebackThreads(4);
+    BOOST_REQUIRE_EQUAL((size_t)4, blaster.GetNumberOfTracebackThreads());
+    blaster.SetNumberOfTracebackThreads(0);
+    BOOST_REQUIRE_EQUAL((size_t)3, blaster.GetNumberOfTracebackThreads());
+    env.Unset("BLAST_TRACEBACK_THREADS");
+
+    // the alignments do not depend on the traceback thread count
+    blaster.SetNumberOfTracebackThreads(4);
+    CRef<CSearchResultSet> results_mt = blaster.Run();
+
+    CLocalBlast blaster_st(query_factory, opts_handle, subjects);
+    blaster_st.SetNumberOfThreads(2);
+    blaster_st.SetNumberOfTracebackThreads(1);
+    CRef<CSearchResultSet> results_st = blaster_st.Run();
+
+    BOOST_REQUIRE_EQUAL(results_st->GetNumResults(),
+                        results_mt->GetNumResults());
+    for (size_t i = 0; i < results_st->GetNumResults(); i++) {
+        const CSeq_align_set::Tdata& aligns_st =
+            (*results_st)[i].GetSeqAlign()->Get();
+        const CSeq_align_set::Tdata& aligns_mt =
+            (*results_mt)[i].GetSeqAlign()->Get();
+        BOOST_REQUIRE(!aligns_st.empty());
+        BOOST_REQUIRE_EQUAL(aligns_st.size(), aligns_mt.size());
+        CSeq_align_set::Tdata::const_iterator it_st = aligns_st.begin();
+        CSeq_align_set::Tdata::const_iterator it_mt = aligns_mt.begin();
+        for ( ; it_st != aligns_st.end(); ++it_st, ++it_mt) {
+            BOOST_REQUIRE((*it_st)->Equals(**it_mt));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -43,6 +43,8 @@
 #include <algo/blast/core/blast_encoding.h>
 #include <algo/blast/core/blast_setup.h>
 #include <algo/blast/core/blast_gapalign.h>
+#include <algo/blast/core/blast_sw.h>
+#include <util/random_gen.hpp>
 #include <blast_objmgr_priv.hpp>
 #ifdef NCBI_OS_IRIX
 #include <stdlib.h>
@@ -678,6 +680,206 @@ BOOST_AUTO_TEST_CASE(testLargeMBSpaceValue) {
         MBSpaceFree(retval);
 }
 
+/// Straightforward Smith-Waterman score of A against B, the reference for
+/// the optimized score computation of BLAST_SmithWatermanGetGappedScore
+static Int4 s_SmithWatermanScore(const vector<Uint1>& A,
+                                 const vector<Uint1>& B,
+                                 Int4 gap_open, Int4 gap_extend,
+                                 Int4** matrix, bool is_pssm)
+{
+    vector<Int4> best(B.size() + 1, 0);
+    vector<Int4> best_gap(B.size() + 1, 0);
+    Int4 retval = 0;
+
+    for (size_t i = 0;  i < A.size();  i++) {
+        Int4 diagonal = 0;
+        Int4 left = 0;
+        Int4 insert = 0;
+        for (size_t j = 0;  j < B.size();  j++) {
+            Int4 score = is_pssm ? matrix[i][B[j]] : matrix[A[i]][B[j]];
+            best_gap[j + 1] = max(best_gap[j + 1] - gap_extend,
+                                  best[j + 1] - gap_open - gap_extend);
+            insert = max(insert - gap_extend, left - gap_open - gap_extend);
+            Int4 cell = max(max(diagonal + score, 0),
+                            max(best_gap[j + 1], insert));
+            diagonal = best[j + 1];
+            best[j + 1] = left = cell;
+            retval = max(retval, cell);
+        }
+    }
+    return retval;
+}
+
+static vector<Uint1> s_RandomProtein(CRandom& random, Int4 length)
+{
+    vector<Uint1> retval(length);
+    for (Int4 i = 0;  i < length;  i++) {
+        // any ncbistdaa letter but the gap
+        retval[i] = (Uint1)random.GetRand(1, BLASTAA_SIZE - 1);
+    }
+    return retval;
+}
+
+/// Compare the scores of BLAST_SmithWatermanGetGappedScore for each pair
+/// of queries and subjects with the reference implementation. The same
+/// gap_align is used throughout, so the query profiles it caches are
+/// reused for all subjects.
+static void s_CheckSmithWatermanScores(BlastGapAlignStruct* gap_align,
+                                       const vector< vector<Uint1> >& queries,
+                                       const vector< vector<Uint1> >& subjects,
+                                       Int4 gap_open, Int4 gap_extend)
+{
+    const Uint1 kNullByte = 0;
+    const Int4 kNumQueries = (Int4)queries.size();
+    Int4** matrix = gap_align->positionBased ?
+                    gap_align->sbp->psi_matrix->pssm->data :
+                    gap_align->sbp->matrix->data;
+
+    // concatenated queries, separated by sentinels
+    vector<Uint1> query_data(1, kNullByte);
+    CBlastQueryInfo query_info(BlastQueryInfoNew(eBlastTypeBlastp,
+                                                 kNumQueries));
+    for (Int4 i = 0;  i < kNumQueries;  i++) {
+        query_info->contexts[i].query_offset = (Int4)query_data.size();
+        query_info->contexts[i].query_length = (Int4)queries[i].size();
+        query_info->contexts[i].is_valid = TRUE;
+        query_data.insert(query_data.end(), queries[i].begin(),
+                          queries[i].end());
+        query_data.push_back(kNullByte);
+    }
+    BLAST_SequenceBlk query;
+    memset(&query, 0, sizeof(query));
+    query.sequence = &query_data[0];
+    query.length = (Int4)query_data.size();
+
+    BlastScoringParameters score_params;
+    memset(&score_params, 0, sizeof(score_params));
+    score_params.gap_open = gap_open;
+    score_params.gap_extend = gap_extend;
+    BlastExtensionParameters ext_params;
+    memset(&ext_params, 0, sizeof(ext_params));
+    BlastHitSavingOptions hit_options;
+    memset(&hit_options, 0, sizeof(hit_options));
+    // a zero cutoff keeps the score of every query
+    vector<BlastGappedCutoffs> cutoffs(kNumQueries);
+    memset(&cutoffs[0], 0, kNumQueries * sizeof(BlastGappedCutoffs));
+    BlastHitSavingParameters hit_params;
+    memset(&hit_params, 0, sizeof(hit_params));
+    hit_params.options = &hit_options;
+    hit_params.cutoffs = &cutoffs[0];
+    BlastInitHitList* init_hitlist = BLAST_InitHitListNew();
+
+    ITERATE(vector< vector<Uint1> >, subject_data, subjects) {
+        vector<Uint1> subject_copy(*subject_data);
+        BLAST_SequenceBlk subject;
+        memset(&subject, 0, sizeof(subject));
+        subject.sequence = &subject_copy[0];
+        subject.length = (Int4)subject_copy.size();
+
+        BlastHSPList* hsp_list = NULL;
+        BOOST_REQUIRE_EQUAL(0, (int)BLAST_SmithWatermanGetGappedScore(
+                                    eBlastTypeBlastp, &query, query_info,
+                                    &subject, gap_align, &score_params,
+                                    &ext_params, &hit_params, NULL,
+                                    init_hitlist, &hsp_list, NULL, NULL));
+        BOOST_REQUIRE(hsp_list != NULL);
+        BOOST_REQUIRE_EQUAL(kNumQueries, hsp_list->hspcnt);
+        for (Int4 i = 0;  i < hsp_list->hspcnt;  i++) {
+            const BlastHSP* hsp = hsp_list->hsp_array[i];
+            BOOST_REQUIRE_EQUAL(s_SmithWatermanScore(queries[hsp->context],
+                                        *subject_data, gap_open, gap_extend,
+                                        matrix, gap_align->positionBased),
+                                hsp->score);
+        }
+        Blast_HSPListFree(hsp_list);
+    }
+    BLAST_InitHitListFree(init_hitlist);
+}
+
+BOOST_AUTO_TEST_CASE(testSmithWatermanScoreRandom) {
+    CRandom random(20240117);
+
+    BOOST_REQUIRE_EQUAL(0, (int)BlastScoringOptionsNew(eBlastTypeBlastp,
+                                                       &m_ScoringOpts));
+    m_ipScoreBlk = BlastScoreBlkNew(BLASTAA_SEQ_CODE, 1);
+    BOOST_REQUIRE_EQUAL(0, (int)Blast_ScoreBlkMatrixInit(eBlastTypeBlastp,
+                                    m_ScoringOpts, m_ipScoreBlk,
+                                    &BlastFindMatrixPath));
+    m_ipGapAlign =
+        (BlastGapAlignStruct*) calloc(1, sizeof(BlastGapAlignStruct));
+    m_ipGapAlign->sbp = m_ipScoreBlk;
+
+    // queries of assorted lengths, including one whose self score
+    // does not fit into 16 bits
+    vector< vector<Uint1> > queries;
+    queries.push_back(s_RandomProtein(random, 1));
+    queries.push_back(s_RandomProtein(random, 7));
+    queries.push_back(s_RandomProtein(random, 250));
+    queries.push_back(vector<Uint1>(3100, AMINOACID_TO_NCBISTDAA['W']));
+
+    vector< vector<Uint1> > subjects;
+    for (int i = 0;  i < 30;  i++) {
+        subjects.push_back(s_RandomProtein(random, random.GetRand(1, 600)));
+    }
+    // similar sequences, to get long alignments with gaps
+    ITERATE(vector< vector<Uint1> >, query, queries) {
+        vector<Uint1> subject;
+        ITERATE(vector<Uint1>, letter, *query) {
+            switch (random.GetRand(0, 19)) {
+            case 0:
+                break;  // deletion
+            case 1:
+                subject.push_back(*letter);
+                subject.push_back((Uint1)random.GetRand(1, BLASTAA_SIZE - 1));
+                break;  // insertion
+            case 2:
+                subject.push_back((Uint1)random.GetRand(1, BLASTAA_SIZE - 1));
+                break;  // substitution
+            default:
+                subject.push_back(*letter);
+            }
+        }
+        if ( !subject.empty() ) {
+            subjects.push_back(subject);
+        }
+    }
+    subjects.push_back(queries.back());
+
+    s_CheckSmithWatermanScores(m_ipGapAlign, queries, subjects, 11, 1);
+    s_CheckSmithWatermanScores(m_ipGapAlign, queries, subjects, 5, 2);
+
+    // the profiles must follow a change of the queries
+    queries.back() = s_RandomProtein(random, 3100);
+    reverse(queries.begin(), queries.end());
+    s_CheckSmithWatermanScores(m_ipGapAlign, queries, subjects, 11, 1);
+}
+
+BOOST_AUTO_TEST_CASE(testSmithWatermanScorePssmRandom) {
+    CRandom random(20240118);
+    const Int4 kQueryLength = 300;
+
+    m_ipScoreBlk = BlastScoreBlkNew(BLASTAA_SEQ_CODE, 1);
+    m_ipScoreBlk->psi_matrix = SPsiBlastScoreMatrixNew(kQueryLength);
+    BOOST_REQUIRE(m_ipScoreBlk->psi_matrix != NULL);
+    for (Int4 i = 0;  i < kQueryLength;  i++) {
+        for (Int4 j = 0;  j < BLASTAA_SIZE;  j++) {
+            m_ipScoreBlk->psi_matrix->pssm->data[i][j] =
+                (Int4)random.GetRand(0, 14) - 6;
+        }
+    }
+    m_ipGapAlign =
+        (BlastGapAlignStruct*) calloc(1, sizeof(BlastGapAlignStruct));
+    m_ipGapAlign->sbp = m_ipScoreBlk;
+    m_ipGapAlign->positionBased = TRUE;
+
+    vector< vector<Uint1> > queries(1, s_RandomProtein(random, kQueryLength));
+    vector< vector<Uint1> > subjects;
+    for (int i = 0;  i < 30;  i++) {
+        subjects.push_back(s_RandomProtein(random, random.GetRand(1, 1000)));
+    }
+    s_CheckSmithWatermanScores(m_ipGapAlign, queries, subjects, 11, 1);
+}
+
 BOOST_AUTO_TEST_CASE(testInitHitListFreeWithNULLInput) {
         BlastInitHitList* input = NULL;
         BlastInitHitList* output = NULL;
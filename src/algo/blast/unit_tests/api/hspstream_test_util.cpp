@@ -51,9 +51,10 @@ setupHSPList(int score, int num_queries, int oid)
 }
 
 CHspStreamWriteThread::CHspStreamWriteThread(BlastHSPStream* hsp_stream, 
-                       int index, int nthreads, int total, int nqueries)
+                       int index, int nthreads, int total, int nqueries,
+                       int batch_size)
     : m_ipHspStream(hsp_stream), m_iIndex(index), m_iNumThreads(nthreads),
-      m_iTotal(total), m_iNumQueries(nqueries)
+      m_iTotal(total), m_iNumQueries(nqueries), m_iBatchSize(batch_size)
 {
 }
 
@@ -67,10 +68,36 @@ void* CHspStreamWriteThread::Main(void)
     int index;
     int status;
     BlastHSPList* hsp_list;
+    vector<BlastHSPList*> batch;
 
     for (index = m_iIndex; index < m_iTotal; index += m_iNumThreads) {
         hsp_list = 
             setupHSPList(rand() % max_score, m_iNumQueries, index);
+        if (m_iBatchSize > 0) {
+            batch.push_back(hsp_list);
+            bool last = index + m_iNumThreads >= m_iTotal;
+            if ((int) batch.size() < m_iBatchSize  &&  !last) {
+                continue;
+            }
+            // As in the preliminary search, a busy stream is skipped
+            // until the buffer is four times the batch size
+            if ((int) batch.size() < 4 * m_iBatchSize  &&  !last) {
+                status = BlastHSPStreamTryBatchWrite(m_ipHspStream, &batch[0],
+                                                     (Int4) batch.size());
+                if (status == kBlastHSPStream_Busy)
+                    continue;
+            } else {
+                status = BlastHSPStreamBatchWrite(m_ipHspStream, &batch[0],
+                                                  (Int4) batch.size());
+            }
+            if (status != kBlastHSPStream_Success)
+                abort();
+            ITERATE(vector<BlastHSPList*>, it, batch) {
+                ASSERT(*it == NULL);
+            }
+            batch.clear();
+            continue;
+        }
         status = BlastHSPStreamWrite(m_ipHspStream, &hsp_list);
         if (status != kBlastHSPStream_Success)
             abort();
@@ -46,8 +46,12 @@ USING_NCBI_SCOPE;
 class CHspStreamWriteThread : public CThread
 {
 public:
+    /// @param batch_size If positive, HSP lists are collected in a buffer
+    /// of this size and written with BlastHSPStreamTryBatchWrite, or with
+    /// BlastHSPStreamBatchWrite once the buffer is four times as full
     CHspStreamWriteThread(BlastHSPStream* hsp_stream, int index, 
-                          int nthreads, int total, int nqueries);
+                          int nthreads, int total, int nqueries,
+                          int batch_size = 0);
     ~CHspStreamWriteThread();
 protected:
     virtual void* Main(void);
@@ -58,6 +62,7 @@ private:
     int m_iNumThreads;
     int m_iTotal;
     int m_iNumQueries;
+    int m_iBatchSize;
 };
 
 // Function to set up an HSP list for hspstream unit tests.
@@ -56,7 +56,7 @@ typedef enum EHSPStreamType {
     eHSPListQueue
 } EHSPStreamType;
 
-void testHSPStream(EHSPStreamType stream_type) {
+void testHSPStream(EHSPStreamType stream_type, int batch_size = 0) {
     const int kNumQueries = 10;
     const int kNumThreads = 40;
     int num_hsp_lists = 1000;
@@ -118,7 +118,8 @@ void testHSPStream(EHSPStreamType stream_type) {
     for (index = 0; index < kNumThreads; ++index) {
         CRef<CHspStreamWriteThread> write_thread(
             new CHspStreamWriteThread(hsp_stream, index, kNumThreads, 
-                                      num_hsp_lists, kNumQueries));
+                                      num_hsp_lists, kNumQueries,
+                                      batch_size));
         write_thread_v.push_back(write_thread);
         write_thread->Run();
     }
@@ -178,6 +179,183 @@ BOOST_AUTO_TEST_CASE(testQueueHSPStream) {
     testHSPStream(eHSPListQueue);
 }
 
+BOOST_AUTO_TEST_CASE(testCollectorHSPStreamBatchWrite) {
+    testHSPStream(eHSPListCollector, 16);
+}
+
+/// Creates a collector HSP stream for one blastp query
+static BlastHSPStream* s_CreateCollectorHSPStream(void)
+{
+    const EBlastProgramType kProgram = eBlastTypeBlastp;
+
+    BlastExtensionOptions* ext_options = NULL;
+    BlastExtensionOptionsNew(kProgram, &ext_options, true);
+    BlastScoringOptions* scoring_options = NULL;
+    BlastScoringOptionsNew(kProgram, &scoring_options);
+    BlastHitSavingOptions* hit_options = NULL;
+    BlastHitSavingOptionsNew(kProgram, &hit_options,
+                             scoring_options->gapped_calculation);
+    // Small enough for the collector to drop some of the lists
+    hit_options->hitlist_size = 20;
+
+    BlastHSPWriterInfo * writer_info = BlastHSPCollectorInfoNew(
+            BlastHSPCollectorParamsNew(
+        hit_options, ext_options->compositionBasedStats,
+        scoring_options->gapped_calculation));
+    BlastHSPWriter* writer = BlastHSPWriterNew(&writer_info, NULL, NULL);
+    BlastHSPStream* hsp_stream = BlastHSPStreamNew(
+        kProgram, ext_options, FALSE, 1, writer);
+
+    BlastScoringOptionsFree(scoring_options);
+    BlastExtensionOptionsFree(ext_options);
+    BlastHitSavingOptionsFree(hit_options);
+    return hsp_stream;
+}
+
+// HSP lists written in batches, as the threads of a preliminary search do,
+// must be collected the same way as lists written one by one.
+BOOST_AUTO_TEST_CASE(testHSPStreamBatchWriteSameResults) {
+    const int kNumSubjects = 1000;
+    const int kBatchSize = 7;
+
+    BlastHSPStream* single_stream = s_CreateCollectorHSPStream();
+    BlastHSPStream* batch_stream = s_CreateCollectorHSPStream();
+
+    vector<BlastHSPList*> batch;
+    int index, status;
+    for (index = 0; index < kNumSubjects; index++) {
+        const int kScore = (index * 37) % 101;
+        BlastHSPList* hsp_list = setupHSPList(kScore, 1, index);
+        status = BlastHSPStreamWrite(single_stream, &hsp_list);
+        BOOST_REQUIRE_EQUAL(kBlastHSPStream_Success, status);
+
+        batch.push_back(setupHSPList(kScore, 1, index));
+        // Empty entries are skipped
+        if (index % 10 == 0) {
+            batch.push_back(NULL);
+        }
+        if ((int) batch.size() >= kBatchSize  ||  index == kNumSubjects - 1) {
+            status = BlastHSPStreamBatchWrite(batch_stream, &batch[0],
+                                              (Int4) batch.size());
+            BOOST_REQUIRE_EQUAL(kBlastHSPStream_Success, status);
+            ITERATE(vector<BlastHSPList*>, it, batch) {
+                BOOST_REQUIRE(*it == NULL);
+            }
+            batch.clear();
+        }
+    }
+
+    BlastHSPList* single_list = NULL;
+    BlastHSPList* batch_list = NULL;
+    int num_lists = 0;
+    for (;;) {
+        int single_status = BlastHSPStreamRead(single_stream, &single_list);
+        int batch_status = BlastHSPStreamRead(batch_stream, &batch_list);
+        BOOST_REQUIRE_EQUAL(single_status, batch_status);
+        if (single_status == kBlastHSPStream_Eof) {
+            break;
+        }
+        BOOST_REQUIRE_EQUAL(single_list->oid, batch_list->oid);
+        BOOST_REQUIRE_EQUAL(single_list->hspcnt, batch_list->hspcnt);
+        BOOST_REQUIRE_EQUAL(single_list->hsp_array[0]->score,
+                            batch_list->hsp_array[0]->score);
+        single_list = Blast_HSPListFree(single_list);
+        batch_list = Blast_HSPListFree(batch_list);
+        num_lists++;
+    }
+    BOOST_REQUIRE(num_lists > 0);
+    BOOST_REQUIRE(num_lists < kNumSubjects);
+
+    // Writing after reading has started fails, and leaves the lists with
+    // the caller
+    batch.push_back(setupHSPList(1, 1, 0));
+    status = BlastHSPStreamBatchWrite(batch_stream, &batch[0], 1);
+    BOOST_REQUIRE_EQUAL(kBlastHSPStream_Error, status);
+    BOOST_REQUIRE(batch[0] != NULL);
+    batch[0] = Blast_HSPListFree(batch[0]);
+
+    BlastHSPStreamFree(single_stream);
+    BlastHSPStreamFree(batch_stream);
+}
+
+// A thread that finds the stream busy keeps its lists and goes on searching
+BOOST_AUTO_TEST_CASE(testHSPStreamTryBatchWrite) {
+    BlastHSPStream* hsp_stream = s_CreateCollectorHSPStream();
+    vector<BlastHSPList*> batch;
+    batch.push_back(setupHSPList(10, 1, 0));
+    batch.push_back(setupHSPList(20, 1, 1));
+
+    // Without a lock nothing is ever busy
+    int status = BlastHSPStreamTryBatchWrite(hsp_stream, &batch[0], 1);
+    BOOST_REQUIRE_EQUAL(kBlastHSPStream_Success, status);
+    BOOST_REQUIRE(batch[0] == NULL);
+
+    MT_LOCK lock = Blast_CMT_LOCKInit();
+    BlastHSPStreamRegisterMTLock(hsp_stream, lock);
+
+    BOOST_REQUIRE(MT_LOCK_Do(lock, eMT_Lock) > 0);
+    status = BlastHSPStreamTryBatchWrite(hsp_stream, &batch[1], 1);
+    BOOST_REQUIRE_EQUAL(kBlastHSPStream_Busy, status);
+    BOOST_REQUIRE(batch[1] != NULL);
+    MT_LOCK_Do(lock, eMT_Unlock);
+
+    status = BlastHSPStreamTryBatchWrite(hsp_stream, &batch[1], 1);
+    BOOST_REQUIRE_EQUAL(kBlastHSPStream_Success, status);
+    BOOST_REQUIRE(batch[1] == NULL);
+
+    BlastHSPList* hsp_list = NULL;
+    int num_lists = 0;
+    while (BlastHSPStreamRead(hsp_stream, &hsp_list) ==
+           kBlastHSPStream_Success) {
+        hsp_list = Blast_HSPListFree(hsp_list);
+        num_lists++;
+    }
+    BOOST_REQUIRE_EQUAL(2, num_lists);
+
+    BlastHSPStreamFree(hsp_stream);
+}
+
+/// Time taken by nthreads threads to write total HSP lists to a collector
+/// stream, one by one if batch_size is 0
+static double s_TimeHSPStreamWrites(int nthreads, int total, int batch_size)
+{
+    BlastHSPStream* hsp_stream = s_CreateCollectorHSPStream();
+    BlastHSPStreamRegisterMTLock(hsp_stream, Blast_CMT_LOCKInit());
+
+    vector<CRef<CHspStreamWriteThread> > threads;
+    CStopWatch sw(CStopWatch::eStart);
+    for (int index = 0; index < nthreads; ++index) {
+        threads.push_back(CRef<CHspStreamWriteThread>(
+            new CHspStreamWriteThread(hsp_stream, index, nthreads, total, 1,
+                                      batch_size)));
+        threads.back()->Run();
+    }
+    for (int index = 0; index < nthreads; ++index) {
+        threads[index]->Join();
+    }
+    double elapsed = sw.Elapsed();
+
+    BlastHSPStreamFree(hsp_stream);
+    return elapsed;
+}
+
+// Measures how writes to a shared stream scale with the number of threads;
+// the timings are only reported, as they depend on the machine.
+BOOST_AUTO_TEST_CASE(testHSPStreamWriteScaling) {
+    const int kTotal = 100000;
+    const int kBatchSize = 64;
+
+    for (int nthreads = 1;  nthreads <= 8;  nthreads *= 2) {
+        double single_time = s_TimeHSPStreamWrites(nthreads, kTotal, 0);
+        double batch_time =
+            s_TimeHSPStreamWrites(nthreads, kTotal, kBatchSize);
+        BOOST_TEST_MESSAGE("HSP stream writes, " << nthreads
+                           << " threads: single " << single_time
+                           << " s, batches of " << kBatchSize << " "
+                           << batch_time << " s");
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testMultiSeqHSPCollector) {
     const int kNumSubjects = 10;
     const EBlastProgramType kProgram = eBlastTypeBlastp;
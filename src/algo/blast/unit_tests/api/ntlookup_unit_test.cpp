@@ -59,6 +59,8 @@
 #include <algo/blast/api/disc_nucl_options.hpp>
 #include <algo/blast/core/blast_nalookup.h>
 #include <algo/blast/core/lookup_util.h>
+#include <corelib/ncbifile.hpp>
+#include "lookup_cache_priv.hpp"
 
 #include "test_objmgr.hpp"
 #include "blast_test_util.hpp"
@@ -834,6 +836,253 @@ BOOST_AUTO_TEST_CASE(testMegablastTableSmallUnmaskedRegion) {
         BOOST_REQUIRE(segments == NULL);
 }
 
+/// Verifies that an array of a lookup table read from the cache matches
+/// the one of the original table
+template <class T>
+static void s_CheckSameArray(const T* expected, const T* actual, Int8 num)
+{
+    if ( !expected ) {
+        BOOST_REQUIRE(actual == NULL);
+        return;
+    }
+    BOOST_REQUIRE(actual != NULL);
+    BOOST_REQUIRE(memcmp(expected, actual, num * sizeof(T)) == 0);
+}
+
+static void s_CheckSameLocations(const BlastSeqLoc* expected,
+                                 const BlastSeqLoc* actual)
+{
+    for ( ;  expected;  expected = expected->next, actual = actual->next) {
+        BOOST_REQUIRE(actual != NULL);
+        BOOST_REQUIRE_EQUAL(expected->ssr->left, actual->ssr->left);
+        BOOST_REQUIRE_EQUAL(expected->ssr->right, actual->ssr->right);
+    }
+    BOOST_REQUIRE(actual == NULL);
+}
+
+static void s_CheckSameLookupTable(const LookupTableWrap* expected,
+                                   const LookupTableWrap* actual,
+                                   Int4 query_length)
+{
+    BOOST_REQUIRE_EQUAL(expected->lut_type, actual->lut_type);
+    if (expected->lut_type == eSmallNaLookupTable) {
+        const BlastSmallNaLookupTable* a =
+            (const BlastSmallNaLookupTable*)expected->lut;
+        const BlastSmallNaLookupTable* b =
+            (const BlastSmallNaLookupTable*)actual->lut;
+        BOOST_REQUIRE_EQUAL(a->mask, b->mask);
+        BOOST_REQUIRE_EQUAL(a->word_length, b->word_length);
+        BOOST_REQUIRE_EQUAL(a->lut_word_length, b->lut_word_length);
+        BOOST_REQUIRE_EQUAL(a->scan_step, b->scan_step);
+        BOOST_REQUIRE_EQUAL(a->backbone_size, b->backbone_size);
+        BOOST_REQUIRE_EQUAL(a->longest_chain, b->longest_chain);
+        BOOST_REQUIRE_EQUAL(a->overflow_size, b->overflow_size);
+        s_CheckSameArray(a->final_backbone, b->final_backbone,
+                         a->backbone_size);
+        s_CheckSameArray(a->overflow, b->overflow, a->overflow_size);
+        s_CheckSameLocations(a->masked_locations, b->masked_locations);
+    }
+    else if (expected->lut_type == eNaLookupTable) {
+        const BlastNaLookupTable* a = (const BlastNaLookupTable*)expected->lut;
+        const BlastNaLookupTable* b = (const BlastNaLookupTable*)actual->lut;
+        BOOST_REQUIRE_EQUAL(a->mask, b->mask);
+        BOOST_REQUIRE_EQUAL(a->word_length, b->word_length);
+        BOOST_REQUIRE_EQUAL(a->lut_word_length, b->lut_word_length);
+        BOOST_REQUIRE_EQUAL(a->scan_step, b->scan_step);
+        BOOST_REQUIRE_EQUAL(a->backbone_size, b->backbone_size);
+        BOOST_REQUIRE_EQUAL(a->longest_chain, b->longest_chain);
+        BOOST_REQUIRE_EQUAL(a->overflow_size, b->overflow_size);
+        s_CheckSameArray(a->thick_backbone, b->thick_backbone,
+                         a->backbone_size);
+        s_CheckSameArray(a->overflow, b->overflow, a->overflow_size);
+        s_CheckSameArray(a->pv, b->pv,
+                         (a->backbone_size >> PV_ARRAY_BTS) + 1);
+        s_CheckSameLocations(a->masked_locations, b->masked_locations);
+    }
+    else if (expected->lut_type == eMBLookupTable) {
+        const BlastMBLookupTable* a = (const BlastMBLookupTable*)expected->lut;
+        const BlastMBLookupTable* b = (const BlastMBLookupTable*)actual->lut;
+        BOOST_REQUIRE_EQUAL(a->word_length, b->word_length);
+        BOOST_REQUIRE_EQUAL(a->lut_word_length, b->lut_word_length);
+        BOOST_REQUIRE_EQUAL(a->hashsize, b->hashsize);
+        BOOST_REQUIRE_EQUAL(a->discontiguous, b->discontiguous);
+        BOOST_REQUIRE_EQUAL(a->template_length, b->template_length);
+        BOOST_REQUIRE_EQUAL(a->template_type, b->template_type);
+        BOOST_REQUIRE_EQUAL(a->two_templates, b->two_templates);
+        BOOST_REQUIRE_EQUAL(a->stride, b->stride);
+        BOOST_REQUIRE_EQUAL(a->scan_step, b->scan_step);
+        BOOST_REQUIRE_EQUAL(a->pv_array_bts, b->pv_array_bts);
+        BOOST_REQUIRE_EQUAL(a->longest_chain, b->longest_chain);
+        s_CheckSameArray(a->hashtable, b->hashtable, a->hashsize);
+        s_CheckSameArray(a->next_pos, b->next_pos, query_length + 1);
+        s_CheckSameArray(a->pv_array, b->pv_array,
+                         a->hashsize >> a->pv_array_bts);
+        s_CheckSameLocations(a->masked_locations, b->masked_locations);
+    }
+    else {
+        BOOST_ERROR("Unexpected lookup table type");
+    }
+}
+
+// Build each cached nucleotide lookup table type, save it and check that
+// the table loaded from the cache is identical
+BOOST_AUTO_TEST_CASE(testLookupTableCacheRoundTrip) {
+    TestUtil::CLookupTableCacheDir cache_dir;
+
+    // the query length selects the small or the standard blastn table
+    const struct {
+        int query_word_size;
+        Boolean megablast;
+        Int4 word_size;
+    } kTables[] = { { 5, FALSE, 8 }, { 8, FALSE, 8 }, { 8, TRUE, 0 } };
+
+    QuerySetUpOptions* query_options = NULL;
+    BlastQuerySetUpOptionsNew(&query_options);
+    set<int> lut_types;
+    for (size_t i = 0;  i < sizeof(kTables) / sizeof(kTables[0]);  i++) {
+        query_blk = BlastSequenceBlkFree(query_blk);
+        lookup_segments = BlastSeqLocFree(lookup_segments);
+        debruijnInit(kTables[i].query_word_size, 4);
+
+        LookupTableOptions* lookup_options;
+        LookupTableOptionsNew(eBlastTypeBlastn, &lookup_options);
+        BLAST_FillLookupTableOptions(lookup_options, eBlastTypeBlastn,
+                                     kTables[i].megablast, 0,
+                                     kTables[i].word_size);
+
+        CLookupTableCache cache(query_blk, lookup_options, query_options,
+                                lookup_segments, NULL);
+        BOOST_REQUIRE(cache.IsEnabled());
+        BOOST_REQUIRE(cache.Load(query_blk) == NULL);
+
+        LookupTableWrap* built = NULL;
+        BOOST_REQUIRE_EQUAL((int)LookupTableWrapInit(query_blk,
+                             lookup_options, query_options, lookup_segments,
+                             0, &built, NULL, NULL, NULL), 0);
+        cache.Save(built, query_blk);
+        BOOST_REQUIRE(CFile(cache.GetPath()).Exists());
+
+        // the small table's compressed query must be recomputed on load
+        sfree(query_blk->compressed_nuc_seq_start);
+        query_blk->compressed_nuc_seq = NULL;
+
+        LookupTableWrap* loaded = cache.Load(query_blk);
+        BOOST_REQUIRE(loaded != NULL);
+        s_CheckSameLookupTable(built, loaded, query_blk->length);
+        if (loaded->lut_type == eSmallNaLookupTable) {
+            BOOST_REQUIRE(query_blk->compressed_nuc_seq != NULL);
+        }
+        lut_types.insert(built->lut_type);
+
+        LookupTableWrapFree(loaded);
+        LookupTableWrapFree(built);
+        LookupTableOptionsFree(lookup_options);
+    }
+    BlastQuerySetUpOptionsFree(query_options);
+
+    BOOST_REQUIRE_EQUAL(sizeof(kTables) / sizeof(kTables[0]),
+                        lut_types.size());
+    // one file per table, no temporary files left behind
+    BOOST_REQUIRE_EQUAL(lut_types.size(),
+                        CDir(cache_dir.GetDir()).GetEntries(kEmptyStr,
+                                        CDir::fIgnoreRecursive).size());
+}
+
+// Check that tables are looked up under a different name whenever the
+// query or the options change, and that damaged files are not used
+BOOST_AUTO_TEST_CASE(testLookupTableCacheInvalidation) {
+    debruijnInit(8, 4);
+
+    LookupTableOptions* lookup_options;
+    LookupTableOptionsNew(eBlastTypeBlastn, &lookup_options);
+    BLAST_FillLookupTableOptions(lookup_options, eBlastTypeBlastn,
+                                 FALSE, 0, 8);
+    {{
+        TestUtil::CLookupTableCacheDir cache_dir;
+        CLookupTableCache cache(query_blk, lookup_options, NULL,
+                                lookup_segments, NULL);
+        BOOST_REQUIRE(cache.IsEnabled());
+
+        LookupTableWrap* built = NULL;
+        BOOST_REQUIRE_EQUAL((int)LookupTableWrapInit(query_blk,
+                             lookup_options, NULL, lookup_segments,
+                             0, &built, NULL, NULL, NULL), 0);
+        cache.Save(built, query_blk);
+        built = LookupTableWrapFree(built);
+
+        // same input, same file
+        CLookupTableCache same(query_blk, lookup_options, NULL,
+                               lookup_segments, NULL);
+        BOOST_REQUIRE_EQUAL(cache.GetPath(), same.GetPath());
+        LookupTableWrap* loaded = same.Load(query_blk);
+        BOOST_REQUIRE(loaded != NULL);
+        LookupTableWrapFree(loaded);
+
+        // different word size
+        lookup_options->word_size = 9;
+        CLookupTableCache word_size(query_blk, lookup_options, NULL,
+                                    lookup_segments, NULL);
+        lookup_options->word_size = 8;
+        BOOST_REQUIRE(word_size.GetPath() != cache.GetPath());
+        BOOST_REQUIRE(word_size.Load(query_blk) == NULL);
+
+        // different query
+        query_blk->sequence[100] ^= 1;
+        CLookupTableCache query(query_blk, lookup_options, NULL,
+                                lookup_segments, NULL);
+        query_blk->sequence[100] ^= 1;
+        BOOST_REQUIRE(query.GetPath() != cache.GetPath());
+
+        // different indexed regions
+        BlastSeqLoc* segments = NULL;
+        BlastSeqLocNew(&segments, 0, query_blk->length / 2);
+        CLookupTableCache region(query_blk, lookup_options, NULL,
+                                 segments, NULL);
+        segments = BlastSeqLocFree(segments);
+        BOOST_REQUIRE(region.GetPath() != cache.GetPath());
+
+        // tables depending on the database are never cached
+        lookup_options->db_filter = TRUE;
+        CLookupTableCache db_filter(query_blk, lookup_options, NULL,
+                                    lookup_segments, NULL);
+        lookup_options->db_filter = FALSE;
+        BOOST_REQUIRE( !db_filter.IsEnabled() );
+
+        // a file of another layout version is ignored
+        string contents;
+        {{
+            CNcbiIfstream in(cache.GetPath().c_str(),
+                             IOS_BASE::in | IOS_BASE::binary);
+            contents.assign(istreambuf_iterator<char>(in),
+                            istreambuf_iterator<char>());
+        }}
+        BOOST_REQUIRE(contents.size() > 100);
+        string damaged(contents);
+        damaged[4] ^= 0xff;
+        {{
+            CNcbiOfstream out(cache.GetPath().c_str(),
+                              IOS_BASE::out | IOS_BASE::binary);
+            out.write(damaged.data(), damaged.size());
+        }}
+        BOOST_REQUIRE(cache.Load(query_blk) == NULL);
+
+        // a truncated file is ignored
+        {{
+            CNcbiOfstream out(cache.GetPath().c_str(),
+                              IOS_BASE::out | IOS_BASE::binary);
+            out.write(contents.data(), contents.size() / 2);
+        }}
+        BOOST_REQUIRE(cache.Load(query_blk) == NULL);
+    }}
+    // the cache is disabled without BLAST_LOOKUP_CACHE_DIR
+    CLookupTableCache disabled(query_blk, lookup_options, NULL,
+                               lookup_segments, NULL);
+    BOOST_REQUIRE( !disabled.IsEnabled() );
+    BOOST_REQUIRE(disabled.Load(query_blk) == NULL);
+
+    LookupTableOptionsFree(lookup_options);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
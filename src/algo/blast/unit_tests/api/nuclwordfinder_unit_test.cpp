@@ -47,6 +47,7 @@
 #include <algo/blast/core/blast_stat.h>
 #include <algo/blast/core/blast_util.h>
 #include <algo/blast/core/na_ungapped.h>
+#include <util/random_gen.hpp>
 
 #include <algo/blast/api/blast_types.hpp>
 #include <algo/blast/api/blast_exception.hpp>
@@ -544,6 +545,291 @@ BOOST_AUTO_TEST_CASE(testHitAtEndOfSubject)
     BOOST_REQUIRE_EQUAL(0, hits_extended);
 }
 
+/// Compares the exact match extensions of lookup table hits, done
+/// 16 bases at a time where SIMD is available, with base by base
+/// comparison. Covers hits near both ends of the subject, every subject
+/// offset modulo COMPRESSION_RATIO, mismatches at all distances from the
+/// hit and ambiguous query bases, which never match.
+BOOST_AUTO_TEST_CASE(testExactMatchExtensionLengths)
+{
+    const Int4 kLength = 600;
+    const Int4 kLutWordLength = 8;
+    const Uint1 kAmbiguity = 14;    // N in blastna
+    CRandom random(29);
+
+    m_Offsets = NULL;
+    vector<Uint1> query(kLength), subject(kLength);
+    for (Int4 i = 0; i < kLength; ++i) {
+        // fewer mismatches in the first half, to get full length matches
+        const CRandom::TValue kMismatchRate = i < kLength/2 ? 60 : 15;
+        query[i] = subject[i] = (Uint1) random.GetRand(0, 3);
+        if (random.GetRand(0, 39) == 0) {
+            query[i] = kAmbiguity;
+        } else if (random.GetRand(0, kMismatchRate) == 0) {
+            subject[i] = (subject[i] + random.GetRand(1, 3)) & 3;
+        }
+    }
+
+    Uint1* buf = (Uint1*) calloc(kLength + 2, sizeof(Uint1));
+    memcpy(buf + 1, &query[0], kLength);
+    BOOST_REQUIRE(BlastSeqBlkNew(&m_pQuery) >= 0);
+    BlastSeqBlkSetSequence(m_pQuery, buf, kLength);
+
+    Uint1* packed = (Uint1*) calloc(kLength / COMPRESSION_RATIO + 8, 1);
+    for (Int4 i = 0; i < kLength; ++i) {
+        packed[i / COMPRESSION_RATIO] |= 
+            subject[i] << (2 * (3 - i % COMPRESSION_RATIO));
+    }
+    BOOST_REQUIRE(BlastSeqBlkNew(&m_pSubject) >= 0);
+    BlastSeqBlkSetCompressedSequence(m_pSubject, packed);
+    m_pSubject->length = kLength;
+
+    m_pQueryInfo = BlastQueryInfoNew(eBlastTypeBlastn, 1);
+    m_pQueryInfo->contexts[0].query_length = kLength;
+    m_pQueryInfo->contexts[1].query_offset = kLength;
+    m_pQueryInfo->contexts[1].is_valid = FALSE;
+
+    setupLookupTable(eNaLookupTable, kContigWordSize, false);
+    setupScoreBlk();
+    setupExtendWord(eDiagArray, 0, false);
+    m_pHitList = BLAST_InitHitListNew();
+
+    // word sizes covering one, two and three and a half 16-base blocks
+    const Int4 kWordSizes[] = { 24, 40, 64 };
+    BlastNaLookupTable* lut = (BlastNaLookupTable*) m_pLookup->lut;
+    for (size_t w = 0; w < ArraySize(kWordSizes); ++w) {
+        const Int4 kExtTo = kWordSizes[w] - kLutWordLength;
+        lut->word_length = kWordSizes[w];
+        lut->lut_word_length = kLutWordLength;
+        lut->scan_step = 1;     // not byte aligned, so BlastNaExtend is used
+        BlastChooseNaExtend(m_pLookup);
+        TNaExtendFunction extend = (TNaExtendFunction) lut->extend_callback;
+
+        // hits on the main diagonal and on a shifted one
+        for (Int4 diag = 0; diag <= 3; diag += 3) {
+            for (Int4 s_off = 0; s_off + diag + kWordSizes[w] <= kLength;
+                 ++s_off) {
+                const Int4 q_off = s_off + diag;
+
+                Int4 left = 0;
+                while (left < min(kExtTo, s_off) &&
+                       query[q_off - left - 1] == subject[s_off - left - 1]) {
+                    ++left;
+                }
+                Int4 right = 0;
+                bool expected = true;
+                if (left < kExtTo) {
+                    if (s_off + kLutWordLength + kExtTo - left > kLength) {
+                        expected = false;
+                    } else {
+                        Int4 q = q_off + kLutWordLength;
+                        Int4 s = s_off + kLutWordLength;
+                        while (right < kExtTo - left &&
+                               query[q + right] == subject[s + right]) {
+                            ++right;
+                        }
+                        expected = left + right >= kExtTo;
+                    }
+                }
+
+                BlastOffsetPair offset_pair;
+                offset_pair.qs_offsets.q_off = q_off;
+                offset_pair.qs_offsets.s_off = s_off;
+                BlastInitHitListReset(m_pHitList);
+                int hits_extended = extend(&offset_pair, 1, m_pWordParams,
+                                    m_pLookup, m_pQuery, m_pSubject,
+                                    m_pScoreBlk->matrix->data, m_pQueryInfo,
+                                    m_pExtendWord, m_pHitList, kLength);
+                Blast_ExtendWordExit(m_pExtendWord, kLength);
+
+                BOOST_REQUIRE_EQUAL(expected ? 1 : 0, hits_extended);
+                BOOST_REQUIRE_EQUAL(expected ? 1 : 0, m_pHitList->total);
+                if (expected) {
+                    const BlastOffsetPair& hit =
+                        m_pHitList->init_hsp_array[0].offsets;
+                    BOOST_REQUIRE_EQUAL(q_off - left, (Int4)hit.qs_offsets.q_off);
+                    BOOST_REQUIRE_EQUAL(s_off - left, (Int4)hit.qs_offsets.s_off);
+                }
+            }
+        }
+    }
+}
+
+/// Packs four bases into the byte compared by the approximate ungapped
+/// extension; ambiguous query bases spill over just as they do there
+static Uint1 s_PackBases(const vector<Uint1>& seq, Int4 offset)
+{
+    return (Uint1) ((seq[offset] << 6) | (seq[offset + 1] << 4) |
+                    (seq[offset + 2] << 2) | seq[offset + 3]);
+}
+
+/// Base by base version of the approximate ungapped extension in
+/// na_ungapped.c, scoring four bases at a time on subject byte boundaries
+static void s_ApproxUngappedExtend(const vector<Uint1>& query,
+                                   const vector<Uint1>& subject,
+                                   Int4 q_off, Int4 s_off, Int4 s_end,
+                                   Int4 X, const Int4* score_table,
+                                   BlastUngappedData* data)
+{
+    const Int4 kQueryLength = (Int4) query.size();
+    const Int4 kSubjectLength = (Int4) subject.size();
+    const Int4 kShift = (COMPRESSION_RATIO - s_off % COMPRESSION_RATIO) %
+                        COMPRESSION_RATIO;
+    const Int4 q_ext = q_off + kShift;
+    const Int4 s_ext = s_off + kShift;
+    Int4 score = 0, sum = 0;
+
+    Int4 new_q = q_ext;
+    for (Int4 q = q_ext, s = s_ext; q >= COMPRESSION_RATIO &&
+         s >= COMPRESSION_RATIO; q -= COMPRESSION_RATIO,
+         s -= COMPRESSION_RATIO) {
+        sum += score_table[s_PackBases(query, q - COMPRESSION_RATIO) ^
+                           s_PackBases(subject, s - COMPRESSION_RATIO)];
+        if (sum > 0) {
+            new_q = q - COMPRESSION_RATIO;
+            score += sum;
+            sum = 0;
+        }
+        if (sum < X) {
+            break;
+        }
+    }
+    data->q_start = new_q;
+    data->s_start = s_ext - (q_ext - new_q);
+
+    sum = 0;
+    new_q = q_ext;
+    for (Int4 q = q_ext, s = s_ext; q + COMPRESSION_RATIO <= kQueryLength &&
+         s + COMPRESSION_RATIO <= kSubjectLength; q += COMPRESSION_RATIO,
+         s += COMPRESSION_RATIO) {
+        sum += score_table[s_PackBases(query, q) ^ s_PackBases(subject, s)];
+        if (sum > 0) {
+            new_q = q + COMPRESSION_RATIO - 1;
+            score += sum;
+            sum = 0;
+        }
+        if (sum < X) {
+            break;
+        }
+    }
+    data->score = score;
+    data->length = max(s_end - data->s_start, new_q - data->q_start + 1);
+}
+
+/// Compares approximate ungapped extensions, done 64 bases at a time
+/// where SIMD is available, with the scalar algorithm. Runs of matches
+/// ending in bursts of mismatches, and ambiguous query bases, make the
+/// extensions drop off at every position of a block, right after blocks
+/// without mismatches, or run into the ends of the sequences.
+BOOST_AUTO_TEST_CASE(testApproxUngappedExtension)
+{
+    const Int4 kLength = 3000;
+    const Int4 kWordSize = 24;
+    const Int4 kLutWordLength = 8;
+    const Uint1 kAmbiguity = 14;    // N in blastna
+    // the small dropoff lets extensions recover within a block after
+    // they dropped off
+    const Int4 kXDrops[] = { 5, 20, 45 };
+    CRandom random(31);
+
+    m_Offsets = NULL;
+    vector<Uint1> query(kLength), subject(kLength);
+    bool burst = true;
+    for (Int4 i = 0, run_end = 0; i < kLength; ++i) {
+        // short and long, nearly identical runs separated by bursts of
+        // mismatches
+        if (i == run_end) {
+            burst = !burst;
+            run_end += random.GetRand(1, burst || random.GetRand(0, 1) ?
+                                      40 : 400);
+        }
+        query[i] = subject[i] = (Uint1) random.GetRand(0, 3);
+        if (random.GetRand(0, 499) == 0) {
+            query[i] = kAmbiguity;
+        } else if (random.GetRand(0, burst ? 1 : 300) == 0) {
+            subject[i] = (subject[i] + random.GetRand(1, 3)) & 3;
+        }
+    }
+
+    Uint1* buf = (Uint1*) calloc(kLength + 2, sizeof(Uint1));
+    memcpy(buf + 1, &query[0], kLength);
+    BOOST_REQUIRE(BlastSeqBlkNew(&m_pQuery) >= 0);
+    BlastSeqBlkSetSequence(m_pQuery, buf, kLength);
+
+    Uint1* packed = (Uint1*) calloc(kLength / COMPRESSION_RATIO + 8, 1);
+    for (Int4 i = 0; i < kLength; ++i) {
+        packed[i / COMPRESSION_RATIO] |= 
+            subject[i] << (2 * (3 - i % COMPRESSION_RATIO));
+    }
+    BOOST_REQUIRE(BlastSeqBlkNew(&m_pSubject) >= 0);
+    BlastSeqBlkSetCompressedSequence(m_pSubject, packed);
+    m_pSubject->length = kLength;
+
+    m_pQueryInfo = BlastQueryInfoNew(eBlastTypeBlastn, 1);
+    m_pQueryInfo->contexts[0].query_length = kLength;
+    m_pQueryInfo->contexts[1].query_offset = kLength;
+    m_pQueryInfo->contexts[1].is_valid = FALSE;
+
+    setupLookupTable(eNaLookupTable, kContigWordSize, false);
+    setupScoreBlk();
+    setupExtendWord(eDiagArray, 0, true);
+    // save every extension and never replace it by the exact one
+    m_pWordParams->cutoffs[0].cutoff_score = 0;
+    m_pWordParams->cutoffs[0].reduced_nucl_cutoff_score = INT4_MAX;
+    m_pHitList = BLAST_InitHitListNew();
+
+    BlastNaLookupTable* lut = (BlastNaLookupTable*) m_pLookup->lut;
+    lut->word_length = kWordSize;
+    lut->lut_word_length = kLutWordLength;
+    lut->scan_step = 1;     // not byte aligned, so BlastNaExtend is used
+    BlastChooseNaExtend(m_pLookup);
+    TNaExtendFunction extend = (TNaExtendFunction) lut->extend_callback;
+
+    Int4 num_compared = 0, longest = 0;
+    for (size_t x = 0; x < ArraySize(kXDrops); ++x) {
+        m_pWordParams->cutoffs[0].x_dropoff = kXDrops[x];
+        for (Int4 diag = 0; diag <= 5; diag += 5) {
+            for (Int4 s_off = 0; s_off + diag + kWordSize <= kLength;
+                 ++s_off) {
+                BlastOffsetPair offset_pair;
+                offset_pair.qs_offsets.q_off = s_off + diag;
+                offset_pair.qs_offsets.s_off = s_off;
+                BlastInitHitListReset(m_pHitList);
+                int hits_extended = extend(&offset_pair, 1, m_pWordParams,
+                                    m_pLookup, m_pQuery, m_pSubject,
+                                    m_pScoreBlk->matrix->data, m_pQueryInfo,
+                                    m_pExtendWord, m_pHitList, kLength);
+                Blast_ExtendWordExit(m_pExtendWord, kLength);
+                if (hits_extended == 0) {
+                    continue;
+                }
+
+                BOOST_REQUIRE_EQUAL(1, m_pHitList->total);
+                const BlastInitHSP& hsp = m_pHitList->init_hsp_array[0];
+                BOOST_REQUIRE(hsp.ungapped_data != NULL);
+                const Int4 q_off = hsp.offsets.qs_offsets.q_off;
+                const Int4 hit_s_off = hsp.offsets.qs_offsets.s_off;
+
+                BlastUngappedData expected;
+                s_ApproxUngappedExtend(query, subject, q_off, hit_s_off,
+                                       hit_s_off + kWordSize, -kXDrops[x],
+                                       m_pWordParams->nucl_score_table,
+                                       &expected);
+                const BlastUngappedData* data = hsp.ungapped_data;
+                BOOST_REQUIRE_EQUAL(expected.q_start, data->q_start);
+                BOOST_REQUIRE_EQUAL(expected.s_start, data->s_start);
+                BOOST_REQUIRE_EQUAL(expected.length, data->length);
+                BOOST_REQUIRE_EQUAL(expected.score, data->score);
+                ++num_compared;
+                longest = max(longest, expected.length);
+            }
+        }
+    }
+    // enough extensions, some of them spanning many 64-base blocks
+    BOOST_REQUIRE(num_compared > 100);
+    BOOST_REQUIRE(longest > 1000);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 /*
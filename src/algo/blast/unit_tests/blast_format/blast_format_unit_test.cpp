@@ -56,6 +56,7 @@
 
 
 #include <algo/blast/format/build_archive.hpp>
+#include "../../../../app/blast/blast_app_util.hpp"
 
 #define NCBI_BOOST_NO_AUTO_TEST_MAIN
 #include <corelib/test_boost.hpp>
@@ -197,4 +198,110 @@ BOOST_AUTO_TEST_CASE(BlastAsyncFormatDuplicateThrow)
     formatThr->Join();
 }
 #endif // NCBI_THREADS
+
+BOOST_AUTO_TEST_CASE(BlastFormatPipelineIsSupported)
+{
+    BOOST_REQUIRE(CBlastFormatPipeline::IsSupported(
+                      CFormattingArgs::ePairwise, false, 2));
+    BOOST_REQUIRE(CBlastFormatPipeline::IsSupported(
+                      CFormattingArgs::eTabular, false, 8));
+    BOOST_REQUIRE(CBlastFormatPipeline::IsSupported(
+                      CFormattingArgs::eXml, false, 2));
+    // single threaded search
+    BOOST_REQUIRE( !CBlastFormatPipeline::IsSupported(
+                      CFormattingArgs::ePairwise, false, 1));
+    // remote search
+    BOOST_REQUIRE( !CBlastFormatPipeline::IsSupported(
+                      CFormattingArgs::ePairwise, true, 2));
+    // archive needs the search messages of each batch
+    BOOST_REQUIRE( !CBlastFormatPipeline::IsSupported(
+                      CFormattingArgs::eArchiveFormat, false, 2));
+}
+
+#ifdef NCBI_THREADS
+/// Query and results read from data/archive.asn for the format pipeline
+struct SPipelineTestData
+{
+    CRef<CScope> scope;
+    CRef<CSeq_id> query_id;
+    CRef<CBlastQueryVector> queries;
+    CRef<CSearchResultSet> results;
+    CRef<CLocalDbAdapter> db_adapter;
+    CBlastNucleotideOptionsHandle nucl_opts;
+
+    SPipelineTestData()
+        : nucl_opts(CBlastOptions::eBoth)
+    {
+        ifstream in("data/archive.asn");
+        CRemoteBlast rb(in);
+        rb.LoadFromArchive();
+
+        CRef<CBlast4_queries> q = rb.GetQueries();
+        const CBioseq& bs = q->GetBioseq_set().GetSeq_set().front()->GetSeq();
+
+        SDataLoaderConfig dlconfig("refseq_rna", false);
+        scope = CBlastScopeSource(dlconfig).NewScope();
+        scope->AddBioseq(bs);
+        CSearchDatabase target_db("refseq_rna",
+                                  CSearchDatabase::eBlastDbIsNucleotide);
+        db_adapter.Reset(new CLocalDbAdapter(target_db));
+
+        query_id.Reset(new CSeq_id);
+        query_id->Assign(*bs.GetFirstId());
+        CRef<CSeq_loc> loc(new CSeq_loc);
+        loc->SetWhole(*query_id);
+        queries.Reset(new CBlastQueryVector);
+        queries->push_back(CRef<CBlastSearchQuery>(
+                               new CBlastSearchQuery(*loc, *scope)));
+        results = rb.GetResultSet();
+    }
+};
+
+BOOST_AUTO_TEST_CASE(BlastFormatPipelineTest)
+{
+    SPipelineTestData data;
+    CNcbiOstrstream streamBuffer;
+    {{
+        CBlastFormat formatter(data.nucl_opts.GetOptions(), *data.db_adapter,
+                               CFormattingArgs::ePairwise, false,
+                               streamBuffer, 10, 10, *data.scope);
+        CBlastFormatPipeline pipeline(formatter, data.scope,
+                                      CFormattingArgs::ePairwise);
+        pipeline.Push(data.queries, data.results);
+        pipeline.Finish();
+    }}
+    string myReport = CNcbiOstrstreamToString(streamBuffer);
+
+    BOOST_REQUIRE(myReport.find("Query=") != std::string::npos);
+    // the query read from the archive is released after formatting
+    BOOST_REQUIRE( !data.scope->GetBioseqHandle(*data.query_id) );
+}
+
+/// Stream buffer failing all writes
+class CFailingStreambuf : public streambuf
+{
+protected:
+    virtual int_type overflow(int_type) { return traits_type::eof(); }
+};
+
+// An exception in the formatting thread is rethrown in the caller's thread.
+BOOST_AUTO_TEST_CASE(BlastFormatPipelineErrorRethrow)
+{
+    SPipelineTestData data;
+    CFailingStreambuf failing_buf;
+    CNcbiOstream out(&failing_buf);
+    CBlastFormat formatter(data.nucl_opts.GetOptions(), *data.db_adapter,
+                           CFormattingArgs::ePairwise, false,
+                           out, 10, 10, *data.scope);
+
+    CBlastFormatPipeline pipeline(formatter, data.scope,
+                                  CFormattingArgs::ePairwise);
+    pipeline.Push(data.queries, data.results);
+    // waits for the first batch, which fails to be written
+    BOOST_REQUIRE_THROW(pipeline.Push(data.queries, data.results),
+                        std::exception);
+    BOOST_REQUIRE_THROW(pipeline.Finish(), std::exception);
+}
+#endif // NCBI_THREADS
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -936,6 +936,187 @@ void QueryBatchCleanup()
 
 }
 
+CBlastFormatPipeline::CBlastFormatPipeline(CBlastFormat & formatter,
+                                           CRef<CScope> scope,
+                                           CFormattingArgs::EOutputFormat format_type)
+    : m_Formatter(formatter),
+      m_Scope(scope),
+      m_FormatType(format_type),
+      m_Busy(false),
+      m_Closed(false)
+{
+    m_Thread.Reset(new CFormatThread(*this));
+    m_Thread->Run();
+}
+
+CBlastFormatPipeline::~CBlastFormatPipeline()
+{
+    try {
+        x_Stop(true);
+    } catch (...) {}
+}
+
+bool
+CBlastFormatPipeline::IsSupported(CFormattingArgs::EOutputFormat format_type,
+                                  bool is_remote, int num_threads)
+{
+    // Archive output needs the search messages of each batch when the batch
+    // is written
+    return !is_remote && num_threads > 1 &&
+        format_type != CFormattingArgs::eArchiveFormat;
+}
+
+void
+CBlastFormatPipeline::Push(CRef<CBlastQueryVector> queries,
+                           CRef<CSearchResultSet> results)
+{
+    {
+        CFastMutexGuard guard(m_Mutex);
+        while ((m_Busy || !m_Queue.empty()) && !m_Error) {
+            m_QueueChanged.WaitForSignal(m_Mutex);
+        }
+    }
+    x_RethrowError();
+
+    // the formatting thread is idle now, and the caller does not search
+    x_ReleaseFormatted();
+
+    {
+        CFastMutexGuard guard(m_Mutex);
+        m_Queue.push_back(TBatch(queries, results));
+    }
+    m_QueueChanged.SignalAll();
+}
+
+void
+CBlastFormatPipeline::Finish()
+{
+    x_Stop(false);
+    x_RethrowError();
+    x_ReleaseFormatted();
+}
+
+void*
+CBlastFormatPipeline::CFormatThread::Main(void)
+{
+    try {
+        m_Pipeline.x_Run();
+    } catch (...) {
+        CFastMutexGuard guard(m_Pipeline.m_Mutex);
+        m_Pipeline.m_Error = std::current_exception();
+        m_Pipeline.m_Queue.clear();
+        m_Pipeline.m_Closed = true;
+    }
+    m_Pipeline.m_QueueChanged.SignalAll();
+    return NULL;
+}
+
+void
+CBlastFormatPipeline::x_Run()
+{
+    while (true) {
+        TBatch batch;
+        {
+            CFastMutexGuard guard(m_Mutex);
+            while (m_Queue.empty() && !m_Closed) {
+                m_QueueChanged.WaitForSignal(m_Mutex);
+            }
+            if (m_Queue.empty()) {
+                break;
+            }
+            batch = m_Queue.front();
+            m_Queue.pop_front();
+            m_Busy = true;
+        }
+
+        x_FormatBatch(batch);
+
+        {
+            CFastMutexGuard guard(m_Mutex);
+            m_Formatted.push_back(batch);
+            m_Busy = false;
+        }
+        m_QueueChanged.SignalAll();
+    }
+}
+
+void
+CBlastFormatPipeline::x_FormatBatch(const TBatch & batch)
+{
+    BlastFormatter_PreFetchSequenceData(*batch.second, m_Scope, m_FormatType);
+    ITERATE(CSearchResultSet, result, *batch.second) {
+        m_Formatter.PrintOneResultSet(**result, batch.first);
+    }
+}
+
+void
+CBlastFormatPipeline::x_ReleaseFormatted()
+{
+    deque<TBatch> formatted;
+    {
+        CFastMutexGuard guard(m_Mutex);
+        formatted.swap(m_Formatted);
+    }
+    // XML output keeps the scope data, see CBlastFormat::ResetScopeHistory
+    if (formatted.empty() || m_FormatType == CFormattingArgs::eXml) {
+        return;
+    }
+
+    // Queries read from FASTA were added to the scope as top level entries;
+    // those fetched by data loaders are released by ResetHistory
+    ITERATE(deque<TBatch>, batch, formatted) {
+        const CBlastQueryVector & queries = *batch->first;
+        for (CBlastQueryVector::size_type i = 0; i < queries.Size(); i++) {
+            const CSeq_id* id = queries.GetQuerySeqLoc(i)->GetId();
+            if ( !id ) {
+                continue;
+            }
+            try {
+                CBioseq_Handle bh = m_Scope->GetBioseqHandle(*id);
+                if (bh) {
+                    CSeq_entry_Handle seh = bh.GetTopLevelEntry();
+                    bh.Reset();
+                    m_Scope->RemoveTopLevelSeqEntry(seh);
+                }
+            } catch (const CException& e) {
+                _TRACE("Query " << id->AsFastaString() << " kept in scope: "
+                       << e.GetMsg());
+            }
+        }
+    }
+    m_Scope->ResetHistory();
+}
+
+void
+CBlastFormatPipeline::x_Stop(bool discard)
+{
+    {
+        CFastMutexGuard guard(m_Mutex);
+        if (discard) {
+            m_Queue.clear();
+        }
+        m_Closed = true;
+    }
+    m_QueueChanged.SignalAll();
+    if (m_Thread.NotEmpty()) {
+        m_Thread->Join();
+        m_Thread.Reset();
+    }
+}
+
+void
+CBlastFormatPipeline::x_RethrowError()
+{
+    std::exception_ptr error;
+    {
+        CFastMutexGuard guard(m_Mutex);
+        error = m_Error;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
 void LogQueryInfo(CBlastUsageReport & report, const CBlastInput & q_info)
 {
 	report.AddParam(CBlastUsageReport::eTotalQueryLength, q_info.GetTotalLengthProcessed());
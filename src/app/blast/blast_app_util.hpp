@@ -50,9 +50,13 @@
 #include <algo/blast/format/blastfmtutil.hpp>   // for CBlastFormatUtil
 #include <algo/blast/blastinput/blast_scope_src.hpp>    // for SDataLoaderConfig
 #include <algo/blast/api/blast_usage_report.hpp>
+#include <exception>
+#include <deque>
 
 BEGIN_NCBI_SCOPE
 
+class CBlastFormat;
+
 /// Class to mix batch size for BLAST runs
 class CBatchSizeMixer 
 {
@@ -328,6 +332,106 @@ void PrintErrorArchive(const CArgs & a, const list<CRef<CBlast4_error> > & msg);
 /// Clean up formatter scope and release
 void QueryBatchCleanup();
 
+/// Formats the results of query batches in a separate thread, so that the
+/// formatting of one batch overlaps with the search of the next one.
+///
+/// Batches are formatted in the order in which they are queued, one at a
+/// time; Push() blocks until the previous batch is formatted, so the
+/// memory used by results does not grow with the number of batches.
+/// Instead of resetting the whole scope after each batch (see
+/// CBlastFormat::ResetScopeHistory), which would drop the queries of the
+/// batch being searched, the query entries of a formatted batch are
+/// removed from the scope along with unused subject data.  This is done
+/// by the thread calling Push() and Finish(), between searches and while
+/// the formatting thread is idle, so the scope is never modified while
+/// it is used by a search or by the formatter.
+class CBlastFormatPipeline
+{
+public:
+    /// Constructor, starts the formatting thread
+    /// @param formatter Formatter used for all batches [in]
+    /// @param scope Scope holding queries and subjects [in]
+    /// @param format_type Output format [in]
+    CBlastFormatPipeline(CBlastFormat & formatter,
+                         CRef<objects::CScope> scope,
+                         blast::CFormattingArgs::EOutputFormat format_type);
+
+    /// Destructor, discards the batches not formatted yet and stops the
+    /// formatting thread
+    ~CBlastFormatPipeline();
+
+    /// Can the results be formatted in a separate thread?
+    /// @param format_type Output format [in]
+    /// @param is_remote Is the search run remotely? [in]
+    /// @param num_threads Number of threads requested for the search [in]
+    static bool IsSupported(blast::CFormattingArgs::EOutputFormat format_type,
+                            bool is_remote, int num_threads);
+
+    /// Queue the results of a query batch for formatting, after the
+    /// previous batch is formatted and its scope data released. Must be
+    /// called when no search is running. Rethrows any exception raised
+    /// while formatting a previous batch.
+    /// @param queries Queries of the batch [in]
+    /// @param results Results of the batch [in]
+    void Push(CRef<blast::CBlastQueryVector> queries,
+              CRef<blast::CSearchResultSet> results);
+
+    /// Wait until all queued batches are formatted, stop the formatting
+    /// thread and release the scope data of the formatted batches.
+    /// Rethrows any exception raised while formatting.
+    void Finish();
+
+private:
+    /// Queries and results of one batch
+    typedef pair< CRef<blast::CBlastQueryVector>,
+                  CRef<blast::CSearchResultSet> > TBatch;
+
+    /// The formatting thread
+    class CFormatThread : public CThread
+    {
+    public:
+        CFormatThread(CBlastFormatPipeline & pipeline) : m_Pipeline(pipeline) {}
+    protected:
+        virtual void* Main(void);
+    private:
+        CBlastFormatPipeline & m_Pipeline;
+    };
+
+    /// Format queued batches until the queue is closed
+    void x_Run();
+
+    /// Format one batch
+    void x_FormatBatch(const TBatch & batch);
+
+    /// Release the scope data of the formatted batches; called only when
+    /// neither the formatting thread nor a search uses the scope
+    void x_ReleaseFormatted();
+
+    /// Close the queue and wait for the formatting thread
+    /// @param discard Discard batches not formatted yet [in]
+    void x_Stop(bool discard);
+
+    /// Rethrow the exception raised in the formatting thread, if any
+    void x_RethrowError();
+
+    CBlastFormat & m_Formatter;
+    CRef<objects::CScope> m_Scope;
+    blast::CFormattingArgs::EOutputFormat m_FormatType;
+
+    deque<TBatch> m_Queue;
+    deque<TBatch> m_Formatted;
+    bool m_Busy;
+    bool m_Closed;
+    std::exception_ptr m_Error;
+    CFastMutex m_Mutex;
+    CConditionVariable m_QueueChanged;
+    CRef<CFormatThread> m_Thread;
+
+    /// Prohibit copy constructor and assignment operator
+    CBlastFormatPipeline(const CBlastFormatPipeline &);
+    CBlastFormatPipeline & operator=(const CBlastFormatPipeline &);
+};
+
 void LogQueryInfo(blast::CBlastUsageReport & report, const blast::CBlastInput & q_info);
 
 /// Log blast usage opts for rpsblast apps
@@ -274,7 +274,15 @@ int CBlastnApp::x_RunMTBySplitDB()
         }
 	BLAST_PROF_ADD( BATCH_SIZE, (int)input.GetBatchSize() );
 	BLAST_PROF_STOP( APP.PRE );
-        for (; !input.End(); formatter.ResetScopeHistory(), QueryBatchCleanup() ) {
+        // format the results of each batch while the next one is searched
+        unique_ptr<CBlastFormatPipeline> fmt_pipeline;
+        if (CBlastFormatPipeline::IsSupported(fmt_args->GetFormattedOutputChoice(),
+                                              m_CmdLineArgs->ExecuteRemotely(),
+                                              m_CmdLineArgs->GetNumThreads())) {
+            fmt_pipeline.reset(new CBlastFormatPipeline(formatter, scope,
+                                   fmt_args->GetFormattedOutputChoice()));
+        }
+        for (; !input.End(); QueryBatchCleanup()) {
 	    BLAST_PROF_START( APP.LOOP.PRE );
             CRef<CBlastQueryVector> query_batch(input.GetNextSeqBatch(*scope));
             CRef<IQueryFactory> queries(new CObjMgr_QueryFactory(*query_batch));
@@ -305,14 +313,24 @@ int CBlastnApp::x_RunMTBySplitDB()
                 formatter.WriteArchive(*queries, *m_OptsHndl, *results, 0, m_Bah.GetMessages());
                 m_Bah.ResetMessages();
             } else {
-                BlastFormatter_PreFetchSequenceData(*results, scope,
-                			                        fmt_args->GetFormattedOutputChoice());
-                ITERATE(CSearchResultSet, result, *results) {
-                    formatter.PrintOneResultSet(**result, query_batch);
+                if (fmt_pipeline) {
+                    fmt_pipeline->Push(query_batch, results);
+                } else {
+                    BlastFormatter_PreFetchSequenceData(*results, scope,
+                                                        fmt_args->GetFormattedOutputChoice());
+                    ITERATE(CSearchResultSet, result, *results) {
+                        formatter.PrintOneResultSet(**result, query_batch);
+                    }
                 }
             }
 	    BLAST_PROF_STOP( APP.LOOP.FMT );
 	    batch_num++;
+            if ( !fmt_pipeline ) {
+                formatter.ResetScopeHistory();
+            }
+        }
+        if (fmt_pipeline) {
+            fmt_pipeline->Finish();
         }
         BLAST_PROF_START( APP.POST );
         formatter.PrintEpilog(opt);
@@ -1426,6 +1426,8 @@ CNCActiveHandler::x_SendCopyPutCmd(void)
     m_CmdToSend += "\" \"";
     m_CmdToSend += GetDiagCtx()->GetSessionID();
     m_CmdToSend.append(1, '"');
+    if (m_BlobAccess->IsCurCompressed())
+        m_CmdToSend += " flags=" + NStr::UIntToString(fCompress);
     return &CNCActiveHandler::x_SendCmdToExecute;
 }
 
@@ -2305,6 +2307,8 @@ CNCActiveHandler::x_WriteBlobData(void)
             m_ErrMsg = "ERR:Blob data is corrupted";
             return &CNCActiveHandler::x_CloseCmdAndConn;
         }
+        if (m_BlobAccess->IsReadPending())
+            return NULL;
         if (m_ChunkSize < want_read)
             want_read = m_ChunkSize;
 
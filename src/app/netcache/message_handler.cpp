@@ -377,7 +377,10 @@ static CNCMessageHandler::SCommandDef s_CommandMap[] = {
           // Parameter is not empty only if command is issued as part of
           // quorum-related functionality, i.e. before client received
           // confirmation of blob writing.
-          { "sid",     eNSPT_Str,  eNSPA_Optional } } },
+          { "sid",     eNSPT_Str,  eNSPA_Optional },
+          // Combination of ENCUserFlags. Only fCompress is used: it's set
+          // when blob is stored compressed on the source server.
+          { "flags",   eNSPT_Int,  eNSPA_Optional } } },
     // Prolong blob lifetime. Command is issued only by other servers while
     // mirroring prolonged blobs.
     { "COPY_PROLONG",
@@ -1061,7 +1064,14 @@ static CNCMessageHandler::SCommandDef s_CommandMap[] = {
           // Version of the command. Field exists for protocol backwards
           // compatibility with previous versions of NC. In current NC this
           // version is always 1.
-          { "cmd_ver", eNSPT_Int,  eNSPA_Optional, "0" } } },
+          { "cmd_ver", eNSPT_Int,  eNSPA_Optional, "0" },
+          // Client IP and session ID. They are sent by other servers with
+          // the same meaning as in COPY_PUT.
+          { "ip",      eNSPT_Str,  fNSPA_Optional },
+          { "sid",     eNSPT_Str,  eNSPA_Optional },
+          // Combination of ENCUserFlags. Only fCompress is used: it's set
+          // when blob is stored compressed on the source server.
+          { "flags",   eNSPT_Int,  eNSPA_Optional } } },
     // Prolong the blob's life. This command is sent only by other NC servers
     // during synchronization session if some blob was prolonged on that server
     // and the same prolongation didn't happen on this server yet.
@@ -3432,6 +3442,8 @@ CNCMessageHandler::x_WriteBlobData(void)
             GetDiagCtx()->SetRequestStatus(eStatus_ServerError);
             return &CNCMessageHandler::x_CloseCmdAndConn;
         }
+        if (m_BlobAccess->IsReadPending())
+            return NULL;
         if (m_Size != Uint8(-1)  &&  m_Size < want_read)
             want_read = Uint4(m_Size);
 
@@ -4234,6 +4246,8 @@ CNCMessageHandler::x_DoCmd_Put(void)
     m_BlobAccess->SetBlobTTL(x_GetBlobTTL());
     m_BlobAccess->SetVersionTTL(0);
     m_BlobAccess->SetBlobVersion(0);
+    m_BlobAccess->SetCompressed(x_IsUserFlagSet(fCompress)
+                                ||  m_AppSetup->compress_blobs);
     if (!x_IsHttpMode()) {
         // on Put, client expects 'ready' status before sending blob data
         WriteText("OK:ID:").WriteText(m_NCBlobKey.RawKey()).WriteText("\n");
@@ -4465,6 +4479,8 @@ CNCMessageHandler::x_DoCmd_IC_Store(void)
     m_BlobAccess->SetBlobTTL(x_GetBlobTTL());
     m_BlobAccess->SetVersionTTL(m_AppSetup->ver_ttl);
     m_BlobAccess->SetBlobVersion(m_BlobVersion);
+    m_BlobAccess->SetCompressed(x_IsUserFlagSet(fCompress)
+                                ||  m_AppSetup->compress_blobs);
     // on Store, client expects 'ready' status before sending blob data
     WriteText("OK:\n");
     if (m_Size == 0) {
@@ -4635,6 +4651,8 @@ CNCMessageHandler::x_DoCmd_CopyPut(void)
     m_CopyBlobInfo->blob_ver = m_BlobVersion;
     bool need_read_blob = m_BlobAccess->ReplaceBlobInfo(*m_CopyBlobInfo);
     if (need_read_blob) {
+        // Mirror stores blob the same way as the server it's copied from
+        m_BlobAccess->SetCompressed(x_IsUserFlagSet(fCompress));
         // while receiving new data, redirect clients to "correct" server
         if (m_BlobAccess->IsBlobExists()) {
             m_BlobAccess->UpdateMetaInfo(m_CopyBlobInfo->create_server, m_CopyBlobInfo->create_time);
@@ -130,7 +130,9 @@ enum ENCUserFlags {
     /// Command does not update blob expiration time
     fNoProlong    = 1 <<  0,
     /// Command does not create blob if it does not exist
-    fNoCreate     = 1 <<  1
+    fNoCreate     = 1 <<  1,
+    /// Blob data is stored compressed
+    fCompress     = 1 <<  2
 };
 typedef Uint4 TNCUserFlags;
 
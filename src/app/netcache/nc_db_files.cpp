@@ -186,4 +186,30 @@ CNCDBIndexFile::UpdatePurgeData(const string& data)
     stmt.Execute();
 }
 
+Uint4
+CNCDBIndexFile::GetStorageFormat(void)
+{
+    const char* sql;
+    sql = "select " SETTINGS_VALUE
+           " from " SETTINGS_TABLENAME
+          " where " SETTINGS_NAME "='format'";
+
+    CSQLITE_Statement stmt(this, sql);
+    if (stmt.Step())
+        return Uint4(stmt.GetInt8(0));
+    return 0;
+}
+
+void
+CNCDBIndexFile::SetStorageFormat(Uint4 format)
+{
+    const char* sql;
+    sql = "insert or replace into " SETTINGS_TABLENAME
+          " values('format',?1)"; 
+
+    CSQLITE_Statement stmt(this, sql);
+    stmt.Bind(1, format);
+    stmt.Execute();
+}
+
 END_NCBI_SCOPE
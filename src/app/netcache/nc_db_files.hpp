@@ -74,6 +74,10 @@ public:
     string GetPurgeData(void);
     void UpdatePurgeData(const string& data);
 
+    /// Format version of the storage files, 0 if it was never saved.
+    Uint4 GetStorageFormat(void);
+    void SetStorageFormat(Uint4 format);
+
 private:
     CNCDBIndexFile(const CNCDBIndexFile&);
     CNCDBIndexFile& operator= (const CNCDBIndexFile&);
@@ -115,6 +115,8 @@ public:
     Uint2   map_size;
     Uint1   map_depth;
     bool    has_error;
+    /// Chunks of this version are compressed when written to database
+    bool    compressed;
 
     bool    is_cur_version;
     bool    meta_has_changed;
@@ -141,6 +143,10 @@ public:
     size_t  releasable_mem;
     size_t  releasing_mem;
     vector<char*> chunks;
+    /// Sizes of compressed data pointed to by chunks (0 if data in chunk is
+    /// not compressed). Filled only when compressed is true and changed
+    /// together with chunks under wb_mem_lock.
+    vector<Uint4> packed_sizes;
 
 
     SNCBlobVerData(CNCBlobVerManager* mgr);
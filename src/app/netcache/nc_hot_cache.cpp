@@ -0,0 +1,310 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "nc_pch.hpp"
+
+#include "nc_hot_cache.hpp"
+#include "nc_stat.hpp"
+
+#include <list>
+#include <unordered_map>
+
+
+BEGIN_NCBI_SCOPE
+
+
+/// Number of independently locked parts of the cache
+static const Uint4 kCntStripes = 64;
+/// Number of rows in frequency sketch
+static const Uint4 kSketchDepth = 4;
+/// Maximum value of frequency counter
+static const Uint1 kMaxFrequency = 15;
+/// Maximum number of blobs evicted to admit one new blob
+static const Uint4 kMaxVictims = 8;
+
+
+typedef list< CSrvRef<SNCHotBlob> > THotBlobsList;
+typedef unordered_map<string, THotBlobsList::iterator> THotBlobsIndex;
+
+/// Part of the cache containing blobs with keys of the same hash range.
+/// Besides blobs it keeps approximate counts of reads of all blobs
+/// (count-min sketch) which are periodically halved, so that blobs read
+/// long ago don't stay hot forever.
+struct SNCHotStripe
+{
+    CMiniMutex      lock;
+    /// Blobs in the order of use, most recently used first
+    THotBlobsList   lru;
+    THotBlobsIndex  index;
+    Uint8           size;
+    vector<Uint1>   sketch;
+    Uint4           cnt_samples;
+};
+
+
+static SNCHotStripe* s_Stripes = NULL;
+static Uint8 s_MaxSize = 0;
+static Uint8 s_StripeSize = 0;
+static Uint4 s_MaxBlobSize = 0;
+static Uint4 s_SketchWidth = 0;
+
+
+SNCHotBlob::SNCHotBlob(const string& key_, const SNCBlobVerData* ver_data,
+                       const char* blob_data)
+    : key(key_),
+      create_time(ver_data->create_time),
+      create_server(ver_data->create_server),
+      create_id(ver_data->create_id),
+      size(Uint4(ver_data->size))
+{
+    data = new char[size];
+    memcpy(data, blob_data, size);
+}
+
+SNCHotBlob::~SNCHotBlob(void)
+{
+    delete [] data;
+}
+
+bool
+SNCHotBlob::IsVersionOf(const SNCBlobVerData* ver_data) const
+{
+    return create_time == ver_data->create_time
+           &&  create_server == ver_data->create_server
+           &&  create_id == ver_data->create_id
+           &&  size == ver_data->size;
+}
+
+
+static inline Uint8
+s_HashKey(const string& key)
+{
+    return Uint8(hash<string>()(key)) * NCBI_CONST_UINT8(0x9E3779B97F4A7C15);
+}
+
+static inline SNCHotStripe&
+s_GetStripe(Uint8 key_hash)
+{
+    return s_Stripes[Uint4(key_hash >> 58) % kCntStripes];
+}
+
+static inline Uint4
+s_SketchIndex(Uint8 key_hash, Uint4 row)
+{
+    Uint4 h1 = Uint4(key_hash);
+    Uint4 h2 = Uint4(key_hash >> 32) | 1;
+    return row * s_SketchWidth + ((h1 + row * h2) & (s_SketchWidth - 1));
+}
+
+static Uint1
+s_GetFrequency(SNCHotStripe& stripe, Uint8 key_hash)
+{
+    Uint1 freq = kMaxFrequency;
+    for (Uint4 row = 0; row < kSketchDepth; ++row)
+        freq = min(freq, stripe.sketch[s_SketchIndex(key_hash, row)]);
+    return freq;
+}
+
+static void
+s_AddFrequency(SNCHotStripe& stripe, Uint8 key_hash)
+{
+    for (Uint4 row = 0; row < kSketchDepth; ++row) {
+        Uint1& cnt = stripe.sketch[s_SketchIndex(key_hash, row)];
+        if (cnt < kMaxFrequency)
+            ++cnt;
+    }
+    if (++stripe.cnt_samples >= 10 * s_SketchWidth) {
+        NON_CONST_ITERATE(vector<Uint1>, it, stripe.sketch) {
+            *it >>= 1;
+        }
+        stripe.cnt_samples = 0;
+    }
+}
+
+static void
+s_RemoveBlob(SNCHotStripe& stripe, THotBlobsIndex::iterator it_idx)
+{
+    THotBlobsList::iterator it_blob = it_idx->second;
+    stripe.size -= (*it_blob)->size;
+    stripe.index.erase(it_idx);
+    stripe.lru.erase(it_blob);
+}
+
+/// Check if blob should replace the least recently used blobs in the stripe
+static bool
+s_CanAdmit(SNCHotStripe& stripe, Uint8 key_hash, Uint4 size)
+{
+    if (stripe.size + size <= s_StripeSize)
+        return true;
+
+    Uint1 freq = s_GetFrequency(stripe, key_hash);
+    Uint8 free_size = s_StripeSize - stripe.size;
+    Uint4 cnt_victims = 0;
+    THotBlobsList::reverse_iterator it = stripe.lru.rbegin();
+    for (; free_size < size; ++it) {
+        if (it == stripe.lru.rend()  ||  ++cnt_victims > kMaxVictims)
+            return false;
+        const SNCHotBlob* victim = *it;
+        if (s_GetFrequency(stripe, s_HashKey(victim->key)) >= freq)
+            return false;
+        free_size += victim->size;
+    }
+    return true;
+}
+
+
+void
+CNCHotBlobCache::Initialize(Uint8 max_size, Uint4 max_blob_size)
+{
+    if (max_size == 0)
+        return;
+
+    s_MaxSize = max_size;
+    s_StripeSize = max_size / kCntStripes;
+    s_MaxBlobSize = Uint4(min(Uint8(max_blob_size), s_StripeSize));
+    // Roughly one counter per blob that can fit in the stripe
+    s_SketchWidth = 256;
+    while (s_SketchWidth < 65536
+           &&  s_SketchWidth < s_StripeSize / max(s_MaxBlobSize / 4, Uint4(1)))
+    {
+        s_SketchWidth <<= 1;
+    }
+    s_Stripes = new SNCHotStripe[kCntStripes];
+    for (Uint4 i = 0; i < kCntStripes; ++i) {
+        s_Stripes[i].size = 0;
+        s_Stripes[i].sketch.resize(kSketchDepth * s_SketchWidth, 0);
+        s_Stripes[i].cnt_samples = 0;
+    }
+}
+
+bool
+CNCHotBlobCache::IsCacheable(const SNCBlobVerData* ver_data)
+{
+    return s_Stripes  &&  ver_data->size != 0
+           &&  ver_data->size <= s_MaxBlobSize
+           &&  ver_data->size <= ver_data->chunk_size;
+}
+
+CSrvRef<SNCHotBlob>
+CNCHotBlobCache::Find(const string& key, const SNCBlobVerData* ver_data)
+{
+    CSrvRef<SNCHotBlob> blob;
+    Uint8 key_hash = s_HashKey(key);
+    SNCHotStripe& stripe = s_GetStripe(key_hash);
+
+    stripe.lock.Lock();
+    s_AddFrequency(stripe, key_hash);
+    THotBlobsIndex::iterator it_idx = stripe.index.find(key);
+    if (it_idx != stripe.index.end()) {
+        THotBlobsList::iterator it_blob = it_idx->second;
+        if ((*it_blob)->IsVersionOf(ver_data)) {
+            blob = *it_blob;
+            stripe.lru.splice(stripe.lru.begin(), stripe.lru, it_blob);
+        }
+        else {
+            // Version was changed and invalidation didn't happen yet
+            s_RemoveBlob(stripe, it_idx);
+        }
+    }
+    stripe.lock.Unlock();
+
+    CNCStat::HotCacheRead(blob.NotNull());
+    return blob;
+}
+
+void
+CNCHotBlobCache::Add(const string& key, const SNCBlobVerData* ver_data,
+                     const char* data)
+{
+    Uint8 key_hash = s_HashKey(key);
+    SNCHotStripe& stripe = s_GetStripe(key_hash);
+    Uint4 size = Uint4(ver_data->size);
+
+    stripe.lock.Lock();
+    bool can_admit = s_CanAdmit(stripe, key_hash, size);
+    stripe.lock.Unlock();
+    CNCStat::HotCacheAdmit(can_admit);
+    if (!can_admit)
+        return;
+
+    // Data can be in database file and reading of it can be long,
+    // so it's copied without the lock.
+    CSrvRef<SNCHotBlob> blob(new SNCHotBlob(key, ver_data, data));
+
+    stripe.lock.Lock();
+    THotBlobsIndex::iterator it_idx = stripe.index.find(key);
+    if (it_idx != stripe.index.end())
+        s_RemoveBlob(stripe, it_idx);
+    while (stripe.size + size > s_StripeSize)
+        s_RemoveBlob(stripe, stripe.index.find(stripe.lru.back()->key));
+    stripe.lru.push_front(blob);
+    stripe.index[key] = stripe.lru.begin();
+    stripe.size += size;
+    stripe.lock.Unlock();
+}
+
+void
+CNCHotBlobCache::Invalidate(const string& key)
+{
+    if (!s_Stripes)
+        return;
+
+    Uint8 key_hash = s_HashKey(key);
+    SNCHotStripe& stripe = s_GetStripe(key_hash);
+    stripe.lock.Lock();
+    THotBlobsIndex::iterator it_idx = stripe.index.find(key);
+    if (it_idx != stripe.index.end())
+        s_RemoveBlob(stripe, it_idx);
+    stripe.lock.Unlock();
+}
+
+void
+CNCHotBlobCache::ReadState(SNCStateStat& state)
+{
+    state.hot_size = 0;
+    state.hot_blobs = 0;
+    if (!s_Stripes)
+        return;
+
+    for (Uint4 i = 0; i < kCntStripes; ++i) {
+        SNCHotStripe& stripe = s_Stripes[i];
+        stripe.lock.Lock();
+        state.hot_size += stripe.size;
+        state.hot_blobs += stripe.index.size();
+        stripe.lock.Unlock();
+    }
+}
+
+void
+CNCHotBlobCache::WriteSetup(CSrvSocketTask& task)
+{
+    string is("\": "), eol(",\n\"");
+    task.WriteText(eol).WriteText("hot_cache_size"         ).WriteText(is ).WriteNumber( s_MaxSize);
+    task.WriteText(eol).WriteText("hot_cache_max_blob_size").WriteText(is ).WriteNumber( s_MaxBlobSize);
+}
+
+
+END_NCBI_SCOPE
@@ -0,0 +1,98 @@
+#ifndef NETCACHE__NC_HOT_CACHE__HPP
+#define NETCACHE__NC_HOT_CACHE__HPP
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description: In-memory cache of frequently read small blobs.
+ *
+ * Data of small blobs that are read often is copied out of database files,
+ * so that reading them doesn't depend on whether the file pages are still
+ * in page cache. Blobs are admitted into the cache only if they are read
+ * more often than the blobs that would have to be evicted for them.
+ */
+
+#include "nc_db_info.hpp"
+
+
+BEGIN_NCBI_SCOPE
+
+
+struct SNCStateStat;
+
+
+/// Copy of blob's data kept in hot cache. Data stays valid while
+/// somebody holds a reference, even if the blob is evicted from the cache.
+struct SNCHotBlob : public CObject
+{
+    string  key;
+    Uint8   create_time;
+    Uint8   create_server;
+    Uint4   create_id;
+    Uint4   size;
+    char*   data;
+
+    SNCHotBlob(const string& key, const SNCBlobVerData* ver_data,
+               const char* blob_data);
+    virtual ~SNCHotBlob(void);
+
+    /// Check if this is a copy of the given blob version
+    bool IsVersionOf(const SNCBlobVerData* ver_data) const;
+
+private:
+    SNCHotBlob(const SNCHotBlob&);
+    SNCHotBlob& operator= (const SNCHotBlob&);
+};
+
+
+class CNCHotBlobCache
+{
+public:
+    /// Set the total size of data in the cache and the maximum size of one
+    /// blob. Cache with zero size is disabled.
+    static void Initialize(Uint8 max_size, Uint4 max_blob_size);
+    /// Check if version of a blob can be put into the cache
+    static bool IsCacheable(const SNCBlobVerData* ver_data);
+    /// Find copy of the blob version. Each call counts as access to the blob
+    /// used by admission policy.
+    static CSrvRef<SNCHotBlob> Find(const string& key,
+                                    const SNCBlobVerData* ver_data);
+    /// Offer data of blob version read from database to the cache
+    static void Add(const string& key, const SNCBlobVerData* ver_data,
+                    const char* data);
+    /// Remove blob from the cache. Called when current version of the blob
+    /// is changed or deleted.
+    static void Invalidate(const string& key);
+
+    static void ReadState(SNCStateStat& state);
+    static void WriteSetup(CSrvSocketTask& task);
+
+private:
+    CNCHotBlobCache(void);
+};
+
+
+END_NCBI_SCOPE
+
+#endif /* NETCACHE__NC_HOT_CACHE__HPP */
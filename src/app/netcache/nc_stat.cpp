@@ -251,6 +251,13 @@ CNCStat::x_ClearStats(void)
     m_PeerSynOps = 0;
     m_CntCleanedFiles = 0;
     m_CntFailedFiles = 0;
+    m_HotHits = 0;
+    m_HotMisses = 0;
+    m_HotAdmitted = 0;
+    m_HotRejected = 0;
+    m_PackRawSize = 0;
+    m_PackedSize = 0;
+    m_UnpackedSize = 0;
     m_CmdLens.Initialize();
     m_CmdsByName.clear();
     m_LensByStatus.clear();
@@ -274,6 +281,7 @@ CNCStat::x_ClearStats(void)
     m_WBMemSize.Initialize();
     m_WBReleasable.Initialize();
     m_WBReleasing.Initialize();
+    m_HotSize.Initialize();
 }
 
 void
@@ -360,6 +368,13 @@ CNCStat::x_AddStats(CNCStat* src_stat)
     m_PeerSynOps += src_stat->m_PeerSynOps;
     m_CntCleanedFiles += src_stat->m_CntCleanedFiles;
     m_CntFailedFiles += src_stat->m_CntFailedFiles;
+    m_HotHits += src_stat->m_HotHits;
+    m_HotMisses += src_stat->m_HotMisses;
+    m_HotAdmitted += src_stat->m_HotAdmitted;
+    m_HotRejected += src_stat->m_HotRejected;
+    m_PackRawSize += src_stat->m_PackRawSize;
+    m_PackedSize += src_stat->m_PackedSize;
+    m_UnpackedSize += src_stat->m_UnpackedSize;
     m_CheckedRecs.AddValues(src_stat->m_CheckedRecs);
     m_MovedRecs.AddValues(src_stat->m_MovedRecs);
     m_MovedSize.AddValues(src_stat->m_MovedSize);
@@ -375,6 +390,7 @@ CNCStat::x_AddStats(CNCStat* src_stat)
     m_WBMemSize.AddValues(src_stat->m_WBMemSize);
     m_WBReleasable.AddValues(src_stat->m_WBReleasable);
     m_WBReleasing.AddValues(src_stat->m_WBReleasing);
+    m_HotSize.AddValues(src_stat->m_HotSize);
 }
 
 void
@@ -590,6 +606,38 @@ CNCStat::DiskBlobWrite(Uint8 blob_size)
     stat->m_StatLock.Unlock();
 }
 
+void
+CNCStat::HotCacheRead(bool hit)
+{
+    if (hit)
+        AtomicAdd(s_Stat()->m_HotHits, Uint8(1));
+    else
+        AtomicAdd(s_Stat()->m_HotMisses, Uint8(1));
+}
+
+void
+CNCStat::HotCacheAdmit(bool admitted)
+{
+    if (admitted)
+        AtomicAdd(s_Stat()->m_HotAdmitted, Uint8(1));
+    else
+        AtomicAdd(s_Stat()->m_HotRejected, Uint8(1));
+}
+
+void
+CNCStat::ChunkPacked(size_t raw_size, size_t packed_size)
+{
+    CNCStat* stat = s_Stat();
+    AtomicAdd(stat->m_PackRawSize, Uint8(raw_size));
+    AtomicAdd(stat->m_PackedSize, Uint8(packed_size));
+}
+
+void
+CNCStat::ChunkUnpacked(size_t raw_size)
+{
+    AtomicAdd(s_Stat()->m_UnpackedSize, Uint8(raw_size));
+}
+
 void
 CNCStat::DBFileCleaned(bool success, Uint4 seen_recs,
                        Uint4 moved_recs, Uint4 moved_size)
@@ -623,6 +671,7 @@ CNCStat::SaveCurStateStat(const SNCStateStat& state)
     stat->m_WBMemSize.AddValue(state.wb_size);
     stat->m_WBReleasable.AddValue(state.wb_releasable);
     stat->m_WBReleasing.AddValue(state.wb_releasing);
+    stat->m_HotSize.AddValue(state.hot_size);
     stat->m_StatLock.Unlock();
 
     CSrvRef<CNCStat> stat_5s = GetStat(kStatPeriodName[0], false);
@@ -774,6 +823,16 @@ CNCStat::PrintToLogs(CTempString stat_name)
         .PrintParam("end_wb_releasing", m_EndState.wb_releasing)
         .PrintParam("avg_wb_releasing", m_WBReleasing.GetAverage())
         .PrintParam("max_wb_releasing", m_WBReleasing.GetMaximum());
+    diag.PrintParam("end_hot_size", m_EndState.hot_size)
+        .PrintParam("end_hot_blobs", m_EndState.hot_blobs)
+        .PrintParam("avg_hot_size", m_HotSize.GetAverage())
+        .PrintParam("hot_hits", m_HotHits)
+        .PrintParam("hot_misses", m_HotMisses)
+        .PrintParam("hot_admitted", m_HotAdmitted)
+        .PrintParam("hot_rejected", m_HotRejected);
+    diag.PrintParam("pack_raw_size", m_PackRawSize)
+        .PrintParam("packed_size", m_PackedSize)
+        .PrintParam("unpacked_size", m_UnpackedSize);
     if (m_StartState.min_dead_time != 0) {
         t.Sec() = m_StartState.min_dead_time;
         t.Print(buf, CSrvTime::eFmtLogging);
@@ -854,6 +913,15 @@ void CNCStat::PrintState(CSrvSocketTask& task)
     task.WriteText(eol).WriteText("wb_releasing" ).WriteText(str).WriteText(iss)
                                       .WriteText(NStr::UInt8ToString_DataSize( m_EndState.wb_releasing)).WriteText("\"");
     task.WriteText(eol).WriteText("wb_releasing" ).WriteText(is ).WriteNumber( m_EndState.wb_releasing);
+    task.WriteText(eol).WriteText("hot_size"     ).WriteText(is ).WriteNumber( m_EndState.hot_size);
+    task.WriteText(eol).WriteText("hot_blobs"    ).WriteText(is ).WriteNumber( m_EndState.hot_blobs);
+    task.WriteText(eol).WriteText("hot_hits"     ).WriteText(is ).WriteNumber( m_HotHits);
+    task.WriteText(eol).WriteText("hot_misses"   ).WriteText(is ).WriteNumber( m_HotMisses);
+    task.WriteText(eol).WriteText("hot_admitted" ).WriteText(is ).WriteNumber( m_HotAdmitted);
+    task.WriteText(eol).WriteText("hot_rejected" ).WriteText(is ).WriteNumber( m_HotRejected);
+    task.WriteText(eol).WriteText("pack_raw_size").WriteText(is ).WriteNumber( m_PackRawSize);
+    task.WriteText(eol).WriteText("packed_size"  ).WriteText(is ).WriteNumber( m_PackedSize);
+    task.WriteText(eol).WriteText("unpacked_size").WriteText(is ).WriteNumber( m_UnpackedSize);
     
     task.WriteText(eol).WriteText("cnt_another_server_main" ).WriteText(is ).WriteNumber( m_EndState.cnt_another_server_main);
     task.WriteText(eol).WriteText("avg_tdiff_blobcopy" ).WriteText(is ).WriteNumber( m_EndState.avg_tdiff_blobcopy);
@@ -1005,6 +1073,17 @@ CNCStat::PrintToSocket(CSrvSocketTask* sock)
                     << g_ToSizeStr(m_WBMemSize.GetMaximum()) << ", releasable "
                     << g_ToSizeStr(m_WBReleasable.GetMaximum()) << ", releasing "
                     << g_ToSizeStr(m_WBReleasing.GetMaximum()) << endl;
+    proxy << "Hot cache - "
+                    << g_ToSizeStr(m_EndState.hot_size) << " in "
+                    << g_ToSmartStr(m_EndState.hot_blobs) << " blobs, "
+                    << g_ToSmartStr(m_HotHits) << " hits, "
+                    << g_ToSmartStr(m_HotMisses) << " misses, "
+                    << g_ToSmartStr(m_HotAdmitted) << " admitted, "
+                    << g_ToSmartStr(m_HotRejected) << " rejected" << endl;
+    proxy << "Compression - "
+                    << g_ToSizeStr(m_PackRawSize) << " packed to "
+                    << g_ToSizeStr(m_PackedSize) << ", "
+                    << g_ToSizeStr(m_UnpackedSize) << " unpacked" << endl;
     proxy << "Blob storage start - "
                     << m_StartState.cnt_another_server_main << " requests for alien blobs, "
                     << "blob update delay: "
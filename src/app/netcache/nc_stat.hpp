@@ -62,6 +62,8 @@ struct SNCStateStat
     size_t wb_size;
     size_t wb_releasable;
     size_t wb_releasing;
+    Uint8  hot_size;
+    Uint8  hot_blobs;
     Uint8  cnt_another_server_main;
     Uint8  avg_tdiff_blobcopy; // average time diff between blob creation time and the time it is sent to mirror
     Uint8  max_tdiff_blobcopy; // maximum time diff between blob creation time and the time it is sent to mirror
@@ -101,6 +103,10 @@ public:
     static void DiskDataWrite(size_t data_size);
     static void DiskDataRead(size_t data_size);
     static void DiskBlobWrite(Uint8 blob_size);
+    static void HotCacheRead(bool hit);
+    static void HotCacheAdmit(bool admitted);
+    static void ChunkPacked(size_t raw_size, size_t packed_size);
+    static void ChunkUnpacked(size_t raw_size);
     static void DBFileCleaned(bool success, Uint4 seen_recs,
                               Uint4 moved_recs, Uint4 moved_size);
     static void SaveCurStateStat(const SNCStateStat& state);
@@ -157,6 +163,13 @@ private:
     Uint8 m_PeerSynOps;
     Uint8 m_CntCleanedFiles;
     Uint8 m_CntFailedFiles;
+    Uint8 m_HotHits;
+    Uint8 m_HotMisses;
+    Uint8 m_HotAdmitted;
+    Uint8 m_HotRejected;
+    Uint8 m_PackRawSize;
+    Uint8 m_PackedSize;
+    Uint8 m_UnpackedSize;
     TSrvTimeTerm m_CmdLens;
     TCmdCountsMap m_CmdsByName;
     TStatusCmdLens m_LensByStatus;
@@ -176,6 +189,7 @@ private:
     CSrvStatTerm<size_t> m_WBMemSize;
     CSrvStatTerm<size_t> m_WBReleasable;
     CSrvStatTerm<size_t> m_WBReleasing;
+    CSrvStatTerm<Uint8> m_HotSize;
     unique_ptr<CSrvStat> m_SrvStat;
 };
 
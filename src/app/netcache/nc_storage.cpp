@@ -43,6 +43,8 @@
 #include "nc_stat.hpp"
 #include "logging.hpp"
 #include "peer_control.hpp"
+#include "nc_uring.hpp"
+#include "nc_hot_cache.hpp"
 
 
 #ifdef NCBI_OS_LINUX
@@ -91,6 +93,9 @@ static const char* kNCStorage_MinRecNoSaveParam = "min_rec_no_save_period";
 static const char* kNCStorage_FailedWriteSize   = "failed_write_blob_key_count";
 static const char* kNCStorage_MaxBlobSizeStore  = "max_blob_size_store";
 static const char* kNCStorage_WbMemRelease      = "task_priority_wb_memrelease";
+static const char* kNCStorage_URingDepthParam  = "io_uring_queue_depth";
+static const char* kNCStorage_HotSizeParam     = "hot_cache_size";
+static const char* kNCStorage_HotBlobSizeParam = "hot_cache_max_blob_size";
 
 
 // storage file type signatures
@@ -221,6 +226,11 @@ static int s_FlushTimePeriod = 0;
 static int s_MaxGarbagePct = 0;
 static int s_MinMoveLife     = 0;
 static int s_FailedMoveDelay = 0;
+/// Size of io_uring queue for reading chunks, 0 if io_uring is not used
+static Uint4 s_URingQueueDepth = 0;
+/// Size of in-memory cache of hot blobs and maximum size of blob in it
+static Uint8 s_HotCacheSize = 0;
+static Uint4 s_HotCacheBlobSize = 0;
 static Int8 s_MinDBSize     = 0;
 /// Name of guard file excluding several instances to run on the same
 /// database.
@@ -271,6 +281,9 @@ static TAllCacheBuckets s_AllCache;
 
 static EStopCause s_IsStopWrite = eNoStop;
 static bool s_CleanStart = false;
+/// Meta records keep per-blob flags (storage format 2 and later). In
+/// format 1 the flags byte was a reserved one and its value is undefined.
+static bool s_MetaFlags = false;
 static bool s_NeedSaveLogRecNo = false;
 static bool s_NeedSavePurgeData = false;
 static int s_WarnLimitOnPct = 0;
@@ -620,7 +633,13 @@ s_ReadStorageParams(void)
                                           kNCStorage_StartedFileName,
                                           s_Prefix);
     }
+    s_URingQueueDepth = Uint4(max(0, reg.GetInt(kNCStorage_RegSection,
+                                                kNCStorage_URingDepthParam, 0)));
     try {
+        s_HotCacheSize = NStr::StringToUInt8_DataSize(reg.GetString(
+                           kNCStorage_RegSection, kNCStorage_HotSizeParam, "0"));
+        s_HotCacheBlobSize = Uint4(NStr::StringToUInt8_DataSize(reg.GetString(
+                           kNCStorage_RegSection, kNCStorage_HotBlobSizeParam, "16 KB")));
         return s_ReadVariableParams(reg);
     }
     catch (CStringException& ex) {
@@ -803,6 +822,48 @@ delete_file:
     return false;
 }
 
+/// Format version of the storage files written by this server:
+/// 1 - meta records have a reserved byte after has_password;
+/// 2 - that byte holds EFileMetaFlags.
+/// Versions before 2 don't save the format in the index database, so older
+/// servers won't refuse to open a database of format 2 and will return
+/// compressed blobs as they are stored. Reinitialize the storage when
+/// downgrading.
+static const Uint4 kNCStorageFormat = 2;
+
+/// Check format of the storage files opened, save the current format for
+/// the new or empty storage.
+static bool
+s_CheckStorageFormat(void)
+{
+    try {
+        Uint4 format = s_IndexDB->GetStorageFormat();
+        if (format > kNCStorageFormat) {
+            SRV_LOG(Critical, "Storage " << s_Prefix << " at " << s_Path
+                              << " has format " << format
+                              << " unknown to this server (max supported is "
+                              << kNCStorageFormat << ")");
+            return false;
+        }
+        if (format < kNCStorageFormat  &&  !s_DBFiles->empty()) {
+            SRV_LOG(Warning, "Storage " << s_Prefix << " at " << s_Path
+                             << " has format " << (format == 0? 1: format)
+                             << ", blobs will be stored uncompressed until "
+                                "the storage is reinitialized");
+            s_MetaFlags = false;
+            return true;
+        }
+        if (format != kNCStorageFormat)
+            s_IndexDB->SetStorageFormat(kNCStorageFormat);
+    }
+    catch (CSQLITE_Exception& ex) {
+        SRV_LOG(Critical, "Cannot read or write storage format: " << ex);
+        return false;
+    }
+    s_MetaFlags = true;
+    return true;
+}
+
 /// Reinitialize database cleaning all data from it.
 /// Only database is cleaned, internal cache is left intact.
 static void
@@ -1307,6 +1368,8 @@ CNCBlobStorage::Initialize(bool do_reinit)
             return false;
         s_CleanStart = false;
     }
+    if (!s_CheckStorageFormat())
+        return false;
 
     for (Uint2 i = 1; i <= CNCDistributionConf::GetCntTimeBuckets(); ++i) {
         s_BucketsCache[i] = new SBucketCache();
@@ -1336,12 +1399,17 @@ CNCBlobStorage::Initialize(bool do_reinit)
     CBlobCacher* cacher = new CBlobCacher();
     cacher->SetRunnable();
 
+    if (s_URingQueueDepth != 0)
+        CNCURing::Initialize(s_URingQueueDepth);
+    CNCHotBlobCache::Initialize(s_HotCacheSize, s_HotCacheBlobSize);
+
     return true;
 }
 
 void
 CNCBlobStorage::Finalize(void)
 {
+    CNCURing::Finalize();
     s_IndexDB.reset();
 
     s_UnlockInstanceGuard();
@@ -1395,6 +1463,8 @@ void CNCBlobStorage::WriteSetup(CSrvSocketTask& task)
     task.WriteText(eol).WriteText("write_back_failed_delay"   ).WriteText(is ).WriteNumber( GetWBFailedWriteDelay());
     task.WriteText(eol).WriteText(kNCStorage_WbMemRelease).WriteText(is).WriteNumber(s_TaskPriorityWbMemRelease);
     task.WriteText(eol).WriteText(kNCStorage_FailedWriteSize  ).WriteText(is ).WriteNumber( CNCBlobAccessor::GetFailedWriteCount());
+    task.WriteText(eol).WriteText(kNCStorage_URingDepthParam  ).WriteText(is ).WriteNumber( s_URingQueueDepth);
+    CNCHotBlobCache::WriteSetup(task);
 }
 
 void CNCBlobStorage::WriteEnvInfo(CSrvSocketTask& task)
@@ -1408,6 +1478,7 @@ void CNCBlobStorage::WriteEnvInfo(CSrvSocketTask& task)
     task.WriteText(eol).WriteText("DBgarbage"    ).WriteText(iss).WriteText(NStr::UInt8ToString_DataSize(s_GarbageSize)).WriteText(eos);
     task.WriteText(eol).WriteText("diskfreespace").WriteText(iss).WriteText(NStr::UInt8ToString_DataSize(GetDiskFree())).WriteText(eos);
     task.WriteText(eol).WriteText("IsStopWrite").WriteText( is).WriteNumber( (int)s_IsStopWrite);
+    CNCURing::WriteEnvInfo(task);
 }
 
 void CNCBlobStorage::WriteBlobStat(CSrvSocketTask& task)
@@ -2075,6 +2146,8 @@ CNCAlerts::Register(CNCAlerts::eDebugReadBlobInfoFailed2, "ReadBlobInfo: ind_rec
     ver_data->create_id = meta_rec->create_id;
     ver_data->create_server = meta_rec->create_server;
     ver_data->data_coord = ind_rec->chain_coord;
+    ver_data->compressed = s_MetaFlags
+                           &&  (meta_rec->flags & fMetaCompressed) != 0;
 
     ver_data->map_depth = s_CalcMapDepth(ver_data->size,
                                          ver_data->chunk_size,
@@ -2289,6 +2362,8 @@ cout << "WriteBlobInfo:" << " coord = " << meta_ind->chain_coord.file_id
     meta_rec->ver_expire = ver_data->ver_expire;
     meta_rec->map_size = ver_data->map_size;
     meta_rec->chunk_size = ver_data->chunk_size;
+    if (s_MetaFlags)
+        meta_rec->flags = ver_data->compressed? fMetaCompressed: 0;
     char* key_data = meta_rec->key_data;
     if (ver_data->password.empty()) {
         meta_rec->has_password = 0;
@@ -2458,7 +2533,9 @@ CNCBlobStorage::ReadChunkData(SNCBlobVerData* ver_data,
                               SNCChunkMaps* maps,
                               Uint8 chunk_num,
                               char*& buffer,
-                              Uint4& buf_size)
+                              Uint4& buf_size,
+                              CSrvTask* waiter,
+                              Uint1* read_state)
 {
     Uint2 map_idx[kNCMaxBlobMapsDepth] = {0};
     Uint1 cur_index = 0;
@@ -2563,6 +2640,18 @@ CNCAlerts::Register(CNCAlerts::eDebugReadChunkData4, "ReadChunkData: data_inf");
     }
     */
     SFileChunkDataRec* data_rec = s_CalcChunkAddress(data_file, data_ind);
+    if (waiter
+        &&  !CNCURing::StartRead(data_file->fd,
+                                 (char*)data_rec - data_file->file_map,
+                                 (char*)data_rec, data_ind->rec_size,
+                                 waiter, read_state))
+    {
+        // waiter will be woken up when data is in memory and will call
+        // this method again
+        buffer = NULL;
+        buf_size = 0;
+        return true;
+    }
     if (data_rec->chunk_num != chunk_num  ||  data_rec->chunk_idx != map_idx[0])
     {
         SRV_LOG(Critical, "File " << data_file->file_name
@@ -2796,6 +2885,12 @@ bool CNCBlobStorage::IsAbandoned(void)
     return s_AbandonDB;
 }
 
+bool
+CNCBlobStorage::CanStoreCompressed(void)
+{
+    return s_MetaFlags;
+}
+
 bool
 CNCBlobStorage::IsDraining(void)
 {
@@ -117,6 +117,9 @@ public:
     static bool IsDraining(void);
     static void AbandonDB(void);
     static bool IsAbandoned(void);
+    /// Whether blobs can be stored compressed, i.e. whether the storage
+    /// format keeps per-blob flags in meta records.
+    static bool CanStoreCompressed(void);
 
     static string PrintablePassword(const string& pass);
     /// Acquire access to the blob identified by key, subkey and version
@@ -164,11 +167,18 @@ public:
     static void DeleteBlobInfo(const SNCBlobVerData* ver_data,
                                SNCChunkMaps* maps);
 
+    /// Get pointer to the data of blob's chunk. If waiter is given and the
+    /// data is not in memory yet, then reading of it is started, buffer is
+    /// set to NULL and waiter will be made runnable when read is finished.
+    /// read_state receives the state of the read (see ENCURingReadState)
+    /// and must be given together with waiter.
     static bool ReadChunkData(SNCBlobVerData* ver_data,
                               SNCChunkMaps* maps,
                               Uint8 chunk_num,
                               char*& buffer,
-                              Uint4& buf_size);
+                              Uint4& buf_size,
+                              CSrvTask* waiter = NULL,
+                              Uint1* read_state = NULL);
     static char* WriteChunkData(SNCBlobVerData* ver_data,
                                 SNCChunkMaps* maps,
                                 SNCCacheData* cache_data,
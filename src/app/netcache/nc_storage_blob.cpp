@@ -35,8 +35,13 @@
 #include "nc_storage.hpp"
 #include "storage_types.hpp"
 #include "nc_stat.hpp"
+#include "nc_uring.hpp"
 #include <set>
 
+#ifdef HAVE_LIBZSTD
+#  include <zstd.h>
+#endif
+
 BEGIN_NCBI_SCOPE
 
 struct SWriteBackData
@@ -47,6 +52,9 @@ struct SWriteBackData
     size_t releasing_size;
     vector<SNCBlobVerData*> *to_add_list;
     vector<SNCBlobVerData*> *to_del_list;
+    /// Buffer for compressing chunks written by this thread, allocated on
+    /// first use.
+    char* pack_mem;
 
     SWriteBackData(void);
 };
@@ -183,7 +191,41 @@ s_GetWBData(void)
 static inline size_t
 s_CalcVerDataSize(SNCBlobVerData* ver_data)
 {
-   return sizeof(*ver_data) + ver_data->chunks.capacity() * sizeof(char*);
+   return sizeof(*ver_data) + ver_data->chunks.capacity() * sizeof(char*)
+                            + ver_data->packed_sizes.capacity() * sizeof(Uint4);
+}
+
+/// Compression level of blobs' chunks. Fastest one is used because chunks
+/// are compressed by write-back and read by clients on every access.
+static const int kNCChunkPackLevel = 1;
+
+/// Compress chunk data into buffer of size src_size. Return size of
+/// compressed data or 0 if data cannot be made smaller.
+static Uint4
+s_PackChunk(const char* src, Uint4 src_size, char* dst)
+{
+#ifdef HAVE_LIBZSTD
+    size_t res = ZSTD_compress(dst, src_size - 1, src, src_size,
+                               kNCChunkPackLevel);
+    if (!ZSTD_isError(res))
+        return Uint4(res);
+#endif
+    return 0;
+}
+
+/// Decompress chunk data into buffer of size dst_size. Return false if data
+/// is corrupted or doesn't decompress to exactly dst_size bytes.
+static bool
+s_UnpackChunk(const char* src, Uint4 src_size, char* dst, Uint4 dst_size)
+{
+#ifdef HAVE_LIBZSTD
+    size_t res = ZSTD_decompress(dst, dst_size, src, src_size);
+    return !ZSTD_isError(res)  &&  res == dst_size;
+#else
+    SRV_LOG(Critical, "Blob chunk is compressed but NetCache is built "
+                      "without zstd library");
+    return false;
+#endif
 }
 
 static size_t
@@ -454,7 +496,8 @@ s_ProcessWBAddDel(Uint4 was_del_size)
 SWriteBackData::SWriteBackData(void)
     : cur_size(0),
       releasable_size(0),
-      releasing_size(0)
+      releasing_size(0),
+      pack_mem(NULL)
 {
     to_add_list = new vector<SNCBlobVerData*>;
     to_del_list = new vector<SNCBlobVerData*>;
@@ -607,6 +650,7 @@ CNCBlobVerManager::x_DeleteCurVersion(void)
     m_CacheData->dead_time = 0;
     CNCBlobStorage::ChangeCacheDeadTime(m_CacheData);
     m_CacheData->expire = 0;
+    CNCHotBlobCache::Invalidate(m_Key);
     if (m_CurVersion) {
         m_CurVersion->SetNotCurrent();
         m_CurVersion.Reset();
@@ -949,6 +993,7 @@ CNCBlobVerManager::FinalizeWriting(SNCBlobVerData* ver_data)
         if (old_ver)
             old_ver->SetNotCurrent();
         m_CurVersion->SetCurrent();
+        CNCHotBlobCache::Invalidate(m_Key);
 
         SetRunnable();
     }
@@ -1025,6 +1070,12 @@ CCurVerReader::ExecuteSlice(TSrvThreadNum thr_num)
         CSrvRef<SNCBlobVerData> cur_ver(ver_data);
         m_VerMgr->DeleteVersion(ver_data);
     }
+    else if (ver_data->compressed) {
+        ver_data->packed_sizes.resize(ver_data->cnt_chunks, 0);
+        size_t add_meta_size = ver_data->packed_sizes.capacity() * sizeof(Uint4);
+        s_AddCurrentMem(add_meta_size);
+        ver_data->meta_mem += add_meta_size;
+    }
 
     FinishTransition();
 }
@@ -1081,6 +1132,7 @@ SNCBlobVerData::SNCBlobVerData(CNCBlobVerManager* mgr)
         map_size(0),
         map_depth(0),
         has_error(false),
+        compressed(false),
         is_cur_version(false),
         meta_has_changed(false),
         move_or_rewrite(false),
@@ -1303,16 +1355,31 @@ SNCBlobVerData::x_WriteCurChunk(char* write_mem, Uint4 write_size)
         need_stop_write = true;
         return true;
     }
+    char* pack_mem = NULL;
+    Uint4 pack_size = 0;
+    if (compressed) {
+        SWriteBackData* wb_data = s_GetWBData();
+        if (!wb_data->pack_mem)
+            wb_data->pack_mem = new char[kNCMaxBlobChunkSize];
+        pack_mem = wb_data->pack_mem;
+        pack_size = s_PackChunk(write_mem, write_size, pack_mem);
+    }
     char* new_mem = CNCBlobStorage::WriteChunkData(
                                         this, chunk_maps, mgr->GetCacheData(),
-                                        cur_chunk_num, write_mem, write_size);
+                                        cur_chunk_num,
+                                        pack_size? pack_mem: write_mem,
+                                        pack_size? pack_size: write_size);
     if (!new_mem) {
         RunAfter(s_WBFailedWriteDelay);
         return false;
     }
-    CNCStat::DiskDataWrite(write_size);
+    CNCStat::DiskDataWrite(pack_size? pack_size: write_size);
+    if (compressed)
+        CNCStat::ChunkPacked(write_size, pack_size? pack_size: write_size);
 
     wb_mem_lock.Lock();
+    if (compressed)
+        packed_sizes[cur_chunk_num] = pack_size;
     chunks[cur_chunk_num] = new_mem;
     ++cur_chunk_num;
     if (data_mem < write_size) {
@@ -1457,6 +1524,8 @@ SNCBlobVerData::AddChunkMem(char* mem, Uint4 mem_size)
     wb_mem_lock.Lock();
     size_t old_meta = s_CalcVerDataSize(this);
     chunks.push_back(mem);
+    if (compressed)
+        packed_sizes.push_back(0);
     ++cnt_chunks;
     size_t add_meta_size = s_CalcVerDataSize(this) - old_meta;
     if (add_meta_size != 0) {
@@ -1476,7 +1545,12 @@ CNCBlobAccessor::CNCBlobAccessor(void)
     : m_ChunkMaps(NULL),
       m_MetaInfoReady(false),
       m_WriteMemRequested(false),
-      m_Buffer(NULL)
+      m_ReadPending(false),
+      m_ReadState(eURingReadNone),
+      m_HotChecked(false),
+      m_HotAdd(false),
+      m_Buffer(NULL),
+      m_UnpackBuf(NULL)
 {
 #if __NC_TASKS_MONITOR
     m_TaskName = "CNCBlobAccessor";
@@ -1510,6 +1584,10 @@ CNCBlobAccessor::Prepare(const string& key,
     m_CurChunk      = 0;
     m_ChunkPos      = 0;
     m_SizeRead      = 0;
+    m_ReadPending   = false;
+    m_ReadState     = eURingReadNone;
+    m_HotChecked    = false;
+    m_HotAdd        = false;
 }
 
 void
@@ -1528,11 +1606,22 @@ CNCBlobAccessor::Deinitialize(void)
 {
     switch (m_AccessType) {
     case eNCReadData:
+        if (ACCESS_ONCE(m_ReadState) != eURingReadNone) {
+            CNCURing::CancelWait(m_Owner);
+            m_ReadState = eURingReadNone;
+        }
+        m_ReadPending = false;
+        m_HotBlob.Reset();
         if (m_ChunkMaps) {
             s_SubCurrentMem(s_CalcChunkMapsSize(m_CurData->map_size));
             delete m_ChunkMaps;
             m_ChunkMaps = NULL;
         }
+        if (m_UnpackBuf) {
+            s_SubCurrentMem(m_CurData->chunk_size);
+            delete [] m_UnpackBuf;
+            m_UnpackBuf = NULL;
+        }
         break;
     case eNCCreate:
     case eNCCopyCreate:
@@ -1616,22 +1705,70 @@ CNCBlobAccessor::GetReadMemSize(void)
     if (GetPosition() >= m_CurData->size) {
         SRV_FATAL("blob accessor broken");
     }
+    CSrvTask* waiter = m_Owner;
+    switch (ACCESS_ONCE(m_ReadState)) {
+    case eURingReadPending:
+        // Owner was woken up for some other reason, it will be woken up
+        // again when the read is finished.
+        m_ReadPending = true;
+        return 0;
+    case eURingReadDone:
+    case eURingReadFailed:
+        // The chunk was just read, or the read has failed and another one
+        // would fail too. Either way it's now touched synchronously.
+        waiter = NULL;
+        m_ReadState = eURingReadNone;
+        break;
+    }
+    m_ReadPending = false;
+    if (!m_HotChecked  &&  m_CurChunk == 0
+        &&  CNCHotBlobCache::IsCacheable(m_CurData))
+    {
+        m_HotChecked = true;
+        m_HotBlob = CNCHotBlobCache::Find(m_BlobKey, m_CurData);
+        m_HotAdd = m_HotBlob.IsNull();
+    }
+    if (m_HotBlob) {
+        m_Buffer = m_HotBlob->data;
+        m_ChunkSize = m_HotBlob->size;
+        return m_ChunkSize - m_ChunkPos;
+    }
     if (m_Buffer) {
         if (m_ChunkPos < m_ChunkSize) {
-            m_Buffer = m_CurData->chunks[m_CurChunk];
-            return m_ChunkSize - m_ChunkPos;
+            if (m_Buffer == m_UnpackBuf)
+                return m_ChunkSize - m_ChunkPos;
+            if (!m_CurData->compressed) {
+                m_Buffer = m_CurData->chunks[m_CurChunk];
+                return m_ChunkSize - m_ChunkPos;
+            }
+            // Chunk could be written to database and compressed since last
+            // read, so it's taken from the beginning.
+        }
+        else {
+            ++m_CurChunk;
+            m_ChunkPos = 0;
         }
-        ++m_CurChunk;
-        m_ChunkPos = 0;
     }
 
     Uint8 need_size = m_CurData->size - GetPosition() + m_ChunkPos;
     if (need_size > m_CurData->chunk_size)
         need_size = m_CurData->chunk_size;
 
-    m_Buffer = ACCESS_ONCE(m_CurData->chunks[m_CurChunk]);
+    Uint4 packed_size = 0;
+    if (m_CurData->compressed) {
+        m_CurData->wb_mem_lock.Lock();
+        m_Buffer = m_CurData->chunks[m_CurChunk];
+        packed_size = m_CurData->packed_sizes[m_CurChunk];
+        m_CurData->wb_mem_lock.Unlock();
+    }
+    else {
+        m_Buffer = ACCESS_ONCE(m_CurData->chunks[m_CurChunk]);
+    }
     if (m_Buffer) {
         m_ChunkSize = Uint4(need_size);
+        if (packed_size != 0  &&  !x_UnpackChunk(packed_size))
+            return 0;
+        x_AddToHotCache();
         return m_ChunkSize - m_ChunkPos;
     }
 
@@ -1640,27 +1777,83 @@ CNCBlobAccessor::GetReadMemSize(void)
         s_AddCurrentMem(s_CalcChunkMapsSize(m_CurData->map_size));
     }
     if (!CNCBlobStorage::ReadChunkData(m_CurData, m_ChunkMaps, m_CurChunk,
-                                       m_Buffer, m_ChunkSize))
+                                       m_Buffer, m_ChunkSize,
+                                       waiter, &m_ReadState))
     {
         x_DelCorruptedVersion();
         return 0;
     }
-    if (m_ChunkSize != need_size) {
-        x_DelCorruptedVersion();
+    if (!m_Buffer) {
+        // Owner will be woken up when chunk is in memory
+        m_ReadPending = true;
         return 0;
     }
+    if (m_ChunkSize != need_size) {
+        // Only compressed chunk can be smaller than its data
+        if (m_ChunkSize > need_size  ||  !m_CurData->compressed) {
+            x_DelCorruptedVersion();
+            return 0;
+        }
+        packed_size = m_ChunkSize;
+        m_ChunkSize = Uint4(need_size);
+    }
 
-    ACCESS_ONCE(m_CurData->chunks[m_CurChunk]) = m_Buffer;
+    if (m_CurData->compressed) {
+        m_CurData->wb_mem_lock.Lock();
+        m_CurData->chunks[m_CurChunk] = m_Buffer;
+        m_CurData->packed_sizes[m_CurChunk] = packed_size;
+        m_CurData->wb_mem_lock.Unlock();
+        if (packed_size != 0  &&  !x_UnpackChunk(packed_size))
+            return 0;
+    }
+    else {
+        ACCESS_ONCE(m_CurData->chunks[m_CurChunk]) = m_Buffer;
+    }
+    x_AddToHotCache();
     return m_ChunkSize - m_ChunkPos;
 }
 
+void
+CNCBlobAccessor::SetCompressed(bool value)
+{
+    x_CreateNewData();
+    m_NewData->compressed = value  &&  CNCBlobStorage::CanStoreCompressed();
+}
+
+bool
+CNCBlobAccessor::x_UnpackChunk(Uint4 packed_size)
+{
+    if (!m_UnpackBuf) {
+        m_UnpackBuf = new char[m_CurData->chunk_size];
+        s_AddCurrentMem(m_CurData->chunk_size);
+    }
+    if (!s_UnpackChunk(m_Buffer, packed_size, m_UnpackBuf, m_ChunkSize)) {
+        m_Buffer = NULL;
+        x_DelCorruptedVersion();
+        return false;
+    }
+    m_Buffer = m_UnpackBuf;
+    CNCStat::ChunkUnpacked(m_ChunkSize);
+    return true;
+}
+
+void
+CNCBlobAccessor::x_AddToHotCache(void)
+{
+    if (m_HotAdd) {
+        m_HotAdd = false;
+        CNCHotBlobCache::Add(m_BlobKey, m_CurData, m_Buffer);
+    }
+}
+
 void
 CNCBlobAccessor::MoveReadPos(Uint4 move_size)
 {
     m_ChunkPos += move_size;
     m_SizeRead += move_size;
-    if (m_CurData->cur_chunk_num > m_CurChunk
-        &&  m_Buffer == m_CurData->chunks[m_CurChunk])
+    if (m_Buffer == m_UnpackBuf
+        ||  (m_CurData->cur_chunk_num > m_CurChunk
+             &&  m_Buffer == m_CurData->chunks[m_CurChunk]))
     {
         CNCStat::DiskDataRead(move_size);
     }
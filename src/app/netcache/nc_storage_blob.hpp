@@ -30,6 +30,7 @@
 
 
 #include "nc_db_info.hpp"
+#include "nc_hot_cache.hpp"
 
 
 BEGIN_NCBI_SCOPE
@@ -133,6 +134,9 @@ public:
     void SetPosition(Uint8 pos);
     Uint8 GetPosition(void);
     Uint4 GetReadMemSize(void);
+    /// Check if GetReadMemSize() returned 0 because chunk is being read from
+    /// disk. Owner task will be made runnable when the data is in memory.
+    bool IsReadPending(void) const;
     const void* GetReadMemPtr(void);
     void MoveReadPos(Uint4 move_size);
     unsigned int GetCurBlobTTL(void) const;
@@ -166,6 +170,11 @@ public:
     Uint8 GetValidServer(void) const;
     string GetCurPassword(void) const;
     void SetPassword(CTempString password);
+    /// Request to store data of the new blob version compressed. Method can
+    /// be called only before writing of blob data is started. Data is
+    /// decompressed transparently when it's read.
+    void SetCompressed(bool value);
+    bool IsCurCompressed(void) const;
     bool ReplaceBlobInfo(const SNCBlobVerData& new_info);
 
     size_t GetWriteMemSize(void);
@@ -227,6 +236,8 @@ private:
 
     void x_CreateNewData(void);
     void x_DelCorruptedVersion(void);
+    void x_AddToHotCache(void);
+    bool x_UnpackChunk(Uint4 packed_size);
 
 
     /// Type of access requested for the blob
@@ -241,6 +252,14 @@ private:
     bool        m_HasError;
     bool        m_MetaInfoReady;
     bool        m_WriteMemRequested;
+    bool        m_ReadPending;
+    /// State of asynchronous read of current chunk (ENCURingReadState).
+    /// Changed by io_uring completion thread while read is in flight.
+    Uint1       m_ReadState;
+    /// Hot cache was already checked for the blob
+    bool        m_HotChecked;
+    /// Blob wasn't found in hot cache and should be offered to it
+    bool        m_HotAdd;
     Uint2       m_TimeBucket;
     Uint8       m_CurChunk;
     /// Current position of reading/writing inside blob's chunk
@@ -248,7 +267,10 @@ private:
     Uint4       m_ChunkSize;
     Uint8       m_SizeRead;
     char*       m_Buffer;
+    /// Buffer with decompressed data of current chunk
+    char*       m_UnpackBuf;
     CSrvTask*   m_Owner;
+    CSrvRef<SNCHotBlob> m_HotBlob;
 };
 
 
@@ -343,6 +365,12 @@ CNCBlobAccessor::IsMetaInfoReady(void)
     return m_MetaInfoReady;
 }
 
+inline bool
+CNCBlobAccessor::IsReadPending(void) const
+{
+    return m_ReadPending;
+}
+
 inline bool
 CNCBlobAccessor::IsBlobExists(void) const
 {
@@ -515,6 +543,12 @@ CNCBlobAccessor::SetBlobTTL(unsigned int ttl)
     m_NewData->ttl = ttl;
 }
 
+inline bool
+CNCBlobAccessor::IsCurCompressed(void) const
+{
+    return m_CurData->compressed;
+}
+
 inline void
 CNCBlobAccessor::SetBlobVersion(int ver)
 {
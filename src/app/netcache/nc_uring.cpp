@@ -0,0 +1,445 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ */
+
+#include "nc_pch.hpp"
+
+#include "nc_uring.hpp"
+
+#ifdef NCBI_OS_LINUX
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <sys/uio.h>
+# include <pthread.h>
+# include <unistd.h>
+# ifdef __NR_io_uring_setup
+#  include <linux/io_uring.h>
+#  define NC_USE_URING 1
+# endif
+#endif
+
+
+BEGIN_NCBI_SCOPE
+
+
+#ifdef NC_USE_URING
+
+static const size_t kPageSize = 4 * 1024;
+static const uintptr_t kPageAlignMask = ~uintptr_t(kPageSize - 1);
+/// Maximum number of pages occupied by one chunk record
+static const size_t kMaxReadPages = 16;
+/// user_data of the request stopping completion thread
+static const Uint8 kStopUserData = Uint8(-1);
+static const Uint4 kNoRequest = Uint4(-1);
+
+
+struct SNCURingRequest
+{
+    CSrvTask* task;
+    Uint1* state;
+    struct iovec iov;
+    Uint4 next_free;
+};
+
+
+static int s_RingFd = -1;
+static void* s_SQRing = MAP_FAILED;
+static size_t s_SQRingSize = 0;
+static void* s_CQRing = MAP_FAILED;
+static size_t s_CQRingSize = 0;
+static io_uring_sqe* s_SQEs = (io_uring_sqe*)MAP_FAILED;
+static size_t s_SQEsSize = 0;
+
+static unsigned* s_SQHead;
+static unsigned* s_SQTail;
+static unsigned* s_SQMask;
+static unsigned* s_SQArray;
+static unsigned* s_CQHead;
+static unsigned* s_CQTail;
+static unsigned* s_CQMask;
+static io_uring_cqe* s_CQEs;
+
+/// Lock for submission queue, requests and statistics
+static CMiniMutex s_URingLock;
+static SNCURingRequest* s_Requests = NULL;
+static Uint4 s_FreeRequest = kNoRequest;
+static pthread_t s_ComplThread;
+static bool s_Active = false;
+/// Destination of all reads. Data is needed in page cache only, so nobody
+/// reads the buffer and it can be shared by all requests.
+static char* s_SinkBuf = (char*)MAP_FAILED;
+static const size_t kSinkBufSize = kMaxReadPages * kPageSize;
+
+static Uint8 s_CntInMemory = 0;
+static Uint8 s_CntStarted = 0;
+static Uint8 s_CntFailed = 0;
+static Uint8 s_CntNoRequest = 0;
+static Uint4 s_CntInFlight = 0;
+static Uint4 s_MaxInFlight = 0;
+
+
+static inline int
+s_URingSetup(unsigned entries, io_uring_params* params)
+{
+    return int(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static inline int
+s_URingEnter(unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return int(syscall(__NR_io_uring_enter, s_RingFd, to_submit,
+                       min_complete, flags, NULL, 0));
+}
+
+static void
+s_CloseRing(void)
+{
+    if (s_SQEs != MAP_FAILED)
+        munmap(s_SQEs, s_SQEsSize);
+    if (s_CQRing != MAP_FAILED  &&  s_CQRing != s_SQRing)
+        munmap(s_CQRing, s_CQRingSize);
+    if (s_SQRing != MAP_FAILED)
+        munmap(s_SQRing, s_SQRingSize);
+    if (s_SinkBuf != MAP_FAILED)
+        munmap(s_SinkBuf, kSinkBufSize);
+    if (s_RingFd != -1)
+        close(s_RingFd);
+    s_SQEs = (io_uring_sqe*)MAP_FAILED;
+    s_CQRing = s_SQRing = MAP_FAILED;
+    s_SinkBuf = (char*)MAP_FAILED;
+    s_RingFd = -1;
+    delete [] s_Requests;
+    s_Requests = NULL;
+}
+
+/// Put new SQE into submission queue and submit it. Lock must be held.
+/// Returns FALSE if kernel didn't accept the SQE.
+static bool
+s_SubmitSQE(const io_uring_sqe& new_sqe)
+{
+    unsigned tail = *s_SQTail;
+    unsigned idx = tail & *s_SQMask;
+    s_SQEs[idx] = new_sqe;
+    s_SQArray[idx] = idx;
+    __atomic_store_n(s_SQTail, tail + 1, __ATOMIC_RELEASE);
+
+    int res;
+    do {
+        res = s_URingEnter(1, 0, 0);
+    }
+    while (res < 0  &&  errno == EINTR);
+
+    if (__atomic_load_n(s_SQHead, __ATOMIC_ACQUIRE) != tail + 1) {
+        // SQE was not consumed, so there will be no completion for it
+        __atomic_store_n(s_SQTail, tail, __ATOMIC_RELEASE);
+        return false;
+    }
+    return true;
+}
+
+static void*
+s_CompletionThreadMain(void*)
+{
+    bool stop = false;
+    while (!stop) {
+        int res = s_URingEnter(0, 1, IORING_ENTER_GETEVENTS);
+        if (res < 0  &&  errno != EINTR  &&  errno != EAGAIN) {
+            // This thread doesn't have server's logging structures, so the
+            // error is only counted. Don't spin on it.
+            AtomicAdd(s_CntFailed, Uint8(1));
+            usleep(1000);
+        }
+
+        s_URingLock.Lock();
+        unsigned head = *s_CQHead;
+        unsigned tail = __atomic_load_n(s_CQTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = s_CQEs[head & *s_CQMask];
+            if (cqe.user_data == kStopUserData) {
+                stop = true;
+                continue;
+            }
+            Uint4 req_idx = Uint4(cqe.user_data);
+            SNCURingRequest& req = s_Requests[req_idx];
+            if (cqe.res < 0)
+                ++s_CntFailed;
+            // State is set before task is woken up, so that the task reads
+            // data synchronously and doesn't start the same read again.
+            if (req.state) {
+                ACCESS_ONCE(*req.state) = Uint1(cqe.res < 0? eURingReadFailed
+                                                           : eURingReadDone);
+            }
+            if (req.task)
+                req.task->SetRunnable();
+            req.task = NULL;
+            req.state = NULL;
+            req.next_free = s_FreeRequest;
+            s_FreeRequest = req_idx;
+            --s_CntInFlight;
+        }
+        __atomic_store_n(s_CQHead, head, __ATOMIC_RELEASE);
+        s_URingLock.Unlock();
+    }
+    return NULL;
+}
+
+#endif /* NC_USE_URING */
+
+
+bool
+CNCURing::Initialize(Uint4 queue_depth)
+{
+#ifdef NC_USE_URING
+    if (queue_depth == 0)
+        return false;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    s_RingFd = s_URingSetup(queue_depth, &params);
+    if (s_RingFd < 0) {
+        SRV_LOG(Warning, "io_uring is not available, errno=" << errno
+                         << ". Storage files will be read synchronously.");
+        s_RingFd = -1;
+        return false;
+    }
+
+    s_SQRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    s_CQRingSize = params.cq_off.cqes
+                   + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        single_mmap = true;
+        s_SQRingSize = s_CQRingSize = max(s_SQRingSize, s_CQRingSize);
+    }
+#endif
+    s_SQRing = mmap(NULL, s_SQRingSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, s_RingFd, IORING_OFF_SQ_RING);
+    if (s_SQRing != MAP_FAILED) {
+        if (single_mmap)
+            s_CQRing = s_SQRing;
+        else
+            s_CQRing = mmap(NULL, s_CQRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, s_RingFd,
+                            IORING_OFF_CQ_RING);
+    }
+    s_SQEsSize = params.sq_entries * sizeof(io_uring_sqe);
+    if (s_CQRing != MAP_FAILED) {
+        s_SQEs = (io_uring_sqe*)mmap(NULL, s_SQEsSize,
+                                     PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_POPULATE, s_RingFd,
+                                     IORING_OFF_SQES);
+    }
+    if (s_SQEs != MAP_FAILED) {
+        s_SinkBuf = (char*)mmap(NULL, kSinkBufSize, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (s_SinkBuf == MAP_FAILED) {
+        SRV_LOG(Critical, "Cannot map io_uring queues, errno=" << errno);
+        s_CloseRing();
+        return false;
+    }
+
+    char* sq_ptr = (char*)s_SQRing;
+    s_SQHead  = (unsigned*)(sq_ptr + params.sq_off.head);
+    s_SQTail  = (unsigned*)(sq_ptr + params.sq_off.tail);
+    s_SQMask  = (unsigned*)(sq_ptr + params.sq_off.ring_mask);
+    s_SQArray = (unsigned*)(sq_ptr + params.sq_off.array);
+    char* cq_ptr = (char*)s_CQRing;
+    s_CQHead  = (unsigned*)(cq_ptr + params.cq_off.head);
+    s_CQTail  = (unsigned*)(cq_ptr + params.cq_off.tail);
+    s_CQMask  = (unsigned*)(cq_ptr + params.cq_off.ring_mask);
+    s_CQEs    = (io_uring_cqe*)(cq_ptr + params.cq_off.cqes);
+
+    // Completion queue is twice as big as submission queue, so with
+    // no more requests in flight than there are SQEs it never overflows.
+    // One SQE is reserved for stopping of completion thread.
+    s_MaxInFlight = params.sq_entries - 1;
+    s_Requests = new SNCURingRequest[s_MaxInFlight];
+    for (Uint4 i = 0; i < s_MaxInFlight; ++i) {
+        s_Requests[i].task = NULL;
+        s_Requests[i].state = NULL;
+        s_Requests[i].next_free = (i + 1 < s_MaxInFlight? i + 1: kNoRequest);
+    }
+    s_FreeRequest = 0;
+
+    if (pthread_create(&s_ComplThread, NULL, s_CompletionThreadMain, NULL) != 0) {
+        SRV_LOG(Critical, "Cannot start io_uring completion thread, errno="
+                          << errno);
+        s_CloseRing();
+        return false;
+    }
+    s_Active = true;
+    SRV_LOG(Info, "io_uring is used for reading storage files, queue depth "
+                  << s_MaxInFlight);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void
+CNCURing::Finalize(void)
+{
+#ifdef NC_USE_URING
+    if (!s_Active)
+        return;
+
+    io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_NOP;
+    sqe.user_data = kStopUserData;
+    s_URingLock.Lock();
+    s_Active = false;
+    bool submitted = s_SubmitSQE(sqe);
+    s_URingLock.Unlock();
+    if (!submitted) {
+        // Completion thread can't be stopped, so resources stay
+        // until process exit.
+        SRV_LOG(Critical, "Cannot stop io_uring completion thread");
+        return;
+    }
+    pthread_join(s_ComplThread, NULL);
+    s_CloseRing();
+#endif
+}
+
+bool
+CNCURing::IsActive(void)
+{
+#ifdef NC_USE_URING
+    return s_Active;
+#else
+    return false;
+#endif
+}
+
+bool
+CNCURing::StartRead(TFileHandle fd, Uint8 file_pos,
+                    const char* mem_ptr, Uint4 size, CSrvTask* task,
+                    Uint1* state)
+{
+#ifdef NC_USE_URING
+    if (!s_Active  ||  size == 0)
+        return true;
+
+    uintptr_t start = uintptr_t(mem_ptr) & kPageAlignMask;
+    uintptr_t end = uintptr_t(mem_ptr) + size;
+    size_t cnt_pages = (end - start + kPageSize - 1) / kPageSize;
+    if (cnt_pages > kMaxReadPages)
+        return true;
+
+    unsigned char pages[kMaxReadPages];
+    if (mincore((void*)start, end - start, pages) != 0)
+        return true;
+    size_t i = 0;
+    while (i < cnt_pages  &&  (pages[i] & 1))
+        ++i;
+    if (i == cnt_pages) {
+        AtomicAdd(s_CntInMemory, Uint8(1));
+        return true;
+    }
+
+    // Whole pages are read to get all of them into page cache.
+    io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = fd;
+    sqe.off = file_pos - (uintptr_t(mem_ptr) - start);
+    sqe.len = 1;
+
+    s_URingLock.Lock();
+    if (s_FreeRequest == kNoRequest) {
+        ++s_CntNoRequest;
+        s_URingLock.Unlock();
+        return true;
+    }
+    Uint4 req_idx = s_FreeRequest;
+    SNCURingRequest& req = s_Requests[req_idx];
+    req.iov.iov_base = s_SinkBuf;
+    req.iov.iov_len = cnt_pages * kPageSize;
+    sqe.addr = Uint8(uintptr_t(&req.iov));
+    sqe.user_data = req_idx;
+    if (!s_SubmitSQE(sqe)) {
+        ++s_CntFailed;
+        s_URingLock.Unlock();
+        return true;
+    }
+    s_FreeRequest = req.next_free;
+    req.task = task;
+    req.state = state;
+    *state = eURingReadPending;
+    ++s_CntStarted;
+    ++s_CntInFlight;
+    s_URingLock.Unlock();
+    return false;
+#else
+    return true;
+#endif
+}
+
+void
+CNCURing::CancelWait(CSrvTask* task)
+{
+#ifdef NC_USE_URING
+    if (!s_Requests)
+        return;
+
+    s_URingLock.Lock();
+    for (Uint4 i = 0; i < s_MaxInFlight; ++i) {
+        if (s_Requests[i].task == task) {
+            s_Requests[i].task = NULL;
+            s_Requests[i].state = NULL;
+        }
+    }
+    s_URingLock.Unlock();
+#endif
+}
+
+void
+CNCURing::WriteEnvInfo(CSrvSocketTask& task)
+{
+    string is("\": "), eol(",\n\"");
+    task.WriteText(eol).WriteText("io_uring_active").WriteText(is).WriteNumber(int(IsActive()));
+#ifdef NC_USE_URING
+    if (!IsActive())
+        return;
+    s_URingLock.Lock();
+    Uint8 cnt_in_memory = ACCESS_ONCE(s_CntInMemory);
+    Uint8 cnt_started   = s_CntStarted;
+    Uint8 cnt_failed    = ACCESS_ONCE(s_CntFailed);
+    Uint8 cnt_no_req    = s_CntNoRequest;
+    Uint4 cnt_in_flight = s_CntInFlight;
+    s_URingLock.Unlock();
+    task.WriteText(eol).WriteText("io_uring_chunks_in_memory").WriteText(is).WriteNumber(cnt_in_memory);
+    task.WriteText(eol).WriteText("io_uring_reads_started"   ).WriteText(is).WriteNumber(cnt_started);
+    task.WriteText(eol).WriteText("io_uring_reads_failed"    ).WriteText(is).WriteNumber(cnt_failed);
+    task.WriteText(eol).WriteText("io_uring_queue_full"      ).WriteText(is).WriteNumber(cnt_no_req);
+    task.WriteText(eol).WriteText("io_uring_reads_in_flight" ).WriteText(is).WriteNumber(cnt_in_flight);
+#endif
+}
+
+
+END_NCBI_SCOPE
@@ -0,0 +1,85 @@
+#ifndef NETCACHE__NC_URING__HPP
+#define NETCACHE__NC_URING__HPP
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description: Asynchronous reading of database files through io_uring.
+ *
+ * Storage files are accessed through memory maps, so a chunk that is not in
+ * memory stalls the worker thread on page faults while it's sent to client.
+ * Instead of that the chunk is read into page cache by io_uring and the task
+ * that needs it is woken up when the read is complete.
+ */
+
+#include "nc_db_info.hpp"
+
+
+BEGIN_NCBI_SCOPE
+
+
+/// State of the read started by CNCURing::StartRead() for one reader
+enum ENCURingReadState {
+    eURingReadNone,     ///< No read was started
+    eURingReadPending,  ///< Read is in flight
+    eURingReadDone,     ///< Read has finished, data is in page cache
+    eURingReadFailed    ///< Read has failed, data must be read synchronously
+};
+
+
+class CNCURing
+{
+public:
+    /// Create the ring with given number of entries and start the thread
+    /// waiting for completions. Returns FALSE if io_uring is not available
+    /// and all reads remain synchronous.
+    static bool Initialize(Uint4 queue_depth);
+    static void Finalize(void);
+    static bool IsActive(void);
+
+    /// Check if memory mapped from file fd at offset file_pos is resident.
+    /// If it is TRUE is returned. Otherwise reading of the data into page
+    /// cache is started, state is set to eURingReadPending and FALSE is
+    /// returned. When the read finishes state is set to eURingReadDone or
+    /// eURingReadFailed and then task is made runnable. If the read can't be
+    /// started TRUE is returned too, i.e. caller will just touch the memory
+    /// and wait for it.
+    static bool StartRead(TFileHandle fd, Uint8 file_pos,
+                          const char* mem_ptr, Uint4 size, CSrvTask* task,
+                          Uint1* state);
+    /// Forget about task waiting for a read started by StartRead().
+    /// Must be called before task is terminated or state is destroyed.
+    static void CancelWait(CSrvTask* task);
+
+    /// Write statistics of asynchronous reads.
+    static void WriteEnvInfo(CSrvSocketTask& task);
+
+private:
+    CNCURing(void);
+};
+
+
+END_NCBI_SCOPE
+
+#endif /* NETCACHE__NC_URING__HPP */
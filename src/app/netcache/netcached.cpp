@@ -50,6 +50,7 @@
 #include "active_handler.hpp"
 #include "periodic_sync.hpp"
 #include "nc_storage_blob.hpp"
+#include "nc_hot_cache.hpp"
 
 #include "logging.hpp"
 #include "server_core.hpp"
@@ -89,6 +90,7 @@ static const char* kNCReg_ProlongOnRead       = "prolong_on_read";
 static const char* kNCReg_SearchOnRead        = "search_on_read";
 static const char* kNCReg_Quorum              = "quorum";
 static const char* kNCReg_FastOnMain          = "fast_quorum_on_main";
+static const char* kNCReg_CompressBlobs       = "compress_blobs";
 static const char* kNCReg_PassPolicy          = "blob_password_policy";
 static const char* kNCReg_AppSetupPrefix      = "app_setup_";
 static const char* kNCReg_AppSetupValue       = "setup";
@@ -397,6 +399,11 @@ s_ReadSpecificParams(const IRegistry& reg,
         params->source[kNCReg_FastOnMain] = section;
         params->keys[kNCReg_FastOnMain] = key;
     }
+    if (reg.HasEntry(section, kNCReg_CompressBlobs, IRegistry::fCountCleared)) {
+        params->compress_blobs = reg.GetBool(section, kNCReg_CompressBlobs, false);
+        params->source[kNCReg_CompressBlobs] = section;
+        params->keys[kNCReg_CompressBlobs] = key;
+    }
     if (reg.HasEntry(section, kNCReg_PassPolicy, IRegistry::fCountCleared)) {
         string pass_policy = reg.GetString(section, kNCReg_PassPolicy, "any");
         params->source[kNCReg_PassPolicy] = section;
@@ -497,6 +504,7 @@ s_ReadPerClientConfig(const CNcbiRegistry& reg)
     main_params->pass_policy     = eNCBlobPassAny;
     main_params->quorum          = 2;
     main_params->fast_on_main    = true;
+    main_params->compress_blobs  = false;
     keys.push_back("default");
     s_ReadSpecificParams(reg, kNCReg_ServerSection, main_params, keys);
     //s_DefConnTimeout = main_params->conn_timeout;
@@ -860,6 +868,10 @@ void CNCServer::WriteAppSetup(TNCBufferType& task, const SNCSpecificParams* para
         WriteText(isv).WriteText(NStr::BoolToString(params->fast_on_main)).
         WriteText(iss).WriteText(source[kNCReg_FastOnMain]).WriteText(eos).
         WriteText(isk).WriteText(keys[kNCReg_FastOnMain]).WriteText(eok);
+    task.WriteText(eol).WriteText(kNCReg_CompressBlobs).
+        WriteText(isv).WriteText(NStr::BoolToString(params->compress_blobs)).
+        WriteText(iss).WriteText(source[kNCReg_CompressBlobs]).WriteText(eos).
+        WriteText(isk).WriteText(keys[kNCReg_CompressBlobs]).WriteText(eok);
     task.WriteText(eol).WriteText(kNCReg_PassPolicy   ).WriteText(isv);
     task.WriteText("\"");
     switch (params->pass_policy) {
@@ -1013,6 +1025,7 @@ CNCServer::ReadCurState(SNCStateStat& state)
     CNCPeerControl::ReadCurState(state);
     state.sync_log_size = CNCSyncLog::GetLogSize();
     CWriteBackControl::ReadState(state);
+    CNCHotBlobCache::ReadState(state);
 }
 
 bool s_ReportPid(const string& pid_file)
@@ -41,6 +41,7 @@
 #include "peer_control.hpp"
 #include "active_handler.hpp"
 #include "nc_storage.hpp"
+#include "nc_hot_cache.hpp"
 #include "nc_stat.hpp"
 #include <random>
 
@@ -1281,6 +1282,8 @@ CNCActiveSyncControl::x_DoEventGet(const SSyncTaskInfo& task_info,
     default:
         break;
     case eSyncWrite:
+        // Blob was changed on peer, its copy in memory won't be used anymore
+        CNCHotBlobCache::Invalidate(event->key.PackedKey());
         conn->SyncRead(this, event);
         break;
     case eSyncProlong:
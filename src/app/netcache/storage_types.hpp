@@ -65,11 +65,15 @@ struct ATTR_PACKED SFileIndexRec
     SNCCacheData* cache_data;
 };
 
+enum EFileMetaFlags {
+    fMetaCompressed = 1 << 0    ///< Blob's chunks can be stored compressed
+};
+
 // Meta-type records (kMetaSignature)
 struct ATTR_PACKED SFileMetaRec
 {
     Uint1   has_password;
-    Uint1   align_reserve;
+    Uint1   flags;          // combination of EFileMetaFlags
     Uint2   map_size;       // max number of down_coords in map record - see SFileChunkMapRec
     Uint4   chunk_size;
     Uint8   size;           // blob size
@@ -116,6 +116,9 @@ void CAppNWA::Init()
 
     argdescr->AddFlag("mt", "Use multiple threads");
 
+    argdescr->AddFlag("score_only",
+                      "Compute the alignment score only, in linear memory");
+
     // output formats
     argdescr->AddOptionalKey
         ("o1", "o1", "Filename for type 1 output", CArgDescriptions::eString);
@@ -178,6 +181,7 @@ void CAppNWA::x_RunOnPair() const
     // analyze parameters
     const bool bMM = args["mm"];
     const bool bMT = args["mt"];
+    const bool bScoreOnly = args["score_only"];
 
     bool   output_type1  ( args["o1"] );
     bool   output_type2  ( args["o2"] );
@@ -187,11 +191,18 @@ void CAppNWA::x_RunOnPair() const
     int    band (args["band"].AsInteger());
     int    shift(args["shift"].AsInteger());
 
-    if(bMT && !bMM) {
+    if(bMT && !bMM && !bScoreOnly) {
         NCBI_THROW(CAppNWAException,
                    eInconsistentParameters,
                    "Mutliple thread mode supported "
-                   "for Myers-Miller method only (invoke with -mm)");
+                   "for Myers-Miller method (invoke with -mm) "
+                   "and score-only mode (invoke with -score_only) only");
+    }
+
+    if(bScoreOnly && band >= 0) {
+        NCBI_THROW(CAppNWAException,
+                   eInconsistentParameters,
+                   "-score_only and -band are inconsistent with each other");
     }
 
     if(bMM && band >= 0) {
@@ -249,9 +260,8 @@ void CAppNWA::x_RunOnPair() const
     aligner->SetScoreMatrix(psm); // re-set score matrix to handle 
                                   // possible ambiguity chars
 
-    if(bMT && bMM) {
-        CMMAligner* pmma = static_cast<CMMAligner*> (aligner.get());
-        pmma -> EnableMultipleThreads();
+    if(bMT) {
+        aligner->EnableMultipleThreads();
     }
     
     unique_ptr<ofstream> pofs1;
@@ -294,6 +304,11 @@ void CAppNWA::x_RunOnPair() const
         NCBI_THROW(CException, eUnknown, "unknown value for \"gp\"");
     }
 
+    if(bScoreOnly) {
+        cerr << "Score = " << aligner->RunScoreOnly() << endl;
+        return;
+    }
+
     int score = aligner->Run();
     cerr << "Score = " << score << endl;
 
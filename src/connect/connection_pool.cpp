@@ -34,12 +34,44 @@
 #include <ncbi_pch.hpp>
 #include "connection_pool.hpp"
 #include <connect/error_codes.hpp>
+#include <corelib/ncbi_param.hpp>
+
+#ifdef NCBI_OS_LINUX
+#  include <sys/eventfd.h>
+#  include <unistd.h>
+#endif
 
 #define NCBI_USE_ERRCODE_X   Connect_ThrServer
 
 
 BEGIN_NCBI_SCOPE
 
+
+NCBI_PARAM_DECL(bool, server, Use_Epoll);
+NCBI_PARAM_DEF_EX(bool, server, Use_Epoll, false, eParam_NoThread,
+                  CSERVER_USE_EPOLL);
+typedef NCBI_PARAM_TYPE(server, Use_Epoll) TParamServerUseEpoll;
+
+#ifdef NCBI_OS_LINUX
+// Max number of events taken by one epoll_wait() call
+static const size_t kEpollMaxEvents = 1024;
+// Period of checking the inactive connections expiration, in seconds
+static const double kEpollSweepPeriod = 1.0;
+#endif
+
+
+struct CServer_ConnectionPool::SAlarms
+{
+    SAlarms(void)
+        : defined(false), min_time(NULL), current_time(CTime::eEmpty)
+    {}
+
+    bool            defined;
+    const CTime *   min_time;
+    CTime           current_time;
+};
+
+
 std::string g_ServerConnTypeToString(enum EServerConnType  conn_type)
 {
     switch (conn_type) {
@@ -57,11 +89,54 @@ std::string g_ServerConnTypeToString(enum EServerConnType  conn_type)
 
 CServer_ConnectionPool::CServer_ConnectionPool(unsigned max_connections) :
     m_MaxConnections(max_connections), m_ListeningStarted(false)
-{}
+#ifdef NCBI_OS_LINUX
+    , m_EpollFd(-1), m_WakeupFd(-1),
+    m_Clock(CStopWatch::eStart), m_NextSweep(0),
+    m_WaitDeadline(-1), m_WaitTimeout(NULL)
+#endif
+{
+#ifdef NCBI_OS_LINUX
+    if (TParamServerUseEpoll::GetDefault()) {
+        m_EpollFd = epoll_create1(EPOLL_CLOEXEC);
+        m_WakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        struct epoll_event  ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+        if (m_EpollFd < 0  ||  m_WakeupFd < 0  ||
+            epoll_ctl(m_EpollFd, EPOLL_CTL_ADD, m_WakeupFd, &ev) != 0) {
+            ERR_POST(Warning << "Failed to initialize epoll ("
+                     << strerror(errno) << "), using poll() instead");
+            if (m_EpollFd >= 0)
+                close(m_EpollFd);
+            if (m_WakeupFd >= 0)
+                close(m_WakeupFd);
+            m_EpollFd = m_WakeupFd = -1;
+        } else {
+            m_EpollEvents.resize(kEpollMaxEvents);
+        }
+    }
+#endif
+}
 
 CServer_ConnectionPool::~CServer_ConnectionPool()
 {
     Erase();
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFd >= 0) {
+        close(m_EpollFd);
+        close(m_WakeupFd);
+    }
+#endif
+}
+
+bool CServer_ConnectionPool::IsEpollUsed(void) const
+{
+#ifdef NCBI_OS_LINUX
+    return m_EpollFd >= 0;
+#else
+    return false;
+#endif
 }
 
 void CServer_ConnectionPool::Erase(void)
@@ -77,6 +152,12 @@ void CServer_ConnectionPool::Erase(void)
         delete *it;
     }
     m_Data.clear();
+#ifdef NCBI_OS_LINUX
+    m_Deferred.clear();
+    m_Alarms.clear();
+    m_Closed.clear();
+    m_Ready.clear();
+#endif
 }
 
 void CServer_ConnectionPool::x_UpdateExpiration(TConnBase* conn)
@@ -111,14 +192,23 @@ bool CServer_ConnectionPool::Add(TConnBase* conn, EServerConnType type)
         if (m_Data.find(conn) != m_Data.end())
             abort();
         m_Data.insert(conn);
+#ifdef NCBI_OS_LINUX
+        if (m_EpollFd >= 0  &&  type == eInactiveSocket)
+            x_EpollRearm(conn);
+#endif
     }}
 
     if (type == eListener)
-        if (m_ListeningStarted)
+        if (m_ListeningStarted) {
             // That's a new listener which should be activated right away
             // because the StartListening() had already been called earlier
             // (e.g. in CServer::Run())
             conn->Activate();
+#ifdef NCBI_OS_LINUX
+            if (m_EpollFd >= 0)
+                x_EpollCtl(EPOLL_CTL_ADD, conn, EPOLLIN);
+#endif
+        }
 
     PingControlConnection();
     return true;
@@ -128,6 +218,13 @@ void CServer_ConnectionPool::Remove(TConnBase* conn)
 {
     CMutexGuard guard(m_Mutex);
     m_Data.erase(conn);
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFd >= 0) {
+        x_EpollForget(conn);
+        if (conn->IsOpen())
+            x_EpollCtl(EPOLL_CTL_DEL, conn, 0);
+    }
+#endif
 }
 
 
@@ -177,6 +274,13 @@ bool CServer_ConnectionPool::RemoveListener(unsigned short  port)
 
 void CServer_ConnectionPool::SetConnType(TConnBase* conn, EServerConnType type)
 {
+#ifdef NCBI_OS_LINUX
+    // With epoll the connection is re-armed under m_Mutex, so that the poll
+    // cycle sees it either before or after the whole transition
+    CMutexGuard guard(eEmptyGuard);
+    if (m_EpollFd >= 0  &&  type == eInactiveSocket)
+        guard.Guard(m_Mutex);
+#endif
     conn->type_lock.Lock();
     if (conn->type != eClosedSocket) {
         EServerConnType new_type = type;
@@ -192,6 +296,14 @@ void CServer_ConnectionPool::SetConnType(TConnBase* conn, EServerConnType type)
     }
     conn->type_lock.Unlock();
 
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFd >= 0) {
+        if (type == eInactiveSocket)
+            x_EpollRearm(conn);
+        return;
+    }
+#endif
+
     // Signal poll cycle to re-read poll vector by sending
     // byte to control socket
     if (type == eInactiveSocket)
@@ -200,6 +312,18 @@ void CServer_ConnectionPool::SetConnType(TConnBase* conn, EServerConnType type)
 
 void CServer_ConnectionPool::PingControlConnection(void)
 {
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFd >= 0) {
+        uint64_t    value = 1;
+        if (write(m_WakeupFd, &value, sizeof(value)) < 0  &&
+            errno != EAGAIN) {
+            ERR_POST_X(4, Warning
+                       << "PingControlConnection: failed to signal epoll: "
+                       << strerror(errno));
+        }
+        return;
+    }
+#endif
     EIO_Status status = m_ControlTrigger.Set();
     if (status != eIO_Success) {
         ERR_POST_X(4, Warning
@@ -244,104 +368,94 @@ bool CServer_ConnectionPool::GetPollAndTimerVec(
     to_delete_conns.clear();
 
     const CTime *   alarm_time = NULL;
-    const CTime *   min_alarm_time = NULL;
-    bool            alarm_time_defined = false;
-    CTime           current_time(CTime::eEmpty);
+    SAlarms         alarms;
 
     CMutexGuard     guard(m_Mutex);
 
-    // Control trigger goes here as well
-    polls.push_back(CSocketAPI::SPoll(&m_ControlTrigger, eIO_Read));
-
-    ERASE_ITERATE(TData, it, m_Data) {
-        // Check that socket is not processing packet - safeguards against
-        // out-of-order packet processing by effectively pulling socket from
-        // poll vector until it is done with previous packet. See comments in
-        // server.cpp: CServer_Connection::CreateRequest() and
-        // CServerConnectionRequest::Process()
-        TConnBase* conn_base = *it;
-        conn_base->type_lock.Lock();
-        EServerConnType conn_type = conn_base->type;
-
-        // There might be a request to delete a listener
-        if (conn_type == eListener) {
-            CServer_Listener *  listener = dynamic_cast<CServer_Listener *>(
-                                                                    conn_base);
-            if (listener) {
-                unsigned short  port = listener->GetPort();
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFd >= 0) {
+        x_EpollCollect(now, timer_requests, alarms,
+                       revived_conns, to_close_conns, to_delete_conns);
+    } else
+#endif
+    {
+        // Control trigger goes here as well
+        polls.push_back(CSocketAPI::SPoll(&m_ControlTrigger, eIO_Read));
+
+        ERASE_ITERATE(TData, it, m_Data) {
+            // Check that socket is not processing packet - safeguards against
+            // out-of-order packet processing by effectively pulling socket from
+            // poll vector until it is done with previous packet. See comments in
+            // server.cpp: CServer_Connection::CreateRequest() and
+            // CServerConnectionRequest::Process()
+            TConnBase* conn_base = *it;
+            conn_base->type_lock.Lock();
+            EServerConnType conn_type = conn_base->type;
+
+            // There might be a request to delete a listener
+            if (conn_type == eListener) {
+                CServer_Listener *  listener = dynamic_cast<CServer_Listener *>(
+                                                                        conn_base);
+                if (listener) {
+                    unsigned short  port = listener->GetPort();
 
-                vector<unsigned short>::iterator    port_it = 
-                        std::find(m_ListenerPortsToStop.begin(),
-                                  m_ListenerPortsToStop.end(), port);
-                if (port_it != m_ListenerPortsToStop.end()) {
-                    conn_base->type_lock.Unlock();
-                    m_ListenerPortsToStop.erase(port_it);
-                    delete conn_base;
-                    m_Data.erase(it);
-                    continue;
+                    vector<unsigned short>::iterator    port_it = 
+                            std::find(m_ListenerPortsToStop.begin(),
+                                      m_ListenerPortsToStop.end(), port);
+                    if (port_it != m_ListenerPortsToStop.end()) {
+                        conn_base->type_lock.Unlock();
+                        m_ListenerPortsToStop.erase(port_it);
+                        delete conn_base;
+                        m_Data.erase(it);
+                        continue;
+                    }
                 }
             }
-        }
 
 
-        if (conn_type == eClosedSocket
-            ||  (conn_type == eInactiveSocket  &&  !conn_base->IsOpen()))
-        {
-            // If it's not eClosedSocket then This connection was closed
-            // by the client earlier in CServer::Run after Poll returned
-            // eIO_Close which was converted into eServIO_ClientClose.
-            // Then during OnSocketEvent(eServIO_ClientClose) it was marked
-            // as closed. Here we just clean it up from the connection pool.
-            to_delete_conns.push_back(conn_base);
-            m_Data.erase(it);
-        }
-        else if (conn_type == eInactiveSocket  &&  conn_base->expiration <= now)
-        {
-            to_close_conns.push_back(conn_base);
-            m_Data.erase(it);
-        }
-        else if ((conn_type == eInactiveSocket  ||  conn_type == eListener)
-                 &&  conn_base->IsOpen())
-        {
-            CPollable* pollable = dynamic_cast<CPollable*>(conn_base);
-            _ASSERT(pollable);
-            polls.push_back(CSocketAPI::SPoll(pollable,
-                            conn_base->GetEventsToPollFor(&alarm_time)));
-            if (alarm_time != NULL) {
-                if (!alarm_time_defined) {
-                    alarm_time_defined = true;
-                    current_time = GetFastLocalTime();
-                    min_alarm_time = *alarm_time > current_time? alarm_time: NULL;
-                    timer_requests.clear();
-                    timer_requests.push_back(conn_base);
-                } else if (min_alarm_time == NULL) {
-                    if (*alarm_time <= current_time)
-                        timer_requests.push_back(conn_base);
-                } else if (*alarm_time <= *min_alarm_time) {
-                    if (*alarm_time != *min_alarm_time) {
-                        min_alarm_time = *alarm_time > current_time? alarm_time
-                                                                   : NULL;
-                        timer_requests.clear();
-                    }
-                    timer_requests.push_back(conn_base);
+            if (conn_type == eClosedSocket
+                ||  (conn_type == eInactiveSocket  &&  !conn_base->IsOpen()))
+            {
+                // If it's not eClosedSocket then This connection was closed
+                // by the client earlier in CServer::Run after Poll returned
+                // eIO_Close which was converted into eServIO_ClientClose.
+                // Then during OnSocketEvent(eServIO_ClientClose) it was marked
+                // as closed. Here we just clean it up from the connection pool.
+                to_delete_conns.push_back(conn_base);
+                m_Data.erase(it);
+            }
+            else if (conn_type == eInactiveSocket  &&  conn_base->expiration <= now)
+            {
+                to_close_conns.push_back(conn_base);
+                m_Data.erase(it);
+            }
+            else if ((conn_type == eInactiveSocket  ||  conn_type == eListener)
+                     &&  conn_base->IsOpen())
+            {
+                CPollable* pollable = dynamic_cast<CPollable*>(conn_base);
+                _ASSERT(pollable);
+                polls.push_back(CSocketAPI::SPoll(pollable,
+                                conn_base->GetEventsToPollFor(&alarm_time)));
+                if (alarm_time != NULL) {
+                    x_AddAlarm(conn_base, alarm_time, alarms, timer_requests);
+                    alarm_time = NULL;
                 }
-                alarm_time = NULL;
             }
+            else if (conn_type == eDeferredSocket  &&  conn_base->IsReadyToProcess())
+            {
+                conn_base->type = eActiveSocket;
+                revived_conns.push_back(conn_base);
+            }
+            conn_base->type_lock.Unlock();
         }
-        else if (conn_type == eDeferredSocket  &&  conn_base->IsReadyToProcess())
-        {
-            conn_base->type = eActiveSocket;
-            revived_conns.push_back(conn_base);
-        }
-        conn_base->type_lock.Unlock();
     }
     guard.Release();
 
-    if (alarm_time_defined) {
-        if (min_alarm_time == NULL)
+    if (alarms.defined) {
+        if (alarms.min_time == NULL)
             timer_timeout->usec = timer_timeout->sec = 0;
         else {
-            CTimeSpan span(min_alarm_time->DiffTimeSpan(current_time));
+            CTimeSpan span(alarms.min_time->DiffTimeSpan(alarms.current_time));
             if (span.GetCompleteSeconds() < 0 ||
                 span.GetNanoSecondsAfterSecond() < 0)
             {
@@ -357,6 +471,42 @@ bool CServer_ConnectionPool::GetPollAndTimerVec(
     return false;
 }
 
+void CServer_ConnectionPool::x_AddAlarm(
+                             TConnBase* conn_base,
+                             const CTime* alarm_time,
+                             SAlarms& alarms,
+                             vector<IServer_ConnectionBase*>& timer_requests)
+{
+    if (!alarms.defined) {
+        alarms.defined = true;
+        alarms.current_time = GetFastLocalTime();
+        alarms.min_time = *alarm_time > alarms.current_time? alarm_time: NULL;
+        timer_requests.clear();
+        timer_requests.push_back(conn_base);
+    } else if (alarms.min_time == NULL) {
+        if (*alarm_time <= alarms.current_time)
+            timer_requests.push_back(conn_base);
+    } else if (*alarm_time <= *alarms.min_time) {
+        if (*alarm_time != *alarms.min_time) {
+            alarms.min_time = *alarm_time > alarms.current_time? alarm_time
+                                                               : NULL;
+            timer_requests.clear();
+        }
+        timer_requests.push_back(conn_base);
+    }
+}
+
+EIO_Status CServer_ConnectionPool::Poll(vector<CSocketAPI::SPoll>& polls,
+                                        const STimeout* timeout,
+                                        size_t* count)
+{
+#ifdef NCBI_OS_LINUX
+    if (m_EpollFd >= 0)
+        return x_EpollWait(polls, timeout, count);
+#endif
+    return CSocketAPI::Poll(polls, timeout, count);
+}
+
 void CServer_ConnectionPool::SetAllActive(const vector<CSocketAPI::SPoll>& polls)
 {
     ITERATE(vector<CSocketAPI::SPoll>, it, polls) {
@@ -387,6 +537,11 @@ void CServer_ConnectionPool::SetAllActive(const vector<IServer_ConnectionBase*>&
         if (conn_base->type != eInactiveSocket)
             abort();
         conn_base->type = eActiveSocket;
+#ifdef NCBI_OS_LINUX
+        // Connections activated by alarm are still armed
+        if (m_EpollFd >= 0)
+            x_EpollCtl(EPOLL_CTL_DEL, conn_base, 0);
+#endif
         conn_base->type_lock.Unlock();
     }
 }
@@ -397,6 +552,10 @@ void CServer_ConnectionPool::StartListening(void)
     CMutexGuard guard(m_Mutex);
     ITERATE (TData, it, m_Data) {
         (*it)->Activate();
+#ifdef NCBI_OS_LINUX
+        if (m_EpollFd >= 0  &&  (*it)->type == eListener)
+            x_EpollCtl(EPOLL_CTL_ADD, *it, EPOLLIN);
+#endif
     }
     m_ListeningStarted = true;
 }
@@ -438,4 +597,293 @@ vector<unsigned short>  CServer_ConnectionPool::GetListenerPorts(void)
     return ports;
 }
 
+#ifdef NCBI_OS_LINUX
+
+bool CServer_ConnectionPool::x_EpollCtl(int op, TConnBase* conn,
+                                        uint32_t events)
+{
+    CPollable*  pollable = dynamic_cast<CPollable*>(conn);
+    int         fd;
+    if (pollable == NULL  ||
+        pollable->GetOSHandle(&fd, sizeof(fd)) != eIO_Success)
+        return false;
+
+    struct epoll_event  ev;
+    ev.events = events;
+    ev.data.ptr = conn;
+    if (epoll_ctl(m_EpollFd, op, fd, &ev) == 0)
+        return true;
+    // Connections taken out by alarm or expiration are not registered
+    if (op == EPOLL_CTL_MOD  &&  errno == ENOENT)
+        return epoll_ctl(m_EpollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    return false;
+}
+
+void CServer_ConnectionPool::x_EpollForget(TConnBase* conn)
+{
+    m_Deferred.erase(conn);
+    m_Alarms.erase(conn);
+
+    CPollable*  pollable = dynamic_cast<CPollable*>(conn);
+    ERASE_ITERATE(vector<CSocketAPI::SPoll>, it, m_Ready) {
+        if (it->m_Pollable == pollable)
+            VECTOR_ERASE(it, m_Ready);
+    }
+}
+
+// Called under m_Mutex when the connection is returned to the pool
+void CServer_ConnectionPool::x_EpollRearm(TConnBase* conn)
+{
+    if (m_Data.find(conn) == m_Data.end())
+        return;
+
+    conn->type_lock.Lock();
+    EServerConnType conn_type = conn->type;
+    conn->type_lock.Unlock();
+
+    bool    ping = false;
+    if (conn_type == eDeferredSocket) {
+        m_Deferred.insert(conn);
+        ping = true;
+    }
+    else if (conn_type == eClosedSocket  ||
+             (conn_type == eInactiveSocket  &&  !conn->IsOpen())) {
+        x_EpollForget(conn);
+        m_Data.erase(conn);
+        m_Closed.push_back(conn);
+        ping = true;
+    }
+    else if (conn_type == eInactiveSocket) {
+        const CTime*    alarm_time = NULL;
+        EIO_Event       events = conn->GetEventsToPollFor(&alarm_time);
+        if (alarm_time != NULL  &&  m_Alarms.insert(conn).second)
+            ping = true;
+
+        // CSocketAPI::Poll() reports the data already read into the socket
+        // buffer and the closed socket without looking at the descriptor
+        EIO_Event   ready = eIO_Open;
+        CSocket*    socket = dynamic_cast<CSocket*>(conn);
+        if (socket  &&  (events & eIO_Read)) {
+            EIO_Status  status = socket->GetStatus(eIO_Read);
+            if (socket->GetCount(eIO_Read) != socket->GetPosition(eIO_Read))
+                ready = eIO_Read;
+            else if (events == eIO_Read  &&
+                     (status == eIO_Closed  ||  status == eIO_Unknown))
+                ready = eIO_Close;
+        }
+
+        uint32_t    epoll_events = EPOLLONESHOT;
+        if (events & eIO_Read)
+            epoll_events |= EPOLLIN;
+        if (events & eIO_Write)
+            epoll_events |= EPOLLOUT;
+        if (ready == eIO_Open  &&
+            !x_EpollCtl(EPOLL_CTL_MOD, conn, epoll_events))
+            ready = eIO_Close;
+
+        if (ready != eIO_Open) {
+            CSocketAPI::SPoll   poll(dynamic_cast<CPollable*>(conn), events);
+            poll.m_REvent = ready;
+            m_Ready.push_back(poll);
+            ping = true;
+        }
+    }
+
+    if (ping)
+        PingControlConnection();
+}
+
+void CServer_ConnectionPool::x_EpollCollect(
+                             const CTime& now,
+                             vector<IServer_ConnectionBase*>& timer_requests,
+                             SAlarms& alarms,
+                             vector<IServer_ConnectionBase*>& revived_conns,
+                             vector<IServer_ConnectionBase*>& to_close_conns,
+                             vector<IServer_ConnectionBase*>& to_delete_conns)
+{
+    if (!m_ListenerPortsToStop.empty()) {
+        ERASE_ITERATE(TData, it, m_Data) {
+            TConnBase* conn_base = *it;
+            if (conn_base->type != eListener)
+                continue;
+            CServer_Listener *  listener = dynamic_cast<CServer_Listener *>(
+                                                                    conn_base);
+            if (listener == NULL)
+                continue;
+
+            vector<unsigned short>::iterator    port_it =
+                    std::find(m_ListenerPortsToStop.begin(),
+                              m_ListenerPortsToStop.end(),
+                              listener->GetPort());
+            if (port_it != m_ListenerPortsToStop.end()) {
+                // Closing the socket removes it from epoll
+                m_ListenerPortsToStop.erase(port_it);
+                delete conn_base;
+                m_Data.erase(it);
+            }
+        }
+    }
+
+    to_delete_conns.swap(m_Closed);
+
+    ERASE_ITERATE(TData, it, m_Deferred) {
+        TConnBase* conn_base = *it;
+        conn_base->type_lock.Lock();
+        if (conn_base->type != eDeferredSocket)
+            m_Deferred.erase(it);
+        else if (conn_base->IsReadyToProcess()) {
+            conn_base->type = eActiveSocket;
+            revived_conns.push_back(conn_base);
+            m_Deferred.erase(it);
+        }
+        conn_base->type_lock.Unlock();
+    }
+
+    ERASE_ITERATE(TData, it, m_Alarms) {
+        TConnBase* conn_base = *it;
+        conn_base->type_lock.Lock();
+        if (conn_base->type == eInactiveSocket) {
+            const CTime*    alarm_time = NULL;
+            conn_base->GetEventsToPollFor(&alarm_time);
+            if (alarm_time != NULL)
+                x_AddAlarm(conn_base, alarm_time, alarms, timer_requests);
+            else
+                m_Alarms.erase(it);
+        }
+        conn_base->type_lock.Unlock();
+    }
+
+    double  elapsed = m_Clock.Elapsed();
+    if (elapsed < m_NextSweep)
+        return;
+    m_NextSweep = elapsed + kEpollSweepPeriod;
+
+    ERASE_ITERATE(TData, it, m_Data) {
+        TConnBase* conn_base = *it;
+        conn_base->type_lock.Lock();
+        if (conn_base->type == eInactiveSocket) {
+            if (!conn_base->IsOpen()) {
+                x_EpollForget(conn_base);
+                to_delete_conns.push_back(conn_base);
+                m_Data.erase(it);
+            }
+            else if (conn_base->expiration <= now) {
+                x_EpollCtl(EPOLL_CTL_DEL, conn_base, 0);
+                x_EpollForget(conn_base);
+                to_close_conns.push_back(conn_base);
+                m_Data.erase(it);
+            }
+        }
+        conn_base->type_lock.Unlock();
+    }
+}
+
+EIO_Status CServer_ConnectionPool::x_EpollWait(
+                                       vector<CSocketAPI::SPoll>& polls,
+                                       const STimeout* timeout,
+                                       size_t* count)
+{
+    double  now = m_Clock.Elapsed();
+    double  deadline = -1;
+    int     timeout_ms = -1;
+    if (timeout != kDefaultTimeout  &&  timeout != kInfiniteTimeout) {
+        // A wait that was interrupted for the expiration sweep only goes
+        // on until its original deadline, otherwise the caller's timeout
+        // would never expire when it's longer than the sweep period.
+        if (m_WaitDeadline >= 0  &&  timeout == m_WaitTimeout
+            &&  timeout->sec  == m_WaitTimeoutValue.sec
+            &&  timeout->usec == m_WaitTimeoutValue.usec) {
+            deadline = m_WaitDeadline;
+        }
+        else {
+            deadline = now + timeout->sec + timeout->usec / 1000000.0;
+        }
+        timeout_ms = deadline > now ? int((deadline - now) * 1000) + 1 : 0;
+    }
+    m_WaitDeadline = -1;
+
+    // Wake up for the next expiration check as well
+    int     sweep_ms = int((m_NextSweep - now) * 1000) + 1;
+    bool    sweep_wait = false;
+    if (sweep_ms < 0)
+        sweep_ms = 0;
+    if (timeout_ms < 0  ||  sweep_ms < timeout_ms) {
+        timeout_ms = sweep_ms;
+        sweep_wait = true;
+    }
+
+    {{
+        CMutexGuard guard(m_Mutex);
+        if (!m_Ready.empty())
+            timeout_ms = 0;
+    }}
+
+    int     n = epoll_wait(m_EpollFd, &m_EpollEvents[0],
+                           int(m_EpollEvents.size()), timeout_ms);
+    if (n < 0) {
+        if (errno != EINTR)
+            return eIO_Unknown;
+        n = 0;
+        sweep_wait = true;
+    }
+
+    polls.clear();
+    bool    wakeup = false;
+    for (int i = 0;  i < n;  ++i) {
+        const struct epoll_event&   ev = m_EpollEvents[i];
+        if (ev.data.ptr == NULL) {
+            uint64_t    value;
+            if (read(m_WakeupFd, &value, sizeof(value)) < 0  &&
+                errno != EAGAIN) {
+                ERR_POST(Warning << "Failed to reset epoll wakeup: "
+                         << strerror(errno));
+            }
+            wakeup = true;
+            continue;
+        }
+
+        int     revent = 0;
+        if (ev.events & EPOLLIN)
+            revent |= eIO_Read;
+        if (ev.events & EPOLLOUT)
+            revent |= eIO_Write;
+        CSocketAPI::SPoll   poll(dynamic_cast<CPollable*>(
+                                 static_cast<TConnBase*>(ev.data.ptr)));
+        // Hang up or error without the requested events
+        poll.m_REvent = revent ? EIO_Event(revent) : eIO_Close;
+        polls.push_back(poll);
+    }
+
+    {{
+        CMutexGuard guard(m_Mutex);
+        polls.insert(polls.end(), m_Ready.begin(), m_Ready.end());
+        m_Ready.clear();
+    }}
+
+    // The wakeups are reported as the control trigger event, so that
+    // they are not taken for the caller's timeout. A sweep-only wakeup
+    // after the caller's deadline is the timeout though.
+    bool    sweep_only = !wakeup  &&  polls.empty()  &&  sweep_wait;
+    if (sweep_only  &&  deadline >= 0) {
+        if (m_Clock.Elapsed() >= deadline) {
+            sweep_only = false;
+        }
+        else {
+            m_WaitDeadline = deadline;
+            m_WaitTimeout = timeout;
+            m_WaitTimeoutValue = *timeout;
+        }
+    }
+    if (wakeup  ||  sweep_only) {
+        CSocketAPI::SPoll   poll(&m_ControlTrigger, eIO_Read);
+        poll.m_REvent = eIO_Read;
+        polls.push_back(poll);
+    }
+
+    *count = polls.size();
+    return *count ? eIO_Success : eIO_Timeout;
+}
+
+#endif /* NCBI_OS_LINUX */
+
 END_NCBI_SCOPE
@@ -36,6 +36,10 @@
 
 #include <connect/impl/server_connection.hpp>
 
+#ifdef NCBI_OS_LINUX
+#  include <sys/epoll.h>
+#endif
+
 
 /** @addtogroup ThreadedServer
  *
@@ -85,6 +89,16 @@ public:
                             vector<IServer_ConnectionBase*>& to_close_conns,
                             vector<IServer_ConnectionBase*>& to_delete_conns);
 
+    /// Wait for events on the connections returned by GetPollAndTimerVec().
+    /// With the epoll backend the connections are registered in the kernel
+    /// once and re-armed when returned to the pool, so polls are rebuilt
+    /// here to hold only the ready ones.
+    EIO_Status Poll(vector<CSocketAPI::SPoll>& polls,
+                    const STimeout* timeout, size_t* count);
+
+    /// Whether the epoll backend is used instead of poll()
+    bool IsEpollUsed(void) const;
+
     void StartListening(void);
     void StopListening(void);
 
@@ -94,7 +108,11 @@ public:
     vector<unsigned short>  GetListenerPorts(void);
 
 private:
+    struct SAlarms;
+
     void x_UpdateExpiration(TConnBase* conn);
+    void x_AddAlarm(TConnBase* conn, const CTime* alarm_time, SAlarms& alarms,
+                    vector<IServer_ConnectionBase*>& timer_requests);
 
 
     typedef set<TConnBase*> TData;
@@ -112,6 +130,45 @@ private:
     // The access to the container is protected with m_Mutex
     vector<unsigned short>  m_ListenerPortsToStop;
     bool                    m_ListeningStarted;
+
+private:
+    // epoll backend. Inactive connections are registered with EPOLLONESHOT,
+    // which pulls them from the poll set exactly like the eActiveSocket
+    // state does, and are re-armed by SetConnType(). Connections which need
+    // the poll cycle attention otherwise (deferred, closed, with alarms or
+    // with already buffered input) are kept in the lists below, so that
+    // an iteration does not scan all connections. Expiration is checked
+    // by a full scan about once a second.
+    // All the lists are protected with m_Mutex.
+#ifdef NCBI_OS_LINUX
+    void x_EpollCollect(const CTime& now,
+                        vector<IServer_ConnectionBase*>& timer_requests,
+                        SAlarms& alarms,
+                        vector<IServer_ConnectionBase*>& revived_conns,
+                        vector<IServer_ConnectionBase*>& to_close_conns,
+                        vector<IServer_ConnectionBase*>& to_delete_conns);
+    EIO_Status x_EpollWait(vector<CSocketAPI::SPoll>& polls,
+                           const STimeout* timeout, size_t* count);
+    void x_EpollRearm(TConnBase* conn);
+    bool x_EpollCtl(int op, TConnBase* conn, uint32_t events);
+    void x_EpollForget(TConnBase* conn);
+
+    int                         m_EpollFd;
+    int                         m_WakeupFd;
+    vector<struct epoll_event>  m_EpollEvents;
+    TData                       m_Deferred;
+    TData                       m_Alarms;
+    vector<TConnBase*>          m_Closed;
+    vector<CSocketAPI::SPoll>   m_Ready;
+    CStopWatch                  m_Clock;
+    double                      m_NextSweep;
+    /// Deadline of the caller's wait which was interrupted for the
+    /// expiration sweep only (negative if there is none)
+    double                      m_WaitDeadline;
+    /// Timeout the interrupted wait was started with
+    const STimeout*             m_WaitTimeout;
+    STimeout                    m_WaitTimeoutValue;
+#endif
 };
 
 
@@ -689,6 +689,8 @@ void CServer::x_DoRun(void)
     TConnsList to_delete_conns;
     STimeout timer_timeout;
     const STimeout* timeout;
+    CStopWatch busy_sw(CStopWatch::eStart);
+    CStopWatch wait_sw;
 
     while (!ShutdownRequested()) {
         bool has_timer = m_ConnectionPool->GetPollAndTimerVec(
@@ -728,7 +730,12 @@ void CServer::x_DoRun(void)
             timeout = &timer_timeout;
         }
 
-        EIO_Status status = CSocketAPI::Poll(polls, timeout, &count);
+        double busy_time = busy_sw.Elapsed();
+        wait_sw.Restart();
+        EIO_Status status = m_ConnectionPool->Poll(polls, timeout, &count);
+        x_UpdateLoopStat(busy_time, wait_sw.Elapsed(),
+                         status == eIO_Success ? count : 0);
+        busy_sw.Restart();
 
         if (status != eIO_Success  &&  status != eIO_Timeout) {
             int x_errno = errno;
@@ -790,6 +797,39 @@ void CServer::x_DoRun(void)
 }
 
 
+void CServer::x_UpdateLoopStat(double busy_time, double wait_time,
+                               size_t events)
+{
+    CFastMutexGuard guard(m_LoopStatLock);
+    ++m_LoopStat.iterations;
+    m_LoopStat.events += events;
+    m_LoopStat.busy_time += busy_time;
+    m_LoopStat.wait_time += wait_time;
+    if (busy_time > m_LoopStat.max_busy_time)
+        m_LoopStat.max_busy_time = busy_time;
+}
+
+
+void CServer::GetLoopStat(SServer_LoopStat* stat) const
+{
+    CFastMutexGuard guard(m_LoopStatLock);
+    *stat = m_LoopStat;
+}
+
+
+void CServer::ResetLoopStat(void)
+{
+    CFastMutexGuard guard(m_LoopStatLock);
+    m_LoopStat = SServer_LoopStat();
+}
+
+
+bool CServer::IsEpollUsed(void) const
+{
+    return m_ConnectionPool->IsEpollUsed();
+}
+
+
 void CServer::Run(void)
 {
     StartListening(); // detect unavailable ports ASAP
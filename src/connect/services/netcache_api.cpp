@@ -111,6 +111,7 @@ void SNetCacheAPIImpl::Init(CSynRegistry& registry, const SRegSynonyms& sections
     m_CacheOutput =                        registry.Get(sections, "cache_output", false);
     const bool prolong_on_write =          registry.Get(sections, "prolong_blob_lifetime_on_write", true);
     const bool create_on_write =           registry.Get(sections, "create_blob_on_write", true);
+    const bool compress_on_write =         registry.Get(sections, "compress_blob_on_write", false);
 
     m_DefaultParameters.SetMirroringMode(  registry.Get(sections, "enable_mirroring", kEmptyStr));
     m_DefaultParameters.SetServerCheck(    registry.Get(sections, "server_check", kEmptyStr));
@@ -119,7 +120,8 @@ void SNetCacheAPIImpl::Init(CSynRegistry& registry, const SRegSynonyms& sections
 
     const auto allowed_services =          registry.Get(sections, "allowed_services", kEmptyStr);
 
-    m_FlagsOnWrite = (prolong_on_write ? 0 : 1) | (create_on_write ? 0 : 2);
+    m_FlagsOnWrite = (prolong_on_write ? 0 : 1) | (create_on_write ? 0 : 2) |
+        (compress_on_write ? 4 : 0);
 
     if (allowed_services.empty()) return;
 
@@ -505,6 +507,38 @@ string CNetCacheAPI::PutData(const void* buf, size_t size,
     return PutData(kEmptyStr, buf, size, optional);
 }
 
+string SNetCacheAPIImpl::MakeBlobKey(string key, CNetServer server,
+        const CNetCacheAPIParameters* parameters)
+{
+    if (m_Service.IsLoadBalanced()) {
+        CNetCacheKey::TNCKeyFlags key_flags = 0;
+
+        switch (parameters->GetMirroringMode()) {
+        case CNetCacheAPI::eMirroringDisabled:
+            key_flags |= CNetCacheKey::fNCKey_SingleServer;
+            break;
+        case CNetCacheAPI::eMirroringEnabled:
+            break;
+        default:
+            if (!server->Get<SNetCacheServerProperties>()->mirrored)
+                key_flags |= CNetCacheKey::fNCKey_SingleServer;
+        }
+
+        bool server_check_hint = true;
+        parameters->GetServerCheckHint(&server_check_hint);
+        if (!server_check_hint)
+            key_flags |= CNetCacheKey::fNCKey_NoServerCheck;
+
+        CNetCacheKey::AddExtensions(key, m_Service.GetServiceName(),
+                key_flags);
+    }
+
+    if (parameters->GetUseCompoundID())
+        key = CNetCacheKey::KeyToCompoundID(key, m_CompoundIDPool);
+
+    return key;
+}
+
 CNetServerConnection SNetCacheAPIImpl::InitiateWriteCmd(
     CNetCacheWriter* nc_writer, const CNetCacheAPIParameters* parameters)
 {
@@ -577,32 +611,8 @@ CNetServerConnection SNetCacheAPIImpl::InitiateWriteCmd(
                 " in response to PUT3 \"" << stripped_blob_id << "\"");
         }
     } else {
-        if (m_Service.IsLoadBalanced()) {
-            CNetCacheKey::TNCKeyFlags key_flags = 0;
-
-            switch (parameters->GetMirroringMode()) {
-            case CNetCacheAPI::eMirroringDisabled:
-                key_flags |= CNetCacheKey::fNCKey_SingleServer;
-                break;
-            case CNetCacheAPI::eMirroringEnabled:
-                break;
-            default:
-                if (!exec_result.conn->m_Server->Get<SNetCacheServerProperties>()->mirrored)
-                    key_flags |= CNetCacheKey::fNCKey_SingleServer;
-            }
-
-            bool server_check_hint = true;
-            parameters->GetServerCheckHint(&server_check_hint);
-            if (!server_check_hint)
-                key_flags |= CNetCacheKey::fNCKey_NoServerCheck;
-
-            CNetCacheKey::AddExtensions(exec_result.response,
-                    m_Service.GetServiceName(), key_flags);
-        }
-
-        if (parameters->GetUseCompoundID())
-            exec_result.response = CNetCacheKey::KeyToCompoundID(
-                    exec_result.response, m_CompoundIDPool);
+        exec_result.response = MakeBlobKey(exec_result.response,
+                exec_result.conn->m_Server, parameters);
 
         nc_writer->SetBlobID(exec_result.response);
     }
@@ -666,6 +676,28 @@ bool CNetCacheAPI::HasBlob(const string& blob_id,
 }
 
 
+vector<bool> CNetCacheAPI::HasBlobs(const vector<string>& blob_ids,
+        const CNamedParameterList* optional)
+{
+    return m_Impl->HasBlobs(blob_ids, optional);
+}
+
+
+vector<CNetCacheAPI::EReadResult> CNetCacheAPI::ReadBlobs(
+        const vector<string>& keys, vector<string>& buffers,
+        const CNamedParameterList* optional)
+{
+    return m_Impl->ReadBlobs(keys, buffers, optional);
+}
+
+
+vector<string> CNetCacheAPI::PutBlobs(const vector<string>& data,
+        const CNamedParameterList* optional)
+{
+    return m_Impl->PutBlobs(data, optional);
+}
+
+
 size_t CNetCacheAPI::GetBlobSize(const string& blob_id,
         const CNamedParameterList* optional)
 {
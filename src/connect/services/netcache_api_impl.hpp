@@ -102,6 +102,18 @@ struct NCBI_XCONNECT_EXPORT SNetCacheAPIImpl : public CObject
     virtual CNetServerConnection InitiateWriteCmd(CNetCacheWriter* nc_writer,
             const CNetCacheAPIParameters* parameters);
 
+    // Add service name, flags and CompoundID form to a newly created key.
+    string MakeBlobKey(string key, CNetServer server,
+            const CNetCacheAPIParameters* parameters);
+
+    // Pipelined multi-blob commands, see netcache_batch.cpp.
+    vector<bool> HasBlobs(const vector<string>& blob_ids,
+            const CNamedParameterList* optional);
+    vector<CNetCacheAPI::EReadResult> ReadBlobs(const vector<string>& keys,
+            vector<string>& buffers, const CNamedParameterList* optional);
+    vector<string> PutBlobs(const vector<string>& data,
+            const CNamedParameterList* optional);
+
     void AppendClientIPSessionID(string* cmd, CRequestContext& req);
     void AppendHitID(string* cmd, CRequestContext& req);
     void AppendClientIPSessionIDHitID(string* cmd);
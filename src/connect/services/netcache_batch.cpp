@@ -0,0 +1,547 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   Multi-blob HASB/GET2/PUT3 for CNetCacheAPI. Commands for the same
+ *   server are written back-to-back over one connection and the responses
+ *   are read in the same order, different servers are served in parallel.
+ *
+ */
+
+
+#include <ncbi_pch.hpp>
+
+#include "netcache_api_impl.hpp"
+#include "netcache_rw.hpp"
+
+#include <connect/services/error_codes.hpp>
+
+#include <corelib/ncbithr.hpp>
+#include <util/buffer_writer.hpp>
+#include <util/transmissionrw.hpp>
+
+#include <map>
+
+
+#define NCBI_USE_ERRCODE_X  ConnServ_NetCache
+
+
+BEGIN_NCBI_SCOPE
+
+
+// Maximum number of commands written before reading their responses
+static const size_t kBatchWindow = 100;
+// PUT3 windows are also limited by the size of the blob data
+static const size_t kBatchWindowBytes = 1024 * 1024;
+// Maximum number of servers served simultaneously
+static const size_t kBatchMaxThreads = 16;
+
+
+enum ENetCacheBatchCmd {
+    eBatch_HasBlob,
+    eBatch_Read,
+    eBatch_Put
+};
+
+struct SNetCacheBatchItem
+{
+    string cmd;
+    bool done = false;
+
+    // HASB and GET2 result
+    bool found = false;
+    // GET2 output
+    string* buffer = NULL;
+
+    // PUT3 input and output
+    const string* data = NULL;
+    string key;
+};
+
+
+class CNetCacheBatchHandler : public INetServerExecHandler
+{
+public:
+    CNetCacheBatchHandler(ENetCacheBatchCmd cmd, CNetServer server) :
+        m_Cmd(cmd), m_Server(server)
+    {
+    }
+
+    virtual void Exec(CNetServerConnection::TInstance conn_impl,
+            const STimeout* timeout);
+
+    // Send as many items as possible; the rest is left for the caller.
+    void Run();
+
+    ENetCacheBatchCmd m_Cmd;
+    CNetServer m_Server;
+    vector<SNetCacheBatchItem*> m_Items;
+
+private:
+    void x_ReadResponse(CNetServerConnection::TInstance conn_impl,
+            SNetCacheBatchItem& item);
+
+    // The first item without response; TryExec() calls Exec() again
+    // on a new connection if a pooled one turns out to be closed,
+    // see the exception handler in Exec() for when this is allowed.
+    size_t m_Next = 0;
+};
+
+
+void CNetCacheBatchHandler::Exec(CNetServerConnection::TInstance conn_impl,
+        const STimeout* timeout)
+{
+    CTimeoutKeeper timeout_keeper(&conn_impl->m_Socket, timeout);
+
+    const size_t first = m_Next;
+    bool sent = false;
+
+    try {
+        while (m_Next < m_Items.size()) {
+            string request;
+            size_t end = m_Next;
+
+            do {
+                const SNetCacheBatchItem& item = *m_Items[end];
+
+                request.append(item.cmd).append("\r\n");
+
+                if (m_Cmd == eBatch_Put) {
+                    CBufferWriter<string> buffer_writer(request,
+                            eCreateMode_Add);
+                    CTransmissionWriter writer(&buffer_writer, eNoOwnership,
+                            CTransmissionWriter::eSendEofPacket);
+
+                    if (!item.data->empty())
+                        writer.Write(item.data->data(), item.data->size());
+                    writer.Close();
+                }
+            } while (++end < m_Items.size() && end - m_Next < kBatchWindow &&
+                    request.size() < kBatchWindowBytes);
+
+            sent = true;
+            conn_impl->Write(request.data(), request.size());
+
+            for (; m_Next < end; ++m_Next)
+                x_ReadResponse(conn_impl, *m_Items[m_Next]);
+        }
+    }
+    catch (CNetSrvConnException& e) {
+        conn_impl->Abort();
+
+        // TryExec() sends the rest again on a new connection after these
+        // errors. Let it do that only for HASB/GET2 with no response read
+        // on this connection, which then most likely was a pooled one
+        // closed by the server. Otherwise the items left not done are
+        // sent one by one by the caller. For PUT3 this means that blobs
+        // the server stored before the connection broke, but whose keys
+        // were not received, are stored once more; the first copies stay
+        // on the server unreferenced until their TTL expires.
+        if (sent && (m_Cmd == eBatch_Put || m_Next != first) &&
+                (e.GetErrCode() == CNetSrvConnException::eWriteFailure ||
+                 e.GetErrCode() ==
+                         CNetSrvConnException::eConnClosedByServer)) {
+            NCBI_RETHROW(e, CNetSrvConnException, eCommunicationError,
+                    "Connection closed in the middle of pipelined commands");
+        }
+        throw;
+    }
+    catch (...) {
+        // Responses to the rest of the window are still pending
+        conn_impl->Abort();
+        throw;
+    }
+}
+
+void CNetCacheBatchHandler::x_ReadResponse(
+        CNetServerConnection::TInstance conn_impl, SNetCacheBatchItem& item)
+{
+    string response;
+
+    switch (m_Cmd) {
+    case eBatch_HasBlob:
+        conn_impl->ReadCmdOutputLine(response, false);
+        item.found = response[0] == '1';
+        break;
+
+    case eBatch_Read:
+        try {
+            conn_impl->ReadCmdOutputLine(response, false);
+        }
+        catch (CNetCacheBlobTooOldException&) {
+            // Left not done: CNetCacheAPI::GetData() looks for the blob
+            // on the mirrors, as it does for a single blob.
+            return;
+        }
+        catch (CNetCacheException& e) {
+            // Same as in CNetCacheAPI::GetData()
+            if (e.GetErrCode() != CNetCacheException::eBlobNotFound &&
+                    e.GetErrCode() != CNetCacheException::eAccessDenied)
+                throw;
+            return;
+        }
+
+        {{
+            string::size_type pos = response.find("SIZE=");
+
+            if (pos == string::npos) {
+                CONNSERV_THROW_FMT(CNetCacheException, eInvalidServerResponse,
+                    m_Server,
+                    "No SIZE field in reply to the blob reading command");
+            }
+
+            size_t blob_size = CheckBlobSize(NStr::StringToUInt8(
+                    response.c_str() + pos + sizeof("SIZE=") - 1,
+                    NStr::fAllowTrailingSymbols));
+
+            item.buffer->resize(blob_size);
+
+            size_t bytes_read = 0;
+            EIO_Status io_st = blob_size == 0 ? eIO_Success :
+                    conn_impl->m_Socket.Read(&(*item.buffer)[0], blob_size,
+                            &bytes_read, eIO_ReadPersist);
+
+            if (io_st == eIO_Timeout) {
+                CONNSERV_THROW_FMT(CNetSrvConnException, eReadTimeout,
+                    m_Server, "Timeout while reading blob contents");
+            } else if (io_st != eIO_Success || bytes_read != blob_size) {
+                CONNSERV_THROW_FMT(CNetSrvConnException, eCommunicationError,
+                    m_Server, "Error while reading blob contents: " <<
+                    IO_StatusStr(io_st));
+            }
+            item.found = true;
+        }}
+        break;
+
+    case eBatch_Put:
+        conn_impl->ReadCmdOutputLine(response, false);
+
+        if (NStr::FindCase(response, "ID:") != 0 || response.size() == 3) {
+            CONNSERV_THROW_FMT(CNetServiceException, eCommunicationError,
+                m_Server, "Unexpected server response: " << response);
+        }
+        item.key = response.substr(3);
+
+        // Confirmation of the blob being stored
+        conn_impl->ReadCmdOutputLine(response, false);
+        break;
+    }
+
+    item.done = true;
+}
+
+void CNetCacheBatchHandler::Run()
+{
+    try {
+        m_Server->TryExec(*this);
+    }
+    catch (exception& e) {
+        ERR_POST_X(4, Warning << "Pipelined commands to " <<
+                m_Server.GetServerAddress() << " failed: " << e.what() <<
+                "; sending the remaining ones one by one.");
+    }
+}
+
+
+class CNetCacheBatchThread : public CThread
+{
+public:
+    CNetCacheBatchThread(vector<CNetCacheBatchHandler*>& handlers,
+            CAtomicCounter& next) :
+        m_Handlers(handlers), m_Next(next)
+    {
+    }
+
+    static void RunHandlers(vector<CNetCacheBatchHandler*>& handlers,
+            CAtomicCounter& next)
+    {
+        size_t i;
+        while ((i = size_t(next.Add(1)) - 1) < handlers.size())
+            handlers[i]->Run();
+    }
+
+protected:
+    virtual void* Main()
+    {
+        RunHandlers(m_Handlers, m_Next);
+        return NULL;
+    }
+
+private:
+    vector<CNetCacheBatchHandler*>& m_Handlers;
+    CAtomicCounter& m_Next;
+};
+
+
+// Items grouped by the server the commands are sent to
+class CNetCacheBatch
+{
+public:
+    CNetCacheBatch(SNetCacheAPIImpl* impl, ENetCacheBatchCmd cmd) :
+        m_Impl(impl), m_Cmd(cmd)
+    {
+    }
+
+    // Group a command for an existing blob by its primary server.
+    // Returns false for keys that need the full logic of
+    // SNetCacheAPIImpl::ExecMirrorAware(): version 3 keys, keys of other
+    // services and keys of servers not registered for the service.
+    bool AddKey(SNetCacheBatchItem* item, const CNetCacheKey& key,
+            const CNetCacheAPIParameters* parameters);
+
+    void Add(SNetCacheBatchItem* item, CNetServer server);
+
+    void Run();
+
+private:
+    typedef pair<unsigned, unsigned short> TAddress;
+
+    CNetCacheBatchHandler& x_GetHandler(CNetServer server);
+
+    SNetCacheAPIImpl* m_Impl;
+    ENetCacheBatchCmd m_Cmd;
+    map<TAddress, unique_ptr<CNetCacheBatchHandler>> m_Handlers;
+    map<TAddress, bool> m_InService;
+};
+
+bool CNetCacheBatch::AddKey(SNetCacheBatchItem* item, const CNetCacheKey& key,
+        const CNetCacheAPIParameters* parameters)
+{
+    if (key.GetVersion() == 3)
+        return false;
+
+    CNetService service(m_Impl->m_Service);
+
+    const string& key_service_name = key.GetServiceName();
+    if (!key_service_name.empty() &&
+            key_service_name != service.GetServiceName())
+        return false;
+
+    CNetServer server(service.GetServer(key.GetHost(), key.GetPort()));
+
+    ESwitch server_check = eDefault;
+    parameters->GetServerCheck(&server_check);
+    if (server_check == eDefault)
+        server_check = key.GetFlag(CNetCacheKey::fNCKey_NoServerCheck) ?
+                eOff : eOn;
+
+    if (server_check != eOff) {
+        auto result = m_InService.emplace(
+                TAddress(server.GetHost(), server.GetPort()), false);
+
+        if (result.second)
+            result.first->second = service->IsInService(server);
+
+        if (!result.first->second)
+            return false;
+    }
+
+    Add(item, server);
+    return true;
+}
+
+void CNetCacheBatch::Add(SNetCacheBatchItem* item, CNetServer server)
+{
+    x_GetHandler(server).m_Items.push_back(item);
+}
+
+CNetCacheBatchHandler& CNetCacheBatch::x_GetHandler(CNetServer server)
+{
+    auto& handler = m_Handlers[TAddress(server.GetHost(), server.GetPort())];
+
+    if (!handler)
+        handler.reset(new CNetCacheBatchHandler(m_Cmd, server));
+
+    return *handler;
+}
+
+void CNetCacheBatch::Run()
+{
+    vector<CNetCacheBatchHandler*> handlers;
+
+    for (auto& server_handler : m_Handlers)
+        handlers.push_back(server_handler.second.get());
+
+    CAtomicCounter next;
+    next.Set(0);
+
+    // The calling thread serves one of the servers as well
+    vector<CRef<CThread>> threads;
+    size_t thread_count = min(handlers.size(), kBatchMaxThreads);
+
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(new CNetCacheBatchThread(handlers, next));
+        threads.back()->Run();
+    }
+
+    CNetCacheBatchThread::RunHandlers(handlers, next);
+
+    for (auto& thread : threads)
+        thread->Join();
+}
+
+
+static void s_AppendGetArgs(SNetCacheAPIImpl* impl, string* cmd,
+        const CNetCacheAPIParameters* parameters)
+{
+    impl->AppendClientIPSessionIDPasswordAgeHitID(cmd, parameters);
+
+    unsigned max_age = parameters->GetMaxBlobAge();
+    if (max_age > 0) {
+        *cmd += " age=";
+        *cmd += NStr::NumericToString(max_age);
+    }
+}
+
+
+vector<bool> SNetCacheAPIImpl::HasBlobs(const vector<string>& blob_ids,
+        const CNamedParameterList* optional)
+{
+    CNetCacheAPIParameters parameters(&m_DefaultParameters);
+
+    parameters.LoadNamedParameters(optional);
+
+    vector<SNetCacheBatchItem> items(blob_ids.size());
+    CNetCacheBatch batch(this, eBatch_HasBlob);
+
+    for (size_t i = 0; i < blob_ids.size(); ++i) {
+        CNetCacheKey key(blob_ids[i], m_CompoundIDPool);
+
+        items[i].cmd = MakeCmd("HASB ", key, &parameters);
+        batch.AddKey(&items[i], key, &parameters);
+    }
+
+    batch.Run();
+
+    CNetCacheAPI api(this);
+    vector<bool> result(blob_ids.size());
+
+    for (size_t i = 0; i < blob_ids.size(); ++i) {
+        result[i] = items[i].done ? items[i].found :
+                api.HasBlob(blob_ids[i], optional);
+    }
+
+    return result;
+}
+
+vector<CNetCacheAPI::EReadResult> SNetCacheAPIImpl::ReadBlobs(
+        const vector<string>& keys, vector<string>& buffers,
+        const CNamedParameterList* optional)
+{
+    CNetCacheAPIParameters parameters(&m_DefaultParameters);
+
+    parameters.LoadNamedParameters(optional);
+
+    buffers.resize(keys.size());
+
+    vector<SNetCacheBatchItem> items(keys.size());
+    CNetCacheBatch batch(this, eBatch_Read);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        CNetCacheKey key(keys[i], m_CompoundIDPool);
+
+        items[i].cmd = "GET2 " + key.StripKeyExtensions();
+        s_AppendGetArgs(this, &items[i].cmd, &parameters);
+        items[i].buffer = &buffers[i];
+        batch.AddKey(&items[i], key, &parameters);
+    }
+
+    batch.Run();
+
+    CNetCacheAPI api(this);
+    vector<CNetCacheAPI::EReadResult> result(keys.size());
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (!items[i].done) {
+            size_t blob_size;
+            unique_ptr<IReader> reader(api.GetData(keys[i], &blob_size,
+                    optional));
+
+            items[i].found = reader.get() != NULL;
+            if (items[i].found) {
+                buffers[i].resize(blob_size);
+                ReadBuffer(*reader, &buffers[i][0], blob_size,
+                        NULL, blob_size);
+            }
+        }
+
+        if (items[i].found)
+            result[i] = CNetCacheAPI::eReadComplete;
+        else {
+            buffers[i].clear();
+            result[i] = CNetCacheAPI::eNotFound;
+        }
+    }
+
+    return result;
+}
+
+vector<string> SNetCacheAPIImpl::PutBlobs(const vector<string>& data,
+        const CNamedParameterList* optional)
+{
+    CNetCacheAPIParameters parameters(&m_DefaultParameters);
+
+    parameters.LoadNamedParameters(optional);
+
+    string cmd("PUT3 ");
+    cmd.append(NStr::IntToString(parameters.GetTTL()));
+    AppendClientIPSessionIDPasswordAgeHitID(&cmd, &parameters);
+    if (m_FlagsOnWrite) cmd.append(" flags=").append(to_string(m_FlagsOnWrite));
+
+    // New blobs are spread over the servers of the service
+    vector<CNetServer> servers;
+
+    for (CNetServiceIterator it(m_Service.Iterate(CNetService::eRandomize));
+            it; ++it) {
+        servers.push_back(*it);
+    }
+
+    vector<SNetCacheBatchItem> items(data.size());
+    CNetCacheBatch batch(this, eBatch_Put);
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        items[i].cmd = cmd;
+        items[i].data = &data[i];
+        if (!servers.empty())
+            batch.Add(&items[i], servers[i % servers.size()]);
+    }
+
+    batch.Run();
+
+    CNetCacheAPI api(this);
+    vector<string> result(data.size());
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        result[i] = items[i].done ?
+                MakeBlobKey(items[i].key, servers[i % servers.size()],
+                        &parameters) :
+                api.PutData(data[i].data(), data[i].size(), optional);
+    }
+
+    return result;
+}
+
+
+END_NCBI_SCOPE
@@ -262,8 +262,13 @@ void SNetServerConnectionImpl::WriteLine(const string& line)
     // TODO change to "\n" when no old NS/NC servers remain.
     string str(line + "\r\n");
 
-    const char* buf = str.data();
-    size_t len = str.size();
+    Write(str.data(), str.size());
+}
+
+void SNetServerConnectionImpl::Write(const void* data, size_t size)
+{
+    const char* buf = static_cast<const char*>(data);
+    size_t len = size;
 
     while (len > 0) {
         size_t n_written;
@@ -112,6 +112,7 @@ struct SNetServerConnectionImpl : public CObject
     // Return this connection to the pool.
     virtual void DeleteThis();
 
+    void Write(const void* data, size_t size);
     void WriteLine(const string& line);
     void ReadCmdOutputLine(string& result,
             bool multiline_output);
@@ -35,6 +35,7 @@
 
 #include <connect/ncbi_types.h>
 #include <connect/ncbi_core_cxx.hpp>
+#include <connect/ncbi_socket.hpp>
 
 #include <corelib/ncbiapp.hpp>
 #include <corelib/ncbiargs.hpp>
@@ -46,8 +47,11 @@
 #include <corelib/request_ctx.hpp>
 #include <corelib/ncbi_test.hpp>
 
+#include <atomic>
 #include <chrono>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <random>
 #include <thread>
@@ -878,6 +882,310 @@ static void s_SimpleTest(const CNamedParameterList* nc_params)
     }
 }
 
+static void s_BatchTest(const CNamedParameterList* nc_params)
+{
+    CNetCacheAPI api(TNetCache_ServiceName::GetDefault(), s_ClientName);
+    api.SetDefaultParameters(nc_params);
+
+    const size_t kBlobCount = 500;
+    vector<string> src(kBlobCount);
+
+    auto random_size = bind(uniform_int_distribution<size_t>(0, 100 * 1024),
+            mt19937());
+    auto random_char = bind(uniform_int_distribution<int>(0, 255), mt19937());
+
+    for (auto& data : src) {
+        data.resize(random_size());
+        generate(data.begin(), data.end(), random_char);
+    }
+
+    vector<string> keys(api.PutBlobs(src));
+    BOOST_REQUIRE_EQUAL(keys.size(), kBlobCount);
+
+    // The last blob is removed to check it is reported as missing
+    api.Remove(keys.back());
+    this_thread::sleep_for(chrono::seconds(1));
+
+    vector<bool> exist(api.HasBlobs(keys));
+    BOOST_REQUIRE_EQUAL(exist.size(), kBlobCount);
+
+    vector<string> buffers;
+    vector<CNetCacheAPI::EReadResult> results(api.ReadBlobs(keys, buffers));
+    BOOST_REQUIRE_EQUAL(results.size(), kBlobCount);
+    BOOST_REQUIRE_EQUAL(buffers.size(), kBlobCount);
+
+    for (size_t i = 0; i < kBlobCount - 1; ++i) {
+        BOOST_REQUIRE_MESSAGE(exist[i], "Blob does not exist (" << i << ")");
+        BOOST_REQUIRE_MESSAGE(results[i] == CNetCacheAPI::eReadComplete,
+                "Blob was not read (" << i << ")");
+        BOOST_REQUIRE_MESSAGE(buffers[i] == src[i],
+                "Blob content does not match the source (" << i << ")");
+    }
+
+    BOOST_REQUIRE_MESSAGE(!exist.back(), "Removed blob still exists");
+    BOOST_REQUIRE_MESSAGE(results.back() == CNetCacheAPI::eNotFound,
+            "Removed blob was read");
+
+    for (size_t i = 0; i < kBlobCount - 1; ++i)
+        api.Remove(keys[i]);
+}
+
+// NetCache server emulation: answers VERSION, HASB and GET2 for a fixed
+// set of blobs, so that mirrors can be tested without in-house servers.
+class CTestNetCacheServer
+{
+public:
+    CTestNetCacheServer() :
+        m_Listener(0)
+    {
+        m_Thread = thread(&CTestNetCacheServer::x_Listen, this);
+    }
+
+    ~CTestNetCacheServer()
+    {
+        m_Stop = true;
+        m_Thread.join();
+        for (auto& connection : m_Connections)
+            connection.join();
+    }
+
+    unsigned short GetPort() const
+    {
+        return m_Listener.GetPort(eNH_HostByteOrder);
+    }
+
+    void AddBlob(const string& key, const string& data)
+    {
+        lock_guard<mutex> lock(m_Mutex);
+        m_Blobs[key] = data;
+    }
+
+    // Number of GET2 commands received
+    size_t GetReads() const { return m_Reads; }
+
+private:
+    void x_Listen()
+    {
+        STimeout timeout = {0, 100000};
+
+        while (!m_Stop) {
+            CSocket* sock = NULL;
+
+            if (m_Listener.Accept(sock, &timeout) == eIO_Success)
+                m_Connections.emplace_back(&CTestNetCacheServer::x_Serve,
+                        this, sock);
+        }
+    }
+
+    void x_Serve(CSocket* sock)
+    {
+        unique_ptr<CSocket> sock_guard(sock);
+        // The client keeps idle connections open; a test takes less time
+        STimeout timeout = {30, 0};
+        sock->SetTimeout(eIO_Read, &timeout);
+
+        string line;
+        // The first line is the client authentication
+        if (sock->ReadLine(line) != eIO_Success)
+            return;
+
+        while (sock->ReadLine(line) == eIO_Success) {
+            NStr::TruncateSpacesInPlace(line);
+
+            vector<string> args;
+            NStr::Split(line, " ", args, NStr::fSplit_Tokenize);
+
+            string response;
+            string data;
+
+            if (args.empty()) {
+                continue;
+            } else if (args[0] == "VERSION") {
+                response = "OK:version=0.0.0&mirrored=true";
+            } else if (args.size() < 2) {
+                response = "ERR:Invalid command";
+            } else {
+                lock_guard<mutex> lock(m_Mutex);
+                auto blob = m_Blobs.find(NStr::Replace(args[1], "\"", ""));
+
+                if (args[0] == "HASB") {
+                    response = blob != m_Blobs.end() ? "OK:1" : "OK:0";
+                } else if (args[0] != "GET2") {
+                    response = "ERR:Unknown command";
+                } else {
+                    ++m_Reads;
+                    if (blob == m_Blobs.end()) {
+                        response = "ERR:BLOB not found.";
+                    } else {
+                        response = "OK:BLOB found. SIZE=" +
+                                NStr::NumericToString(blob->second.size());
+                        data = blob->second;
+                    }
+                }
+            }
+
+            response += "\r\n";
+            response += data;
+            if (sock->Write(response.data(), response.size()) != eIO_Success)
+                break;
+        }
+    }
+
+    mutex m_Mutex;
+    map<string, string> m_Blobs;
+    CListeningSocket m_Listener;
+    atomic<bool> m_Stop{false};
+    atomic<size_t> m_Reads{0};
+    thread m_Thread;
+    vector<thread> m_Connections;
+};
+
+// Blobs not found on their primary server are read from the mirrors
+static void s_BatchMirrorTest()
+{
+    const string kService("NC_BatchMirrorTest");
+    const string kHost("127.0.0.1");
+
+    CTestNetCacheServer primary, mirror;
+    unsigned short primary_port = primary.GetPort();
+
+    // keys of blobs on both servers, on the mirror only, and missing
+    vector<string> keys;
+    vector<string> src;
+    for (unsigned id = 1; id <= 3; ++id) {
+        string key;
+        CNetCacheKey::GenerateBlobKey(&key, id, kHost, primary_port, 1, id);
+        src.push_back("blob " + key);
+        if (id == 1)
+            primary.AddBlob(key, src.back());
+        if (id != 3)
+            mirror.AddBlob(key, src.back());
+        CNetCacheKey::AddExtensions(key, kService, 0);
+        keys.push_back(key);
+    }
+
+    CNcbiEnvironment env;
+    string prefix(kService);
+    NStr::ToUpper(prefix);
+    prefix += "_CONN_";
+    env.Set(prefix + "LOCAL_ENABLE", "1");
+    env.Set(prefix + "LOCAL_SERVER_1", "STANDALONE " + kHost + ':' +
+            NStr::NumericToString(primary_port));
+    env.Set(prefix + "LOCAL_SERVER_2", "STANDALONE " + kHost + ':' +
+            NStr::NumericToString(mirror.GetPort()));
+
+    {
+        CNetCacheAPI api(kService, s_ClientName);
+
+        vector<string> buffers;
+        vector<CNetCacheAPI::EReadResult> results(
+                api.ReadBlobs(keys, buffers));
+        BOOST_REQUIRE_EQUAL(results.size(), keys.size());
+
+        BOOST_CHECK(results[0] == CNetCacheAPI::eReadComplete);
+        BOOST_CHECK(buffers[0] == src[0]);
+        BOOST_CHECK(results[1] == CNetCacheAPI::eReadComplete);
+        BOOST_CHECK(buffers[1] == src[1]);
+        BOOST_CHECK(results[2] == CNetCacheAPI::eNotFound);
+        BOOST_CHECK(buffers[2].empty());
+    }
+
+    // all keys were sent to the primary server, first pipelined
+    BOOST_CHECK(primary.GetReads() >= keys.size());
+    // the two blobs not found there were looked for on the mirror
+    BOOST_CHECK_EQUAL(mirror.GetReads(), 2u);
+}
+
+static void s_CompressionTest(const CNamedParameterList* nc_params)
+{
+    CMemoryRegistry registry;
+    registry.Set("netcache_api", "service",
+            TNetCache_ServiceName::GetDefault());
+    registry.Set("netcache_api", "client_name", s_ClientName);
+    registry.Set("netcache_api", "compress_blob_on_write", "true");
+    CNetCacheAPI api(registry);
+    api.SetDefaultParameters(nc_params);
+
+    // Server side chunk sizes (kNCMaxBlobChunkSize, depending on the
+    // memory manager build); parts are read across their boundaries
+    const size_t kChunkSizes[] = { 32736, 32740 };
+    const size_t kSrcSize = 6 * 1024 * 1024; // 6MB, more than one chunk map
+    const size_t kBufSize = 77777; // not a multiple of any chunk size
+
+    // Compressible, but not trivially repetitive content
+    string src;
+    auto random_word = bind(uniform_int_distribution<int>(0, 9), mt19937());
+    const char* const kWords[] = { "alpha", "beta", "gamma", "delta",
+        "epsilon", "zeta", "eta", "theta", "iota", "kappa" };
+
+    for (size_t line = 0; src.size() < kSrcSize; ++line) {
+        src += NStr::NumericToString(line);
+        src += ' ';
+        src += kWords[random_word()];
+        src += ' ';
+        src += kWords[random_word()];
+        src += '\n';
+    }
+
+    src.resize(kSrcSize);
+
+    string key = api.PutData(src.data(), src.size());
+    BOOST_REQUIRE_MESSAGE(api.HasBlob(key), "Blob does not exist");
+    BOOST_REQUIRE_MESSAGE(api.GetBlobSize(key) == kSrcSize,
+            "Blob size (GetBlobSize) differs from the source");
+
+    // Reading the whole blob in pieces that do not match chunks
+    size_t size = 0;
+    unique_ptr<IReader> reader(api.GetData(key, &size));
+    BOOST_REQUIRE_MESSAGE(reader.get(), "Failed to get reader");
+    BOOST_REQUIRE_MESSAGE(size == kSrcSize,
+            "Blob size (GetData) differs from the source");
+
+    vector<char> buf(kBufSize);
+    size_t offset = 0;
+
+    for (;;) {
+        size_t read = s_ReadIntoBuffer(reader.get(), buf.data(), kBufSize);
+
+        if (!read) break;
+
+        BOOST_REQUIRE_MESSAGE(offset + read <= kSrcSize,
+                "Blob size is greater than the source");
+        BOOST_REQUIRE_MESSAGE(!memcmp(buf.data(), src.data() + offset, read),
+                "Blob content does not match the source at " << offset);
+        offset += read;
+    }
+
+    BOOST_REQUIRE_MESSAGE(offset == kSrcSize,
+            "Blob size is less than the source");
+    reader.reset();
+
+    string part;
+
+    // Reading parts around chunk boundaries
+    for (auto chunk_size : kChunkSizes) {
+        for (size_t boundary = chunk_size; boundary < kSrcSize;
+                boundary += chunk_size * 37) {
+            const size_t kPartOffset = boundary - 100;
+            const size_t kPartSize = 200;
+
+            api.ReadPart(key, kPartOffset, kPartSize, part);
+            BOOST_REQUIRE_MESSAGE(part == src.substr(kPartOffset, kPartSize),
+                    "Blob part does not match the source at " << kPartOffset);
+        }
+    }
+
+    // Reading parts spanning several chunks, and the tail of the blob
+    api.ReadPart(key, 12345, 3 * kChunkSizes[1], part);
+    BOOST_REQUIRE_MESSAGE(part == src.substr(12345, 3 * kChunkSizes[1]),
+            "Blob part spanning chunks does not match the source");
+    api.ReadPart(key, kSrcSize - 1000, 1000, part);
+    BOOST_REQUIRE_MESSAGE(part == src.substr(kSrcSize - 1000),
+            "Blob tail does not match the source");
+
+    api.Remove(key);
+}
+
 #define OUTPUT_CTX(ctx) ctx << '[' << __LINE__ << "]: "
 
 #define BOOST_ERROR_CTX(message, ctx) \
@@ -1038,6 +1346,31 @@ BOOST_AUTO_TEST_CASE(SimpleTestMirroring)
     s_SimpleTest(nc_mirroring_mode = CNetCacheAPI::eMirroringEnabled);
 }
 
+BOOST_AUTO_TEST_CASE(BatchTest)
+{
+    s_BatchTest(nc_mirroring_mode = CNetCacheAPI::eMirroringDisabled);
+}
+
+BOOST_AUTO_TEST_CASE(BatchTestMirroring)
+{
+    s_BatchTest(nc_mirroring_mode = CNetCacheAPI::eMirroringEnabled);
+}
+
+BOOST_AUTO_TEST_CASE(BatchMirrorTest)
+{
+    s_BatchMirrorTest();
+}
+
+BOOST_AUTO_TEST_CASE(CompressionTest)
+{
+    s_CompressionTest(nc_mirroring_mode = CNetCacheAPI::eMirroringDisabled);
+}
+
+BOOST_AUTO_TEST_CASE(CompressionTestMirroring)
+{
+    s_CompressionTest(nc_mirroring_mode = CNetCacheAPI::eMirroringEnabled);
+}
+
 BOOST_AUTO_TEST_CASE(AllowedServices)
 {
     s_AllowedServicesTest();
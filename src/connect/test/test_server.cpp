@@ -70,18 +70,32 @@ public:
     CTestServer(int max_number_of_clients, unsigned int max_delay)
         : m_MaxNumberOfClients(max_number_of_clients),
           m_MaxDelay(max_delay),
-          m_ShutdownRequested(false)
+          m_ShutdownRequested(false),
+          m_IdleTimeoutSeen(false),
+          m_AcceptTimeoutSeen(false)
     {
         m_ClientCount.Set(0);
     }
 
     /// Callback indicating whether to proceed with a clean exit.
-    virtual bool ShutdownRequested(void) { return m_ShutdownRequested; }
+    /// The exit waits until the idle client has been timed out and the
+    /// server has been idle for the accept timeout after the last client.
+    virtual bool ShutdownRequested(void)
+    {
+        return m_ShutdownRequested  &&  m_IdleTimeoutSeen
+            &&  m_AcceptTimeoutSeen;
+    }
+
+    /// Called when no socket activity has occurred for the accept timeout.
+    virtual void ProcessTimeout(void);
 
     /// Request a clean exit.  (Called by CTestConnectionHandler upon
     /// processing the Nth connection.)
     void RequestShutdown(void) { m_ShutdownRequested = true; }
 
+    /// Register that a client connection was closed for inactivity.
+    void RegisterIdleTimeout(void);
+
     /// Increment the count of client connections received, and return
     /// the new value.
     int  RegisterClient(void) { return int(m_ClientCount.Add(1)); }
@@ -99,6 +113,8 @@ private:
     CAtomicCounter     m_ClientCount;         ///< Number of connections so far
     unsigned int       m_MaxDelay;            ///< Max processing time, in ms
     volatile bool      m_ShutdownRequested;   ///< Done with the last client?
+    volatile bool      m_IdleTimeoutSeen;     ///< Idle client timed out?
+    volatile bool      m_AcceptTimeoutSeen;   ///< ProcessTimeout after all?
     mutable CRandom    m_Rng;                 ///< Random delay generator
     mutable CFastMutex m_RngMutex;            ///< Ensure RNG thread-safety
 };
@@ -110,6 +126,20 @@ unsigned int CTestServer::GetRandomDelay() const
     return m_Rng.GetRand(0, m_MaxDelay);
 }
 
+void CTestServer::ProcessTimeout(void)
+{
+    if (m_ShutdownRequested  &&  !m_AcceptTimeoutSeen) {
+        ERR_POST(Info << "Accept timeout after the last client");
+        m_AcceptTimeoutSeen = true;
+    }
+}
+
+void CTestServer::RegisterIdleTimeout(void)
+{
+    ERR_POST(Info << "Idle client timed out");
+    m_IdleTimeoutSeen = true;
+}
+
 
 /// CTestConnectionHandler --
 ///
@@ -137,6 +167,7 @@ public:
     virtual EIO_Event GetEventsToPollFor(const CTime** alarm_time) const;
     virtual void OnOpen(void); ///< MANDATORY to implement
     virtual void OnTimer(void); ///< optional (no-op by default)
+    virtual void OnTimeout(void); ///< optional (no-op by default)
 
     /// MANDATORY for subclasses of IServer_(Line)MessageHandler
     virtual void OnMessage(BUF buf);
@@ -183,6 +214,11 @@ void CTestConnectionHandler::OnTimer(void)
     m_State = SayHello;
 }
 
+void CTestConnectionHandler::OnTimeout(void)
+{
+    m_Server->RegisterIdleTimeout();
+}
+
 void CTestConnectionHandler::OnMessage(BUF buf)
 {
     char data[1024];
@@ -293,6 +329,38 @@ void CConnectionRequest::Process(void)
 }
 
 
+/// CIdleConnectionRequest --
+///
+/// Client that takes the greeting and then stays silent until the server
+/// closes the connection for inactivity.
+
+class CIdleConnectionRequest : public CStdRequest
+{
+public:
+    CIdleConnectionRequest(unsigned short port)
+        : m_Port(port)
+    {
+    }
+
+protected:
+    virtual void Process(void);
+
+private:
+    unsigned short m_Port;
+};
+
+void CIdleConnectionRequest::Process(void)
+{
+    CConn_SocketStream stream("localhost", m_Port);
+
+    string junk;
+    stream >> junk;
+
+    // Returns when the server closes the connection
+    stream >> junk;
+}
+
+
 /// CServerTestApp --
 ///
 /// Main application class pulling everything together.
@@ -357,8 +425,10 @@ void CServerTestApp::Exit(void)
     CORE_SetLOCK(0);
 }
 
-// Check for shutdown request every second
-static STimeout kAcceptTimeout = { 1, 0 };
+// Both timeouts are longer than the period of expiration checks done by
+// the epoll backend, so that these checks can't be taken for a timeout
+static STimeout kAcceptTimeout = { 2, 0 };
+static STimeout kIdleTimeout = { 3, 0 };
 
 int CServerTestApp::Run(void)
 {
@@ -397,6 +467,7 @@ int CServerTestApp::Run(void)
     params.init_threads = args["srvthreads"].AsInteger();
     params.max_threads = args["maxsrvthreads"].AsInteger();
     params.accept_timeout = &kAcceptTimeout;
+    params.idle_timeout = &kIdleTimeout;
 
     int max_number_of_clients = args["requests"].AsInteger();
 
@@ -407,10 +478,12 @@ int CServerTestApp::Run(void)
     server.StartListening();
 
     CStdPoolOfThreads pool(args["maxclthreads"].AsInteger(),
-                           max_number_of_clients);
+                           max_number_of_clients + 1);
 
     pool.Spawn(args["clthreads"].AsInteger());
 
+    pool.AcceptRequest(CRef<ncbi::CStdRequest>
+        (new CIdleConnectionRequest(port)));
     for (int i = max_number_of_clients;  i > 0;  i--) {
         pool.AcceptRequest(CRef<ncbi::CStdRequest>
             (new CConnectionRequest(port, rate_control, rate_mutex)));
@@ -0,0 +1,9 @@
+#! /bin/sh
+# $Id$
+
+# Same as test_server, with the epoll based connection pool (Linux only,
+# elsewhere the poll based one is used anyway)
+CSERVER_USE_EPOLL=1
+export CSERVER_USE_EPOLL
+
+exec $CHECK_EXEC test_server
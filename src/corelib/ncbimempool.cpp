@@ -255,14 +255,18 @@ void CObjectMemoryPool::SetMallocThreshold(size_t malloc_threshold)
 void* CObjectMemoryPool::Allocate(size_t size)
 {
     if ( size > m_MallocThreshold ) {
+        ++m_Statistics.m_LargeAllocations;
         return 0;
     }
     for ( int i = 0; i < 2; ++i ) {
         if ( !m_CurrentChunk ) {
             m_CurrentChunk = CObjectMemoryPoolChunk::CreateChunk(m_ChunkSize);
+            ++m_Statistics.m_Chunks;
         }
         void* ptr = m_CurrentChunk->Allocate(size);
         if ( ptr ) {
+            ++m_Statistics.m_Allocations;
+            m_Statistics.m_AllocatedBytes += size;
             return ptr;
         }
         m_CurrentChunk.Reset();
@@ -321,9 +321,30 @@ size_t CSeq_id_Mapper::Dump(CNcbiOstream& out, EDumpDetails details) const
     if ( details >= eDumpTotalBytes ) {
         out << "Total CSeq_id_Mapper bytes: "<<total_bytes<<endl;
     }
+    if ( details >= eDumpStatistics ) {
+        out << "CSeq_id_Mapper lock contention: "
+            << GetLockContentionCount() << endl;
+    }
     return total_bytes;
 }
 
 
+Uint8 CSeq_id_Mapper::GetLockContentionCount(void) const
+{
+    Uint8 count = 0;
+    for ( size_t i = 0; i < m_Trees.size(); ++i ) {
+        // some trees are shared between several Seq-id types
+        bool shared = false;
+        for ( size_t j = 0; j < i && !shared; ++j ) {
+            shared = m_Trees[j] == m_Trees[i];
+        }
+        if ( !shared ) {
+            count += m_Trees[i]->GetLockContentionCount();
+        }
+    }
+    return count;
+}
+
+
 END_SCOPE(objects)
 END_NCBI_SCOPE
@@ -122,6 +122,81 @@ struct PEqualNocase {
 //
 
 
+// Read/write lock of a seq-id tree.
+// Most of the requests to a tree are lookups of already existing handles,
+// so readers do not block each other. A reader registers itself in one of
+// several counters selected by the calling thread, so that concurrent
+// lookups do not modify a shared cache line. A writer takes the mutex,
+// raises the writer flag and waits until all reader counters drain.
+// Recursive locking is not allowed.
+class CSeq_id_TreeLock
+{
+public:
+    typedef CGuard<CSeq_id_TreeLock,
+                   SSimpleReadLock<CSeq_id_TreeLock>,
+                   SSimpleReadUnlock<CSeq_id_TreeLock> > TReadLockGuard;
+    typedef CGuard<CSeq_id_TreeLock,
+                   SSimpleWriteLock<CSeq_id_TreeLock>,
+                   SSimpleWriteUnlock<CSeq_id_TreeLock> > TWriteLockGuard;
+
+    CSeq_id_TreeLock(void)
+        : m_Writer(false), m_Contention(0)
+        {
+            for ( auto& stripe : m_Stripes ) {
+                stripe.m_Readers.store(0, memory_order_relaxed);
+            }
+        }
+
+    void ReadLock(void)
+        {
+            atomic<Uint4>& readers = x_GetReaders();
+            readers.fetch_add(1);
+            if ( m_Writer.load() ) {
+                x_ReadLockWait(readers);
+            }
+        }
+    void ReadUnlock(void)
+        {
+            x_GetReaders().fetch_sub(1, memory_order_release);
+        }
+
+    void WriteLock(void);
+    void WriteUnlock(void);
+
+    // Number of lock requests that had to wait for another thread
+    Uint8 GetContentionCount(void) const
+        {
+            return m_Contention.load(memory_order_relaxed);
+        }
+
+private:
+    enum {
+        kStripes = 16,
+        kStripeSize = 64 // separate cache lines
+    };
+    struct SStripe {
+        atomic<Uint4> m_Readers;
+        char m_Padding[kStripeSize - sizeof(atomic<Uint4>)];
+    };
+
+    static size_t x_NewStripeIndex(void);
+    atomic<Uint4>& x_GetReaders(void)
+        {
+            static thread_local size_t s_Index = x_NewStripeIndex();
+            return m_Stripes[s_Index].m_Readers;
+        }
+    void x_ReadLockWait(atomic<Uint4>& readers);
+
+    SStripe         m_Stripes[kStripes];
+    atomic<bool>    m_Writer;
+    atomic<Uint8>   m_Contention;
+    CFastMutex      m_WriteMutex;
+
+    CSeq_id_TreeLock(const CSeq_id_TreeLock&);
+    CSeq_id_TreeLock& operator=(const CSeq_id_TreeLock&);
+};
+
+
 // Base class for seq-id type-specific trees
 class CSeq_id_Which_Tree : public CObject
 {
@@ -167,6 +242,11 @@ public:
                         CSeq_id::E_Choice type,
                         int details) const = 0;
 
+    Uint8 GetLockContentionCount(void) const
+        {
+            return m_TreeLock.GetContentionCount();
+        }
+
 protected:
     friend class CSeq_id_Mapper;
 
@@ -185,7 +265,7 @@ protected:
         }
     virtual void x_Unindex(const CSeq_id_Info* info) = 0;
 
-    typedef CFastMutex TTreeLock;
+    typedef CSeq_id_TreeLock TTreeLock;
     typedef TTreeLock::TReadLockGuard TReadLockGuard;
     typedef TTreeLock::TWriteLockGuard TWriteLockGuard;
 
@@ -41,6 +41,7 @@
 #include <objects/general/Object_id.hpp>
 #include <objects/seq/Seq_inst.hpp>
 #include <objects/seqloc/seqloc__.hpp>
+#include <objects/seq/seq_id_mapper.hpp>
 #include <objects/seqfeat/Seq_feat.hpp>
 #include <objects/seqfeat/SeqFeatData.hpp>
 
@@ -167,6 +168,71 @@ BOOST_AUTO_TEST_CASE(s_MTGiTest)
         tt[i].join();
     }
 }
+
+
+BOOST_AUTO_TEST_CASE(s_MTLookupTest)
+{
+    // concurrent lookups of existing handles mixed with creation
+    // and release of new ones must always return the same handle
+    const size_t NQ = 16;
+    const int kIds = 200;
+    vector<CSeq_id_Handle> ids;
+    for ( int i = 0; i < kIds; ++i ) {
+        CSeq_id id;
+        switch ( i%3 ) {
+        case 0:
+            id.SetOther().SetAccession("NC_"+NStr::NumericToString(100000+i));
+            break;
+        case 1:
+            id.SetLocal().SetStr("mt_lookup_"+NStr::NumericToString(i));
+            break;
+        default:
+            id.SetGeneral().SetDb("MTLOOKUP");
+            id.SetGeneral().SetTag().SetId(i);
+            break;
+        }
+        ids.push_back(CSeq_id_Handle::GetHandle(id));
+    }
+    CRef<CSeq_id_Mapper> mapper = CSeq_id_Mapper::GetInstance();
+    vector<thread> tt(NQ);
+    atomic<int> errors(0);
+    for ( size_t i = 0; i < NQ; ++i ) {
+        tt[i] =
+            thread([&]
+                   (int t)
+                   {
+                       CRandom random(t);
+                       for ( int i = 0; i < 20000; ++i ) {
+                           int k = random.GetRand(0, kIds-1);
+                           CSeq_id_Handle idh =
+                               CSeq_id_Handle::GetHandle(*ids[k].GetSeqId());
+                           if ( idh != ids[k] ) {
+                               ++errors;
+                           }
+                           CSeq_id tmp_id;
+                           tmp_id.SetLocal().SetId(t*100000+i%100);
+                           CSeq_id_Handle tmp = CSeq_id_Handle::GetHandle(tmp_id);
+                           if ( tmp.GetSeqId()->GetLocal().GetId() != t*100000+i%100 ) {
+                               ++errors;
+                           }
+                       }
+                   }, int(i));
+    }
+    for ( size_t i = 0; i < NQ; ++i ) {
+        tt[i].join();
+    }
+    BOOST_CHECK_EQUAL(errors.load(), 0);
+
+    // Uncontended lookups and insertions must not be counted as contention
+    Uint8 contention = mapper->GetLockContentionCount();
+    for ( int i = 0; i < kIds; ++i ) {
+        BOOST_CHECK(CSeq_id_Handle::GetHandle(*ids[i].GetSeqId()) == ids[i]);
+        CSeq_id tmp_id;
+        tmp_id.SetLocal().SetStr("mt_lookup_new_"+NStr::NumericToString(i));
+        CSeq_id_Handle::GetHandle(tmp_id);
+    }
+    BOOST_CHECK_EQUAL(mapper->GetLockContentionCount(), contention);
+}
 #endif
 
 
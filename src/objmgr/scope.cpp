@@ -43,9 +43,13 @@
 #include <objmgr/seq_entry_handle.hpp>
 #include <objmgr/seq_annot_handle.hpp>
 #include <objmgr/bioseq_set_handle.hpp>
+#include <objmgr/feat_ci.hpp>
 #include <objmgr/impl/scope_impl.hpp>
 #include <objmgr/impl/synonyms.hpp>
 #include <objmgr/error_codes.hpp>
+#include <objmgr/objmgr_exception.hpp>
+#include <objects/seqloc/Seq_loc.hpp>
+#include <corelib/ncbithr.hpp>
 
 
 #define NCBI_USE_ERRCODE_X   ObjMgr_Scope
@@ -519,6 +523,18 @@ void CScope::AddScope(CScope& scope, TPriority priority)
 }
 
 
+void CScope::Freeze(void)
+{
+    m_Impl->Freeze();
+}
+
+
+bool CScope::IsFrozen(void) const
+{
+    return m_Impl->IsFrozen();
+}
+
+
 CSeq_entry_Handle CScope::AddTopLevelSeqEntry(CSeq_entry& entry,
                                               TPriority priority,
                                               EExist action)
@@ -908,5 +924,141 @@ CScope::TSequenceHashes CScope::GetSequenceHashes(const TSeq_id_Handles& ids,
 }
 
 
+static
+void s_CollectBulkFeatures(CScope& scope,
+                           const CScope::TSeq_locs& locs,
+                           const SAnnotSelector& sel,
+                           CScope::TBulkFeatures& results,
+                           size_t begin, size_t end)
+{
+    for ( size_t i = begin; i < end; ++i ) {
+        if ( !locs[i] ) {
+            continue;
+        }
+        CScope::TMappedFeats& feats = results[i];
+        for ( CFeat_CI it(scope, *locs[i], sel); it; ++it ) {
+            feats.push_back(*it);
+        }
+    }
+}
+
+
+#ifdef NCBI_THREADS
+class CBulkFeaturesThread : public CThread
+{
+public:
+    CBulkFeaturesThread(CScope& scope,
+                        const CScope::TSeq_locs& locs,
+                        const SAnnotSelector& sel,
+                        CScope::TBulkFeatures& results,
+                        size_t begin, size_t end)
+        : m_Scope(scope),
+          m_Locs(locs),
+          m_Sel(sel),
+          m_Results(results),
+          m_Begin(begin),
+          m_End(end)
+        {
+        }
+
+    /// Exception thrown while collecting features, if any
+    const exception_ptr& GetError(void) const
+        {
+            return m_Error;
+        }
+
+protected:
+    virtual void* Main(void) override
+        {
+            try {
+                s_CollectBulkFeatures(m_Scope, m_Locs, m_Sel, m_Results,
+                                      m_Begin, m_End);
+            }
+            catch ( ... ) {
+                m_Error = current_exception();
+            }
+            return 0;
+        }
+
+private:
+    CScope& m_Scope;
+    const CScope::TSeq_locs& m_Locs;
+    const SAnnotSelector& m_Sel;
+    CScope::TBulkFeatures& m_Results;
+    size_t m_Begin, m_End;
+    exception_ptr m_Error;
+};
+#endif
+
+
+void CScope::GetBulkFeatures(TBulkFeatures* results,
+                             const TSeq_locs& locs,
+                             const SAnnotSelector& sel,
+                             unsigned thread_count)
+{
+    if ( !results ) {
+        NCBI_THROW(CCoreException, eNullPtr,
+                   "CScope::GetBulkFeatures: null results pointer");
+    }
+    results->clear();
+    results->resize(locs.size());
+
+    // resolve all referenced sequences at once so the loaders
+    // get batched requests, and keep them locked while collecting
+    TIds ids;
+    ITERATE ( TSeq_locs, it, locs ) {
+        if ( !*it ) {
+            continue;
+        }
+        for ( CSeq_loc_CI loc_it(**it); loc_it; ++loc_it ) {
+            if ( !loc_it.IsEmpty() ) {
+                ids.push_back(loc_it.GetSeq_id_Handle());
+            }
+        }
+    }
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    TBioseqHandles bhs = GetBioseqHandles(ids);
+
+    size_t count = locs.size();
+#ifdef NCBI_THREADS
+    size_t threads = min(size_t(max(thread_count, 1u)), count);
+    if ( threads > 1 ) {
+        typedef vector< CRef<CBulkFeaturesThread> > TThreads;
+        TThreads tt;
+        for ( size_t i = 0; i < threads; ++i ) {
+            size_t begin = count*i/threads, end = count*(i+1)/threads;
+            tt.push_back(Ref(new CBulkFeaturesThread(*this, locs, sel,
+                                                     *results, begin, end)));
+            tt.back()->Run();
+        }
+        // rethrow the first error as it was thrown in the thread
+        exception_ptr error;
+        NON_CONST_ITERATE ( TThreads, it, tt ) {
+            (*it)->Join();
+            if ( (*it)->GetError() && !error ) {
+                error = (*it)->GetError();
+            }
+        }
+        if ( error ) {
+            rethrow_exception(error);
+        }
+        return;
+    }
+#endif
+    s_CollectBulkFeatures(*this, locs, sel, *results, 0, count);
+}
+
+
+CScope::TBulkFeatures CScope::GetBulkFeatures(const TSeq_locs& locs,
+                                              const SAnnotSelector& sel,
+                                              unsigned thread_count)
+{
+    TBulkFeatures results;
+    GetBulkFeatures(&results, locs, sel, thread_count);
+    return results;
+}
+
+
 END_SCOPE(objects)
 END_NCBI_SCOPE
@@ -114,6 +114,8 @@ CScope_Impl::CScope_Impl(CObjectManager& objmgr)
 
 CScope_Impl::~CScope_Impl(void)
 {
+    // nobody else can use the scope anymore
+    m_ConfLock.Unfreeze();
     TConfWriteLockGuard guard(m_ConfLock);
     x_DetachFromOM();
 }
@@ -137,6 +139,9 @@ void CScope_Impl::x_AttachToOM(CObjectManager& objmgr)
 void CScope_Impl::x_DetachFromOM(void)
 {
     _ASSERT(m_ObjMgr);
+    // The scope is unusable after detaching, so it may be reset even
+    // if it is frozen; this is also called from ~CObjectManager().
+    m_ConfLock.Unfreeze();
     // Drop and release all TSEs
     ResetScope();
     m_ObjMgr->RevokeScope(*this);
@@ -176,6 +181,28 @@ void CScope_Impl::SetKeepExternalAnnotsForEdit(bool keep)
 }
 
 
+void CScope_ConfLock::x_ThrowFrozen(void)
+{
+    NCBI_THROW(CObjMgrException, eModifyDataError,
+               "CScope is frozen: its configuration cannot be changed");
+}
+
+
+void CScope_Impl::Freeze(void)
+{
+    if ( m_ConfLock.IsFrozen() ) {
+        return;
+    }
+    TConfWriteLockGuard guard(m_ConfLock);
+    // transactions are created under the same lock
+    if ( m_Transaction ) {
+        NCBI_THROW(CObjMgrException, eTransaction,
+                   "CScope_Impl::Freeze: transaction is active");
+    }
+    m_ConfLock.SetFrozen();
+}
+
+
 void CScope_Impl::AddDefaults(TPriority priority)
 {
     CObjectManager::TDataSourcesLock ds_set;
@@ -1291,7 +1318,12 @@ CSeq_feat_Handle CScope_Impl::GetSeq_featHandle(const CSeq_feat& feat,
                    "Seq-feat location is empty");
     }
     
-    TConfWriteLockGuard guard(m_ConfLock);
+    // the lookup itself does not change the configuration,
+    // so a frozen scope doesn't need the lock
+    TConfWriteLockGuard guard(eEmptyGuard);
+    if ( !m_ConfLock.IsFrozen() ) {
+        guard.Guard(m_ConfLock);
+    }
     for (CPriority_I it(m_setDataSrc); it; ++it) {
         CDataSource_ScopeInfo::TSeq_feat_Lock lock =
             it->FindSeq_feat_Lock(loc_id, loc_pos, feat);
@@ -3243,12 +3275,18 @@ IScopeTransaction_Impl* CScope_Impl::CreateTransaction()
     } else {
         m_Transaction = new CScopeTransaction_Impl(*this);
         }*/
+    TConfWriteLockGuard guard(m_ConfLock);
     m_Transaction = new CScopeTransaction_Impl(*this, m_Transaction);
     return m_Transaction;   
 }
 
 void CScope_Impl::SetActiveTransaction(IScopeTransaction_Impl* transaction)
 {
+    TConfWriteLockGuard guard(eEmptyGuard);
+    if ( transaction ) {
+        // a frozen scope cannot join a transaction
+        guard.Guard(m_ConfLock);
+    }
     if (m_Transaction && (transaction && !transaction->HasScope(*this))) {
         NCBI_THROW(CObjMgrException, eModifyDataError,
                    "CScope_Impl::AttachToTransaction: already attached to another transaction");
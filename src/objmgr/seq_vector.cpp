@@ -348,6 +348,93 @@ void CSeqVector::GetPackedSeqData(string& dst_str,
     }
 }
 
+static inline
+const char* s_GetPackedDataPtr(const CSeq_data& data)
+{
+    switch ( data.Which() ) {
+    case CSeq_data::e_Ncbi2na:
+        return data.GetNcbi2na().Get().data();
+    case CSeq_data::e_Ncbi4na:
+        return data.GetNcbi4na().Get().data();
+    case CSeq_data::e_Iupacna:
+        return data.GetIupacna().Get().data();
+    case CSeq_data::e_Ncbi8na:
+        return data.GetNcbi8na().Get().data();
+    case CSeq_data::e_Iupacaa:
+        return data.GetIupacaa().Get().data();
+    case CSeq_data::e_Ncbieaa:
+        return data.GetNcbieaa().Get().data();
+    case CSeq_data::e_Ncbi8aa:
+        return data.GetNcbi8aa().Get().data();
+    case CSeq_data::e_Ncbistdaa:
+        return data.GetNcbistdaa().Get().data();
+    default:
+        return 0;
+    }
+}
+
+
+bool CSeqVector::GetPackedSegments(TPackedSegments& segments,
+                                   TSeqPos src_pos,
+                                   TSeqPos src_end) const
+{
+    segments.clear();
+    src_end = min(src_end, size());
+    if ( src_pos >= src_end ) {
+        return true;
+    }
+
+    if ( m_TSE && !CanGetRange(src_pos, src_end) ) {
+        NCBI_THROW_FMT(CSeqVectorException, eDataError,
+                       "CSeqVector::GetPackedSegments: "
+                       "cannot get seq-data in range: "
+                       <<src_pos<<"-"<<src_end);
+    }
+
+    SSeqMapSelector sel(CSeqMap::fDefaultFlags, kMax_UInt);
+    sel.SetStrand(m_Strand);
+    if ( m_TSE ) {
+        sel.SetLinkUsedTSE(m_TSE);
+    }
+    CSeqMap_CI seg(m_SeqMap, m_Scope.GetScopeOrNull(), sel, src_pos);
+
+    while ( src_pos < src_end ) {
+        TSeqPos count = min(src_end-src_pos, seg.GetEndPosition()-src_pos);
+        SPackedSegment packed;
+        packed.m_Pos = src_pos;
+        packed.m_Length = count;
+        packed.m_Coding = CSeq_data::e_not_set;
+        packed.m_Data = 0;
+        packed.m_DataPos = 0;
+        packed.m_Reverse = false;
+        if ( seg.GetType() != CSeqMap::eSeqGap &&
+             !seg.GetRefData().IsGap() ) {
+            const CSeq_data& data = seg.GetRefData();
+            packed.m_Data = s_GetPackedDataPtr(data);
+            if ( !packed.m_Data ) {
+                segments.clear();
+                return false;
+            }
+            packed.m_Coding = data.Which();
+            packed.m_Reverse = seg.GetRefMinusStrand();
+            if ( packed.m_Reverse ) {
+                packed.m_DataPos = seg.GetRefEndPosition() -
+                    (src_pos - seg.GetPosition()) - count;
+            }
+            else {
+                packed.m_DataPos = seg.GetRefPosition() +
+                    (src_pos - seg.GetPosition());
+            }
+            packed.m_SeqData = &data;
+        }
+        segments.push_back(packed);
+        ++seg;
+        src_pos += count;
+    }
+    return true;
+}
+
+
 static const size_t kBufferSize = 1024; // must be multiple of 4
 
 static inline
@@ -893,8 +893,192 @@ BOOST_AUTO_TEST_CASE(TestReResolveMT4)
         BOOST_REQUIRE_EQUAL(c, total_feats);
     }
 }
+
+
+BOOST_AUTO_TEST_CASE(TestFrozenScopeMT)
+{
+    const size_t COUNT = 1000;
+    const size_t THREADS = 10;
+
+    // check lookups in a frozen scope
+    CScope scope(*CObjectManager::GetInstance());
+    vector< CRef<CSeq_id> > ids, ids2;
+    size_t total_feats = 0;
+    for ( size_t i = 0; i < COUNT; ++i ) {
+        ids.push_back(s_GetId(i));
+        ids2.push_back(s_GetId2(i));
+        scope.AddTopLevelSeqEntry(*s_GetEntry(i));
+        size_t count = i%5+1;
+        scope.AddSeq_annot(*s_GetAnnot(*ids.back(), count));
+        total_feats += count;
+    }
+    BOOST_CHECK(!scope.IsFrozen());
+    scope.Freeze();
+    BOOST_CHECK(scope.IsFrozen());
+    for ( auto c : s_GetBioseqParallel(THREADS, scope, ids, ids2) ) {
+        BOOST_REQUIRE_EQUAL(c, COUNT);
+    }
+    for ( auto c : s_GetFeatParallel(THREADS, scope, ids) ) {
+        BOOST_REQUIRE_EQUAL(c, total_feats);
+    }
+    // configuration changes are not allowed anymore
+    BOOST_CHECK_THROW(scope.AddTopLevelSeqEntry(*s_GetEntry(COUNT)),
+                      CObjMgrException);
+    BOOST_CHECK_THROW(scope.ResetHistory(), CObjMgrException);
+    BOOST_CHECK_THROW(scope.RemoveTopLevelSeqEntry
+                      (scope.GetBioseqHandle(*ids[0]).GetTopLevelEntry()),
+                      CObjMgrException);
+    BOOST_CHECK(scope.GetBioseqHandle(*ids[0]));
+}
 #endif // NCBI_THREADS
 
+BOOST_AUTO_TEST_CASE(TestFrozenScopeTransaction)
+{
+    CRef<CScope> scope(new CScope(*CObjectManager::GetInstance()));
+    CRef<CSeq_id> id = s_GetId(0);
+    scope->AddTopLevelSeqEntry(*s_GetEntry(0));
+    // an edit handle obtained before freezing
+    CBioseq_EditHandle ebh = scope->GetBioseqHandle(*id).GetEditHandle();
+    {{
+        // a scope with an active transaction cannot be frozen
+        CScopeTransaction tr = scope->GetTransaction();
+        BOOST_CHECK_THROW(scope->Freeze(), CObjMgrException);
+        BOOST_CHECK(!scope->IsFrozen());
+    }}
+    scope->Freeze();
+    BOOST_CHECK(scope->IsFrozen());
+    // freezing again is allowed
+    scope->Freeze();
+    // a frozen scope cannot start a transaction
+    BOOST_CHECK_THROW(scope->GetTransaction(), CObjMgrException);
+    // edit commands need a transaction
+    CRef<CSeqdesc> desc(new CSeqdesc);
+    desc->SetTitle("title");
+    BOOST_CHECK_THROW(ebh.AddSeqdesc(*desc), CObjMgrException);
+    BOOST_CHECK(!ebh.IsSetDescr());
+    ebh.Reset();
+    BOOST_CHECK(scope->GetBioseqHandle(*id));
+    // a frozen scope is reset when it detaches from the object manager
+    BOOST_CHECK_NO_THROW(scope.Reset());
+}
+
+BOOST_AUTO_TEST_CASE(TestBulkFeatures)
+{
+    const size_t COUNT = 200;
+
+    // check that bulk collection matches per-location CFeat_CI
+    CScope scope(*CObjectManager::GetInstance());
+    CScope::TSeq_locs locs;
+    for ( size_t i = 0; i < COUNT; ++i ) {
+        CRef<CSeq_id> id = s_GetId(i);
+        scope.AddTopLevelSeqEntry(*s_GetEntry(i));
+        if ( i%5 ) {
+            scope.AddSeq_annot(*s_GetAnnot(*id, i%5));
+        }
+        locs.push_back(CConstRef<CSeq_loc>(s_CreateLoc(id.GetPointer())));
+    }
+    // missing sequence and null location
+    CRef<CSeq_id> missing_id = s_GetId(COUNT);
+    locs.push_back(CConstRef<CSeq_loc>(s_CreateLoc(missing_id.GetPointer())));
+    locs.push_back(null);
+    SAnnotSelector sel(CSeqFeatData::e_Region);
+    // thread count 0 collects in the calling thread, as 1 does
+    const unsigned kThreadCounts[] = { 0, 1, 2, 4 };
+    for ( auto threads : kThreadCounts ) {
+        CScope::TBulkFeatures feats =
+            scope.GetBulkFeatures(locs, sel, threads);
+        BOOST_REQUIRE_EQUAL(feats.size(), locs.size());
+        for ( size_t i = 0; i < COUNT; ++i ) {
+            CFeat_CI it(scope, *locs[i], sel);
+            BOOST_REQUIRE_EQUAL(feats[i].size(), i%5);
+            for ( size_t j = 0; j < feats[i].size(); ++j, ++it ) {
+                BOOST_CHECK(feats[i][j].GetOriginalSeq_feat() ==
+                            it->GetOriginalSeq_feat());
+            }
+        }
+        BOOST_CHECK(feats[COUNT].empty());
+        BOOST_CHECK(feats[COUNT+1].empty());
+    }
+    // null results pointer
+    BOOST_CHECK_THROW(scope.GetBulkFeatures(0, locs, sel), CCoreException);
+}
+
+
+static Uint1 s_GetPackedResidue4na(const CSeqVector::SPackedSegment& seg,
+                                   TSeqPos offset)
+{
+    TSeqPos pos = seg.m_Reverse?
+        seg.m_DataPos + seg.m_Length - 1 - offset:
+        seg.m_DataPos + offset;
+    Uint1 ret;
+    if ( seg.m_Coding == CSeq_data::e_Ncbi2na ) {
+        ret = Uint1(1 << ((seg.m_Data[pos>>2] >> (6-2*(pos&3))) & 3));
+    }
+    else {
+        BOOST_REQUIRE_EQUAL(seg.m_Coding, CSeq_data::e_Ncbi4na);
+        ret = Uint1((seg.m_Data[pos>>1] >> ((pos&1)? 0: 4)) & 15);
+    }
+    if ( seg.m_Reverse ) {
+        // complement in Ncbi4na is the reversed bit order
+        ret = Uint1(((ret&1)<<3)|((ret&2)<<1)|((ret&4)>>1)|((ret&8)>>3));
+    }
+    return ret;
+}
+
+
+BOOST_AUTO_TEST_CASE(TestPackedSegments)
+{
+    // delta sequence of Ncbi2na literal, gap, and Ncbi4na literal
+    CRef<CSeq_entry> entry(new CSeq_entry);
+    CBioseq& seq = entry->SetSeq();
+    seq.SetId().push_back(s_GetId(0));
+    CSeq_inst& inst = seq.SetInst();
+    inst.SetRepr(inst.eRepr_delta);
+    inst.SetMol(inst.eMol_dna);
+    inst.SetLength(8+5+3);
+    CRef<CDelta_seq> lit;
+    lit = new CDelta_seq;
+    lit->SetLiteral().SetLength(8);
+    lit->SetLiteral().SetSeq_data().SetNcbi2na().Set() = {'\x1b', '\x2d'};
+    inst.SetExt().SetDelta().Set().push_back(lit);
+    lit = new CDelta_seq;
+    lit->SetLiteral().SetLength(5);
+    inst.SetExt().SetDelta().Set().push_back(lit);
+    lit = new CDelta_seq;
+    lit->SetLiteral().SetLength(3);
+    lit->SetLiteral().SetSeq_data().SetNcbi4na().Set() = {'\x12', '\x4f'};
+    inst.SetExt().SetDelta().Set().push_back(lit);
+
+    CScope scope(*CObjectManager::GetInstance());
+    CBioseq_Handle bh = scope.AddTopLevelSeqEntry(*entry).GetSeq();
+    for ( int minus = 0; minus < 2; ++minus ) {
+        CSeqVector sv(bh, bh.eCoding_Ncbi,
+                      minus? eNa_strand_minus: eNa_strand_plus);
+        sv.SetCoding(CSeq_data::e_Ncbi4na);
+        string expected;
+        sv.GetSeqData(0, sv.size(), expected);
+        for ( TSeqPos start = 0; start < sv.size(); start += 3 ) {
+            CSeqVector::TPackedSegments segs;
+            BOOST_REQUIRE(sv.GetPackedSegments(segs, start));
+            TSeqPos pos = start;
+            for ( auto& seg : segs ) {
+                BOOST_REQUIRE_EQUAL(seg.m_Pos, pos);
+                for ( TSeqPos i = 0; i < seg.m_Length; ++i, ++pos ) {
+                    if ( !seg.m_Data ) {
+                        BOOST_CHECK(sv.IsInGap(pos));
+                    }
+                    else {
+                        BOOST_CHECK_EQUAL(int(s_GetPackedResidue4na(seg, i)),
+                                          int(Uint1(expected[pos])));
+                    }
+                }
+            }
+            BOOST_CHECK_EQUAL(pos, sv.size());
+        }
+    }
+}
+
+
 BOOST_AUTO_TEST_CASE(CppIterFeat)
 {
     // check for C++-11 style feature iteration
@@ -0,0 +1,693 @@
+/* $Id$
+* ===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE
+*               National Center for Biotechnology Information
+*
+*  This software/database is a "United States Government Work" under the
+*  terms of the United States Copyright Act.  It was written as part of
+*  the author's offical duties as a United States Government employee and
+*  thus cannot be copyrighted.  This software/database is freely available
+*  to the public for use. The National Library of Medicine and the U.S.
+*  Government have not placed any restriction on its use or reproduction.
+*
+*  Although all reasonable efforts have been taken to ensure the accuracy
+*  and reliability of the software and data, the NLM and the U.S.
+*  Government do not and cannot warrant the performance or results that
+*  may be obtained by using this software or data. The NLM and the U.S.
+*  Government disclaim all warranties, express or implied, including
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.
+*
+*  Please cite the author in any work or product based on this material.
+*
+* ===========================================================================
+*/
+
+/// @file: binary_tabular.cpp
+/// Binary columnar form of the BLAST tabular output.
+#include <ncbi_pch.hpp>
+
+#include <objtools/align_format/binary_tabular.hpp>
+#include <util/compress/zstd.hpp>
+
+#include <cstring>
+#include <limits>
+
+BEGIN_NCBI_SCOPE
+BEGIN_SCOPE(align_format)
+
+/// File signature
+static const char kMagic[4] = { 'B', 'L', 'T', 'C' };
+/// Format version
+static const Uint1 kVersion = 1;
+
+/// Text of numeric values that are not available
+static const char* kNotAvailable = "N/A";
+
+/// Size of a block header: rows, codec, payload size, stored size
+static const size_t kBlockHeaderSize = 4 + 1 + 4 + 4;
+
+static void s_PutUint2(string& buf, Uint2 value)
+{
+    buf += (char)(value & 0xff);
+    buf += (char)(value >> 8);
+}
+
+static void s_PutUint4(string& buf, Uint4 value)
+{
+    for (int i = 0;  i < 4;  i++) {
+        buf += (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static void s_PutUint8(string& buf, Uint8 value)
+{
+    for (int i = 0;  i < 8;  i++) {
+        buf += (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+static Uint8 s_GetUint(const char*& ptr, const char* end, int num_bytes)
+{
+    if (end - ptr < num_bytes) {
+        NCBI_THROW(CException, eInvalid,
+                   "Truncated binary tabular data");
+    }
+    Uint8 value = 0;
+    for (int i = 0;  i < num_bytes;  i++) {
+        value |= (Uint8)(unsigned char)ptr[i] << (8 * i);
+    }
+    ptr += num_bytes;
+    return value;
+}
+
+/// Read exactly the given number of bytes from a stream
+static bool s_Read(CNcbiIstream& istr, char* buf, size_t size)
+{
+    istr.read(buf, size);
+    return (size_t)istr.gcount() == size;
+}
+
+bool
+CBlastBinaryTabularWriter::IsCompressionSupported(ECompression compression)
+{
+    if (compression == eNoCompression) {
+        return true;
+    }
+#if defined(HAVE_LIBZSTD)
+    return compression == eZstd;
+#else
+    return false;
+#endif
+}
+
+CBlastBinaryTabularWriter::ECompression
+CBlastBinaryTabularWriter::GetDefaultCompression(void)
+{
+    return IsCompressionSupported(eZstd) ? eZstd : eNoCompression;
+}
+
+CBlastBinaryTabularWriter::CBlastBinaryTabularWriter(CNcbiOstream& ostr,
+                                                     ECompression compression,
+                                                     size_t rows_per_block)
+    : m_Ostream(ostr),
+      m_Compression(compression),
+      m_RowsPerBlock(max(rows_per_block, (size_t)1)),
+      m_NumRows(0),
+      m_NextColumn(0),
+      m_HeaderWritten(false),
+      m_Finished(false)
+{
+    if ( !IsCompressionSupported(m_Compression) ) {
+        ERR_POST(Warning << "Compression of binary tabular output is not "
+                 "supported in this build, writing uncompressed data");
+        m_Compression = eNoCompression;
+    }
+}
+
+CBlastBinaryTabularWriter::~CBlastBinaryTabularWriter()
+{
+    try {
+        Finish();
+    } catch (...) {/*ignore exceptions*/}
+}
+
+void
+CBlastBinaryTabularWriter::SetColumns(const TBinaryTabularColumns& columns)
+{
+    if (m_HeaderWritten) {
+        NCBI_THROW(CException, eInvalid,
+                   "Binary tabular columns are already set");
+    }
+    m_Columns = columns;
+    m_Buffers.clear();
+    m_Buffers.resize(m_Columns.size());
+
+    string header(kMagic, sizeof(kMagic));
+    header += (char)kVersion;
+    s_PutUint4(header, (Uint4)m_Columns.size());
+    ITERATE(TBinaryTabularColumns, it, m_Columns) {
+        header += (char)it->type;
+        s_PutUint2(header, (Uint2)it->name.size());
+        header += it->name;
+    }
+    m_Ostream.write(header.data(), header.size());
+    m_HeaderWritten = true;
+}
+
+void
+CBlastBinaryTabularWriter::AddRow(const vector<string>& values)
+{
+    if (values.size() != m_Columns.size()) {
+        NCBI_THROW(CException, eInvalid,
+                   "Number of values does not match the binary tabular "
+                   "columns");
+    }
+
+    try {
+        for (size_t i = 0;  i < m_Columns.size();  i++) {
+            bool not_available = (values[i] == kNotAvailable);
+            switch (m_Columns[i].type) {
+            case eBTC_Int4:
+            case eBTC_Int8:
+                SetInteger(i, not_available ?
+                              -1 : NStr::StringToInt8(values[i]));
+                break;
+            case eBTC_Double:
+                SetDouble(i, not_available ?
+                             numeric_limits<double>::quiet_NaN() :
+                             NStr::StringToDouble(values[i]));
+                break;
+            case eBTC_String:
+                SetString(i, values[i]);
+                break;
+            }
+        }
+    } catch (...) {
+        x_DiscardRow();
+        throw;
+    }
+    EndRow();
+}
+
+void
+CBlastBinaryTabularWriter::x_DiscardRow(void)
+{
+    for (size_t i = 0;  i < m_NextColumn;  i++) {
+        SColumnBuffer& buffer = m_Buffers[i];
+        switch (m_Columns[i].type) {
+        case eBTC_Int4:
+        case eBTC_Int8:
+            buffer.ints.pop_back();
+            break;
+        case eBTC_Double:
+            buffer.reals.pop_back();
+            break;
+        case eBTC_String:
+            buffer.indices.pop_back();
+            break;
+        }
+    }
+    m_NextColumn = 0;
+}
+
+CBlastBinaryTabularWriter::SColumnBuffer&
+CBlastBinaryTabularWriter::x_GetBuffer(size_t col,
+                                       EBinaryTabularColumnType type)
+{
+    _ASSERT(m_HeaderWritten && !m_Finished);
+    if (col != m_NextColumn  ||  col >= m_Columns.size()) {
+        NCBI_THROW(CException, eInvalid,
+                   "Binary tabular values must be set column by column");
+    }
+    bool is_int = (type == eBTC_Int4  ||  type == eBTC_Int8);
+    EBinaryTabularColumnType col_type = m_Columns[col].type;
+    if (is_int ? (col_type != eBTC_Int4  &&  col_type != eBTC_Int8)
+               : col_type != type) {
+        NCBI_THROW(CException, eInvalid,
+                   "Value type does not match binary tabular column " +
+                   m_Columns[col].name);
+    }
+    ++m_NextColumn;
+    return m_Buffers[col];
+}
+
+void
+CBlastBinaryTabularWriter::SetInteger(size_t col, Int8 value)
+{
+    x_GetBuffer(col, eBTC_Int8).ints.push_back(value);
+}
+
+void
+CBlastBinaryTabularWriter::SetDouble(size_t col, double value)
+{
+    x_GetBuffer(col, eBTC_Double).reals.push_back(value);
+}
+
+void
+CBlastBinaryTabularWriter::SetString(size_t col, const string& value)
+{
+    SColumnBuffer& buffer = x_GetBuffer(col, eBTC_String);
+    pair<unordered_map<string, Uint4>::iterator, bool> ins =
+        buffer.dict_map.insert(make_pair(value, (Uint4)buffer.dict.size()));
+    if (ins.second) {
+        buffer.dict.push_back(value);
+    }
+    buffer.indices.push_back(ins.first->second);
+}
+
+void
+CBlastBinaryTabularWriter::EndRow(void)
+{
+    if (m_NextColumn != m_Columns.size()) {
+        NCBI_THROW(CException, eInvalid,
+                   "Not all binary tabular columns of the row are set");
+    }
+    m_NextColumn = 0;
+    if (++m_NumRows >= m_RowsPerBlock) {
+        x_FlushBlock();
+    }
+}
+
+void
+CBlastBinaryTabularWriter::x_FlushBlock(void)
+{
+    if (m_NumRows == 0) {
+        return;
+    }
+
+    string payload;
+    for (size_t i = 0;  i < m_Columns.size();  i++) {
+        SColumnBuffer& buffer = m_Buffers[i];
+        switch (m_Columns[i].type) {
+        case eBTC_Int4:
+            ITERATE(vector<Int8>, it, buffer.ints) {
+                s_PutUint4(payload, (Uint4)(Int4)*it);
+            }
+            break;
+        case eBTC_Int8:
+            ITERATE(vector<Int8>, it, buffer.ints) {
+                s_PutUint8(payload, (Uint8)*it);
+            }
+            break;
+        case eBTC_Double:
+            ITERATE(vector<double>, it, buffer.reals) {
+                Uint8 bits;
+                memcpy(&bits, &*it, sizeof(bits));
+                s_PutUint8(payload, bits);
+            }
+            break;
+        case eBTC_String:
+            s_PutUint4(payload, (Uint4)buffer.dict.size());
+            ITERATE(vector<string>, it, buffer.dict) {
+                s_PutUint4(payload, (Uint4)it->size());
+                payload += *it;
+            }
+            ITERATE(vector<Uint4>, it, buffer.indices) {
+                s_PutUint4(payload, *it);
+            }
+            break;
+        }
+        buffer = SColumnBuffer();
+    }
+
+    ECompression codec = eNoCompression;
+    string compressed;
+#if defined(HAVE_LIBZSTD)
+    if (m_Compression == eZstd) {
+        CZstdCompression zstd;
+        compressed.resize(zstd.EstimateCompressionBufferSize(payload.size()));
+        size_t compressed_size = 0;
+        if (zstd.CompressBuffer(payload.data(), payload.size(),
+                                &compressed[0], compressed.size(),
+                                &compressed_size)
+            &&  compressed_size < payload.size()) {
+            compressed.resize(compressed_size);
+            codec = eZstd;
+        }
+    }
+#endif
+    const string& stored = (codec == eNoCompression) ? payload : compressed;
+
+    string header;
+    header.reserve(kBlockHeaderSize);
+    s_PutUint4(header, (Uint4)m_NumRows);
+    header += (char)codec;
+    s_PutUint4(header, (Uint4)payload.size());
+    s_PutUint4(header, (Uint4)stored.size());
+    m_Ostream.write(header.data(), header.size());
+    m_Ostream.write(stored.data(), stored.size());
+    m_NumRows = 0;
+}
+
+void
+CBlastBinaryTabularWriter::Finish(void)
+{
+    if (m_Finished) {
+        return;
+    }
+    if ( !m_HeaderWritten ) {
+        SetColumns(TBinaryTabularColumns());
+    }
+    x_FlushBlock();
+    string end_marker;
+    s_PutUint4(end_marker, 0);
+    m_Ostream.write(end_marker.data(), end_marker.size());
+    m_Ostream.flush();
+    m_Finished = true;
+}
+
+
+CBlastBinaryTabularReader::CBlastBinaryTabularReader(CNcbiIstream& istr)
+    : m_Istream(istr),
+      m_NumRows(0),
+      m_AtEnd(false)
+{
+    char buf[sizeof(kMagic) + 1 + 4];
+    if ( !s_Read(m_Istream, buf, sizeof(buf))
+         ||  memcmp(buf, kMagic, sizeof(kMagic)) != 0) {
+        NCBI_THROW(CException, eInvalid,
+                   "Input is not in the binary tabular format");
+    }
+    if ((Uint1)buf[sizeof(kMagic)] != kVersion) {
+        NCBI_THROW(CException, eInvalid,
+                   "Unsupported binary tabular format version");
+    }
+    const char* ptr = buf + sizeof(kMagic) + 1;
+    Uint4 num_columns = (Uint4)s_GetUint(ptr, buf + sizeof(buf), 4);
+
+    for (Uint4 i = 0;  i < num_columns;  i++) {
+        char col_header[1 + 2];
+        if ( !s_Read(m_Istream, col_header, sizeof(col_header)) ) {
+            NCBI_THROW(CException, eInvalid,
+                       "Truncated binary tabular header");
+        }
+        ptr = col_header + 1;
+        size_t name_len = (size_t)s_GetUint(ptr, col_header +
+                                            sizeof(col_header), 2);
+        string name(name_len, '\0');
+        if (name_len > 0  &&  !s_Read(m_Istream, &name[0], name_len)) {
+            NCBI_THROW(CException, eInvalid,
+                       "Truncated binary tabular header");
+        }
+        int type = (unsigned char)col_header[0];
+        if (type < eBTC_Int4  ||  type > eBTC_String) {
+            NCBI_THROW(CException, eInvalid,
+                       "Unknown binary tabular column type for " + name);
+        }
+        m_Columns.push_back(SBinaryTabularColumn(name,
+                                        (EBinaryTabularColumnType)type));
+    }
+    m_Data.resize(m_Columns.size());
+}
+
+int
+CBlastBinaryTabularReader::GetColumnIndex(const string& name) const
+{
+    for (size_t i = 0;  i < m_Columns.size();  i++) {
+        if (m_Columns[i].name == name) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool
+CBlastBinaryTabularReader::ReadBlock(void)
+{
+    m_NumRows = 0;
+    if (m_AtEnd) {
+        return false;
+    }
+
+    char header[kBlockHeaderSize];
+    if ( !s_Read(m_Istream, header, 4) ) {
+        NCBI_THROW(CException, eInvalid,
+                   "Binary tabular data ends without an end marker");
+    }
+    const char* ptr = header;
+    size_t num_rows = (size_t)s_GetUint(ptr, header + 4, 4);
+    if (num_rows == 0) {
+        m_AtEnd = true;
+        return false;
+    }
+    if ( !s_Read(m_Istream, header + 4, kBlockHeaderSize - 4) ) {
+        NCBI_THROW(CException, eInvalid, "Truncated binary tabular block");
+    }
+    const char* const header_end = header + kBlockHeaderSize;
+    int codec = (unsigned char)*ptr++;
+    size_t payload_size = (size_t)s_GetUint(ptr, header_end, 4);
+    size_t stored_size = (size_t)s_GetUint(ptr, header_end, 4);
+
+    string stored(stored_size, '\0');
+    if (stored_size > 0  &&  !s_Read(m_Istream, &stored[0], stored_size)) {
+        NCBI_THROW(CException, eInvalid, "Truncated binary tabular block");
+    }
+
+    string payload;
+    if (codec == CBlastBinaryTabularWriter::eNoCompression) {
+        payload.swap(stored);
+    }
+    else if (codec == CBlastBinaryTabularWriter::eZstd) {
+#if defined(HAVE_LIBZSTD)
+        CZstdCompression zstd;
+        payload.resize(payload_size);
+        size_t decompressed_size = 0;
+        if ( !zstd.DecompressBuffer(stored.data(), stored.size(),
+                                    &payload[0], payload.size(),
+                                    &decompressed_size)
+             ||  decompressed_size != payload_size) {
+            NCBI_THROW(CException, eInvalid,
+                       "Failed to decompress binary tabular block");
+        }
+#else
+        NCBI_THROW(CException, eInvalid,
+                   "Binary tabular block is zstd-compressed, but zstd is "
+                   "not supported in this build");
+#endif
+    }
+    else {
+        NCBI_THROW(CException, eInvalid,
+                   "Unknown binary tabular block compression");
+    }
+    if (payload.size() != payload_size) {
+        NCBI_THROW(CException, eInvalid, "Corrupt binary tabular block");
+    }
+
+    ptr = payload.data();
+    const char* const end = ptr + payload.size();
+    for (size_t i = 0;  i < m_Columns.size();  i++) {
+        SColumnData& data = m_Data[i];
+        data = SColumnData();
+        switch (m_Columns[i].type) {
+        case eBTC_Int4:
+            data.ints.reserve(num_rows);
+            for (size_t row = 0;  row < num_rows;  row++) {
+                data.ints.push_back((Int4)(Uint4)s_GetUint(ptr, end, 4));
+            }
+            break;
+        case eBTC_Int8:
+            data.ints.reserve(num_rows);
+            for (size_t row = 0;  row < num_rows;  row++) {
+                data.ints.push_back((Int8)s_GetUint(ptr, end, 8));
+            }
+            break;
+        case eBTC_Double:
+            data.reals.reserve(num_rows);
+            for (size_t row = 0;  row < num_rows;  row++) {
+                Uint8 bits = s_GetUint(ptr, end, 8);
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                data.reals.push_back(value);
+            }
+            break;
+        case eBTC_String:
+            {{
+                size_t dict_size = (size_t)s_GetUint(ptr, end, 4);
+                data.dict.reserve(dict_size);
+                for (size_t d = 0;  d < dict_size;  d++) {
+                    size_t len = (size_t)s_GetUint(ptr, end, 4);
+                    if ((size_t)(end - ptr) < len) {
+                        NCBI_THROW(CException, eInvalid,
+                                   "Truncated binary tabular data");
+                    }
+                    data.dict.push_back(string(ptr, len));
+                    ptr += len;
+                }
+                data.indices.reserve(num_rows);
+                for (size_t row = 0;  row < num_rows;  row++) {
+                    Uint4 index = (Uint4)s_GetUint(ptr, end, 4);
+                    if (index >= dict_size) {
+                        NCBI_THROW(CException, eInvalid,
+                                   "Corrupt binary tabular dictionary index");
+                    }
+                    data.indices.push_back(index);
+                }
+            }}
+            break;
+        }
+    }
+    if (ptr != end) {
+        NCBI_THROW(CException, eInvalid, "Corrupt binary tabular block");
+    }
+
+    m_NumRows = num_rows;
+    return true;
+}
+
+Int8
+CBlastBinaryTabularReader::GetInteger(size_t col, size_t row) const
+{
+    _ASSERT(m_Columns[col].type == eBTC_Int4  ||
+            m_Columns[col].type == eBTC_Int8);
+    return m_Data[col].ints[row];
+}
+
+double
+CBlastBinaryTabularReader::GetDouble(size_t col, size_t row) const
+{
+    _ASSERT(m_Columns[col].type == eBTC_Double);
+    return m_Data[col].reals[row];
+}
+
+const string&
+CBlastBinaryTabularReader::GetString(size_t col, size_t row) const
+{
+    _ASSERT(m_Columns[col].type == eBTC_String);
+    const SColumnData& data = m_Data[col];
+    return data.dict[data.indices[row]];
+}
+
+string
+CBlastBinaryTabularReader::GetValue(size_t col, size_t row) const
+{
+    switch (m_Columns[col].type) {
+    case eBTC_Int4:
+    case eBTC_Int8:
+        return NStr::Int8ToString(GetInteger(col, row));
+    case eBTC_Double:
+        return NStr::DoubleToString(GetDouble(col, row));
+    case eBTC_String:
+        return GetString(col, row);
+    }
+    return kEmptyStr;
+}
+
+
+CBlastBinaryTabularInfo::CBlastBinaryTabularInfo(
+                                    CBlastBinaryTabularWriter& writer,
+                                    const string& format,
+                                    bool parse_local_ids)
+    : CBlastTabularInfo(writer.GetStream(), format, eTab, parse_local_ids),
+      m_Writer(writer)
+{
+    if ( !m_Writer.HasColumns() ) {
+        m_Writer.SetColumns(GetColumns());
+    }
+    else if (m_Writer.GetColumns().size() != x_GetFieldsToShow().size()) {
+        NCBI_THROW(CException, eInvalid,
+                   "Binary tabular fields do not match the writer columns");
+    }
+}
+
+EBinaryTabularColumnType
+CBlastBinaryTabularInfo::GetColumnType(ETabularField field)
+{
+    switch (field) {
+    case eQueryLength:
+    case eSubjectLength:
+    case eQueryStart:
+    case eQueryEnd:
+    case eSubjectStart:
+    case eSubjectEnd:
+    case eScore:
+    case eAlignmentLength:
+    case eNumIdentical:
+    case eMismatches:
+    case ePositives:
+    case eGapOpenings:
+    case eGaps:
+    case eQueryFrame:
+    case eSubjFrame:
+    case eQueryCovSubject:
+    case eQueryCovSeqalign:
+    case eQueryCovUniqSubject:
+        return eBTC_Int4;
+    case eQueryGi:
+    case eSubjectGi:
+    case eSubjectTaxId:
+        return eBTC_Int8;
+    case eEvalue:
+    case eBitScore:
+    case ePercentIdentical:
+    case ePercentPositives:
+        return eBTC_Double;
+    default:
+        return eBTC_String;
+    }
+}
+
+TBinaryTabularColumns
+CBlastBinaryTabularInfo::GetColumns(void) const
+{
+    TBinaryTabularColumns columns;
+    ITERATE(list<ETabularField>, iter, x_GetFieldsToShow()) {
+        string name;
+        for (size_t i = 0;  i < kNumTabularOutputFormatSpecifiers;  i++) {
+            if (sc_FormatSpecifiers[i].field == *iter) {
+                name = sc_FormatSpecifiers[i].name;
+                break;
+            }
+        }
+        columns.push_back(SBinaryTabularColumn(name, GetColumnType(*iter)));
+    }
+    return columns;
+}
+
+void
+CBlastBinaryTabularInfo::Print(void)
+{
+    size_t col = 0;
+    ITERATE(list<ETabularField>, iter, x_GetFieldsToShow()) {
+        switch (GetColumnType(*iter)) {
+        case eBTC_Int4:
+        case eBTC_Int8:
+            {{
+                Int8 value;
+                m_Writer.SetInteger(col, x_GetIntegerField(*iter, value) ?
+                                         value : -1);
+            }}
+            break;
+        case eBTC_Double:
+            {{
+                double value;
+                m_Writer.SetDouble(col, x_GetDoubleField(*iter, value) ?
+                                        value :
+                                        numeric_limits<double>::quiet_NaN());
+            }}
+            break;
+        case eBTC_String:
+            {{
+                // Let the text formatter produce the field in a scratch
+                // buffer, so that it is exactly that of the text output
+                m_FieldStream.str(kEmptyStr);
+                streambuf* orig_buf = m_Ostream.rdbuf(m_FieldStream.rdbuf());
+                try {
+                    x_PrintField(*iter);
+                } catch (...) {
+                    m_Ostream.rdbuf(orig_buf);
+                    throw;
+                }
+                m_Ostream.rdbuf(orig_buf);
+                m_Writer.SetString(col, m_FieldStream.str());
+            }}
+            break;
+        }
+        ++col;
+    }
+    m_Writer.EndRow();
+}
+
+END_SCOPE(align_format)
+END_NCBI_SCOPE
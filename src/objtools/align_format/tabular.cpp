@@ -49,6 +49,8 @@
 #include <objects/seqfeat/Org_ref.hpp>
 
 #include <map>
+#include <limits>
+#include <cmath>
 
 BEGIN_NCBI_SCOPE
 USING_SCOPE(objects);
@@ -106,6 +108,7 @@ void CBlastTabularInfo::x_ResetFields()
     m_SubjectEnd = m_QueryFrame = m_SubjectFrame = 0;
     m_BitScore = NcbiEmptyString;
     m_Evalue = NcbiEmptyString;
+    m_BitScoreValue = m_EvalueValue = numeric_limits<double>::quiet_NaN();
     m_QuerySeq = NcbiEmptyString;
     m_SubjectSeq = NcbiEmptyString;
     m_BTOP = NcbiEmptyString;
@@ -1287,6 +1290,8 @@ CBlastTabularInfo::SetScores(int score, double bit_score, double evalue)
 {
     string total_bit_string, raw_score_string;
     m_Score = score;
+    m_BitScoreValue = bit_score;
+    m_EvalueValue = evalue;
     CAlignFormatUtil::GetScoreString(evalue, bit_score, 0, score, m_Evalue, 
                                      m_BitScore, total_bit_string, raw_score_string);
 
@@ -1475,6 +1480,88 @@ CBlastTabularInfo::x_PrintField(ETabularField field)
     }
 }
 
+bool
+CBlastTabularInfo::x_GetIntegerField(ETabularField field, Int8& value) const
+{
+    switch (field) {
+    case eQueryGi:
+        value = GI_TO(Int8, FindGi(m_QueryId)); break;
+    case eSubjectGi:
+        value = GI_TO(Int8, FindGi(m_SubjectId)); break;
+    case eQueryLength:
+        value = m_QueryLength; break;
+    case eSubjectLength:
+        value = m_SubjectLength; break;
+    case eQueryStart:
+        value = m_QueryStart; break;
+    case eQueryEnd:
+        value = m_QueryEnd; break;
+    case eSubjectStart:
+        value = m_SubjectStart; break;
+    case eSubjectEnd:
+        value = m_SubjectEnd; break;
+    case eScore:
+        value = m_Score; break;
+    case eAlignmentLength:
+        value = m_AlignLength; break;
+    case eNumIdentical:
+        value = m_NumIdent; break;
+    case eMismatches:
+        value = m_AlignLength - m_NumIdent - m_NumGaps; break;
+    case ePositives:
+        value = m_NumPositives; break;
+    case eGapOpenings:
+        value = m_NumGapOpens; break;
+    case eGaps:
+        value = m_NumGaps; break;
+    case eQueryFrame:
+        value = m_QueryFrame; break;
+    case eSubjFrame:
+        value = m_SubjectFrame; break;
+    case eSubjectTaxId:
+        if (m_SubjectTaxId == ZERO_TAX_ID) {
+            return false;
+        }
+        value = TAX_ID_TO(Int8, m_SubjectTaxId); break;
+    case eQueryCovSubject:
+        value = m_QueryCovSubject.second; break;
+    case eQueryCovUniqSubject:
+        value = m_QueryCovUniqSubject.second; break;
+    case eQueryCovSeqalign:
+        value = m_QueryCovSeqalign; break;
+    default:
+        return false;
+    }
+    if (field == eQueryCovSubject  ||  field == eQueryCovUniqSubject  ||
+        field == eQueryCovSeqalign) {
+        // Coverages are negative when they are not available
+        return value >= 0;
+    }
+    return true;
+}
+
+bool
+CBlastTabularInfo::x_GetDoubleField(ETabularField field, double& value) const
+{
+    switch (field) {
+    case eEvalue:
+        value = m_EvalueValue; break;
+    case eBitScore:
+        value = m_BitScoreValue; break;
+    case ePercentIdentical:
+        value = (m_AlignLength > 0 ?
+                 ((double)m_NumIdent)/m_AlignLength * 100 : 0);
+        break;
+    case ePercentPositives:
+        value = (m_AlignLength > 0 ?
+                 ((double)m_NumPositives)/m_AlignLength * 100 : 0);
+        break;
+    default:
+        return false;
+    }
+    return !std::isnan(value);
+}
+
 /// @todo FIXME add means to specify masked database (SB-343)
 void 
 CIgBlastTabularInfo::PrintHeader(const CConstRef<blast::CIgBlastOptions>& ig_opts,
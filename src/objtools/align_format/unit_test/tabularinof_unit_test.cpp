@@ -45,6 +45,7 @@
 
 #include <objtools/align_format/align_format_util.hpp>
 #include <objtools/align_format/tabular.hpp>
+#include <objtools/align_format/binary_tabular.hpp>
 
 #include "blast_test_util.hpp"
 #define NCBI_BOOST_NO_AUTO_TEST_MAIN
@@ -368,6 +369,215 @@ BOOST_AUTO_TEST_CASE(ExtractCorrectSeqIdWhenThereIsSourceObjectInDescription) {
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(binarytabularinfo)
+
+BOOST_AUTO_TEST_CASE(WriteAndReadBlocks) {
+
+    TBinaryTabularColumns columns;
+    columns.push_back(SBinaryTabularColumn("sseqid", eBTC_String));
+    columns.push_back(SBinaryTabularColumn("qstart", eBTC_Int4));
+    columns.push_back(SBinaryTabularColumn("staxid", eBTC_Int8));
+    columns.push_back(SBinaryTabularColumn("evalue", eBTC_Double));
+
+    CNcbiOstrstream output_stream;
+    {
+        // small blocks to exercise multiple block output
+        CBlastBinaryTabularWriter writer(output_stream,
+                                   CBlastBinaryTabularWriter::eNoCompression,
+                                   3);
+        writer.SetColumns(columns);
+        for (int i = 0;  i < 10;  i++) {
+            vector<string> values;
+            values.push_back(i % 2 ? "AE000111.1" : "AE000188.1");
+            values.push_back(NStr::IntToString(i + 1));
+            values.push_back(i == 4 ? "N/A" : "562");
+            values.push_back(i == 3 ? "1e-50" : "0.0");
+            writer.AddRow(values);
+        }
+        writer.Finish();
+    }
+
+    string output = CNcbiOstrstreamToString(output_stream);
+    CNcbiIstrstream input_stream(output);
+    CBlastBinaryTabularReader reader(input_stream);
+    BOOST_REQUIRE_EQUAL(reader.GetColumns().size(), columns.size());
+    BOOST_REQUIRE_EQUAL(reader.GetColumnIndex("staxid"), 2);
+    BOOST_REQUIRE_EQUAL(reader.GetColumnIndex("bitscore"), -1);
+
+    int num_rows = 0, num_blocks = 0;
+    while (reader.ReadBlock()) {
+        num_blocks++;
+        for (size_t row = 0;  row < reader.GetNumRows();  row++, num_rows++) {
+            BOOST_REQUIRE_EQUAL(reader.GetString(0, row),
+                          num_rows % 2 ? "AE000111.1" : "AE000188.1");
+            BOOST_REQUIRE_EQUAL(reader.GetInteger(1, row), num_rows + 1);
+            BOOST_REQUIRE_EQUAL(reader.GetInteger(2, row),
+                                num_rows == 4 ? -1 : 562);
+            BOOST_REQUIRE_EQUAL(reader.GetDouble(3, row),
+                                num_rows == 3 ? 1e-50 : 0.0);
+        }
+    }
+    BOOST_REQUIRE_EQUAL(num_rows, 10);
+    BOOST_REQUIRE_EQUAL(num_blocks, 4);
+    BOOST_REQUIRE(!reader.ReadBlock());
+}
+
+BOOST_AUTO_TEST_CASE(TypedValues) {
+
+    TBinaryTabularColumns columns;
+    columns.push_back(SBinaryTabularColumn("sacc", eBTC_String));
+    columns.push_back(SBinaryTabularColumn("sgi", eBTC_Int8));
+    columns.push_back(SBinaryTabularColumn("evalue", eBTC_Double));
+    // More digits than the text tabular output keeps
+    const double kEvalue = 1.234567890123e-42;
+    const Int8 kGi = NCBI_CONST_INT8(4294967296123);
+
+    CNcbiOstrstream output_stream;
+    {
+        CBlastBinaryTabularWriter writer(output_stream,
+                                   CBlastBinaryTabularWriter::eNoCompression);
+        writer.SetColumns(columns);
+        writer.SetString(0, "AE000111.1");
+        writer.SetInteger(1, kGi);
+        writer.SetDouble(2, kEvalue);
+        writer.EndRow();
+
+        // values must be set in column order and with the column type
+        BOOST_REQUIRE_THROW(writer.SetInteger(1, 1), CException);
+        BOOST_REQUIRE_THROW(writer.SetInteger(0, 1), CException);
+        writer.SetString(0, "AE000188.1");
+        BOOST_REQUIRE_THROW(writer.EndRow(), CException);
+        writer.SetInteger(1, -1);
+        writer.SetDouble(2, 0.0);
+        writer.EndRow();
+
+        vector<string> values;
+        values.push_back("AE000111.1");
+        values.push_back("N/A");
+        values.push_back("N/A");
+        writer.AddRow(values);
+        values[1] = "gi";
+        BOOST_REQUIRE_THROW(writer.AddRow(values), CStringException);
+    }
+
+    string output = CNcbiOstrstreamToString(output_stream);
+    CNcbiIstrstream input_stream(output);
+    CBlastBinaryTabularReader reader(input_stream);
+    BOOST_REQUIRE(reader.ReadBlock());
+    BOOST_REQUIRE_EQUAL(reader.GetNumRows(), 3U);
+    BOOST_REQUIRE_EQUAL(reader.GetString(0, 0), "AE000111.1");
+    BOOST_REQUIRE_EQUAL(reader.GetInteger(1, 0), kGi);
+    BOOST_REQUIRE_EQUAL(reader.GetDouble(2, 0), kEvalue);
+    BOOST_REQUIRE_EQUAL(reader.GetString(0, 1), "AE000188.1");
+    BOOST_REQUIRE_EQUAL(reader.GetInteger(1, 1), -1);
+    BOOST_REQUIRE_EQUAL(reader.GetDouble(2, 1), 0.0);
+    BOOST_REQUIRE_EQUAL(reader.GetInteger(1, 2), -1);
+    BOOST_REQUIRE(reader.GetDouble(2, 2) != reader.GetDouble(2, 2));
+    BOOST_REQUIRE(!reader.ReadBlock());
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedInput) {
+
+    CNcbiOstrstream output_stream;
+    {
+        CBlastBinaryTabularWriter writer(output_stream,
+                                   CBlastBinaryTabularWriter::eNoCompression);
+        writer.SetColumns(TBinaryTabularColumns(1,
+                               SBinaryTabularColumn("qseqid", eBTC_String)));
+        writer.AddRow(vector<string>(1, "Query_1"));
+    }
+    string output = CNcbiOstrstreamToString(output_stream);
+
+    CNcbiIstrstream input_stream(output.substr(0, output.size() - 6));
+    CBlastBinaryTabularReader reader(input_stream);
+    BOOST_REQUIRE_THROW(reader.ReadBlock(), CException);
+
+    CNcbiIstrstream text_stream("Query_1\tSubject_1\n");
+    BOOST_REQUIRE_THROW(CBlastBinaryTabularReader tmp(text_stream),
+                        CException);
+}
+
+BOOST_AUTO_TEST_CASE(SameValuesAsTabular) {
+
+    const string seqAlignFileName_in = "data/blastn.vs.ecoli.asn";
+    CRef<CSeq_annot> san(new CSeq_annot);
+
+    ifstream in(seqAlignFileName_in.c_str());
+    in >> MSerial_AsnText >> *san;
+    in.close();
+
+    list<CRef<CSeq_align> > seqalign_list = san->GetData().GetAlign();
+
+    const string kDbName("ecoli");
+    const CBlastDbDataLoader::EDbType kDbType(CBlastDbDataLoader::eNucleotide);
+    TestUtil::CBlastOM tmp_data_loader(kDbName, kDbType, CBlastOM::eLocal);
+    CRef<CScope> scope = tmp_data_loader.NewScope();
+
+    const string kFormat("qacc sacc pident length qstart send evalue");
+    CNcbiOstrstream text_stream;
+    CBlastTabularInfo ctab(text_stream, kFormat);
+    CNcbiOstrstream binary_stream;
+    CBlastBinaryTabularWriter writer(binary_stream);
+    CBlastBinaryTabularInfo btab(writer, kFormat);
+
+    vector<double> evalues;
+    ITERATE(list<CRef<CSeq_align> >, iter, seqalign_list)
+    {
+       ctab.SetFields(**iter, *scope);
+       ctab.Print();
+       btab.SetFields(**iter, *scope);
+       btab.Print();
+       double evalue = 0.0;
+       (*iter)->GetNamedScore(CSeq_align::eScore_EValue, evalue);
+       evalues.push_back(evalue);
+    }
+    writer.Finish();
+
+    vector<string> lines;
+    string text_output = CNcbiOstrstreamToString(text_stream);
+    NStr::Split(text_output, "\n", lines, NStr::fSplit_Tokenize);
+
+    string binary_output = CNcbiOstrstreamToString(binary_stream);
+    CNcbiIstrstream input_stream(binary_output);
+    CBlastBinaryTabularReader reader(input_stream);
+    const TBinaryTabularColumns& columns = reader.GetColumns();
+    BOOST_REQUIRE_EQUAL(columns.size(), 7U);
+    BOOST_REQUIRE_EQUAL(columns[0].name, "qacc");
+    BOOST_REQUIRE_EQUAL(columns[0].type, eBTC_String);
+    BOOST_REQUIRE_EQUAL(columns[2].type, eBTC_Double);
+    BOOST_REQUIRE_EQUAL(columns[3].type, eBTC_Int4);
+
+    size_t line = 0;
+    while (reader.ReadBlock()) {
+        for (size_t row = 0;  row < reader.GetNumRows();  row++, line++) {
+            BOOST_REQUIRE(line < lines.size());
+            vector<string> fields;
+            NStr::Split(lines[line], "\t", fields);
+            BOOST_REQUIRE_EQUAL(fields.size(), columns.size());
+            BOOST_REQUIRE_EQUAL(reader.GetString(0, row), fields[0]);
+            BOOST_REQUIRE_EQUAL(reader.GetString(1, row), fields[1]);
+            BOOST_REQUIRE_CLOSE(reader.GetDouble(2, row),
+                                NStr::StringToDouble(fields[2]), 0.001);
+            for (size_t col = 3;  col < 6;  col++) {
+                BOOST_REQUIRE_EQUAL(reader.GetValue(col, row), fields[col]);
+            }
+            // The binary output keeps the e-value at full precision
+            BOOST_REQUIRE_EQUAL(reader.GetDouble(6, row), evalues[line]);
+            double text_evalue = NStr::StringToDouble(fields[6]);
+            if (text_evalue == 0.0) {
+                BOOST_REQUIRE(reader.GetDouble(6, row) < 1.0e-180);
+            } else {
+                BOOST_REQUIRE_CLOSE(reader.GetDouble(6, row), text_evalue,
+                                    5.0);
+            }
+        }
+    }
+    BOOST_REQUIRE_EQUAL(line, lines.size());
+    scope->GetObjectManager().RevokeAllDataLoaders();                
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 /*
 * ===========================================================================
 
@@ -756,6 +756,11 @@ void CSeqDB::ResetInternalChunkBookmark()
     m_Impl->ResetInternalChunkBookmark();
 }
 
+void CSeqDB::GetMemoryMapStats(SSeqDBMemoryMapStats & stats) const
+{
+    m_Impl->GetMemoryMapStats(stats);
+}
+
 const string & CSeqDB::GetDBNameList() const
 {
     return m_Impl->GetDBNameList();
@@ -98,15 +98,95 @@ TOut SeqDB_CheckLength(TIn value)
     return result;
 }
 
+void SeqDB_GetPageFaults(Int8 & major_faults, Int8 & minor_faults)
+{
+    major_faults = minor_faults = 0;
+#if defined(NCBI_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        major_faults = usage.ru_majflt;
+        minor_faults = usage.ru_minflt;
+    }
+#endif
+}
+
+/// Read the readahead policy from the environment or registry.
+static CSeqDBAtlas::EReadahead s_GetReadaheadConfig()
+{
+    CNcbiEnvironment env;
+    string value = env.Get("BLASTDB_READAHEAD");
+    if (value.empty()) {
+        CNcbiApplicationAPI* app = CNcbiApplicationAPI::Instance();
+        if (app) {
+            value = app->GetConfig().Get("BLAST", "READAHEAD");
+        }
+    }
+    NStr::TruncateSpacesInPlace(value);
+    if (value.empty() || NStr::EqualNocase(value, "none")) {
+        return CSeqDBAtlas::eReadaheadNone;
+    }
+    if (NStr::EqualNocase(value, "willneed")) {
+        return CSeqDBAtlas::eReadaheadWillNeed;
+    }
+    if (NStr::EqualNocase(value, "sequential")) {
+        return CSeqDBAtlas::eReadaheadSequential;
+    }
+    ERR_POST(Warning << "Unknown BLAST database readahead mode '" << value
+             << "' ignored");
+    return CSeqDBAtlas::eReadaheadNone;
+}
+
 CSeqDBAtlas::CSeqDBAtlas(bool use_atlas_lock)
      :m_UseLock           (use_atlas_lock),
       m_MaxFileSize       (0),      
-      m_SearchPath        (GenerateSearchPath())
+      m_SearchPath        (GenerateSearchPath()),
+      m_Readahead         (s_GetReadaheadConfig()),
+      m_MappedBytes       (0)
 {
     m_OpenedFilesCount = 0;
     m_MaxOpenedFilesCount = 0;
 }
 
+Uint8 CSeqDBAtlas::Readahead(CMemoryFile * file,
+                             TIndx         begin,
+                             TIndx         end,
+                             bool          first_use)
+{
+    if (m_Readahead == eReadaheadNone || !file || !file->GetPtr()) {
+        return 0;
+    }
+    TIndx file_size = (TIndx) file->GetSize();
+    end = min(end, file_size);
+    if (begin < 0 || begin >= end) {
+        return 0;
+    }
+
+    if (first_use && m_Readahead == eReadaheadSequential) {
+        file->MemMapAdvise(CMemoryFile::eMMA_Sequential);
+    }
+
+    // madvise() requires a page aligned address
+    const TIndx page_size = (TIndx) GetVirtualMemoryPageSize();
+    TIndx aligned_begin = begin - (begin % page_size);
+    char * ptr = (char *) file->GetPtr() + aligned_begin;
+    size_t length = (size_t)(end - aligned_begin);
+
+    if ( !CMemoryFile::MemMapAdviseAddr(ptr, length,
+                                        CMemoryFile::eMMA_WillNeed)) {
+        return 0;
+    }
+    return length;
+}
+
+void CSeqDBAtlas::GetMemoryMapStats(SSeqDBMemoryMapStats & stats)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_FileMemMapMutex);
+        stats.mapped_files = m_FileMemMap.size();
+    }
+    stats.mapped_bytes = m_MappedBytes;
+}
+
 CSeqDBAtlas::~CSeqDBAtlas()
 {
 }
@@ -122,6 +202,7 @@ CMemoryFile* CSeqDBAtlas::GetMemoryFile(const string& fileName)
     }
     CAtlasMappedFile* file(new CAtlasMappedFile(fileName));
     m_FileMemMap[fileName].reset(file);
+    m_MappedBytes += file->GetSize();
    	_TRACE("Open File: " << fileName);
     ChangeOpenedFilseCount(CSeqDBAtlas::eFileCounterIncrement);
     return file;
@@ -138,6 +219,7 @@ CMemoryFile* CSeqDBAtlas::ReturnMemoryFile(const string& fileName)
    	//LOG_POST(Info << "Return File: " << fileName << "count " << it->second.get()->m_Count);
    	if ((GetOpenedFilseCount() > CSeqDBAtlas::e_MaxFileDescritors) &&
    		(it->second.get()->m_isIsam) && (it->second.get()->m_Count == 0)) {
+   		m_MappedBytes -= it->second.get()->GetSize();
    		m_FileMemMap.erase(it);
    		LOG_POST(Info << "Unmap max file descriptor reached: " << fileName);
    		ChangeOpenedFilseCount(CSeqDBAtlas::eFileCounterDecrement);
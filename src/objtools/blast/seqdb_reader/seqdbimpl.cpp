@@ -63,6 +63,8 @@ CSeqDBImpl::CSeqDBImpl(const string       & db_name_list,
       m_RestrictBegin   (oid_begin),
       m_RestrictEnd     (oid_end),
       m_NextChunkOID    (0),
+      m_ReadaheadRequests(0),
+      m_ReadaheadBytes  (0),
       m_NumSeqs         (0),
       m_NumSeqsStats    (0),
       m_NumOIDs         (0),
@@ -83,6 +85,7 @@ CSeqDBImpl::CSeqDBImpl(const string       & db_name_list,
       m_NumThreads      (0)
 {
     INIT_CLASS_MARK();
+    SeqDB_GetPageFaults(m_MajorFaultsBase, m_MinorFaultsBase);
 
     if (m_UseGiMask) {
         vector <string> mask_list;
@@ -162,6 +165,8 @@ CSeqDBImpl::CSeqDBImpl(bool use_atlas_lock)
       m_RestrictBegin   (0),
       m_RestrictEnd     (0),
       m_NextChunkOID    (0),
+      m_ReadaheadRequests(0),
+      m_ReadaheadBytes  (0),
       m_NumSeqs         (0),
       m_NumOIDs         (0),
       m_TotalLength     (0),
@@ -175,6 +180,7 @@ CSeqDBImpl::CSeqDBImpl(bool use_atlas_lock)
       m_NumThreads      (0)
 {
     INIT_CLASS_MARK();
+    SeqDB_GetPageFaults(m_MajorFaultsBase, m_MinorFaultsBase);
 
     reusable_inpstr =  new CObjectIStreamAsnBinary ; 
     CHECK_MARKER();
@@ -350,9 +356,21 @@ CSeqDBImpl::GetNextOIDChunk(int         & begin_chunk, // out
     }
     *state_obj = end_chunk;
 
+    // The sequence data of the next chunk is read ahead while this one
+    // is searched; the request is issued after the atlas lock is released
+    // so that it does not hold up other threads fetching their chunks.
+    int readahead_begin = end_chunk;
+    int readahead_end = end_chunk;
+    if (m_Atlas.GetReadahead() != CSeqDBAtlas::eReadaheadNone) {
+        readahead_end =
+            min(m_RestrictEnd, end_chunk + (end_chunk - begin_chunk));
+    }
+
     // Case 2: Return a range
 
     if (m_OIDList.Empty()) {
+        m_Atlas.Unlock(locked);
+        x_Readahead(readahead_begin, readahead_end);
         return CSeqDB::eOidRange;
     }
 
@@ -392,6 +410,8 @@ CSeqDBImpl::GetNextOIDChunk(int         & begin_chunk, // out
         *state_obj = next_oid;
     }
 
+    m_Atlas.Unlock(locked);
+    x_Readahead(readahead_begin, readahead_end);
     return CSeqDB::eOidList;
 }
 
@@ -402,6 +422,45 @@ void CSeqDBImpl::ResetInternalChunkBookmark()
     m_NextChunkOID = 0;
 }
 
+void CSeqDBImpl::x_Readahead(int begin, int end) const
+{
+    if (begin >= end) {
+        return;
+    }
+    for(int vol_idx = 0; vol_idx < m_VolSet.GetNumVols(); vol_idx++) {
+        const CSeqDBVolEntry * entry = m_VolSet.GetVolEntry(vol_idx);
+
+        if (entry->OIDEnd() <= begin) {
+            continue;
+        }
+        if (entry->OIDStart() >= end) {
+            break;
+        }
+
+        int vol_start = entry->OIDStart();
+        Uint8 bytes =
+            entry->Vol()->Readahead(max(begin, vol_start) - vol_start,
+                                    min(end, entry->OIDEnd()) - vol_start);
+        if (bytes) {
+            m_ReadaheadRequests++;
+            m_ReadaheadBytes += bytes;
+        }
+    }
+}
+
+void CSeqDBImpl::GetMemoryMapStats(SSeqDBMemoryMapStats & stats) const
+{
+    CHECK_MARKER();
+    m_Atlas.GetMemoryMapStats(stats);
+    stats.readahead_requests = m_ReadaheadRequests;
+    stats.readahead_bytes = m_ReadaheadBytes;
+
+    Int8 major_faults = 0, minor_faults = 0;
+    SeqDB_GetPageFaults(major_faults, minor_faults);
+    stats.major_faults = major_faults - m_MajorFaultsBase;
+    stats.minor_faults = minor_faults - m_MinorFaultsBase;
+}
+
 int CSeqDBImpl::GetSeqLength(int oid) const
 {
     CHECK_MARKER();
@@ -693,12 +752,22 @@ void CSeqDBImpl::x_FillSeqBuffer(SSeqResBuffer  *buffer,
     buffer->oid_start = oid;
     Int4 vol_oid = 0;
 
+    // Guided chunk sizes: each chunk gets at most half of the residues
+    // left per thread, counted from the index offsets, so that chunks
+    // shrink toward single sequences at the end of the iteration and
+    // threads finish at about the same time.  A long sequence always
+    // starts a new chunk (see the loop below), so it is not queued
+    // behind other sequences on the same thread.
+    Int8 remaining = x_GetRangeLength(oid, m_RestrictEnd);
+
     // Get all sequences within the lease
     if (const CSeqDBVol * vol = m_VolSet.FindVol(oid, vol_oid)) {
         SSeqRes res;
         const char * seq;
         Int8 tot_length = m_Atlas.GetSliceSize() / (4*m_NumThreads) + 1;
 
+        tot_length = min(tot_length, remaining / (2*m_NumThreads) + 1);
+
         res.length = vol->GetSequence(vol_oid++, &seq);
         if (res.length < 0) return;
         // must return at least one sequence
@@ -715,6 +784,37 @@ void CSeqDBImpl::x_FillSeqBuffer(SSeqResBuffer  *buffer,
     NCBI_THROW(CSeqDBException, eArgErr, CSeqDB::kOidNotFound);
 }
 
+Int8 CSeqDBImpl::x_GetRangeLength(int begin, int end) const
+{
+    if (begin >= end  ||  m_VolResidueStart.empty()) {
+        return 0;
+    }
+    return x_GetResidueOffset(end) - x_GetResidueOffset(begin);
+}
+
+Int8 CSeqDBImpl::x_GetResidueOffset(int oid) const
+{
+    _ASSERT((int) m_VolResidueStart.size() == m_VolSet.GetNumVols() + 1);
+
+    // Find the last volume starting at or before the OID
+    int lo = 0, hi = m_VolSet.GetNumVols();
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        if (m_VolSet.GetVolOIDStart(mid) <= oid) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    const CSeqDBVol * vol = m_VolSet.GetVol(lo);
+    int vol_oid = oid - m_VolSet.GetVolOIDStart(lo);
+    if (vol_oid >= vol->GetNumOIDs()) {
+        return m_VolResidueStart[lo + 1];
+    }
+    return m_VolResidueStart[lo] + vol->GetRangeLengthApprox(0, vol_oid);
+}
+
 int CSeqDBImpl::GetSequence(int oid, const char ** buffer) const
 {
     CHECK_MARKER();
@@ -2590,6 +2690,19 @@ void CSeqDBImpl::SetNumberOfThreads(int num_threads, bool force_mt)
         }
     }
 
+    // Residue counts of the volumes, for the chunk sizes computed by
+    // x_FillSeqBuffer()
+    if (num_threads  &&  m_VolResidueStart.empty()  &&
+        m_VolSet.GetNumVols() > 0) {
+        Int8 residues = 0;
+        for (int i = 0; i < m_VolSet.GetNumVols(); i++) {
+            m_VolResidueStart.push_back(residues);
+            const CSeqDBVol * vol = m_VolSet.GetVol(i);
+            residues += vol->GetRangeLengthApprox(0, vol->GetNumOIDs());
+        }
+        m_VolResidueStart.push_back(residues);
+    }
+
     m_CacheID.clear();
     m_NextCacheID = 0;
     m_NumThreads = num_threads;
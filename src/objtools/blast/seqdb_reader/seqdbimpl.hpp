@@ -561,6 +561,11 @@ public:
     /// Restart chunk iteration at the beginning of the database.
     void ResetInternalChunkBookmark();
 
+    /// Get memory mapping statistics.
+    /// @param stats
+    ///   The statistics are returned here.
+    void GetMemoryMapStats(SSeqDBMemoryMapStats & stats) const;
+
     /// Get list of database names.
     ///
     /// This returns the database name list used at construction.
@@ -1306,6 +1311,16 @@ private:
     /// "Bookmark" for multithreaded chunk-type OID iteration.
     int m_NextChunkOID;
 
+    /// Number of readahead requests issued for this database.
+    mutable std::atomic<Uint8> m_ReadaheadRequests;
+
+    /// Number of bytes covered by those readahead requests.
+    mutable std::atomic<Uint8> m_ReadaheadBytes;
+
+    /// Process page fault counts when this object was created.
+    Int8 m_MajorFaultsBase;
+    Int8 m_MinorFaultsBase;
+
     /// Number of sequences in the overall database.
     int m_NumSeqs;
 
@@ -1410,9 +1425,35 @@ private:
     /// Cached sequences.
     mutable vector<SSeqResBuffer *> m_CachedSeqs;
 
+    /// Approximate number of residues before each volume, and in all of
+    /// them as the last element; filled in when threads are enabled.
+    vector<Int8> m_VolResidueStart;
+
     /// Fill up the buffer
     void x_FillSeqBuffer(SSeqResBuffer * buffer, int oid) const;
 
+    /// Approximate number of residues in a range of OIDs.
+    ///
+    /// The length is computed from the index file offsets of the
+    /// volumes holding the ends of the range and from the residue
+    /// counts of the volumes, not from the sequence data.
+    /// @param begin First OID of the range.
+    /// @param end OID after the last one in the range.
+    /// @return The approximate number of residues.
+    Int8 x_GetRangeLength(int begin, int end) const;
+
+    /// Approximate number of residues before an OID.
+    /// @param oid The OID, or the number of OIDs for the whole database.
+    /// @return The approximate number of residues.
+    Int8 x_GetResidueOffset(int oid) const;
+
+    /// Request the sequence data of an OID range in advance.
+    ///
+    /// The atlas lock must not be held by the caller.
+    /// @param begin First OID of the range.
+    /// @param end OID after the last one in the range.
+    void x_Readahead(int begin, int end) const;
+
     /// Get sequence from buffer
     int x_GetSeqBuffer(SSeqResBuffer * buffer, int oid, const char ** seq) const;
 
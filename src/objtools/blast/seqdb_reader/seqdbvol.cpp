@@ -338,6 +338,28 @@ int CSeqDBVol::GetSeqLengthApprox(int oid) const
     return (whole_bytes * 4) + (oid & 0x03);
 }
 
+Int8 CSeqDBVol::GetRangeLengthApprox(int begin, int end) const
+{
+    if (begin >= end) {
+        return 0;
+    }
+
+    TIndx start_offset = 0;
+    TIndx end_offset   = 0;
+
+    m_Idx->GetSeqStart(begin, start_offset);
+    m_Idx->GetSeqStart(end, end_offset);
+
+    Int8 bytes = Int8(end_offset - start_offset);
+
+    if ('p' == m_Idx->GetSeqType()) {
+        // Subtract the inter-sequence nulls.
+        return bytes - (end - begin);
+    }
+
+    return bytes * 4;
+}
+
 /// Translation table type
 typedef vector<Uint1> TTable;
 
@@ -2802,6 +2824,34 @@ void CSeqDBVol::SeqidToOids(CSeq_id              & seqid,
 
 }
 
+Uint8 CSeqDBVol::Readahead(int begin, int end) const
+{
+    if (m_Atlas.GetReadahead() == CSeqDBAtlas::eReadaheadNone) {
+        return 0;
+    }
+
+    begin = max(begin, 0);
+    end = min(end, m_Idx->GetNumOIDs());
+    if (begin >= end) {
+        return 0;
+    }
+
+    if (!m_SeqFileOpened) x_OpenSeqFile();
+    if (m_Seq.Empty()) {
+        return 0;
+    }
+
+    // The offset array has an entry for one past the last OID, and the
+    // data for a sequence includes its ambiguities, so the region runs up
+    // to the start of the sequence after the range.
+    TIndx start_offset = 0;
+    TIndx end_offset = 0;
+    m_Idx->GetSeqStart(begin, start_offset);
+    m_Idx->GetSeqStart(end, end_offset);
+
+    return m_Seq->Readahead(start_offset, end_offset);
+}
+
 void CSeqDBVol::UnLease()
 {
     m_Idx->UnLease();
@@ -122,6 +122,15 @@ CSeqDBPerfApp::x_ReportMemUsage() const
     SMemUsage total = std::accumulate(m_MemoryUsage.begin(),
                                       m_MemoryUsage.end(), SMemUsage());
     cout << total << endl;
+
+    SSeqDBMemoryMapStats stats;
+    m_BlastDb->GetMemoryMapStats(stats);
+    cout << "Mapped files: " << stats.mapped_files << endl;
+    cout << "Mapped bytes: " << NStr::UInt8ToString_DataSize(stats.mapped_bytes) << endl;
+    cout << "Readahead requests: " << stats.readahead_requests << endl;
+    cout << "Readahead bytes: " << NStr::UInt8ToString_DataSize(stats.readahead_bytes) << endl;
+    cout << "Major page faults: " << stats.major_faults << endl;
+    cout << "Minor page faults: " << stats.minor_faults << endl;
 }
 
 int
@@ -3545,6 +3545,65 @@ BOOST_AUTO_TEST_CASE(LimitProteinDeflines)
 
 
 
+BOOST_AUTO_TEST_CASE(ReadaheadOidChunks)
+{
+    const string kReadahead("BLASTDB_READAHEAD");
+    CNcbiEnvironment env;
+    const string saved_value = env.Get(kReadahead);
+
+    const char* kModes[] = { "none", "willneed", "sequential" };
+    for (size_t i = 0;  i < ArraySize(kModes);  ++i) {
+        env.Set(kReadahead, kModes[i]);
+        const bool readahead = i != 0;
+
+        CSeqDB db("data/writedb_prot", CSeqDB::eProtein);
+        const int num_oids = db.GetNumOIDs();
+        BOOST_REQUIRE(num_oids > 1);
+
+        // Shares the memory layer, but not the readahead counts
+        CSeqDB other("data/writedb_prot", CSeqDB::eProtein);
+
+        // Walk the database one OID at a time, so that every chunk but
+        // the last one asks for the next OID to be read ahead
+        int begin = 0, end = 0, next_oid = 0;
+        vector<int> oid_list;
+        while (db.GetNextOIDChunk(begin, end, 1, oid_list) ==
+               CSeqDB::eOidRange  &&  begin < end) {
+            BOOST_REQUIRE_EQUAL(next_oid, begin);
+            for (int oid = begin;  oid < end;  ++oid) {
+                const char* buffer = NULL;
+                const int length = db.GetSequence(oid, &buffer);
+                BOOST_REQUIRE_EQUAL(db.GetSeqLength(oid), length);
+                db.RetSequence(&buffer);
+            }
+            next_oid = end;
+        }
+        BOOST_REQUIRE_EQUAL(num_oids, next_oid);
+
+        SSeqDBMemoryMapStats stats;
+        db.GetMemoryMapStats(stats);
+        if (readahead) {
+            BOOST_CHECK_EQUAL(Uint8(num_oids - 1), stats.readahead_requests);
+            BOOST_CHECK(stats.readahead_bytes > 0);
+        } else {
+            BOOST_CHECK_EQUAL(0U, stats.readahead_requests);
+            BOOST_CHECK_EQUAL(0U, stats.readahead_bytes);
+        }
+
+        SSeqDBMemoryMapStats other_stats;
+        other.GetMemoryMapStats(other_stats);
+        BOOST_CHECK_EQUAL(0U, other_stats.readahead_requests);
+        BOOST_CHECK_EQUAL(0U, other_stats.readahead_bytes);
+        BOOST_CHECK_EQUAL(stats.mapped_files, other_stats.mapped_files);
+    }
+
+    if (saved_value.empty()) {
+        env.Unset(kReadahead);
+    } else {
+        env.Set(kReadahead, saved_value);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif /* SKIP_DOXYGEN_PROCESSING */
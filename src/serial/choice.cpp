@@ -180,8 +180,7 @@ bool CChoiceTypeInfo::IsDefault(TConstObjectPtr object) const
 static inline
 TObjectPtr GetMember(const CMemberInfo* memberInfo, TObjectPtr object)
 {
-    if ( memberInfo->CanBeDelayed() )
-        memberInfo->GetDelayBuffer(object).Update();
+    memberInfo->ParseDelayed(object);
     return memberInfo->GetItemPtr(object);
 }
 
@@ -189,8 +188,7 @@ static inline
 TConstObjectPtr GetMember(const CMemberInfo* memberInfo,
                           TConstObjectPtr object)
 {
-    if ( memberInfo->CanBeDelayed() )
-        const_cast<CDelayBuffer&>(memberInfo->GetDelayBuffer(object)).Update();
+    memberInfo->ParseDelayed(object);
     return memberInfo->GetItemPtr(object);
 }
 
@@ -84,6 +84,7 @@ void CClassTypeInfo::InitClassTypeInfo(void)
 {
     m_ClassType = eSequential;
     m_ParentClassInfo = 0;
+    m_CompiledReadFunction = 0;
 
     UpdateFunctions();
 }
@@ -109,6 +110,13 @@ CClassTypeInfo* CClassTypeInfo::SetImplicit(void)
     return this;
 }
 
+CClassTypeInfo* CClassTypeInfo::SetCompiledReadFunction(TTypeReadFunction func)
+{
+    m_CompiledReadFunction = func;
+    UpdateFunctions();
+    return this;
+}
+
 bool CClassTypeInfo::IsImplicitNonEmpty(void) const
 {
     _ASSERT(Implicit());
@@ -191,8 +199,7 @@ void CClassTypeInfo::RegisterSubClasses(void) const
 static inline
 TObjectPtr GetMember(const CMemberInfo* memberInfo, TObjectPtr object)
 {
-    if ( memberInfo->CanBeDelayed() )
-        memberInfo->GetDelayBuffer(object).Update();
+    memberInfo->ParseDelayed(object);
     return memberInfo->GetItemPtr(object);
 }
 
@@ -200,8 +207,7 @@ static inline
 TConstObjectPtr GetMember(const CMemberInfo* memberInfo,
                           TConstObjectPtr object)
 {
-    if ( memberInfo->CanBeDelayed() )
-        const_cast<CDelayBuffer&>(memberInfo->GetDelayBuffer(object)).Update();
+    memberInfo->ParseDelayed(object);
     return memberInfo->GetItemPtr(object);
 }
 
@@ -246,7 +252,8 @@ void CClassTypeInfo::UpdateFunctions(void)
 {
     switch ( m_ClassType ) {
     case eSequential:
-        SetReadFunction(&ReadClassSequential);
+        SetReadFunction(m_CompiledReadFunction? &ReadClassCompiled:
+                        &ReadClassSequential);
         SetWriteFunction(&WriteClassSequential);
         SetCopyFunction(&CopyClassSequential);
         SetSkipFunction(&SkipClassSequential);
@@ -276,6 +283,23 @@ void CClassTypeInfo::ReadClassSequential(CObjectIStream& in,
     in.ReadClassSequential(classType, objectPtr);
 }
 
+void CClassTypeInfo::ReadClassCompiled(CObjectIStream& in,
+                                       TTypeInfo objectType,
+                                       TObjectPtr objectPtr)
+{
+    const CClassTypeInfo* classType =
+        CTypeConverter<CClassTypeInfo>::SafeCast(objectType);
+
+    // the compiled reader knows only ASN.1 binary automatic member tags
+    if ( in.GetDataFormat() == eSerial_AsnBinary &&
+         classType->GetTagType() == CAsnBinaryDefs::eAutomatic ) {
+        classType->m_CompiledReadFunction(in, classType, objectPtr);
+    }
+    else {
+        in.ReadClassSequential(classType, objectPtr);
+    }
+}
+
 void CClassTypeInfo::ReadClassRandom(CObjectIStream& in,
                                      TTypeInfo objectType,
                                      TObjectPtr objectPtr)
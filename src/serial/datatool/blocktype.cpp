@@ -838,6 +838,20 @@ AutoPtr<CTypeStrings> CDataContainerType::GetFullCType(void) const
     return AddMembers(code);
 }
 
+string CDataContainerType::x_GetMemberTypeName(const CDataMember& member)
+{
+    // referenced type name, or that of SET OF/SEQUENCE OF elements
+    const CDataType* type = member.GetType();
+    const CUniSequenceDataType* uniType =
+        dynamic_cast<const CUniSequenceDataType*>(type);
+    if ( uniType ) {
+        type = uniType->GetElementType();
+    }
+    const CReferenceDataType* refType =
+        dynamic_cast<const CReferenceDataType*>(type);
+    return refType? refType->GetUserTypeName(): kEmptyStr;
+}
+
 AutoPtr<CTypeStrings> CDataContainerType::AddMembers(
     AutoPtr<CClassTypeStrings>& code) const
 {
@@ -854,6 +868,10 @@ AutoPtr<CTypeStrings> CDataContainerType::AddMembers(
 */
     code->SetHaveUserClass(haveUserClass);
     code->SetObject(true /*isObject*/ );
+    // members of these types get delay buffers used on request
+    list<string> delayTypes;
+    NStr::Split(GetVar("_delay_types"), " ,;", delayTypes,
+                NStr::fSplit_Tokenize);
     ITERATE ( TMembers, i, GetMembers() ) {
         string defaultCode;
         bool optional = (*i)->Optional();
@@ -864,6 +882,9 @@ AutoPtr<CTypeStrings> CDataContainerType::AddMembers(
         }
 
         bool delayed = GetBoolVar((*i)->GetName()+"._delay");
+        bool delayOnRequest = !delayed && !delayTypes.empty() &&
+            find(delayTypes.begin(), delayTypes.end(),
+                 x_GetMemberTypeName(**i)) != delayTypes.end();
         AutoPtr<CTypeStrings> memberType = (*i)->GetType()->GetFullCType();
         string external_name = (*i)->GetName();
         string member_name = (*i)->GetType()->DefClassMemberName();
@@ -876,7 +897,7 @@ AutoPtr<CTypeStrings> CDataContainerType::AddMembers(
                         (*i)->GetType()->GetTag(),
                         !IsASNDataSpec(), (*i)->Attlist(), (*i)->Notag(),
                         (*i)->SimpleType(),(*i)->GetType(),false,
-                        (*i)->Comments());
+                        (*i)->Comments(), delayOnRequest);
         (*i)->GetType()->SetTypeStr(&(*code));
     }
     SetTypeStr(&(*code));
@@ -183,6 +183,9 @@ public:
 protected:
     AutoPtr<CTypeStrings> AddMembers(AutoPtr<CClassTypeStrings>& code) const;
     virtual CClassTypeInfo* CreateClassInfo(void);
+
+private:
+    static string x_GetMemberTypeName(const CDataMember& member);
 };
 
 class CDataSetType : public CDataContainerType {
@@ -50,6 +50,23 @@ BEGIN_NCBI_SCOPE
 #define SET_PREFIX "m_set_State"
 #define DELAY_PREFIX "m_delay_"
 
+// Code calling method of the delay buffer of a member: "Update", "Forget"
+// or "IsDelayed". Members delayed on request keep their buffers outside
+// of the object (see CDelayBuffer::GetExternal()), so that the class
+// layout does not change.
+static string s_DelayCall(const CClassTypeStrings::SMemberInfo& member,
+                          const string& method)
+{
+    if ( member.delayOnRequest ) {
+        return "NCBI_NS_NCBI::CDelayBuffer::"+method+"External(&"+
+            member.mName+")";
+    }
+    if ( method == "IsDelayed" ) {
+        return DELAY_PREFIX+member.cName;
+    }
+    return DELAY_PREFIX+member.cName+"."+method+"()";
+}
+
 CClassTypeStrings::CClassTypeStrings(const string& externalName,
                                      const string& className,
                                      const string& namespaceName,
@@ -109,6 +126,117 @@ bool CClassTypeStrings::x_IsUniSeq(TMembers::const_iterator i) const
     return i->dataType && i->dataType->IsUniSeq();
 }
 
+bool CClassTypeStrings::x_IsNillable(TMembers::const_iterator i) const
+{
+    return i->dataType && i->dataType->GetDataMember() &&
+        i->dataType->GetDataMember()->Nillable();
+}
+
+bool CClassTypeStrings::x_CanGenerateCompiledReader(bool isSet,
+                                                    bool wrapperClass) const
+{
+    // only plain SEQUENCE classes with automatic tagging,
+    // everything else is left to the generic reader
+    if ( !CClassCode::GetCompiledReaders() || isSet || wrapperClass ||
+         m_Members.empty() || !m_ParentClassName.empty() ) {
+        return false;
+    }
+    if ( DataType() &&
+         DataType()->GetTagType() != CAsnBinaryDefs::eAutomatic ) {
+        return false;
+    }
+    ITERATE ( TMembers, i, m_Members ) {
+        if ( i->attlist || i->noTag || x_IsAnyContentType(i) ||
+             x_IsNillable(i) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CClassTypeStrings::x_GenerateCompiledReader(CClassCode& code,
+                                                 const string& methodPrefix,
+                                                 const string& classPrefix) const
+{
+    // C++ types, which CObjectIStream::ReadStd() reads
+    // exactly as their CStdTypeInfo<> does
+    static const char* const kStdTypes[] = {
+        "bool", "int", "unsigned", "Int4", "Uint4", "Int8", "Uint8",
+        "double", "string", "NCBI_NS_STD::string"
+    };
+
+    CNcbiOstrstream cases;
+    TMemberIndex index = kFirstMemberIndex;
+    for ( TMembers::const_iterator i = m_Members.begin();
+          i != m_Members.end(); ++i, ++index ) {
+        if ( x_IsNullType(i) || i->delayed ) {
+            // read by generic code
+            continue;
+        }
+        bool readStd = false;
+        if ( !i->ref && !i->type->HaveSpecialRef() &&
+             (i->type->GetKind() == eKindStd ||
+              i->type->GetKind() == eKindString) ) {
+            string cType = i->type->GetCType(code.GetNamespace());
+            if ( i->type->GetStorageType(code.GetNamespace()) == cType ) {
+                for ( const char* std_type : kStdTypes ) {
+                    if ( cType == std_type ) {
+                        readStd = true;
+                        break;
+                    }
+                }
+            }
+        }
+        cases <<
+            "        case "<<index<<":\n";
+        if ( readStd ) {
+            cases <<
+                "            in.ReadStd(obj."<<i->mName<<");\n";
+        }
+        else {
+            cases <<
+                "            in.ReadObject(&obj."<<i->mName<<",\n"
+                "                info->GetMemberInfo(index)->GetTypeInfo());\n";
+        }
+        cases <<
+            "            return true;\n";
+    }
+    if ( IsOssEmpty(cases) ) {
+        return false;
+    }
+
+    string ncbiNamespace =
+        code.GetNamespace().GetNamespaceRef(CNamespace::KNCBINamespace);
+    code.CPPIncludes().insert("serial/impl/objistrasnbimpl");
+    code.ClassPrivate() <<
+        "\n"
+        "    // specialized ASN.1 binary reader\n"
+        "    static void x_ReadAsnBinary("<<ncbiNamespace<<"CObjectIStream& in,\n"
+        "        "<<ncbiNamespace<<"TTypeInfo typeInfo,\n"
+        "        "<<ncbiNamespace<<"TObjectPtr objectPtr);\n";
+
+    code.Methods() <<
+        "void "<<methodPrefix<<"x_ReadAsnBinary("<<ncbiNamespace<<"CObjectIStream& in,\n"
+        "    "<<ncbiNamespace<<"TTypeInfo typeInfo,\n"
+        "    "<<ncbiNamespace<<"TObjectPtr objectPtr)\n"
+        "{\n"
+        "    const "<<ncbiNamespace<<"CClassTypeInfo* info =\n"
+        "        static_cast<const "<<ncbiNamespace<<"CClassTypeInfo*>(typeInfo);\n"
+        "    "<<code.GetClassNameDT()<<"& obj =\n"
+        "        *static_cast<"<<classPrefix<<GetClassNameDT()<<"*>(objectPtr);\n"
+        "    static_cast<"<<ncbiNamespace<<"CObjectIStreamAsnBinary&>(in).\n"
+        "        ReadCompiledClass(info, objectPtr, [&]("<<ncbiNamespace<<"TMemberIndex index) {\n"
+        "        switch ( index ) {\n"
+        << string(CNcbiOstrstreamToString(cases)) <<
+        "        default:\n"
+        "            return false;\n"
+        "        }\n"
+        "    });\n"
+        "}\n"
+        "\n";
+    return true;
+}
+
 void CClassTypeStrings::AddMember(const string& external_name,
                                   const string& name,
                                   const AutoPtr<CTypeStrings>& type,
@@ -118,13 +246,16 @@ void CClassTypeStrings::AddMember(const string& external_name,
                                   bool delayed, int tag,
                                   bool noPrefix, bool attlist, bool noTag,
                                   bool simple,const CDataType* dataType,
-                                  bool nonempty, const CComments& comments)
+                                  bool nonempty, const CComments& comments,
+                                  bool delayOnRequest)
 {
     m_Members.push_back(SMemberInfo(external_name, name, type,
                                     pointerType,
                                     optional, defaultValue,
-                                    delayed, tag, noPrefix,attlist,noTag,
+                                    delayed || delayOnRequest,
+                                    tag, noPrefix,attlist,noTag,
                                     simple,dataType,nonempty, comments));
+    m_Members.back().delayOnRequest = delayOnRequest;
 }
 
 CClassTypeStrings::SMemberInfo::SMemberInfo(const string& external_name,
@@ -139,7 +270,7 @@ CClassTypeStrings::SMemberInfo::SMemberInfo(const string& external_name,
     : externalName(external_name), cName(Identifier(name)),
       mName("m_"+cName), tName('T'+cName),
       type(t), ptrType(pType),
-      optional(opt), delayed(del), memberTag(tag),
+      optional(opt), delayed(del), delayOnRequest(false), memberTag(tag),
       defaultValue(defValue), noPrefix(noPrefx), attlist(attlst), noTag(noTg),
       simple(simpl),dataType(dataTp),nonEmpty(nEmpty), comments(commnts)
 {
@@ -589,7 +720,7 @@ mem_simple = false;
                     else {
                         if ( i->delayed ) {
                             inlineMethods <<
-                                "    if ( " DELAY_PREFIX<<i->cName<<" )\n"
+                                "    if ( "<<s_DelayCall(*i, "IsDelayed")<<" )\n"
                                 "        return true;\n";
                         }
                         if ( as_ref ) {
@@ -684,7 +815,7 @@ mem_simple = false;
                 "{\n";
             if ( i->delayed ) {
                 code.Methods(inl) <<
-                    "    " DELAY_PREFIX<<i->cName<<".Forget();\n";
+                    "    "<<s_DelayCall(*i, "Forget")<<";\n";
             }
             WriteTabbed(code.Methods(inl), destructionCode);
             if ( (as_ref && !i->canBeNull) ) {
@@ -835,7 +966,7 @@ mem_simple = false;
                 }
                 if ( i->delayed ) {
                     code.Methods(inl) <<
-                        "    " DELAY_PREFIX<<i->cName<<".Update();\n";
+                        "    "<<s_DelayCall(*i, "Update")<<";\n";
                 }
                 if ( (as_ref && !i->canBeNull) ) {
                     code.Methods(inl) <<
@@ -883,7 +1014,7 @@ mem_simple = false;
                     "{\n";
                 if ( i->delayed ) {
                     methods <<
-                        "    " DELAY_PREFIX<<i->cName<<".Forget();\n";
+                        "    "<<s_DelayCall(*i, "Forget")<<";\n";
                 }
                 methods <<
                     "    "<<i->mName<<".Reset(&value);\n";
@@ -920,7 +1051,7 @@ mem_simple = false;
                         "{\n";
                     if ( i->delayed ) {
                         methods <<
-                            "    " DELAY_PREFIX<<i->cName<<".Update();\n";
+                            "    "<<s_DelayCall(*i, "Update")<<";\n";
                     }
                     methods <<
                         "    if ( !"<<i->mName<<" )\n"
@@ -957,7 +1088,7 @@ mem_simple = false;
                             "{\n";
                         if ( i->delayed ) {
                             inlineMethods <<
-                                "    " DELAY_PREFIX<<i->cName<<".Update();\n";
+                                "    "<<s_DelayCall(*i, "Update")<<";\n";
                         }
                         if ( (as_ref && !i->canBeNull) ) {
                             inlineMethods <<
@@ -1076,7 +1207,7 @@ mem_simple = false;
                         }
                         if ( i->delayed ) {
                             inlineMethods <<
-                                "    " DELAY_PREFIX<<i->cName<<".Forget();\n";
+                                "    "<<s_DelayCall(*i, "Forget")<<";\n";
                         }
                         inlineMethods <<                        
                             "    "<<valueRef<<" = value;\n";
@@ -1125,7 +1256,7 @@ mem_simple = false;
                         "{\n";
                     if ( i->delayed ) {
                         inlineMethods <<
-                            "    " DELAY_PREFIX<<i->cName<<".Update();\n";
+                            "    "<<s_DelayCall(*i, "Update")<<";\n";
                     }
                     if ( i->haveFlag ) {
 
@@ -1186,7 +1317,7 @@ mem_simple = false;
                     "{\n";
                 if ( i->delayed ) {
                     inlineMethods <<
-                        "    " DELAY_PREFIX<<i->cName<<".Update();\n";
+                        "    "<<s_DelayCall(*i, "Update")<<";\n";
                 }
                 inlineMethods << "    return ";
                 if ( as_ref )
@@ -1201,7 +1332,7 @@ mem_simple = false;
                     "{\n";
                 if ( i->delayed ) {
                     inlineMethods <<
-                        "    " DELAY_PREFIX<<i->cName<<".Update();\n";
+                        "    "<<s_DelayCall(*i, "Update")<<";\n";
                 }
                 if ( i->haveFlag ) {
 
@@ -1264,7 +1395,7 @@ mem_simple = false;
         }
         {
             ITERATE ( TMembers, i, m_Members ) {
-                if ( i->delayed ) {
+                if ( i->delayed && !i->delayOnRequest ) {
                     code.ClassPrivate() <<
                         "    mutable NCBI_NS_NCBI::CDelayBuffer " DELAY_PREFIX<<i->cName<<";\n";
                 }
@@ -1370,8 +1501,16 @@ mem_simple = false;
               i != m_Members.rend(); ++i ) {
             code.AddDestructionCode(i->type->GetDestructionCode(i->valueName));
         }
+        ITERATE ( TMembers, i, m_Members ) {
+            if ( i->delayOnRequest ) {
+                code.AddDestructionCode(s_DelayCall(*i, "Forget")+";");
+            }
+        }
     }
 
+    bool compiledReader = x_CanGenerateCompiledReader(isSet, wrapperClass) &&
+        x_GenerateCompiledReader(code, methodPrefix, classPrefix);
+
     // generate type info
     methods << "BEGIN_NAMED_";
     if ( haveUserClass )
@@ -1528,7 +1667,10 @@ mem_simple = false;
                 methods <<
                     "->SetSetFlag(MEMBER_PTR(" SET_PREFIX "[0]))";
             }
-            if ( i->delayed ) {
+            if ( i->delayOnRequest ) {
+                methods << "->SetDelayOnRequest()";
+            }
+            else if ( i->delayed ) {
                 methods <<
                     "->SetDelayBuffer(MEMBER_PTR(" DELAY_PREFIX<<
                     i->cName<<"))";
@@ -1638,6 +1780,10 @@ mem_simple = false;
             // Just query the flag to avoid warnings.
             methods << "    info->RandomOrder();\n";
         }
+        if ( compiledReader ) {
+            methods <<
+                "    info->SetCompiledReadFunction(&"<<methodPrefix<<"x_ReadAsnBinary);\n";
+        }
     }
     methods <<  "    info->CodeVersion(" << DATATOOL_VERSION << ");\n";
     methods <<  "    info->DataSpec(" << CDataType::GetSourceDataSpecString() << ");\n";
@@ -60,6 +60,7 @@ public:
         bool haveFlag;  // need additional boolean flag 'isSet'
         bool canBeNull; // pointer type can be NULL pointer
         bool delayed;
+        bool delayOnRequest; // delayed only for types selected at runtime
         int memberTag;
         string defaultValue; // DEFAULT value code
         bool noPrefix;
@@ -110,7 +111,8 @@ public:
                    bool optional, const string& defaultValue,
                    bool delayed, int tag,
                    bool noPrefix, bool attlist, bool noTag, bool simple,
-                   const CDataType* dataType, bool nonEmpty, const CComments& comments);
+                   const CDataType* dataType, bool nonEmpty, const CComments& comments,
+                   bool delayOnRequest = false);
     void AddMember(const AutoPtr<CTypeStrings>& type, int tag, bool nonEmpty, bool noPrefix)
         {
             AddMember(NcbiEmptyString, NcbiEmptyString, type, NcbiEmptyString,
@@ -164,6 +166,11 @@ protected:
     bool x_IsNullWithAttlist(TMembers::const_iterator i, string& name) const;
     bool x_IsAnyContentType(TMembers::const_iterator i) const;
     bool x_IsUniSeq(TMembers::const_iterator i) const;
+    bool x_IsNillable(TMembers::const_iterator i) const;
+    bool x_CanGenerateCompiledReader(bool isSet, bool wrapperClass) const;
+    bool x_GenerateCompiledReader(CClassCode& code,
+                                  const string& methodPrefix,
+                                  const string& classPrefix) const;
 
 private:
     bool m_IsObject;
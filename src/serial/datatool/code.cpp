@@ -41,6 +41,7 @@ string    CClassCode::sm_ExportSpecifier;
 bool      CClassCode::sm_DoxygenComments=false;
 string    CClassCode::sm_DoxygenGroup;
 string    CClassCode::sm_DocRootURL;
+bool      CClassCode::sm_CompiledReaders=false;
 
 
 CClassContext::~CClassContext(void)
@@ -99,6 +100,15 @@ bool CClassCode::GetDoxygenComments(void)
     return sm_DoxygenComments;
 }
 
+void CClassCode::SetCompiledReaders(bool set)
+{
+    sm_CompiledReaders = set;
+}
+bool CClassCode::GetCompiledReaders(void)
+{
+    return sm_CompiledReaders;
+}
+
 void CClassCode::SetDoxygenGroup(const string& str)
 {
     sm_DoxygenGroup = str;
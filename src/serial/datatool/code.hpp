@@ -146,6 +146,9 @@ public:
     static void SetDocRootURL(const string& str);
     static const string& GetDocRootURL(void);
 
+    static void SetCompiledReaders(bool set);
+    static bool GetCompiledReaders(void);
+
 private:
     CClassContext& m_Code;
     string m_ClassName;
@@ -155,6 +158,7 @@ private:
     static bool   sm_DoxygenComments;
     static string sm_DoxygenGroup;
     static string sm_DocRootURL;
+    static bool   sm_CompiledReaders;
 
     bool m_VirtualDestructor;
     bool m_EmptyClassCode;
@@ -243,6 +243,9 @@ void CDataTool::Init(void)
     d->AddOptionalKey("odx", "URL",
                       "URL of documentation root folder (for DOXYGEN)",
                       CArgDescriptions::eString);
+    d->AddFlag("ocr",
+               "generate specialized ASN.1 binary readers of SEQUENCE classes"
+               " (also enabled by _compiled_readers in [-] section of .def)");
     d->AddFlag("lax_syntax",
                "allow non-standard ASN.1 syntax accepted by asntool");
     d->AddOptionalKey("pch", "file",
@@ -716,6 +719,11 @@ bool CDataTool::GenerateCode(bool undo)
     if ( generator.GetOpt("orA") )
         generator.SetFileNamePrefixSource(eFileName_UseAllPrefixes);
 
+    // specialized readers, requested either in command line or in module.def
+    CClassCode::SetCompiledReaders(generator.GetOpt("ocr") ||
+        generator.GetConfig().GetBool("-", "_compiled_readers", false,
+                                      0, IRegistry::eReturn));
+
     // precompiled header
     if ( generator.GetOpt("pch", &opt) )
         CFileCode::SetPchHeader(opt);
@@ -37,6 +37,8 @@
 #include <util/bytesrc.hpp>
 #include <serial/impl/item.hpp>
 #include <serial/impl/stdtypes.hpp>
+#include <corelib/ncbi_safe_static.hpp>
+#include <unordered_map>
 
 BEGIN_NCBI_SCOPE
 
@@ -69,18 +71,122 @@ void CDelayBuffer::DoUpdate(void)
     if ( m_Info.get() == nullptr ) {
         return;
     }
+    x_Parse();
+}
+
+void CDelayBuffer::x_Parse(void)
+{
+    x_ParseData();
+    m_Info.reset(0);
+}
+
+void CDelayBuffer::x_ParseData(void) const
+{
     _ASSERT(m_Info.get() != 0);
     SInfo& info = *m_Info;
 
-    {
-        unique_ptr<CObjectIStream> in(CObjectIStream::Create(info.m_DataFormat,
-                                                           *info.m_Source));
-        in->SetFlags(info.m_Flags);
-        info.m_ItemInfo->UpdateDelayedBuffer(*in, info.m_Object);
-        _VERIFY(in->EndOfData());
+    unique_ptr<CObjectIStream> in(CObjectIStream::Create(info.m_DataFormat,
+                                                       *info.m_Source));
+    in->SetFlags(info.m_Flags);
+    info.m_ItemInfo->UpdateDelayedBuffer(*in, info.m_Object);
+    _VERIFY(in->EndOfData());
+}
+
+
+// buffers kept outside of objects, by member address
+// The map is split into shards with their own mutexes, so that threads
+// looking up different members rarely wait for each other.
+typedef unordered_map<TConstObjectPtr, unique_ptr<CDelayBuffer> > TExternalBuffers;
+struct SExternalShard
+{
+    CFastMutex m_Mutex;
+    TExternalBuffers m_Buffers;
+};
+static const size_t kExternalShards = 64;
+struct SExternalShards
+{
+    SExternalShard m_Shards[kExternalShards];
+};
+static SExternalShard& s_GetExternalShard(TConstObjectPtr member)
+{
+    static CSafeStatic<SExternalShards> s_Shards;
+    size_t hash = reinterpret_cast<size_t>(member);
+    hash ^= hash >> 12;
+    return s_Shards->m_Shards[(hash >> 3) % kExternalShards];
+}
+
+atomic<size_t> CDelayBuffer::sm_ExternalCount(0);
+
+CDelayBuffer& CDelayBuffer::GetExternal(TConstObjectPtr member)
+{
+    SExternalShard& shard = s_GetExternalShard(member);
+    CFastMutexGuard guard(shard.m_Mutex);
+    unique_ptr<CDelayBuffer>& buffer = shard.m_Buffers[member];
+    if ( !buffer ) {
+        buffer.reset(::new CDelayBuffer());
+        ++sm_ExternalCount;
     }
+    return *buffer;
+}
 
-    m_Info.reset(0);
+bool CDelayBuffer::x_IsDelayedExternal(TConstObjectPtr member)
+{
+    SExternalShard& shard = s_GetExternalShard(member);
+    CFastMutexGuard guard(shard.m_Mutex);
+    TExternalBuffers::const_iterator it = shard.m_Buffers.find(member);
+    return it != shard.m_Buffers.end()  &&  it->second->Delayed();
+}
+
+void CDelayBuffer::x_UpdateExternal(TConstObjectPtr member)
+{
+    // Quick check with the shard mutex only. A buffer stays in the map,
+    // still delayed, until its data is parsed, so other threads see it
+    // and wait for the update mutex below, as they do in DoUpdate().
+    if ( !x_IsDelayedExternal(member) ) {
+        return;
+    }
+    CFastMutexGuard guard(s_UpdateMutex);
+    SExternalShard& shard = s_GetExternalShard(member);
+    const CDelayBuffer* delayed = 0;
+    {{
+        CFastMutexGuard guard2(shard.m_Mutex);
+        TExternalBuffers::const_iterator it = shard.m_Buffers.find(member);
+        if ( it == shard.m_Buffers.end() ) {
+            // parsed by another thread
+            return;
+        }
+        delayed = it->second.get();
+    }}
+    // the buffer is not changed by other threads while the update mutex
+    // is locked, and its parsing creates buffers of other members only
+    if ( delayed->Delayed() ) {
+        delayed->x_ParseData();
+    }
+    unique_ptr<CDelayBuffer> buffer;
+    {{
+        CFastMutexGuard guard2(shard.m_Mutex);
+        TExternalBuffers::iterator it = shard.m_Buffers.find(member);
+        _ASSERT(it != shard.m_Buffers.end()  &&  it->second.get() == delayed);
+        buffer = move(it->second);
+        shard.m_Buffers.erase(it);
+        --sm_ExternalCount;
+    }}
+}
+
+void CDelayBuffer::x_ForgetExternal(TConstObjectPtr member)
+{
+    unique_ptr<CDelayBuffer> buffer;
+    {{
+        SExternalShard& shard = s_GetExternalShard(member);
+        CFastMutexGuard guard(shard.m_Mutex);
+        TExternalBuffers::iterator it = shard.m_Buffers.find(member);
+        if ( it == shard.m_Buffers.end() ) {
+            return;
+        }
+        buffer = move(it->second);
+        shard.m_Buffers.erase(it);
+        --sm_ExternalCount;
+    }}
 }
 
 TMemberIndex CDelayBuffer::GetIndex(void) const
@@ -173,6 +173,8 @@ CMemberInfo::CMemberInfo(const CClassTypeInfoBase* classType,
       m_ClassType(classType), m_Default(0),
       m_SetFlagOffset(eNoOffset), m_BitSetMask(0),
       m_DelayOffset(eNoOffset),
+      m_DelayOnRequest(false),
+      m_DelayExternal(false),
       m_GetConstFunction(&TFunc::GetConstSimpleMember),
       m_GetFunction(&TFunc::GetSimpleMember),
       m_ReadHookData(make_pair(&TFunc::ReadSimpleMember,
@@ -198,6 +200,8 @@ CMemberInfo::CMemberInfo(const CClassTypeInfoBase* classType,
       m_ClassType(classType), m_Default(0),
       m_SetFlagOffset(eNoOffset), m_BitSetMask(0),
       m_DelayOffset(eNoOffset),
+      m_DelayOnRequest(false),
+      m_DelayExternal(false),
       m_GetConstFunction(&TFunc::GetConstSimpleMember),
       m_GetFunction(&TFunc::GetSimpleMember),
       m_ReadHookData(make_pair(&TFunc::ReadSimpleMember,
@@ -223,6 +227,8 @@ CMemberInfo::CMemberInfo(const CClassTypeInfoBase* classType,
       m_ClassType(classType), m_Default(0),
       m_SetFlagOffset(eNoOffset), m_BitSetMask(0),
       m_DelayOffset(eNoOffset),
+      m_DelayOnRequest(false),
+      m_DelayExternal(false),
       m_GetConstFunction(&TFunc::GetConstSimpleMember),
       m_GetFunction(&TFunc::GetSimpleMember),
       m_ReadHookData(make_pair(&TFunc::ReadSimpleMember,
@@ -248,6 +254,8 @@ CMemberInfo::CMemberInfo(const CClassTypeInfoBase* classType,
       m_ClassType(classType), m_Default(0),
       m_SetFlagOffset(eNoOffset), m_BitSetMask(0),
       m_DelayOffset(eNoOffset),
+      m_DelayOnRequest(false),
+      m_DelayExternal(false),
       m_GetConstFunction(&TFunc::GetConstSimpleMember),
       m_GetFunction(&TFunc::GetSimpleMember),
       m_ReadHookData(make_pair(&TFunc::ReadSimpleMember,
@@ -319,6 +327,16 @@ CMemberInfo* CMemberInfo::SetDelayBuffer(CDelayBuffer* buffer)
     return this;
 }
 
+CMemberInfo* CMemberInfo::SetDelayOnRequest(void)
+{
+    m_DelayOnRequest = true;
+    if ( m_DelayOffset == eNoOffset && EnabledDelayBuffers() ) {
+        m_DelayExternal = true;
+        UpdateFunctions();
+    }
+    return this;
+}
+
 CMemberInfo* CMemberInfo::SetOptional(void)
 {
     m_Optional = true;
@@ -491,7 +509,8 @@ void CMemberInfo::UpdateDelayedBuffer(CObjectIStream& in,
                                       TObjectPtr classPtr) const
 {
     _ASSERT(CanBeDelayed());
-    _ASSERT(GetDelayBuffer(classPtr).GetIndex() == GetIndex());
+    _ASSERT(m_DelayExternal ||
+            GetDelayBuffer(classPtr).GetIndex() == GetIndex());
 
     BEGIN_OBJECT_FRAME_OF2(in, eFrameClass, GetClassType());
     BEGIN_OBJECT_FRAME_OF2(in, eFrameClassMember, GetId());
@@ -669,7 +688,7 @@ CMemberInfoFunctions::GetConstDelayedMember(const CMemberInfo* memberInfo,
                                             TConstObjectPtr classPtr)
 {
     _ASSERT(memberInfo->CanBeDelayed());
-    const_cast<CDelayBuffer&>(memberInfo->GetDelayBuffer(classPtr)).Update();
+    memberInfo->ParseDelayed(classPtr);
     return memberInfo->GetItemPtr(classPtr);
 }
 
@@ -693,7 +712,7 @@ TObjectPtr CMemberInfoFunctions::GetDelayedMember(const CMemberInfo* memberInfo,
                                                   TObjectPtr classPtr)
 {
     _ASSERT(memberInfo->CanBeDelayed());
-    memberInfo->GetDelayBuffer(classPtr).Update();
+    memberInfo->ParseDelayed(classPtr);
     memberInfo->UpdateSetFlagYes(classPtr);
     return memberInfo->GetItemPtr(classPtr);
 }
@@ -727,31 +746,37 @@ void CMemberInfoFunctions::ReadWithSetFlagMember(CObjectIStream& in,
         }
     }
     catch (CSerialException& e) {
-        if (e.GetErrCode() == CSerialException::eNullValue) {
-            if ( memberInfo->HaveSetFlag() ) {
-                memberInfo->UpdateSetFlagNo(classPtr);
-            } else {
-                NCBI_RETHROW(e, CSerialException, eFormatError,
-                    "null value " + memberInfo->GetId().GetName());
-            }
-        } else if (e.GetErrCode() == CSerialException::eMissingValue) {
-            if ( memberInfo->Optional() && memberInfo->HaveSetFlag() ) {
-                in.SetFailFlags(CObjectIStream::fNoError);
-                if ( memberInfo->UpdateSetFlagNo(classPtr) ) {
-                    memberInfo->GetTypeInfo()->SetDefault(
-                        memberInfo->GetItemPtr(classPtr));
-                    if (memberInfo->GetDefault()) {
-                        memberInfo->GetTypeInfo()->Assign(memberInfo->GetItemPtr(classPtr),memberInfo->GetDefault());
-                    }
+        memberInfo->ReadWithSetFlagFailed(in, classPtr, e);
+    }
+}
+
+void CMemberInfo::ReadWithSetFlagFailed(CObjectIStream& in,
+                                        TObjectPtr classPtr,
+                                        CSerialException& e) const
+{
+    if (e.GetErrCode() == CSerialException::eNullValue) {
+        if ( HaveSetFlag() ) {
+            UpdateSetFlagNo(classPtr);
+        } else {
+            NCBI_RETHROW(e, CSerialException, eFormatError,
+                "null value " + GetId().GetName());
+        }
+    } else if (e.GetErrCode() == CSerialException::eMissingValue) {
+        if ( Optional() && HaveSetFlag() ) {
+            in.SetFailFlags(CObjectIStream::fNoError);
+            if ( UpdateSetFlagNo(classPtr) ) {
+                GetTypeInfo()->SetDefault(GetItemPtr(classPtr));
+                if (GetDefault()) {
+                    GetTypeInfo()->Assign(GetItemPtr(classPtr),GetDefault());
                 }
-            } else {
-                NCBI_RETHROW(e, CSerialException, eFormatError,
-                    "missing value " + memberInfo->GetId().GetName());
             }
         } else {
-            NCBI_RETHROW_SAME(e,
-                "error while reading " + memberInfo->GetId().GetName());
+            NCBI_RETHROW(e, CSerialException, eFormatError,
+                "missing value " + GetId().GetName());
         }
+    } else {
+        NCBI_RETHROW_SAME(e,
+            "error while reading " + GetId().GetName());
     }
 }
 
@@ -850,17 +875,19 @@ void CMemberInfoFunctions::ReadLongMember(CObjectIStream& in,
                                           TObjectPtr classPtr)
 {
     if ( memberInfo->CanBeDelayed() ) {
-        CDelayBuffer& buffer = memberInfo->GetDelayBuffer(classPtr);
-        if ( !buffer ) {
-            if (!in.ShouldParseDelayBuffer()) {
+        if ( !memberInfo->IsDelayed(classPtr) ) {
+            if (!in.ShouldParseDelayBuffer() &&
+                (!memberInfo->DelayOnRequest() ||
+                 in.IsDelayedType(memberInfo->GetTypeInfo()))) {
                 memberInfo->UpdateSetFlagYes(classPtr);
                 in.StartDelayBuffer();
                 memberInfo->GetTypeInfo()->SkipData(in);
-                in.EndDelayBuffer(buffer, memberInfo, classPtr);
+                in.EndDelayBuffer(memberInfo->GetDelayBuffer(classPtr),
+                                  memberInfo, classPtr);
                 return;
             }
         }
-        buffer.Update();
+        memberInfo->ParseDelayed(classPtr);
     }
     
     memberInfo->UpdateSetFlagYes(classPtr);
@@ -1091,17 +1118,15 @@ void CMemberInfoFunctions::WriteLongMember(CObjectOStream& out,
         return;
     }
     
-    if ( memberInfo->CanBeDelayed() ) {
-        const CDelayBuffer& buffer = memberInfo->GetDelayBuffer(classPtr);
-        if ( buffer ) {
-            if (!out.ShouldParseDelayBuffer()) {
-                if ( out.WriteClassMember(memberInfo->GetId(), buffer) )
-                    return;
-            }
-
-            // cannot write delayed buffer -> proceed after update
-            const_cast<CDelayBuffer&>(buffer).Update();
+    if ( memberInfo->IsDelayed(classPtr) ) {
+        if (!out.ShouldParseDelayBuffer()) {
+            if ( out.WriteClassMember(memberInfo->GetId(),
+                                      memberInfo->GetDelayBuffer(classPtr)) )
+                return;
         }
+
+        // cannot write delayed buffer -> proceed after update
+        memberInfo->ParseDelayed(classPtr);
     }
     
     TTypeInfo memberType = memberInfo->GetTypeInfo();
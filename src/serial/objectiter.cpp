@@ -72,8 +72,7 @@ bool CObjectTypeInfoMI::IsSet(const CConstObjectInfo& object) const
     if ( memberInfo->HaveSetFlag() )
         return memberInfo->GetSetFlagYes(object.GetObjectPtr());
     
-    if ( memberInfo->CanBeDelayed() &&
-         memberInfo->GetDelayBuffer(object.GetObjectPtr()).Delayed() )
+    if ( memberInfo->IsDelayed(object.GetObjectPtr()) )
         return true;
 
     if ( memberInfo->Optional() ) {
@@ -51,6 +51,7 @@
 #include <serial/impl/choice.hpp>
 #include <serial/impl/aliasinfo.hpp>
 #include <serial/impl/continfo.hpp>
+#include <serial/impl/ptrinfo.hpp>
 #include <serial/enumvalues.hpp>
 #include <serial/impl/memberlist.hpp>
 #include <serial/delaybuf.hpp>
@@ -85,6 +86,14 @@ NCBI_PARAM_DECL(bool, SERIAL, READ_MMAPBYTESOURCE);
 NCBI_PARAM_DEF_EX(bool, SERIAL, READ_MMAPBYTESOURCE, false,
                   eParam_NoThread, SERIAL_READ_MMAPBYTESOURCE);
 
+NCBI_PARAM_DECL(bool, SERIAL, READ_MEMORY_POOL);
+NCBI_PARAM_DEF_EX(bool, SERIAL, READ_MEMORY_POOL, false,
+                  eParam_NoThread, SERIAL_READ_MEMORY_POOL);
+
+NCBI_PARAM_DECL(string, SERIAL, READ_DELAYED_TYPES);
+NCBI_PARAM_DEF_EX(string, SERIAL, READ_DELAYED_TYPES, "",
+                  eParam_NoThread, SERIAL_READ_DELAYED_TYPES);
+
 CRef<CByteSource> CObjectIStream::GetSource(ESerialDataFormat format,
                                             const string& fileName,
                                             TSerialOpenFlags openFlags)
@@ -470,6 +479,16 @@ CObjectIStream::CObjectIStream(ESerialDataFormat format)
       m_MonitorType(0),
       m_MemberDefault(0), m_SpecialCaseToExpect(0), m_SpecialCaseUsed(eReadAsNormal)
 {
+    static CSafeStatic<NCBI_PARAM_TYPE(SERIAL, READ_MEMORY_POOL)> s_UsePool;
+    if ( s_UsePool->Get() ) {
+        UseMemoryPool();
+    }
+    static CSafeStatic<NCBI_PARAM_TYPE(SERIAL, READ_DELAYED_TYPES)> s_DelayedTypes;
+    string delayed_types = s_DelayedTypes->Get();
+    if ( !delayed_types.empty() ) {
+        NStr::Split(delayed_types, " ,;", m_DelayedTypes,
+                    NStr::fSplit_Tokenize);
+    }
 }
 
 CObjectIStream::~CObjectIStream(void)
@@ -481,6 +500,15 @@ CObjectIStream::~CObjectIStream(void)
     catch (...) {
         ERR_POST_X(1, "Cannot close input stream");
     }
+    if ( m_MemoryPool ) {
+        const CObjectMemoryPool::SStatistics& stat =
+            m_MemoryPool->GetStatistics();
+        ERR_POST_X(11, Trace << "CObjectIStream: memory pool: "
+                   << stat.m_Allocations << " objects ("
+                   << stat.m_AllocatedBytes << " bytes) in "
+                   << stat.m_Chunks << " chunks, "
+                   << stat.m_LargeAllocations << " large objects");
+    }
 }
 
 void CObjectIStream::ResetState(void)
@@ -631,6 +659,49 @@ void CObjectIStream::AddMonitorType(TTypeInfo type)
     }
 }
 
+void CObjectIStream::SetDelayedType(TTypeInfo type)
+{
+    m_DelayedTypes.assign(1, type->GetName());
+}
+
+void CObjectIStream::AddDelayedType(TTypeInfo type)
+{
+    if (find(m_DelayedTypes.begin(), m_DelayedTypes.end(), type->GetName()) ==
+             m_DelayedTypes.end()) {
+        m_DelayedTypes.push_back(type->GetName());
+    }
+}
+
+void CObjectIStream::ResetDelayedTypes(void)
+{
+    m_DelayedTypes.clear();
+}
+
+bool CObjectIStream::IsDelayedType(TTypeInfo type) const
+{
+    if ( m_DelayedTypes.empty() ) {
+        return false;
+    }
+    // look through aliases, pointers and containers
+    for ( ;; ) {
+        if ( find(m_DelayedTypes.begin(), m_DelayedTypes.end(),
+                  type->GetName()) != m_DelayedTypes.end() ) {
+            return true;
+        }
+        if ( type->GetTypeFamily() == eTypeFamilyPointer ) {
+            type = CTypeConverter<CPointerTypeInfo>::SafeCast(type)
+                ->GetPointedType();
+        }
+        else if ( type->GetTypeFamily() == eTypeFamilyContainer ) {
+            type = CTypeConverter<CContainerTypeInfo>::SafeCast(type)
+                ->GetElementType();
+        }
+        else {
+            return false;
+        }
+    }
+}
+
 void CObjectIStream::ResetMonitorType()
 {
     m_ReqMonitorType.clear();
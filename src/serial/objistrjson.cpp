@@ -310,12 +310,29 @@ TUnicodeSymbol CObjectIStreamJson::ReadUtf8Char(char c)
     return chU;
 }
 
+size_t CObjectIStreamJson::x_ReadPlainChars(string& str, EStringType type)
+{
+    // copy chars needing no unescaping and no recoding directly from buffer
+    if ( !m_Utf8Buf.empty() ) {
+        return 0;
+    }
+    EEncoding enc_out( type == eStringTypeUTF8 ? eEncoding_UTF8 : m_StringEncoding);
+    size_t count = m_Input.PeekFindSpecialChar('\"', '\\',
+        enc_out != eEncoding_UTF8 && enc_out != eEncoding_Unknown);
+    str.append(m_Input.GetCurrentPos(), count);
+    m_Input.SkipChars(count);
+    return count;
+}
+
 string CObjectIStreamJson::x_ReadString(EStringType type)
 {
     m_ExpectValue = false;
     Expect('\"',true);
     string str;
     for (;;) {
+        if ( x_ReadPlainChars(str, type) ) {
+            continue;
+        }
         bool encoded = false;
         char c = ReadEncodedChar(type, encoded);
         if (!encoded) {
@@ -373,6 +390,13 @@ void  CObjectIStreamJson::x_SkipData(void)
     m_ExpectValue = false;
     char to = GetChar(true);
     for (;;) {
+        if ( to == '\"'  &&  m_Utf8Buf.empty() ) {
+            size_t count = m_Input.PeekFindSpecialChar('\"', '\\', false);
+            if ( count ) {
+                m_Input.SkipChars(count);
+                continue;
+            }
+        }
         bool encoded = false;
         char c = ReadEncodedChar(eStringTypeUTF8, encoded);
         if (!encoded) {
@@ -881,6 +881,22 @@ TUnicodeSymbol CObjectIStreamXml::ReadUtf8Char(char c)
     return chU;
 }
 
+size_t CObjectIStreamXml::x_ReadPlainChars(string& str, char endingChar,
+                                           EStringType type)
+{
+    // copy chars needing no unescaping and no recoding directly from buffer
+    if ( !m_Utf8Buf.empty() ) {
+        return 0;
+    }
+    EEncoding enc_out( type == eStringTypeUTF8 ? eEncoding_UTF8 : m_StringEncoding);
+    EEncoding enc_in(m_Encoding == eEncoding_Unknown ? eEncoding_UTF8 : m_Encoding);
+    size_t count = m_Input.PeekFindSpecialChar('&', endingChar,
+        enc_out != eEncoding_Unknown && enc_out != enc_in);
+    str.append(m_Input.GetCurrentPos(), count);
+    m_Input.SkipChars(count);
+    return count;
+}
+
 CTempString CObjectIStreamXml::ReadAttributeName(void)
 {
     if ( OutsideTag() )
@@ -899,6 +915,9 @@ void CObjectIStreamXml::ReadAttributeValue(string& value, bool skipClosing)
     m_Input.SkipChar();
     bool encoded = false;
     for ( ;; ) {
+        if ( x_ReadPlainChars(value, startChar, eStringTypeUTF8) ) {
+            continue;
+        }
         int c = ReadEncodedChar(startChar,eStringTypeUTF8,encoded);
         if ( c < 0 )
             break;
@@ -1318,6 +1337,9 @@ void CObjectIStreamXml::ReadTagData(string& str, EStringType type)
     bool CR = false;
     try {
         for ( ;; ) {
+            if ( !CR  &&  x_ReadPlainChars(str, m_Attlist ? '\"' : '<', type) ) {
+                continue;
+            }
             int c = ReadEncodedChar(m_Attlist ? '\"' : '<', type, encoded);
             if ( c < 0 ) {
                 if (m_Attlist || !ReadCDSection(str)) {
@@ -32,6 +32,9 @@
 
 #include <ncbi_pch.hpp>
 #include "test_serial.hpp"
+#include <serial/objistrjson.hpp>
+#include <serial/objistrxml.hpp>
+#include <thread>
 #ifndef HAVE_NCBI_C
 
 /////////////////////////////////////////////////////////////////////////////
@@ -102,6 +105,492 @@ BOOST_AUTO_TEST_CASE(s_TestAsnSerialization)
         BOOST_CHECK( CFile( bin_in).Compare( bin_out) );
     }
 }
+
+/////////////////////////////////////////////////////////////////////////////
+// Test reading with memory pool
+
+BOOST_AUTO_TEST_CASE(s_TestMemoryPool)
+{
+    string bin_in("webenv.bin");
+    CRef<CWeb_Env> env(new CWeb_Env);
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        *in >> *env;
+    }
+    CRef<CWeb_Env> pool_env;
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        in->UseMemoryPool();
+        BOOST_REQUIRE(in->GetMemoryPool());
+        pool_env.Reset(new(in->GetMemoryPool()) CWeb_Env);
+        *in >> *pool_env;
+        const CObjectMemoryPool::SStatistics& stat =
+            in->GetMemoryPool()->GetStatistics();
+        BOOST_CHECK(stat.m_Allocations > 1);
+        BOOST_CHECK(stat.m_AllocatedBytes >= stat.m_Allocations);
+        BOOST_CHECK(stat.m_Chunks > 0);
+    }
+    // the objects outlive the stream and its pool
+    BOOST_CHECK(pool_env->Equals(*env));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test delayed parsing of types selected in input stream
+// (we_cpp.def generates on-request delay buffers for Query-History members)
+
+static bool s_IsDelayed(const CSerialObject& obj, const char* member)
+{
+    const CClassTypeInfo* info =
+        CTypeConverter<CClassTypeInfo>::SafeCast(obj.GetThisTypeInfo());
+    const CMemberInfo* mem_info =
+        info->GetMemberInfo(info->GetMembers().Find(member));
+    return mem_info->IsDelayed(&obj);
+}
+
+BOOST_AUTO_TEST_CASE(s_TestDelayedTypes)
+{
+    string bin_in("webenv.bin");
+    CRef<CWeb_Env> env(new CWeb_Env);
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        BOOST_CHECK(!in->IsDelayedType(CQuery_History::GetTypeInfo()));
+        *in >> *env;
+    }
+    BOOST_REQUIRE(env->IsSetQueries());
+    BOOST_CHECK(!s_IsDelayed(*env, "queries"));
+
+    CRef<CWeb_Env> delayed_env(new CWeb_Env);
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        in->AddDelayedType(CQuery_History::GetTypeInfo());
+        BOOST_CHECK(in->IsDelayedType(CQuery_History::GetTypeInfo()));
+        *in >> *delayed_env;
+    }
+    BOOST_REQUIRE(delayed_env->IsSetQueries());
+    BOOST_CHECK(s_IsDelayed(*delayed_env, "queries"));
+
+    // access to other members doesn't parse the delayed one
+    BOOST_CHECK_EQUAL(delayed_env->IsSetArguments(), env->IsSetArguments());
+    BOOST_CHECK(s_IsDelayed(*delayed_env, "queries"));
+
+    // unparsed data is written in the same format as is
+    {
+        CNcbiOstrstream expected, written;
+        expected << MSerial_AsnBinary << *env;
+        written << MSerial_AsnBinary << *delayed_env;
+        BOOST_CHECK(string(CNcbiOstrstreamToString(written)) ==
+                    string(CNcbiOstrstreamToString(expected)));
+    }
+    BOOST_CHECK(s_IsDelayed(*delayed_env, "queries"));
+
+    // first access through const getter parses the data
+    const CWeb_Env& const_env = *delayed_env;
+    BOOST_CHECK_EQUAL(const_env.GetQueries().size(),
+                      env->GetQueries().size());
+    BOOST_CHECK(!s_IsDelayed(*delayed_env, "queries"));
+    BOOST_CHECK(delayed_env->Equals(*env));
+}
+
+// delayed members of many objects are parsed by concurrent getters
+BOOST_AUTO_TEST_CASE(s_TestDelayedTypesMT)
+{
+    string bin_in("webenv.bin");
+    CRef<CWeb_Env> env(new CWeb_Env);
+    {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        *in >> *env;
+    }
+    BOOST_REQUIRE(env->IsSetQueries());
+
+    const size_t kObjects = 200, kThreads = 4;
+    vector< CRef<CWeb_Env> > envs;
+    for ( size_t i = 0; i < kObjects; ++i ) {
+        unique_ptr<CObjectIStream> in(
+            CObjectIStream::Open(bin_in,eSerial_AsnBinary));
+        in->AddDelayedType(CQuery_History::GetTypeInfo());
+        envs.push_back(CRef<CWeb_Env>(new CWeb_Env));
+        *in >> *envs.back();
+        BOOST_REQUIRE(s_IsDelayed(*envs.back(), "queries"));
+    }
+
+    vector<size_t> sizes(kObjects*kThreads);
+    vector<thread> threads;
+    for ( size_t t = 0; t < kThreads; ++t ) {
+        threads.push_back(thread([&, t]() {
+            // threads walk the objects in different orders
+            for ( size_t i = 0; i < kObjects; ++i ) {
+                size_t j = t % 2 ? kObjects-1-i : i;
+                const CWeb_Env& const_env = *envs[j];
+                sizes[t*kObjects+j] = const_env.GetQueries().size();
+            }
+        }));
+    }
+    for ( auto& t : threads ) {
+        t.join();
+    }
+    for ( size_t i = 0; i < kObjects*kThreads; ++i ) {
+        BOOST_CHECK_EQUAL(sizes[i], env->GetQueries().size());
+    }
+    for ( auto& e : envs ) {
+        BOOST_CHECK(!s_IsDelayed(*e, "queries"));
+        BOOST_CHECK(e->Equals(*env));
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test class readers generated by datatool (_compiled_readers in we_cpp.def)
+
+static size_t s_CompiledQueries = 0;
+static TTypeReadFunction s_GeneratedQuerySearchReader = 0;
+
+static void s_CountQuerySearch(CObjectIStream& in,
+                               TTypeInfo typeInfo, TObjectPtr objectPtr)
+{
+    ++s_CompiledQueries;
+    s_GeneratedQuerySearchReader(in, typeInfo, objectPtr);
+}
+
+static CClassTypeInfo* s_GetClassInfo(TTypeInfo type)
+{
+    return const_cast<CClassTypeInfo*>(
+        CTypeConverter<CClassTypeInfo>::SafeCast(type));
+}
+
+static string s_ReadWebEnv(const string& data, CWeb_Env& env)
+{
+    CNcbiIstrstream istr(data);
+    istr >> MSerial_AsnBinary >> env;
+    CNcbiOstrstream ostr;
+    ostr << MSerial_AsnBinary << env;
+    return CNcbiOstrstreamToString(ostr);
+}
+
+BOOST_AUTO_TEST_CASE(s_TestCompiledReader)
+{
+    TTypeInfo types[] = {
+        CWeb_Env::GetTypeInfo(),
+        CQuery_History::GetTypeInfo(),
+        CQuery_Search::GetTypeInfo(),
+        CQuery_Select::GetTypeInfo(),
+        CQuery_Related::GetTypeInfo(),
+        CFull_Time::GetTypeInfo(),
+        CDb_Env::GetTypeInfo(),
+        CArgument::GetTypeInfo()
+    };
+    vector<TTypeReadFunction> readers;
+    for ( auto type : types ) {
+        readers.push_back(s_GetClassInfo(type)->GetCompiledReadFunction());
+        BOOST_CHECK(readers.back() != 0);
+    }
+
+    string data;
+    {
+        CNcbiIfstream in("webenv.bin", IOS_BASE::in | IOS_BASE::binary);
+        CNcbiOstrstream ostr;
+        NcbiStreamCopy(ostr, in);
+        data = CNcbiOstrstreamToString(ostr);
+    }
+
+    CClassTypeInfo* search_info = s_GetClassInfo(CQuery_Search::GetTypeInfo());
+    s_GeneratedQuerySearchReader = search_info->GetCompiledReadFunction();
+    BOOST_REQUIRE(s_GeneratedQuerySearchReader);
+    search_info->SetCompiledReadFunction(&s_CountQuerySearch);
+    CWeb_Env compiled_env;
+    string compiled_data = s_ReadWebEnv(data, compiled_env);
+    search_info->SetCompiledReadFunction(s_GeneratedQuerySearchReader);
+    BOOST_CHECK(s_CompiledQueries > 0);
+
+    // reference data is read by the generic reader
+    for ( auto type : types ) {
+        s_GetClassInfo(type)->SetCompiledReadFunction(0);
+    }
+    CWeb_Env generic_env;
+    string generic_data = s_ReadWebEnv(data, generic_env);
+    for ( size_t i = 0; i < readers.size(); ++i ) {
+        s_GetClassInfo(types[i])->SetCompiledReadFunction(readers[i]);
+    }
+
+    BOOST_CHECK(compiled_env.Equals(generic_env));
+    BOOST_CHECK(compiled_data == generic_data);
+    BOOST_CHECK(compiled_data == data);
+
+    {
+        // other formats use the generic reader
+        size_t count = s_CompiledQueries;
+        search_info->SetCompiledReadFunction(&s_CountQuerySearch);
+        CNcbiOstrstream ostr;
+        ostr << MSerial_AsnText << generic_env;
+        string text = CNcbiOstrstreamToString(ostr);
+        CNcbiIstrstream istr(text);
+        CWeb_Env text_env;
+        istr >> MSerial_AsnText >> text_env;
+        search_info->SetCompiledReadFunction(s_GeneratedQuerySearchReader);
+        BOOST_CHECK(text_env.Equals(generic_env));
+        BOOST_CHECK_EQUAL(s_CompiledQueries, count);
+    }
+}
+
+// optional, default and NULL members are read as by the generic reader
+static void s_ReadTestMembers(const string& data, CTest_Members& obj,
+                              bool compiled)
+{
+    CClassTypeInfo* info = s_GetClassInfo(CTest_Members::GetTypeInfo());
+    TTypeReadFunction reader = info->GetCompiledReadFunction();
+    if ( !compiled ) {
+        info->SetCompiledReadFunction(0);
+    }
+    try {
+        CNcbiIstrstream istr(data);
+        istr >> MSerial_AsnBinary >> obj;
+    }
+    catch ( CException& ) {
+        info->SetCompiledReadFunction(reader);
+        throw;
+    }
+    info->SetCompiledReadFunction(reader);
+}
+
+static void s_CheckTestMembers(const CTest_Members& obj1,
+                               const CTest_Members& obj2)
+{
+    BOOST_CHECK_EQUAL(obj1.IsSetId(), obj2.IsSetId());
+    BOOST_CHECK_EQUAL(obj1.IsSetName(), obj2.IsSetName());
+    BOOST_CHECK_EQUAL(obj1.IsSetPresent(), obj2.IsSetPresent());
+    BOOST_CHECK_EQUAL(obj1.IsSetMarker(), obj2.IsSetMarker());
+    BOOST_CHECK_EQUAL(obj1.IsSetFlags(), obj2.IsSetFlags());
+    BOOST_CHECK_EQUAL(obj1.IsSetNames(), obj2.IsSetNames());
+    BOOST_CHECK_EQUAL(obj1.IsSetRef(), obj2.IsSetRef());
+}
+
+BOOST_AUTO_TEST_CASE(s_TestCompiledReaderMembers)
+{
+    BOOST_REQUIRE(s_GetClassInfo(CTest_Members::GetTypeInfo())->
+                  GetCompiledReadFunction());
+
+    vector< CRef<CTest_Members> > objs;
+    {
+        // only mandatory members
+        CRef<CTest_Members> obj(new CTest_Members);
+        obj->SetId(1);
+        obj->SetMarker();
+        objs.push_back(obj);
+    }
+    {
+        // all members, default one with its default value
+        CRef<CTest_Members> obj(new CTest_Members);
+        obj->SetId(-2);
+        obj->SetName("name");
+        obj->SetPresent();
+        obj->SetMarker();
+        obj->SetFlags(3);
+        obj->SetNames().push_back("a");
+        obj->SetNames().push_back("");
+        obj->SetRef().SetName("ref");
+        obj->SetRef().SetDescription("description");
+        objs.push_back(obj);
+    }
+    {
+        // empty strings and containers, non-default value
+        CRef<CTest_Members> obj(new CTest_Members);
+        obj->SetId(0);
+        obj->SetName("");
+        obj->SetMarker();
+        obj->SetFlags(7);
+        obj->SetNames();
+        obj->SetRef().SetName("");
+        objs.push_back(obj);
+    }
+
+    for ( auto& obj : objs ) {
+        string data;
+        {
+            CNcbiOstrstream ostr;
+            ostr << MSerial_AsnBinary << *obj;
+            data = CNcbiOstrstreamToString(ostr);
+        }
+        CTest_Members compiled, generic;
+        s_ReadTestMembers(data, compiled, true);
+        s_ReadTestMembers(data, generic, false);
+        BOOST_CHECK(compiled.Equals(*obj));
+        BOOST_CHECK(compiled.Equals(generic));
+        s_CheckTestMembers(compiled, generic);
+        s_CheckTestMembers(compiled, *obj);
+        CNcbiOstrstream ostr;
+        ostr << MSerial_AsnBinary << compiled;
+        BOOST_CHECK(string(CNcbiOstrstreamToString(ostr)) == data);
+
+        // the set flag of a member is set before it is read,
+        // so truncated data leaves the objects in the same state
+        for ( size_t size = 1; size < data.size(); ++size ) {
+            CTest_Members compiled_part, generic_part;
+            string part = data.substr(0, size);
+            BOOST_CHECK_THROW(s_ReadTestMembers(part, compiled_part, true),
+                              CException);
+            BOOST_CHECK_THROW(s_ReadTestMembers(part, generic_part, false),
+                              CException);
+            s_CheckTestMembers(compiled_part, generic_part);
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Test reading of strings in JSON and XML
+// (plain runs are copied from the input buffer 16 chars at a time)
+
+static const char* const kValuePlaceholder = "@VALUE@";
+
+static string s_WriteArgument(ESerialDataFormat format, const string& value)
+{
+    CArgument arg;
+    arg.SetName("name");
+    arg.SetValue(value);
+    CNcbiOstrstream ostr;
+    {
+        unique_ptr<CObjectOStream> out(CObjectOStream::Open(format, ostr));
+        *out << arg;
+    }
+    return CNcbiOstrstreamToString(ostr);
+}
+
+// document with raw (already escaped) text in place of the value
+static string s_MakeArgument(ESerialDataFormat format, const string& raw)
+{
+    string data = s_WriteArgument(format, kValuePlaceholder);
+    return NStr::Replace(data, kValuePlaceholder, raw);
+}
+
+static string s_ReadArgumentValue(ESerialDataFormat format,
+                                  const string& data,
+                                  EEncoding enc = eEncoding_Unknown)
+{
+    CNcbiIstrstream istr(data);
+    unique_ptr<CObjectIStream> in(CObjectIStream::Open(format, istr));
+    if (enc != eEncoding_Unknown) {
+        if (format == eSerial_Json) {
+            dynamic_cast<CObjectIStreamJson&>(*in).SetDefaultStringEncoding(enc);
+        } else {
+            dynamic_cast<CObjectIStreamXml&>(*in).SetDefaultStringEncoding(enc);
+        }
+    }
+    CArgument arg;
+    *in >> arg;
+    BOOST_CHECK_EQUAL(arg.GetName(), "name");
+    return arg.GetValue();
+}
+
+static string s_RoundTripArgument(ESerialDataFormat format,
+                                  const string& value)
+{
+    return s_ReadArgumentValue(format, s_WriteArgument(format, value));
+}
+
+// plain text with no chars special for JSON or XML
+static string s_PlainText(size_t length, size_t seed = 0)
+{
+    static const char kChars[] =
+        "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789.,;:-+=*/_()[]{}#!?";
+    string text;
+    for (size_t i = 0; i < length; ++i) {
+        text += kChars[(i + seed) % (sizeof(kChars) - 1)];
+    }
+    return text;
+}
+
+BOOST_AUTO_TEST_CASE(s_TestStringReading)
+{
+    const ESerialDataFormat formats[] = { eSerial_Json, eSerial_Xml };
+    for (ESerialDataFormat format : formats) {
+        // plain runs around the block size
+        for (size_t len = 0; len <= 70; ++len) {
+            string value = s_PlainText(len, len);
+            BOOST_CHECK_EQUAL(s_RoundTripArgument(format, value), value);
+        }
+        // chars which need escaping at every offset of the first blocks
+        const string specials("\"\\&<>'");
+        for (char c : specials) {
+            for (size_t pos = 0; pos < 48; ++pos) {
+                string value = s_PlainText(pos) + c + s_PlainText(47 - pos, pos);
+                BOOST_CHECK_EQUAL(s_RoundTripArgument(format, value), value);
+                value = s_PlainText(pos) + c + c + s_PlainText(17, pos);
+                BOOST_CHECK_EQUAL(s_RoundTripArgument(format, value), value);
+            }
+        }
+        // non-ASCII text is kept as is, or recoded into the requested encoding
+        for (size_t pos = 0; pos < 40; ++pos) {
+            string head = s_PlainText(pos), tail = s_PlainText(40 - pos, pos);
+            string data = s_MakeArgument(format, head + "\xC3\xA9" + tail);
+            BOOST_CHECK_EQUAL(s_ReadArgumentValue(format, data),
+                              head + "\xC3\xA9" + tail);
+            BOOST_CHECK_EQUAL(s_ReadArgumentValue(format, data, eEncoding_ISO8859_1),
+                              head + "\xE9" + tail);
+        }
+    }
+
+    // JSON control chars and escapes
+    for (size_t pos = 0; pos < 40; ++pos) {
+        string head = s_PlainText(pos), tail = s_PlainText(40 - pos, pos);
+        for (char c = 1; c < ' '; ++c) {
+            string value = head + c + tail;
+            BOOST_CHECK_EQUAL(s_RoundTripArgument(eSerial_Json, value), value);
+        }
+        const char* const escapes[][2] = {
+            { "\\\"", "\"" }, { "\\\\", "\\" }, { "\\/", "/" },
+            { "\\u0041", "A" }, { "\\u000a", "\n" }, { "\\u00e9", "\xC3\xA9" }
+        };
+        for (const auto& e : escapes) {
+            string data = s_MakeArgument(eSerial_Json, head + e[0] + tail);
+            BOOST_CHECK_EQUAL(s_ReadArgumentValue(eSerial_Json, data),
+                              head + e[1] + tail);
+        }
+    }
+
+    // XML entities and line ends
+    for (size_t pos = 0; pos < 40; ++pos) {
+        string head = s_PlainText(pos), tail = s_PlainText(40 - pos, pos);
+        const char* const entities[][2] = {
+            { "&amp;", "&" }, { "&lt;", "<" }, { "&gt;", ">" },
+            { "&quot;", "\"" }, { "&apos;", "'" }, { "&#x41;", "A" },
+            { "&#65;", "A" }, { "&#xE9;", "\xC3\xA9" },
+            { "\r\n", "\n" }, { "\n", "\n" }, { "\t", "\t" }
+        };
+        for (const auto& e : entities) {
+            string data = s_MakeArgument(eSerial_Xml, head + e[0] + tail);
+            BOOST_CHECK_EQUAL(s_ReadArgumentValue(eSerial_Xml, data),
+                              head + e[1] + tail);
+        }
+    }
+
+    // strings longer than the input buffer, special chars straddle refills
+    {
+        string value, json_raw, xml_raw, utf8_raw, latin1;
+        for (size_t i = 0; value.size() < 3*4096 + 500; ++i) {
+            string text = s_PlainText(96, i);
+            value += text + '&' + text + '"' + text + '<';
+            json_raw += text + '&' + text + "\\\"" + text + '<';
+            xml_raw += text + "&amp;" + text + '"' + text + "&lt;";
+            utf8_raw += text + "\xC3\xA9";
+            latin1 += text + "\xE9";
+        }
+        const ESerialDataFormat formats[] = { eSerial_Json, eSerial_Xml };
+        for (ESerialDataFormat format : formats) {
+            BOOST_CHECK(s_RoundTripArgument(format, value) == value);
+            string data = s_MakeArgument(format,
+                                         format == eSerial_Json ? json_raw : xml_raw);
+            BOOST_CHECK(s_ReadArgumentValue(format, data) == value);
+            data = s_MakeArgument(format, utf8_raw);
+            BOOST_CHECK(s_ReadArgumentValue(format, data, eEncoding_ISO8859_1) ==
+                        latin1);
+        }
+        string long_plain = s_PlainText(5*4096 + 7);
+        BOOST_CHECK(s_RoundTripArgument(eSerial_Json, long_plain) == long_plain);
+        BOOST_CHECK(s_RoundTripArgument(eSerial_Xml, long_plain) == long_plain);
+    }
+}
 #endif
 
 /////////////////////////////////////////////////////////////////////////////
@@ -456,6 +945,88 @@ BOOST_AUTO_TEST_CASE(s_TestSerialFilter)
             cout << MSerial_AsnText << obj << endl;
         }
     }
+    {
+        // split root objects and parse their children in parallel
+        CNcbiOstrstream ostrs;
+        {
+            unique_ptr<CObjectOStream> os(
+                CObjectOStream::Open(eSerial_AsnBinary, ostrs));
+            for (int n = 0; n < 3; ++n) {
+                *os << obj;
+            }
+        }
+        string bin_data = CNcbiOstrstreamToString(ostrs);
+
+        vector< CRef<CWeb_Env> > expected;
+        {
+            CNcbiIstrstream istrs(bin_data);
+            for ( CWeb_Env& env_obj : CObjectIStreamIterator<CTestSerialObject,CWeb_Env>(
+                    *CObjectIStream::Open(eSerial_AsnBinary, istrs), eTakeOwnership)) {
+                expected.push_back(CRef<CWeb_Env>(&env_obj));
+            }
+        }
+        BOOST_CHECK(!expected.empty());
+        for (size_t buffer_size : {size_t(1), size_t(128 * 1024)}) {
+            CNcbiIstrstream istrs(bin_data);
+            size_t count = 0;
+            for ( CWeb_Env& env_obj : CObjectIStreamAsyncIterator<CTestSerialObject,CWeb_Env>(
+                    *CObjectIStream::Open(eSerial_AsnBinary, istrs), eTakeOwnership,
+                    CObjectIStreamAsyncIterator<CTestSerialObject,CWeb_Env>::CParams()
+                        .SplitRootObjects(true).MinRawBufferSize(buffer_size))) {
+                BOOST_REQUIRE(count < expected.size());
+                BOOST_CHECK(env_obj.Equals(*expected[count]));
+                ++count;
+            }
+            BOOST_CHECK_EQUAL(count, expected.size());
+        }
+    }
+    {
+        // truncated input: objects read before the error come first,
+        // then the error is reported
+        CNcbiOstrstream ostrs;
+        {
+            unique_ptr<CObjectOStream> os(
+                CObjectOStream::Open(eSerial_AsnBinary, ostrs));
+            for (int n = 0; n < 3; ++n) {
+                *os << obj;
+            }
+        }
+        string bin_data = CNcbiOstrstreamToString(ostrs);
+        bin_data.resize(bin_data.size() - bin_data.size() / 5);
+
+        vector< CRef<CWeb_Env> > expected;
+        bool sync_failed = false;
+        try {
+            CNcbiIstrstream istrs(bin_data);
+            for ( CWeb_Env& env_obj : CObjectIStreamIterator<CTestSerialObject,CWeb_Env>(
+                    *CObjectIStream::Open(eSerial_AsnBinary, istrs), eTakeOwnership)) {
+                expected.push_back(CRef<CWeb_Env>(&env_obj));
+            }
+        } catch (CException&) {
+            sync_failed = true;
+        }
+        BOOST_REQUIRE(sync_failed);
+        BOOST_CHECK(!expected.empty());
+        for (size_t buffer_size : {size_t(1), size_t(128 * 1024)}) {
+            CNcbiIstrstream istrs(bin_data);
+            size_t count = 0;
+            bool failed = false;
+            try {
+                for ( CWeb_Env& env_obj : CObjectIStreamAsyncIterator<CTestSerialObject,CWeb_Env>(
+                        *CObjectIStream::Open(eSerial_AsnBinary, istrs), eTakeOwnership,
+                        CObjectIStreamAsyncIterator<CTestSerialObject,CWeb_Env>::CParams()
+                            .SplitRootObjects(true).MinRawBufferSize(buffer_size))) {
+                    BOOST_REQUIRE(count < expected.size());
+                    BOOST_CHECK(env_obj.Equals(*expected[count]));
+                    ++count;
+                }
+            } catch (CException&) {
+                failed = true;
+            }
+            BOOST_CHECK(failed);
+            BOOST_CHECK_EQUAL(count, expected.size());
+        }
+    }
     {
         // find serial objects of a specific type
         // process them right here
@@ -21,6 +21,15 @@
 # include "twebenv.h"
 #else
 # include <serial/test/Web_Env.hpp>
+# include <serial/test/Query_Search.hpp>
+# include <serial/test/Query_Select.hpp>
+# include <serial/test/Query_Related.hpp>
+# include <serial/test/Query_History.hpp>
+# include <serial/test/Full_Time.hpp>
+# include <serial/test/Db_Env.hpp>
+# include <serial/test/Argument.hpp>
+# include <serial/test/Test_Members.hpp>
+# include <serial/test/Name.hpp>
 #endif
 
 #include <corelib/ncbifile.hpp>
@@ -264,28 +264,9 @@ SIZE_TYPE CSeqConvert_imp::x_ConvertIupacnaTo2na
     // correspond to an iupacna letter and each column corresponds to
     // that letter being in one of the 4 possible offsets within the 
     // ncbi2na byte
-    const Uint1* table = CIupacnaTo2na::GetTable();
+    static const CPackTable table(CIupacnaTo2na::GetTable(), 4);
     
-    const char* src_i = src + pos;
-    for ( size_t count = length / 4; count; --count ) {
-        *dst = 
-            table[*src_i * 4          ] | 
-            table[*(src_i + 1) * 4 + 1] |
-            table[*(src_i + 2) * 4 + 2] |
-            table[*(src_i + 3) * 4 + 3];
-        src_i += 4;
-        ++dst;
-    }
-    
-    // Handle overhang
-    if ( length % 4 != 0 ) {
-        *dst = 0x0;
-        for( size_t i = 0; i < (length % 4); ++i, ++src_i ) {
-            *dst |= (char)table[static_cast<Uint1>(*src_i) * 4 + i];
-        }
-    }
-    
-    return length;
+    return convert_4_to_1(src, pos, length, dst, table);
 }
 
 
@@ -321,22 +302,9 @@ SIZE_TYPE CSeqConvert_imp::x_ConvertIupacnaTo4na
     // correspond to an iupacna letter and each column corresponds to
     // that letter being in one of the 2 possible offsets within the 
     // ncbi4na byte
-    const Uint1* table = CIupacnaTo4na::GetTable();
-    
-    const char* src_i = src + pos;
-    
-    for ( size_t count = length / 2; count; --count ) {
-        *dst = table[*src_i * 2] | table[*(src_i + 1) * 2 + 1];
-        src_i += 2;
-        ++dst;
-    }
-    
-    // handle overhang
-    if ( length % 2 != 0 ) {
-        *dst = table[static_cast<Uint1>(*src_i) * 2];
-    }
+    static const CPackTable table(CIupacnaTo4na::GetTable(), 2);
     
-    return length;
+    return convert_2_to_1(src, pos, length, dst, table);
 }
 
 
@@ -793,27 +761,9 @@ SIZE_TYPE CSeqConvert_imp::x_Convert8naTo2na
  TSeqPos length,
  char *dst)
 {
-    const Uint1* table = C8naTo2na::GetTable();
-    
-    const char* iter = src + pos;
+    static const CPackTable table(C8naTo2na::GetTable(), 4);
     
-    for ( size_t i = length / 4; i; --i, ++dst ) {
-        *dst = table[static_cast<Uint1>(*iter) * 4] |
-            table[static_cast<Uint1>(*(iter + 1)) * 4 + 1] |
-            table[static_cast<Uint1>(*(iter + 2)) * 4 + 2] |
-            table[static_cast<Uint1>(*(iter + 3)) * 4 + 3];
-        iter += 4;
-    }
-    
-    // Handle overhang
-    if ( (length % 4) != 0 ) {
-        *dst = 0;
-        for( size_t i = 0; i < (length % 4); ++i, ++iter ) {
-            *dst |= (char)table[static_cast<Uint1>(*iter)*4 + i];
-        }
-    }
-    
-    return length;
+    return convert_4_to_1(src, pos, length, dst, table);
 }
 
 
@@ -487,9 +487,7 @@ static SIZE_TYPE s_Ncbi2naRevCmp
 
     case 3:
         // aligned operation
-        for ( ; iter != begin; ++dst ) {
-            *dst = table[static_cast<Uint1>(*--iter)];
-        }
+        dst += copy_packed_reverse(begin, iter, dst, table);
         break;
     }
 
@@ -547,9 +545,7 @@ static SIZE_TYPE s_Ncbi4naRevCmp
 
     case 1:
         {{
-            for ( ; iter != begin; ++dst ) {
-                *dst = table[static_cast<Uint1>(*--iter)];
-            }
+            dst += copy_packed_reverse(begin, iter, dst, table);
 
             if ( length % 2 != 0 ) {
                 *dst &= char(0xF0);
@@ -34,9 +34,100 @@
 #include <util/sequtil/sequtil.hpp>
 #include "sequtil_shared.hpp"
 
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 40
+#  include <immintrin.h>
+#  define NCBI_SEQUTIL_USE_SSSE3
+#endif
+
 
 BEGIN_NCBI_SCOPE
 
+
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+
+// The kernels below process 16 bytes of the source at a time using
+// byte shuffles as 16-entry table lookups. Anything they can not handle
+// exactly is left to the scalar code.
+
+static inline
+__m128i s_Load(const void* src)
+{
+    return _mm_loadu_si128(static_cast<const __m128i*>(src));
+}
+
+
+static inline
+void s_Store(void* dst, __m128i value)
+{
+    _mm_storeu_si128(static_cast<__m128i*>(dst), value);
+}
+
+
+static inline
+__m128i s_Reverse(__m128i value)
+{
+    return _mm_shuffle_epi8(value,
+                            _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                          7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+
+// Look up 16 bytes in a 256-entry table.
+// Succeeds only if all the bytes fall into the same 32-entry window of the
+// table, which is true for sequence data of a single case (IUPAC letters)
+// or in the binary codings (values 0-31).
+static inline
+bool s_Lookup(__m128i value, const Uint1* table, __m128i& result)
+{
+    int base = _mm_cvtsi128_si32(value) & 0xe0;
+    __m128i window = _mm_and_si128(value, _mm_set1_epi8(char(0xe0)));
+    window = _mm_cmpeq_epi8(window, _mm_set1_epi8(char(base)));
+    if ( _mm_movemask_epi8(window) != 0xffff ) {
+        return false;
+    }
+    __m128i index = _mm_and_si128(value, _mm_set1_epi8(0x0f));
+    __m128i lo = _mm_shuffle_epi8(s_Load(table + base), index);
+    __m128i hi = _mm_shuffle_epi8(s_Load(table + base + 16), index);
+    __m128i sel = _mm_and_si128(value, _mm_set1_epi8(0x10));
+    sel = _mm_cmpeq_epi8(sel, _mm_set1_epi8(0x10));
+    result = _mm_or_si128(_mm_and_si128(sel, hi), _mm_andnot_si128(sel, lo));
+    return true;
+}
+
+
+// Same as s_Lookup() with a scalar fallback.
+static inline
+__m128i s_LookupAny(__m128i value, const Uint1* table)
+{
+    __m128i result;
+    if ( !s_Lookup(value, table, result) ) {
+        Uint1 buf[16];
+        s_Store(buf, value);
+        for ( size_t i = 0; i < 16; ++i ) {
+            buf[i] = table[buf[i]];
+        }
+        result = s_Load(buf);
+    }
+    return result;
+}
+
+
+static inline
+__m128i s_HiNibbles(__m128i value)
+{
+    return _mm_and_si128(_mm_srli_epi16(value, 4), _mm_set1_epi8(0x0f));
+}
+
+
+static inline
+__m128i s_LoNibbles(__m128i value)
+{
+    return _mm_and_si128(value, _mm_set1_epi8(0x0f));
+}
+
+#endif // NCBI_SEQUTIL_USE_SSSE3
+
+
 // converts one byte for another using the conversion table.
 SIZE_TYPE convert_1_to_1
 (const char* src, 
@@ -48,6 +139,12 @@ SIZE_TYPE convert_1_to_1
     const char* iter = src + pos;
     const char* end = src + pos + length;
 
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+    for ( ; end - iter >= 16; iter += 16, dst += 16 ) {
+        s_Store(dst, s_LookupAny(s_Load(iter), table));
+    }
+#endif
+
     for ( ; iter != end; ++iter, ++dst ) {
         *dst = table[static_cast<Uint1>(*iter)];
     }
@@ -75,6 +172,25 @@ SIZE_TYPE convert_1_to_2
         --size;
     }
 
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+    if ( size >= 64 ) {
+        // residue tables for the upper and lower half of the source byte
+        Uint1 first[16], second[16];
+        for ( size_t i = 0; i < 16; ++i ) {
+            first[i] = table[(i << 4) * 2];
+            second[i] = table[i * 2 + 1];
+        }
+        __m128i first_v = s_Load(first), second_v = s_Load(second);
+        for ( ; size >= 32; size -= 32, iter += 16, dst += 32 ) {
+            __m128i v = s_Load(iter);
+            __m128i r0 = _mm_shuffle_epi8(first_v, s_HiNibbles(v));
+            __m128i r1 = _mm_shuffle_epi8(second_v, s_LoNibbles(v));
+            s_Store(dst, _mm_unpacklo_epi8(r0, r1));
+            s_Store(dst + 16, _mm_unpackhi_epi8(r0, r1));
+        }
+    }
+#endif
+
     // NB: we "trick" the compiler so that we copy 2 bytes instead
     // of one with each assignment operation
     Uint2* out_i  = reinterpret_cast<Uint2*>(dst);
@@ -116,6 +232,37 @@ SIZE_TYPE convert_1_to_4
         size -= to - (pos % 4);
     }
 
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+    if ( size >= 128 ) {
+        // residue tables for each of the 4 positions within the source byte
+        Uint1 res0[16], res1[16], res2[16], res3[16];
+        for ( size_t i = 0; i < 16; ++i ) {
+            res0[i] = table[(i << 4) * 4];
+            res1[i] = table[(i << 4) * 4 + 1];
+            res2[i] = table[i * 4 + 2];
+            res3[i] = table[i * 4 + 3];
+        }
+        __m128i res0_v = s_Load(res0), res1_v = s_Load(res1);
+        __m128i res2_v = s_Load(res2), res3_v = s_Load(res3);
+        for ( ; size >= 64; size -= 64, iter += 16, dst += 64 ) {
+            __m128i v = s_Load(iter);
+            __m128i hi = s_HiNibbles(v), lo = s_LoNibbles(v);
+            __m128i r0 = _mm_shuffle_epi8(res0_v, hi);
+            __m128i r1 = _mm_shuffle_epi8(res1_v, hi);
+            __m128i r2 = _mm_shuffle_epi8(res2_v, lo);
+            __m128i r3 = _mm_shuffle_epi8(res3_v, lo);
+            __m128i r01 = _mm_unpacklo_epi8(r0, r1);
+            __m128i r23 = _mm_unpacklo_epi8(r2, r3);
+            s_Store(dst, _mm_unpacklo_epi16(r01, r23));
+            s_Store(dst + 16, _mm_unpackhi_epi16(r01, r23));
+            r01 = _mm_unpackhi_epi8(r0, r1);
+            r23 = _mm_unpackhi_epi8(r2, r3);
+            s_Store(dst + 32, _mm_unpacklo_epi16(r01, r23));
+            s_Store(dst + 48, _mm_unpackhi_epi16(r01, r23));
+        }
+    }
+#endif
+
     // NB: we "trick" the compiler so that we copy 4 bytes instead
     // of one with each assignment operation
     Uint4* out_i  = reinterpret_cast<Uint4*>(dst);
@@ -148,6 +295,13 @@ SIZE_TYPE copy_1_to_1_reverse
     const char* begin = src + pos;
     const char* iter = src + pos + length;
 
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+    for ( ; iter - begin >= 16; dst += 16 ) {
+        iter -= 16;
+        s_Store(dst, s_Reverse(s_LookupAny(s_Load(iter), table)));
+    }
+#endif
+
     for ( ; iter != begin; ++dst ) {
         *dst = table[static_cast<Uint1>(*--iter)];
     }
@@ -166,6 +320,15 @@ SIZE_TYPE revcmp
     char* last  = first + length - 1;
     char temp;
 
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+    for ( ; last - first >= 31; first += 16, last -= 16 ) {
+        __m128i head = s_LookupAny(s_Load(first), table);
+        __m128i tail = s_LookupAny(s_Load(last - 15), table);
+        s_Store(first, s_Reverse(tail));
+        s_Store(last - 15, s_Reverse(head));
+    }
+#endif
+
     for ( ; first <= last; ++first, --last ) {
         temp = table[static_cast<Uint1>(*first)];
         *first = table[static_cast<Uint1>(*last)];
@@ -180,6 +343,183 @@ SIZE_TYPE revcmp
 }
 
 
+CPackTable::CPackTable(const Uint1* table, size_t width)
+    : m_Table(table),
+      m_Width(width),
+      m_Exact(true)
+{
+    _ASSERT(width == 2  ||  width == 4);
+    size_t bits = 8 / width;
+    for ( size_t c = 0; c < 256; ++c ) {
+        m_Codes[c] = table[c * width + width - 1];
+        if ( m_Codes[c] >> bits ) {
+            m_Exact = false;
+        }
+        for ( size_t i = 0; i < width; ++i ) {
+            if ( table[c * width + i] !=
+                 Uint1(m_Codes[c] << (bits * (width - 1 - i))) ) {
+                m_Exact = false;
+            }
+        }
+    }
+}
+
+
+static inline
+char s_Pack4(const char* iter, const Uint1* table)
+{
+    return char(table[static_cast<Uint1>(iter[0]) * 4    ] |
+                table[static_cast<Uint1>(iter[1]) * 4 + 1] |
+                table[static_cast<Uint1>(iter[2]) * 4 + 2] |
+                table[static_cast<Uint1>(iter[3]) * 4 + 3]);
+}
+
+
+static inline
+char s_Pack2(const char* iter, const Uint1* table)
+{
+    return char(table[static_cast<Uint1>(iter[0]) * 2    ] |
+                table[static_cast<Uint1>(iter[1]) * 2 + 1]);
+}
+
+
+// packs 4 bytes into one using the conversion table.
+SIZE_TYPE convert_4_to_1
+(const char* src,
+ TSeqPos pos,
+ TSeqPos length,
+ char* dst,
+ const CPackTable& table)
+{
+    _ASSERT(table.GetWidth() == 4);
+    const Uint1* tbl = table.GetTable();
+    const char* iter = src + pos;
+    size_t count = length / 4;
+
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+    if ( table.IsExact() ) {
+        const Uint1* codes = table.GetCodes();
+        // weights of the residues within the packed byte
+        const __m128i weights = _mm_set1_epi32(0x01041040);
+        const __m128i ones = _mm_set1_epi16(1);
+        for ( ; count >= 16; count -= 16, iter += 64, dst += 16 ) {
+            __m128i c0, c1, c2, c3;
+            if ( !s_Lookup(s_Load(iter), codes, c0)  ||
+                 !s_Lookup(s_Load(iter + 16), codes, c1)  ||
+                 !s_Lookup(s_Load(iter + 32), codes, c2)  ||
+                 !s_Lookup(s_Load(iter + 48), codes, c3) ) {
+                for ( size_t i = 0; i < 16; ++i ) {
+                    dst[i] = s_Pack4(iter + i * 4, tbl);
+                }
+                continue;
+            }
+            c0 = _mm_madd_epi16(_mm_maddubs_epi16(c0, weights), ones);
+            c1 = _mm_madd_epi16(_mm_maddubs_epi16(c1, weights), ones);
+            c2 = _mm_madd_epi16(_mm_maddubs_epi16(c2, weights), ones);
+            c3 = _mm_madd_epi16(_mm_maddubs_epi16(c3, weights), ones);
+            s_Store(dst, _mm_packus_epi16(_mm_packs_epi32(c0, c1),
+                                          _mm_packs_epi32(c2, c3)));
+        }
+    }
+#endif
+
+    for ( ; count; --count, iter += 4, ++dst ) {
+        *dst = s_Pack4(iter, tbl);
+    }
+
+    // Handle overhang
+    if ( length % 4 != 0 ) {
+        *dst = 0x0;
+        for( size_t i = 0; i < (length % 4); ++i, ++iter ) {
+            *dst |= (char)tbl[static_cast<Uint1>(*iter) * 4 + i];
+        }
+    }
+
+    return length;
+}
+
+
+// packs 2 bytes into one using the conversion table.
+SIZE_TYPE convert_2_to_1
+(const char* src,
+ TSeqPos pos,
+ TSeqPos length,
+ char* dst,
+ const CPackTable& table)
+{
+    _ASSERT(table.GetWidth() == 2);
+    const Uint1* tbl = table.GetTable();
+    const char* iter = src + pos;
+    size_t count = length / 2;
+
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+    if ( table.IsExact() ) {
+        const Uint1* codes = table.GetCodes();
+        // weights of the residues within the packed byte
+        const __m128i weights = _mm_set1_epi16(0x0110);
+        for ( ; count >= 16; count -= 16, iter += 32, dst += 16 ) {
+            __m128i c0, c1;
+            if ( !s_Lookup(s_Load(iter), codes, c0)  ||
+                 !s_Lookup(s_Load(iter + 16), codes, c1) ) {
+                for ( size_t i = 0; i < 16; ++i ) {
+                    dst[i] = s_Pack2(iter + i * 2, tbl);
+                }
+                continue;
+            }
+            s_Store(dst, _mm_packus_epi16(_mm_maddubs_epi16(c0, weights),
+                                          _mm_maddubs_epi16(c1, weights)));
+        }
+    }
+#endif
+
+    for ( ; count; --count, iter += 2, ++dst ) {
+        *dst = s_Pack2(iter, tbl);
+    }
+
+    // handle overhang
+    if ( length % 2 != 0 ) {
+        *dst = tbl[static_cast<Uint1>(*iter) * 2];
+    }
+
+    return length;
+}
+
+
+SIZE_TYPE copy_packed_reverse
+(const char* begin,
+ const char* end,
+ char* dst,
+ const Uint1* table)
+{
+    SIZE_TYPE count = end - begin;
+
+#ifdef NCBI_SEQUTIL_USE_SSSE3
+    if ( count >= 64 ) {
+        // contributions of the upper and lower half of the source byte
+        Uint1 from_hi[16], from_lo[16];
+        for ( size_t i = 0; i < 16; ++i ) {
+            from_hi[i] = table[i << 4] & 0x0f;
+            from_lo[i] = table[i] & 0xf0;
+        }
+        __m128i from_hi_v = s_Load(from_hi), from_lo_v = s_Load(from_lo);
+        for ( ; end - begin >= 16; dst += 16 ) {
+            end -= 16;
+            __m128i v = s_Load(end);
+            v = _mm_or_si128(_mm_shuffle_epi8(from_hi_v, s_HiNibbles(v)),
+                             _mm_shuffle_epi8(from_lo_v, s_LoNibbles(v)));
+            s_Store(dst, s_Reverse(v));
+        }
+    }
+#endif
+
+    for ( ; end != begin; ++dst ) {
+        *dst = table[static_cast<Uint1>(*--end)];
+    }
+
+    return count;
+}
+
+
 size_t GetBasesPerByte(CSeqUtil::TCoding coding)
 {
     if ( coding == CSeqUtil::e_Ncbi2na ) {
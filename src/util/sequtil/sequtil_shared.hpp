@@ -55,6 +55,38 @@ SIZE_TYPE convert_1_to_4(const char* src,
                          char* dst, 
                          const Uint1* table);
 
+// Table for packing 2 or 4 residues into a byte.
+// The table has 'width' columns for each source byte, one for each
+// position of the residue within the packed byte.
+class CPackTable
+{
+public:
+    CPackTable(const Uint1* table, size_t width);
+
+    const Uint1* GetTable(void) const { return m_Table; }
+    size_t GetWidth(void) const { return m_Width; }
+    // residue codes, i.e. the values of the last column
+    const Uint1* GetCodes(void) const { return m_Codes; }
+    // true if all columns are the shifted residue codes
+    bool IsExact(void) const { return m_Exact; }
+
+private:
+    const Uint1* m_Table;
+    size_t       m_Width;
+    bool         m_Exact;
+    Uint1        m_Codes[256];
+};
+
+SIZE_TYPE convert_2_to_1(const char* src,
+                         TSeqPos pos, TSeqPos length,
+                         char* dst,
+                         const CPackTable& table);
+
+SIZE_TYPE convert_4_to_1(const char* src,
+                         TSeqPos pos, TSeqPos length,
+                         char* dst,
+                         const CPackTable& table);
+
 SIZE_TYPE copy_1_to_1_reverse(const char* src,
                               TSeqPos pos, TSeqPos length,
                               char* dst, 
@@ -62,6 +94,13 @@ SIZE_TYPE copy_1_to_1_reverse(const char* src,
 
 SIZE_TYPE revcmp(char* buf, TSeqPos pos, TSeqPos length, const Uint1* table);
 
+// Copy packed bytes [begin, end) in reverse order converting them with
+// the table, which must map the upper half of the source byte into the
+// lower half of the result and vice versa.
+SIZE_TYPE copy_packed_reverse(const char* begin, const char* end,
+                              char* dst,
+                              const Uint1* table);
+
 
 size_t GetBasesPerByte(CSeqUtil::TCoding coding);
 
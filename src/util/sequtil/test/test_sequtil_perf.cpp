@@ -0,0 +1,279 @@
+/*  $Id$
+ * ===========================================================================
+ *
+ *                            PUBLIC DOMAIN NOTICE
+ *               National Center for Biotechnology Information
+ *
+ *  This software/database is a "United States Government Work" under the
+ *  terms of the United States Copyright Act.  It was written as part of
+ *  the author's official duties as a United States Government employee and
+ *  thus cannot be copyrighted.  This software/database is freely available
+ *  to the public for use. The National Library of Medicine and the U.S.
+ *  Government have not placed any restriction on its use or reproduction.
+ *
+ *  Although all reasonable efforts have been taken to ensure the accuracy
+ *  and reliability of the software and data, the NLM and the U.S.
+ *  Government do not and cannot warrant the performance or results that
+ *  may be obtained by using this software or data. The NLM and the U.S.
+ *  Government disclaim all warranties, express or implied, including
+ *  warranties of performance, merchantability or fitness for any particular
+ *  purpose.
+ *
+ *  Please cite the author in any work or product based on this material.
+ *
+ * ===========================================================================
+ *
+ * File Description:
+ *   Micro-benchmark of sequence coding conversions and reverse-complement.
+ *   Every timed operation is also checked against the same operation done
+ *   in small pieces, which always go through the scalar code.
+ *
+ */
+
+#include <ncbi_pch.hpp>
+#include <corelib/ncbiapp.hpp>
+#include <corelib/ncbienv.hpp>
+#include <corelib/ncbiargs.hpp>
+#include <corelib/ncbitime.hpp>
+#include <util/random_gen.hpp>
+#include <util/sequtil/sequtil_convert.hpp>
+#include <util/sequtil/sequtil_manip.hpp>
+
+#include <common/test_assert.h>  /* This header must go last */
+
+
+USING_NCBI_SCOPE;
+
+
+// piece size for the reference results, a multiple of all packing factors
+static const TSeqPos kPiece = 12;
+
+
+static TSeqPos s_BasesPerByte(CSeqUtil::TCoding coding)
+{
+    switch ( coding ) {
+    case CSeqUtil::e_Ncbi2na: return 4;
+    case CSeqUtil::e_Ncbi4na: return 2;
+    default:                  return 1;
+    }
+}
+
+
+static size_t s_Bytes(CSeqUtil::TCoding coding, TSeqPos length)
+{
+    TSeqPos bpb = s_BasesPerByte(coding);
+    return (length + bpb - 1) / bpb;
+}
+
+
+class CSeqUtilPerfApp : public CNcbiApplication
+{
+private:
+    virtual void Init(void);
+    virtual int  Run(void);
+
+    void x_MakeSequence(TSeqPos length, bool mixed, Uint4 seed);
+    const vector<char>& x_GetData(CSeqUtil::TCoding coding);
+
+    bool x_TestConvert(const char* name,
+                       CSeqUtil::TCoding src_coding,
+                       CSeqUtil::TCoding dst_coding);
+    bool x_TestRevCmp(const char* name,
+                      CSeqUtil::TCoding coding);
+    void x_Report(const char* name, double per_run);
+
+    TSeqPos m_Length;
+    int     m_Iterations;
+    map<CSeqUtil::TCoding, vector<char> > m_Data;
+};
+
+
+void CSeqUtilPerfApp::Init(void)
+{
+    unique_ptr<CArgDescriptions> arg_desc(new CArgDescriptions);
+    arg_desc->SetUsageContext(GetArguments().GetProgramBasename(),
+                              "sequence conversion micro-benchmark");
+
+    arg_desc->AddDefaultKey("length", "Length",
+                            "sequence length in residues",
+                            CArgDescriptions::eInteger, "10000000");
+    arg_desc->AddDefaultKey("iterations", "Count",
+                            "number of timed runs of each operation",
+                            CArgDescriptions::eInteger, "10");
+    arg_desc->AddDefaultKey("seed", "Seed",
+                            "random generator seed",
+                            CArgDescriptions::eInteger, "1");
+    arg_desc->AddFlag("mixed",
+                      "mix in lower case runs and ambiguity codes");
+
+    SetupArgDescriptions(arg_desc.release());
+}
+
+
+void CSeqUtilPerfApp::x_MakeSequence(TSeqPos length, bool mixed, Uint4 seed)
+{
+    static const char kBases[] = "ACGT";
+    static const char kAmbig[] = "NRYKMSWBDHV";
+
+    CRandom random(seed);
+    vector<char>& seq = m_Data[CSeqUtil::e_Iupacna];
+    seq.resize(length);
+    bool lower = false;
+    for ( TSeqPos i = 0; i < length; ++i ) {
+        char c = kBases[random.GetRand(0, 3)];
+        if ( mixed ) {
+            if ( random.GetRand(0, 999) == 0 ) {
+                lower = !lower;
+            }
+            if ( random.GetRand(0, 99) == 0 ) {
+                c = kAmbig[random.GetRand(0, sizeof(kAmbig)-2)];
+            }
+            if ( lower ) {
+                c = char(tolower((unsigned char)c));
+            }
+        }
+        seq[i] = c;
+    }
+}
+
+
+const vector<char>& CSeqUtilPerfApp::x_GetData(CSeqUtil::TCoding coding)
+{
+    vector<char>& data = m_Data[coding];
+    if ( data.empty() ) {
+        CSeqConvert::Convert(m_Data[CSeqUtil::e_Iupacna],
+                             CSeqUtil::e_Iupacna, 0, m_Length,
+                             data, coding);
+    }
+    return data;
+}
+
+
+// report the best time of all runs
+void CSeqUtilPerfApp::x_Report(const char* name, double per_run)
+{
+    NcbiCout << setw(24) << left << name << right
+             << setw(10) << fixed << setprecision(3) << per_run*1e3
+             << " ms " << setw(10) << setprecision(1)
+             << (per_run > 0? m_Length / per_run / 1e6: 0.)
+             << " Mres/s" << NcbiEndl;
+}
+
+
+bool CSeqUtilPerfApp::x_TestConvert(const char* name,
+                                    CSeqUtil::TCoding src_coding,
+                                    CSeqUtil::TCoding dst_coding)
+{
+    const vector<char>& src = x_GetData(src_coding);
+    vector<char> dst(s_Bytes(dst_coding, m_Length));
+
+    double best = 0;
+    for ( int i = 0; i < m_Iterations; ++i ) {
+        CStopWatch sw(CStopWatch::eStart);
+        CSeqConvert::Convert(&src[0], src_coding, 0, m_Length,
+                             &dst[0], dst_coding);
+        double t = sw.Elapsed();
+        if ( i == 0  ||  t < best ) {
+            best = t;
+        }
+    }
+    x_Report(name, best);
+
+    vector<char> ref(dst.size());
+    for ( TSeqPos pos = 0; pos < m_Length; pos += kPiece ) {
+        CSeqConvert::Convert(&src[0], src_coding, pos,
+                             min(kPiece, m_Length-pos),
+                             &ref[pos/s_BasesPerByte(dst_coding)],
+                             dst_coding);
+    }
+    if ( dst != ref ) {
+        ERR_POST(name << ": result mismatch");
+        return false;
+    }
+    return true;
+}
+
+
+bool CSeqUtilPerfApp::x_TestRevCmp(const char* name,
+                                   CSeqUtil::TCoding coding)
+{
+    const vector<char>& src = x_GetData(coding);
+    vector<char> dst(s_Bytes(coding, m_Length));
+
+    double best = 0;
+    for ( int i = 0; i < m_Iterations; ++i ) {
+        CStopWatch sw(CStopWatch::eStart);
+        CSeqManip::ReverseComplement(&src[0], coding, 0, m_Length, &dst[0]);
+        double t = sw.Elapsed();
+        if ( i == 0  ||  t < best ) {
+            best = t;
+        }
+    }
+    x_Report(name, best);
+
+    vector<char> ref(dst.size());
+    for ( TSeqPos pos = 0; pos < m_Length; pos += kPiece ) {
+        TSeqPos count = min(kPiece, m_Length-pos);
+        TSeqPos dst_pos = m_Length - pos - count;
+        CSeqManip::ReverseComplement(&src[0], coding, pos, count,
+                                     &ref[dst_pos/s_BasesPerByte(coding)]);
+    }
+    if ( dst != ref ) {
+        ERR_POST(name << ": result mismatch");
+        return false;
+    }
+
+    if ( s_BasesPerByte(coding) == 1 ) {
+        // packed codings are reversed in place through ncbi8na
+        vector<char> in_place(src);
+        CSeqManip::ReverseComplement(in_place, coding, 0, m_Length);
+        if ( in_place != ref ) {
+            ERR_POST(name << ": in place result mismatch");
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int CSeqUtilPerfApp::Run(void)
+{
+    const CArgs& args = GetArgs();
+
+    // keep the pieces of the reference results byte aligned
+    m_Length = TSeqPos(args["length"].AsInteger()) / kPiece * kPiece;
+    m_Iterations = max(args["iterations"].AsInteger(), 1);
+    x_MakeSequence(m_Length, args["mixed"], Uint4(args["seed"].AsInteger()));
+
+    bool ok = true;
+    ok &= x_TestConvert("iupacna -> ncbi2na",
+                        CSeqUtil::e_Iupacna, CSeqUtil::e_Ncbi2na);
+    ok &= x_TestConvert("iupacna -> ncbi4na",
+                        CSeqUtil::e_Iupacna, CSeqUtil::e_Ncbi4na);
+    ok &= x_TestConvert("iupacna -> ncbi8na",
+                        CSeqUtil::e_Iupacna, CSeqUtil::e_Ncbi8na);
+    ok &= x_TestConvert("ncbi2na -> iupacna",
+                        CSeqUtil::e_Ncbi2na, CSeqUtil::e_Iupacna);
+    ok &= x_TestConvert("ncbi2na -> ncbi8na",
+                        CSeqUtil::e_Ncbi2na, CSeqUtil::e_Ncbi8na);
+    ok &= x_TestConvert("ncbi4na -> iupacna",
+                        CSeqUtil::e_Ncbi4na, CSeqUtil::e_Iupacna);
+    ok &= x_TestConvert("ncbi4na -> ncbi8na",
+                        CSeqUtil::e_Ncbi4na, CSeqUtil::e_Ncbi8na);
+    ok &= x_TestConvert("ncbi8na -> ncbi2na",
+                        CSeqUtil::e_Ncbi8na, CSeqUtil::e_Ncbi2na);
+    ok &= x_TestConvert("ncbi8na -> iupacna",
+                        CSeqUtil::e_Ncbi8na, CSeqUtil::e_Iupacna);
+    ok &= x_TestRevCmp("iupacna revcmp", CSeqUtil::e_Iupacna);
+    ok &= x_TestRevCmp("ncbi2na revcmp", CSeqUtil::e_Ncbi2na);
+    ok &= x_TestRevCmp("ncbi4na revcmp", CSeqUtil::e_Ncbi4na);
+    ok &= x_TestRevCmp("ncbi8na revcmp", CSeqUtil::e_Ncbi8na);
+
+    return ok? 0: 1;
+}
+
+
+int main(int argc, const char* argv[])
+{
+    return CSeqUtilPerfApp().AppMain(argc, argv);
+}
@@ -37,6 +37,10 @@
 #include <util/error_codes.hpp>
 #include <algorithm>
 
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+#  include <emmintrin.h>
+#endif
+
 
 #define NCBI_USE_ERRCODE_X   Util_Stream
 
@@ -306,6 +310,47 @@ size_t CIStreamBuffer::PeekFindChar(char c, size_t limit)
 }
 
 
+size_t CIStreamBuffer::PeekFindSpecialChar(char c1, char c2, bool stop8bit)
+    THROWS1((CIOException))
+{
+    PeekChar();
+    // cache pointers
+    const char* start = m_CurrentPos;
+    const char* end = m_DataEndPos;
+    const char* pos = start;
+#if defined(NCBI_SSE)  &&  NCBI_SSE >= 20
+    // check 16 chars at once, find the exact position below
+    const __m128i v1 = _mm_set1_epi8(c1);
+    const __m128i v2 = _mm_set1_epi8(c2);
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i maxCtrl = _mm_set1_epi8(' ' - 1);
+    for ( ; end - pos >= 16; pos += 16 ) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(d, v1),
+                                 _mm_cmpeq_epi8(d, v2));
+        if ( stop8bit ) {
+            // signed comparison catches chars above 0x7F as well
+            m = _mm_or_si128(m, _mm_cmplt_epi8(d, space));
+        }
+        else {
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(d, maxCtrl), d));
+        }
+        if ( _mm_movemask_epi8(m) ) {
+            break;
+        }
+    }
+#endif
+    for ( ; pos < end; ++pos ) {
+        char c = *pos;
+        if ( c == c1  ||  c == c2  ||  (unsigned char)c < ' '  ||
+             (stop8bit  &&  (c & 0x80)) ) {
+            break;
+        }
+    }
+    return pos - start;
+}
+
+
 bool CIStreamBuffer::TrySetCurrentPos(const char* pos)
 {
     if (m_BufferPos == 0 && pos >= m_Buffer && pos <= m_DataEndPos) {